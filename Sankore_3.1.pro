@@ -60,6 +60,20 @@ DEPENDPATH += $$THIRD_PARTY_PATH/trolltech/singleapplication
 INCLUDEPATH += $$THIRD_PARTY_PATH/trolltech/singleapplication
 include($$THIRD_PARTY_PATH/trolltech/singleapplication/qtsingleapplication.pri)
 
+# Headless benchmark suite: qmake "CONFIG+=bench" builds sankore-bench instead of the application
+CONFIG(bench) {
+   TARGET = "sankore-bench"
+   SOURCES -= src/core/main.cpp
+   include(src/bench/bench.pri)
+}
+
+# Batch converter: qmake "CONFIG+=convert" builds sankore-convert instead of the application
+CONFIG(convert) {
+   TARGET = "sankore-convert"
+   SOURCES -= src/core/main.cpp
+   include(src/convert/convert.pri)
+}
+
 FORMS += resources/forms/mainWindow.ui \
    resources/forms/preferences.ui \
    resources/forms/brushProperties.ui \
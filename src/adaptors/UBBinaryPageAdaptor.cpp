@@ -0,0 +1,513 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBBinaryPageAdaptor.h"
+
+#include "core/UB.h"
+
+#include "document/UBDocumentProxy.h"
+
+#include "domain/UBGraphicsScene.h"
+#include "domain/UBGraphicsPolygonItem.h"
+#include "domain/UBGraphicsStroke.h"
+
+#include "adaptors/UBSvgSubsetAdaptor.h"
+
+#include "frameworks/UBFileSystemUtils.h"
+#include "frameworks/UBTrace.h"
+
+#include "core/memcheck.h"
+
+static const quint32 pageMagic = 0x55425047; // "UBPG"
+static const quint16 pageVersion = 1;
+
+// hundredths of a pixel, as written in the svg file
+static const qreal pointScale = 100.0;
+
+enum PolygonFlag
+{
+    NominalLine = 0x1
+};
+
+
+static void writeVarint(QByteArray& pData, quint64 pValue)
+{
+    while (pValue >= 0x80)
+    {
+        pData.append((char)((pValue & 0x7f) | 0x80));
+        pValue >>= 7;
+    }
+
+    pData.append((char)pValue);
+}
+
+
+static void writeSignedVarint(QByteArray& pData, qint64 pValue)
+{
+    writeVarint(pData, ((quint64)pValue << 1) ^ (quint64)(pValue >> 63));
+}
+
+
+static void writeDouble(QByteArray& pData, double pValue)
+{
+    quint64 bits;
+    memcpy(&bits, &pValue, sizeof(bits));
+
+    bits = qToLittleEndian(bits);
+    pData.append((const char*)&bits, sizeof(bits));
+}
+
+
+class UBInkReader
+{
+    public:
+        UBInkReader(const QByteArray& pData)
+            : mCurrent(pData.constData())
+            , mEnd(pData.constData() + pData.size())
+            , mHasError(false)
+        {
+            // NOOP
+        }
+
+        bool hasError() const
+        {
+            return mHasError;
+        }
+
+        quint64 readVarint()
+        {
+            quint64 value = 0;
+            int shift = 0;
+
+            while (mCurrent < mEnd && shift < 64)
+            {
+                quint8 byte = *mCurrent++;
+                value |= (quint64)(byte & 0x7f) << shift;
+
+                if (!(byte & 0x80))
+                    return value;
+
+                shift += 7;
+            }
+
+            mHasError = true;
+            return 0;
+        }
+
+        qint64 readSignedVarint()
+        {
+            quint64 value = readVarint();
+            return (qint64)(value >> 1) ^ -(qint64)(value & 1);
+        }
+
+        double readDouble()
+        {
+            if (mEnd - mCurrent < (int)sizeof(quint64))
+            {
+                mHasError = true;
+                return 0;
+            }
+
+            quint64 bits;
+            memcpy(&bits, mCurrent, sizeof(bits));
+            mCurrent += sizeof(bits);
+
+            bits = qFromLittleEndian(bits);
+
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+
+            return value;
+        }
+
+    private:
+        const char* mCurrent;
+        const char* mEnd;
+        bool mHasError;
+};
+
+
+void UBBinaryPageAdaptor::appendPolygon(Ink& pInk, UBGraphicsPolygonItem* pPolygonItem, int pStrokeIndex)
+{
+    QRgb itemColors[3] = {pPolygonItem->brush().color().rgba(),
+                          pPolygonItem->colorOnDarkBackground().rgba(),
+                          pPolygonItem->colorOnLightBackground().rgba()};
+
+    QByteArray& ink = pInk.data;
+
+    writeVarint(ink, pStrokeIndex);
+    writeVarint(ink, pPolygonItem->isNominalLine() ? NominalLine : 0);
+
+    for (int i = 0; i < 3; i++)
+    {
+        if (!pInk.colorIndexes.contains(itemColors[i]))
+        {
+            pInk.colorIndexes.insert(itemColors[i], pInk.colors.size());
+            pInk.colors << itemColors[i];
+        }
+
+        writeVarint(ink, pInk.colorIndexes.value(itemColors[i]));
+    }
+
+    writeDouble(ink, pPolygonItem->zValue());
+
+    if (pPolygonItem->isNominalLine())
+    {
+        QLineF line = pPolygonItem->originalLine();
+
+        writeSignedVarint(ink, qRound64(line.x1() * pointScale));
+        writeSignedVarint(ink, qRound64(line.y1() * pointScale));
+        writeSignedVarint(ink, qRound64(line.x2() * pointScale));
+        writeSignedVarint(ink, qRound64(line.y2() * pointScale));
+        writeVarint(ink, qRound64(pPolygonItem->originalWidth() * pointScale));
+    }
+    else
+    {
+        const QPolygonF& polygon = pPolygonItem->polygon();
+
+        writeVarint(ink, polygon.size());
+
+        qint64 previousX = 0;
+        qint64 previousY = 0;
+
+        // consecutive points of a stroke are close, their deltas fit in one or two bytes
+        for (int i = 0; i < polygon.size(); i++)
+        {
+            qint64 x = qRound64(polygon.at(i).x() * pointScale);
+            qint64 y = qRound64(polygon.at(i).y() * pointScale);
+
+            writeSignedVarint(ink, x - previousX);
+            writeSignedVarint(ink, y - previousY);
+
+            previousX = x;
+            previousY = y;
+        }
+    }
+
+    pInk.polygonCount++;
+}
+
+
+bool UBBinaryPageAdaptor::readPolygons(const Ink& pInk, QList<UBGraphicsPolygonItem*>& pPolygonItems, QList<int>& pStrokeIndexes)
+{
+    UBInkReader reader(pInk.data);
+
+    for (quint32 i = 0; i < pInk.polygonCount && !reader.hasError(); i++)
+    {
+        int strokeIndex = reader.readVarint();
+        int flags = reader.readVarint();
+
+        QColor itemColors[3];
+
+        for (int j = 0; j < 3; j++)
+        {
+            int colorIndex = reader.readVarint();
+            itemColors[j] = QColor::fromRgba(pInk.colors.value(colorIndex));
+        }
+
+        qreal zValue = reader.readDouble();
+
+        UBGraphicsPolygonItem* polygonItem = 0;
+
+        if (flags & NominalLine)
+        {
+            qreal x1 = reader.readSignedVarint() / pointScale;
+            qreal y1 = reader.readSignedVarint() / pointScale;
+            qreal x2 = reader.readSignedVarint() / pointScale;
+            qreal y2 = reader.readSignedVarint() / pointScale;
+            qreal width = reader.readVarint() / pointScale;
+
+            polygonItem = new UBGraphicsPolygonItem(QLineF(x1, y1, x2, y2), width);
+        }
+        else
+        {
+            int pointCount = reader.readVarint();
+
+            QPolygonF polygon;
+            polygon.reserve(qMin(pointCount, pInk.data.size()));
+
+            qint64 x = 0;
+            qint64 y = 0;
+
+            for (int j = 0; j < pointCount && !reader.hasError(); j++)
+            {
+                x += reader.readSignedVarint();
+                y += reader.readSignedVarint();
+
+                polygon << QPointF(x / pointScale, y / pointScale);
+            }
+
+            polygonItem = new UBGraphicsPolygonItem();
+            polygonItem->setPolygon(polygon);
+        }
+
+        polygonItem->setColor(itemColors[0]);
+        polygonItem->setColorOnDarkBackground(itemColors[1]);
+        polygonItem->setColorOnLightBackground(itemColors[2]);
+        polygonItem->setZValue(zValue);
+
+        pPolygonItems << polygonItem;
+        pStrokeIndexes << strokeIndex;
+    }
+
+    if (reader.hasError())
+    {
+        qDeleteAll(pPolygonItems);
+        pPolygonItems.clear();
+        pStrokeIndexes.clear();
+
+        return false;
+    }
+
+    return true;
+}
+
+
+qreal UBBinaryPageAdaptor::addPolygons(UBGraphicsScene* pScene, const QList<UBGraphicsPolygonItem*>& pPolygonItems,
+                                       const QList<int>& pStrokeIndexes, QHash<int, UBGraphicsStroke*>& pStrokes)
+{
+    qreal maxDrawingZIndex = 0;
+
+    for (int i = 0; i < pPolygonItems.size(); i++)
+    {
+        UBGraphicsPolygonItem* polygonItem = pPolygonItems.at(i);
+        int strokeIndex = pStrokeIndexes.value(i);
+
+        if (strokeIndex > 0)
+        {
+            if (!pStrokes.contains(strokeIndex))
+                pStrokes.insert(strokeIndex, new UBGraphicsStroke());
+
+            pStrokes.value(strokeIndex)->addPolygon(polygonItem);
+            polygonItem->setStroke(pStrokes.value(strokeIndex));
+        }
+
+        pScene->addItem(polygonItem);
+
+        polygonItem->setData(UBGraphicsItemData::ItemLayerType, QVariant(UBItemLayerType::Graphic));
+        maxDrawingZIndex = qMax(polygonItem->zValue(), maxDrawingZIndex);
+
+        polygonItem->show();
+    }
+
+    return maxDrawingZIndex;
+}
+
+
+QString UBBinaryPageAdaptor::pagePath(const QString& pDocumentPath, int pPageIndex)
+{
+    return pDocumentPath + UBFileSystemUtils::digitFileFormat("/page%1.ubpage", pPageIndex + 1);
+}
+
+
+static QString svgPath(const QString& pDocumentPath, int pPageIndex)
+{
+    return pDocumentPath + UBFileSystemUtils::digitFileFormat("/page%1.svg", pPageIndex + 1);
+}
+
+
+// false when the svg file was written by another version or another application since
+static bool readHeader(QDataStream& pStream, const QString& pDocumentPath, int pPageIndex)
+{
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64 svgSize = 0;
+    quint32 svgModified = 0;
+
+    pStream >> magic >> version >> svgSize >> svgModified;
+
+    QFileInfo svgInfo(svgPath(pDocumentPath, pPageIndex));
+
+    return pStream.status() == QDataStream::Ok && magic == pageMagic && version == pageVersion
+            && svgInfo.size() == svgSize && svgInfo.lastModified().toTime_t() == svgModified;
+}
+
+
+bool UBBinaryPageAdaptor::hasPendingSvg(const QString& pDocumentPath, int pPageIndex)
+{
+    QFile file(pagePath(pDocumentPath, pPageIndex));
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    return readHeader(stream, pDocumentPath, pPageIndex);
+}
+
+
+QByteArray UBBinaryPageAdaptor::pageSvgWithoutInk(const QString& pDocumentPath, int pPageIndex)
+{
+    QFile file(pagePath(pDocumentPath, pPageIndex));
+
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    if (!readHeader(stream, pDocumentPath, pPageIndex))
+        return QByteArray();
+
+    QByteArray skeleton;
+    stream >> skeleton;
+
+    if (stream.status() != QDataStream::Ok)
+        return QByteArray();
+
+    return qUncompress(skeleton);
+}
+
+
+bool UBBinaryPageAdaptor::persistSvg(UBDocumentProxy* pProxy, int pPageIndex)
+{
+    if (!hasPendingSvg(pProxy->persistencePath(), pPageIndex))
+        return true;
+
+    UB_TRACE_SCOPE("binary.persistSvg", "persistence");
+
+    UBGraphicsScene* scene = loadScene(pProxy, pPageIndex);
+
+    if (!scene)
+        return false;
+
+    // the writer skips the scenes that are not modified
+    scene->setModified(true);
+
+    UBSvgSubsetAdaptor::UBSvgSubsetWriter writer(pProxy, scene, pPageIndex);
+    bool written = writer.persistScene();
+
+    delete scene;
+
+    // the svg file is the newest version of the page, the binary page is written again on the next save
+    if (written)
+        QFile::remove(pagePath(pProxy->persistencePath(), pPageIndex));
+
+    return written;
+}
+
+
+bool UBBinaryPageAdaptor::persistScene(UBDocumentProxy* pProxy, UBGraphicsScene* pScene, int pPageIndex)
+{
+    UB_TRACE_SCOPE("binary.persistScene", "persistence");
+
+    QFileInfo svgInfo(svgPath(pProxy->persistencePath(), pPageIndex));
+
+    if (!svgInfo.exists())
+        return false;
+
+    Ink ink;
+    QHash<UBGraphicsStroke*, int> strokeIndexes;
+
+    foreach(QGraphicsItem* item, pScene->itemsInZOrder())
+    {
+        UBGraphicsPolygonItem* polygonItem = qgraphicsitem_cast<UBGraphicsPolygonItem*>(item);
+
+        if (!polygonItem || !polygonItem->isVisible() || item->scene() != pScene)
+            continue;
+
+        int strokeIndex = 0;
+
+        if (polygonItem->stroke())
+        {
+            if (!strokeIndexes.contains(polygonItem->stroke()))
+                strokeIndexes.insert(polygonItem->stroke(), strokeIndexes.size() + 1);
+
+            strokeIndex = strokeIndexes.value(polygonItem->stroke());
+        }
+
+        appendPolygon(ink, polygonItem, strokeIndex);
+    }
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    stream << pageMagic << pageVersion;
+    stream << (qint64)svgInfo.size() << (quint32)svgInfo.lastModified().toTime_t();
+    stream << qCompress(UBSvgSubsetAdaptor::sceneSvg(pProxy, pScene, pPageIndex, false));
+    stream << ink.colors << ink.polygonCount << ink.data;
+
+    QString fileName = pagePath(pProxy->persistencePath(), pPageIndex);
+    QString tmpFileName = fileName + ".tmp";
+    QFile file(tmpFileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "cannot open " << tmpFileName << " for writing ...";
+        return false;
+    }
+
+    bool written = file.write(data) == data.size() && file.flush();
+    file.close();
+
+    if (!written || !UBFileSystemUtils::replaceFile(tmpFileName, fileName))
+    {
+        file.remove();
+        return false;
+    }
+
+    return true;
+}
+
+
+UBGraphicsScene* UBBinaryPageAdaptor::loadScene(UBDocumentProxy* pProxy, int pPageIndex)
+{
+    QFile file(pagePath(pProxy->persistencePath(), pPageIndex));
+
+    if (!file.open(QIODevice::ReadOnly))
+        return 0;
+
+    UB_TRACE_SCOPE("binary.loadScene", "persistence");
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    if (!readHeader(stream, pProxy->persistencePath(), pPageIndex))
+        return 0;
+
+    QByteArray skeleton;
+    Ink ink;
+
+    stream >> skeleton >> ink.colors >> ink.polygonCount >> ink.data;
+
+    if (stream.status() != QDataStream::Ok)
+        return 0;
+
+    QList<UBGraphicsPolygonItem*> polygonItems;
+    QList<int> strokeIndexes;
+
+    if (!readPolygons(ink, polygonItems, strokeIndexes))
+    {
+        qWarning() << "corrupted binary page" << file.fileName();
+        return 0;
+    }
+
+    UBGraphicsScene* scene = UBSvgSubsetAdaptor::loadScene(pProxy, qUncompress(skeleton));
+
+    if (!scene)
+    {
+        qDeleteAll(polygonItems);
+        return 0;
+    }
+
+    QHash<int, UBGraphicsStroke*> strokes;
+
+    scene->setDrawingZIndex(addPolygons(scene, polygonItems, strokeIndexes, strokes));
+    scene->setModified(false);
+
+    return scene;
+}
@@ -0,0 +1,89 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBBINARYPAGEADAPTOR_H_
+#define UBBINARYPAGEADAPTOR_H_
+
+#include <QtGui>
+
+class UBDocumentProxy;
+class UBGraphicsScene;
+class UBGraphicsPolygonItem;
+class UBGraphicsStroke;
+
+/**
+ * Compact binary page, pageNNN.ubpage, the working copy of a page saved again after its svg file
+ * was first written. The saves of the page only write the binary page, stamped with the size and
+ * time of the svg file; while the svg file keeps that stamp the binary page is the newest version
+ * of the page and is loaded instead of it.
+ *
+ * The svg file is brought up to date by persistSvg() before the document files are read as svg
+ * (export, publishing, duplication, page copy) and when the application quits, the binary page is
+ * then removed.
+ *
+ * The ink is stored as item records: a color table, then for each polygon its stroke, colors,
+ * z value and points as zigzag varint deltas in hundredths of a pixel, the precision of the svg
+ * file. The other items are kept as an svg page without the ink, read by UBSvgSubsetAdaptor.
+ */
+class UBBinaryPageAdaptor
+{
+    public:
+        static QString pagePath(const QString& pDocumentPath, int pPageIndex);
+
+        static bool persistScene(UBDocumentProxy* pProxy, UBGraphicsScene* pScene, int pPageIndex);
+
+        // 0 when missing or older than the svg file
+        static UBGraphicsScene* loadScene(UBDocumentProxy* pProxy, int pPageIndex);
+
+        // true when the binary page is newer than the svg file, safe on any thread
+        static bool hasPendingSvg(const QString& pDocumentPath, int pPageIndex);
+
+        // the svg page stored without its ink, for the readers of the text; empty when the svg file is up to date
+        static QByteArray pageSvgWithoutInk(const QString& pDocumentPath, int pPageIndex);
+
+        // writes the svg file of a page from its binary page when it is newer, GUI thread only
+        static bool persistSvg(UBDocumentProxy* pProxy, int pPageIndex);
+
+        // ink records as stored in the binary page, also written by the document journal
+        struct Ink
+        {
+            Ink()
+                : polygonCount(0)
+            {
+                // NOOP
+            }
+
+            QList<QRgb> colors;
+            quint32 polygonCount;
+            QByteArray data;
+
+            QHash<QRgb, int> colorIndexes; // not stored
+        };
+
+        // pStrokeIndex groups the polygons of a stroke, 0 for none
+        static void appendPolygon(Ink& pInk, UBGraphicsPolygonItem* pPolygonItem, int pStrokeIndex);
+
+        // the polygons in their order and the stroke index of each, false when the records are corrupted
+        static bool readPolygons(const Ink& pInk, QList<UBGraphicsPolygonItem*>& pPolygonItems, QList<int>& pStrokeIndexes);
+
+        // adds the polygons read to a scene, pStrokes keeps the strokes by index across calls; returns the highest z value
+        static qreal addPolygons(UBGraphicsScene* pScene, const QList<UBGraphicsPolygonItem*>& pPolygonItems,
+                                 const QList<int>& pStrokeIndexes, QHash<int, UBGraphicsStroke*>& pStrokes);
+
+    private:
+        UBBinaryPageAdaptor() {}
+};
+
+#endif /* UBBINARYPAGEADAPTOR_H_ */
@@ -14,11 +14,11 @@
  */
 
 #include <QRegExp>
-#include <QSvgGenerator>
-#include <QSvgRenderer>
 
 
+#include "core/UBApplication.h"
 #include "core/UBPersistenceManager.h"
+#include "board/UBBoardController.h"
 #include "document/UBDocumentProxy.h"
 #include "domain/UBItem.h"
 #include "domain/UBGraphicsPolygonItem.h"
@@ -35,6 +35,7 @@
 
 //tag names definition
 //use them everiwhere!
+static QString tDefs            = "defs";
 static QString tElement         = "element";
 static QString tEllipse         = "ellipse";
 static QString tIwb             = "iwb";
@@ -50,6 +51,7 @@ static QString tTspan           = "tspan";
 static QString tBreak           = "tbreak";
 
 //attribute names definition
+static QString aId              = "id";
 static QString aFill            = "fill";
 static QString aFillopacity     = "fill-opacity";
 static QString aX               = "x";
@@ -62,6 +64,7 @@ static QString aCx              = "cx";
 static QString aCy              = "cy";
 static QString aRx              = "rx";
 static QString aRy              = "ry";
+static QString aPoints          = "points";
 static QString aTransform       = "transform";
 static QString aViewbox         = "viewbox";
 static QString aFontSize        = "font-size";
@@ -76,6 +79,50 @@ UBCFFSubsetAdaptor::UBCFFSubsetAdaptor()
 {
 }
 
+//copies the current element of the reader with its content, the reader is left on its end element
+static void copyElement(QXmlStreamReader& reader, QXmlStreamWriter& writer)
+{
+    int depth = 0;
+
+    do
+    {
+        if (reader.isStartElement())
+        {
+            writer.writeStartElement(reader.qualifiedName().toString());
+            foreach(const QXmlStreamAttribute& attribute, reader.attributes())
+                writer.writeAttribute(attribute.qualifiedName().toString(), attribute.value().toString());
+            depth++;
+        }
+        else
+        if (reader.isEndElement())
+        {
+            writer.writeEndElement();
+            depth--;
+        }
+        else
+        if (reader.isCharacters() && !reader.isWhitespace())
+            writer.writeCharacters(reader.text().toString());
+
+        if (depth > 0)
+            reader.readNext();
+    }
+    while (depth > 0 && !reader.atEnd());
+}
+
+//ids of the definitions used by a paint (url(#id)) or a gradient (xlink:href="#id")
+static void collectReferences(const QString& content, QStringList& ids)
+{
+    QRegExp reference("(?:url\\(#|href=\"#)([^)\"]+)");
+
+    int index = 0;
+    while ((index = reference.indexIn(content, index)) != -1)
+    {
+        if (!ids.contains(reference.cap(1)))
+            ids << reference.cap(1);
+        index += reference.matchedLength();
+    }
+}
+
 bool UBCFFSubsetAdaptor::ConvertCFFFileToUbz(QString &cffSourceFile, UBDocumentProxy* pDocument)
 {
     //TODO
@@ -115,16 +162,11 @@ bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parse()
     UBMetadataDcSubsetAdaptor::persist(mProxy);
 
     mIndent = "";
-    if (!getTempFileName())
-        return false;
 
     bool result = parseDoc();
     if (result)
         result = mProxy->pageCount() != 0;
 
-    if (QFile::exists(mTempFilePath))
-        QFile::remove(mTempFilePath);
-
     return result;
 }
 
@@ -250,6 +292,12 @@ bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseCurrentElementStart()
         if (!parseIwbElementRef())
             return false;
     }
+    else
+    if ( elName == tDefs)
+    {
+        if (!parseDefs())
+            return false;
+    }
 
     return true;
 }
@@ -330,35 +378,197 @@ bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseSvg()
     return true;
 }
 
-void UBCFFSubsetAdaptor::UBCFFSubsetReader::repositionSvgItem(UBGraphicsSvgItem *item, qreal width, qreal height, qreal x, qreal y, bool useTransform, QTransform &transform)
-{
-    QTransform curTrans = item->transform();
-    qWarning() << QString().sprintf("Item current transform = %f 0 0 %f %f %f, position %f, %f", curTrans.m11(), curTrans.m22(), curTrans.dx(), curTrans.dy(), item->x(), item->y());
-    //check if rect is rotated
-    //rotate svg item itself
-    QRectF itemBounds = item->boundingRect();
-    //first, svg is mapped to svg item bound
-    //second, svg item is mapped to scene
-    //so, get svg to svg item scale and multiple by scene scale
-    qreal hScale = itemBounds.width() / width * curTrans.m11();
-    qreal vScale = itemBounds.height() / height * curTrans.m22();
-    
-    if (useTransform)
-    {
-        QPointF oldVector((x - transform.dx()), (y - transform.dy()));
-        QTransform rTransform(transform.m11(), transform.m12(), transform.m21(), transform.m22(), 0, 0);
-        QPointF newVector = rTransform.map(oldVector);
-        rTransform.scale(curTrans.m11(), curTrans.m22());
-        item->setTransform(QTransform(rTransform.m11(), rTransform.m12(), rTransform.m21(), rTransform.m22(), 0, 0));
-        item->setPos((x - mViewBoxCenter.x() + (newVector - oldVector).x()) * hScale, (y - mViewBoxCenter.y() + (newVector - oldVector).y()) * vScale );
+bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseDefs()
+{
+    //the definitions (gradients, patterns) are kept by id, for the svg elements using them
+    while (!mReader.atEnd())
+    {
+        mReader.readNext();
+
+        if (mReader.isEndElement())
+            break;
+
+        if (mReader.isStartElement())
+        {
+            QString id = mReader.attributes().value(aId).toString();
+
+            QByteArray definition;
+            QXmlStreamWriter writer(&definition);
+            copyElement(mReader, writer);
+
+            if (!id.isEmpty())
+                mDefinitions.insert(id, definition);
+        }
+    }
+
+    //the end of the defs element is read here, parseCurrentElementEnd does not see it
+    mIndent.remove(0,1);
+
+    if (mReader.hasError())
+    {
+        qWarning() << "iwb content parse error, unreadable defs at line" << mReader.lineNumber();
+        return false;
+    }
+
+    return true;
+}
+
+QTransform UBCFFSubsetAdaptor::UBCFFSubsetReader::elementToSceneTransform()
+{
+    //rotation of the element around the center given in its transform attribute
+    QTransform elementTransform;
+    QTransform svgTransform;
+    if (getCurElementTransorm(svgTransform))
+    {
+        QTransform rotation(svgTransform.m11(), svgTransform.m12(), svgTransform.m21(), svgTransform.m22(), 0, 0);
+        elementTransform = QTransform::fromTranslate(-svgTransform.dx(), -svgTransform.dy())
+                * rotation
+                * QTransform::fromTranslate(svgTransform.dx(), svgTransform.dy());
     }
-    else
+
+    //the view box center is the scene origin, items are scaled as the ones added on the board
+    qreal scale = 1;
+    if (UBApplication::boardController)
+        scale = 1 / UBApplication::boardController->systemScaleFactor();
+
+    return elementTransform
+            * QTransform::fromTranslate(-mViewBoxCenter.x(), -mViewBoxCenter.y())
+            * QTransform::fromScale(scale, scale);
+}
+
+bool UBCFFSubsetAdaptor::UBCFFSubsetReader::isSupportedPaint(const QString& paint)
+{
+    //gradients and patterns (url(#id)) have no native equivalent
+    return paint.isEmpty() || paint == "none" || colorFromString(paint).isValid();
+}
+
+bool UBCFFSubsetAdaptor::UBCFFSubsetReader::addShape(const QPainterPath& path)
+{
+    QTransform transform = elementToSceneTransform();
+
+    QString fill = mReader.attributes().value(aFill).toString();
+    QString stroke = mReader.attributes().value(aStroke).toString();
+
+    if (!isSupportedPaint(fill) || !isSupportedPaint(stroke))
+        return addSvgElement(path.controlPointRect(), transform);
+
+    //fill and stroke of a shape stay grouped, as the polygons of a stroke drawn on the board
+    UBGraphicsStroke *group = new UBGraphicsStroke();
+
+    QColor fillColor = colorFromString(fill);
+    if (fill != "none" && fillColor.isValid())
+    {
+        if (mReader.attributes().hasAttribute(aFillopacity))
+            fillColor.setAlphaF(mReader.attributes().value(aFillopacity).toString().toDouble());
+
+        addPolygonItem(path.toFillPolygon(transform), fillColor, group);
+    }
+
+    QColor strokeColor = colorFromString(stroke);
+    qreal strokeWidth = 1;
+    if (mReader.attributes().hasAttribute(aStrokewidth))
+        strokeWidth = mReader.attributes().value(aStrokewidth).toString().toDouble();
+
+    if (stroke != "none" && strokeColor.isValid() && strokeWidth > 0)
+    {
+        QPainterPathStroker stroker;
+        stroker.setWidth(strokeWidth);
+        stroker.setJoinStyle(Qt::MiterJoin);
+
+        addPolygonItem(stroker.createStroke(path).toFillPolygon(transform), strokeColor, group);
+    }
+
+    if (group->polygons().isEmpty())
+        delete group;
+
+    return true;
+}
+
+void UBCFFSubsetAdaptor::UBCFFSubsetReader::addPolygonItem(const QPolygonF& polygon, const QColor& color, UBGraphicsStroke *group)
+{
+    UBGraphicsPolygonItem *polygonItem = new UBGraphicsPolygonItem(polygon);
+
+    polygonItem->setColor(color);
+    polygonItem->setColorOnDarkBackground(color);
+    polygonItem->setColorOnLightBackground(color);
+
+    polygonItem->setZValue(mCurrentScene->getNextObjectZIndex());
+    polygonItem->setData(UBGraphicsItemData::ItemLayerType, QVariant(UBItemLayerType::Graphic));
+
+    group->addPolygon(polygonItem);
+    polygonItem->setStroke(group);
+
+    mCurrentScene->addItem(polygonItem);
+}
+
+bool UBCFFSubsetAdaptor::UBCFFSubsetReader::addSvgElement(const QRectF& bounds, const QTransform& transform)
+{
+    //standalone svg document made of the current element only, rendered by QtSvg
+    QRectF viewBox = bounds.adjusted(-5, -5, 5, 5);
+
+    QByteArray svg;
+    QXmlStreamWriter writer(&svg);
+    writer.writeStartDocument();
+    writer.writeStartElement(tSvg);
+    writer.writeDefaultNamespace("http://www.w3.org/2000/svg");
+    writer.writeNamespace("http://www.w3.org/1999/xlink", "xlink");
+    writer.writeAttribute(aWidth, QString::number(viewBox.width()));
+    writer.writeAttribute(aHeight, QString::number(viewBox.height()));
+    writer.writeAttribute("viewBox", QString("%1 %2 %3 %4").arg(viewBox.x()).arg(viewBox.y()).arg(viewBox.width()).arg(viewBox.height()));
+
+    //the definitions used by the element, and the ones they use in turn
+    QStringList ids;
+    foreach(const QXmlStreamAttribute& attribute, mReader.attributes())
+        collectReferences(attribute.value().toString(), ids);
+
+    for (int i = 0; i < ids.size(); i++)
+        collectReferences(QString::fromUtf8(mDefinitions.value(ids.at(i))), ids);
+
+    if (!ids.isEmpty())
+    {
+        writer.writeStartElement(tDefs);
+
+        //QtSvg resolves the references while parsing, the definitions used come first
+        for (int i = ids.size() - 1; i >= 0; i--)
+        {
+            if (!mDefinitions.contains(ids.at(i)))
+                continue;
+
+            QXmlStreamReader definition(mDefinitions.value(ids.at(i)));
+            definition.setNamespaceProcessing(false);
+
+            while (!definition.atEnd() && !definition.isStartElement())
+                definition.readNext();
+
+            if (definition.isStartElement())
+                copyElement(definition, writer);
+        }
+
+        writer.writeEndElement();
+    }
+
+    writer.writeStartElement(mReader.name().toString());
+    foreach(const QXmlStreamAttribute& attribute, mReader.attributes())
     {
-        item->setPos((x - mViewBoxCenter.x()) * hScale, (y  - mViewBoxCenter.y()) * vScale);
+        if (attribute.name() != aTransform)
+            writer.writeAttribute(attribute.name().toString(), attribute.value().toString());
     }
+    writer.writeEndElement();
+
+    writer.writeEndElement();
+    writer.writeEndDocument();
+
+    UBGraphicsSvgItem *svgItem = new UBGraphicsSvgItem(svg);
+    svgItem->setFlag(QGraphicsItem::ItemIsMovable, true);
+    svgItem->setFlag(QGraphicsItem::ItemIsSelectable, true);
+    svgItem->setZValue(mCurrentScene->getNextObjectZIndex());
 
-    QTransform newTrans = item->transform();
-    qWarning() << QString("Item new transform = %3 0 0 %4 %1 %2, position %5, %6").arg(newTrans.dx()).arg(newTrans.dy()).arg(newTrans.m11()).arg(newTrans.m22()).arg(item->x()).arg(item->y());
+    svgItem->setTransform(QTransform(transform.m11(), transform.m12(), transform.m21(), transform.m22(), 0, 0));
+    svgItem->setPos(transform.map(viewBox.topLeft()));
+
+    mCurrentScene->addItem(svgItem);
+
+    return true;
 }
 
 bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseRect()
@@ -380,45 +590,10 @@ bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseRect()
     qreal width = mReader.attributes().value(aWidth).toString().toDouble();
     qreal height = mReader.attributes().value(aHeight).toString().toDouble();
 
-    //init svg generator with temp file
-    QSvgGenerator *generator = createSvgGenerator(width + 10, height + 10);
+    QPainterPath path;
+    path.addRect(x1, y1, width, height);
 
-    //init painter to paint to svg
-    QPainter painter;
-    painter.begin(generator);
-
-    //fill rect
-    if (mReader.attributes().hasAttribute(aFill))
-    {
-        QColor fillColor = colorFromString(mReader.attributes().value(aFill).toString());
-        painter.setBrush(QBrush(fillColor));
-        painter.fillRect(5, 5, width, height, fillColor);
-    }
-
-    bool hasStrokeColor = mReader.attributes().hasAttribute(aStroke);
-    bool hasStrokeWidth = mReader.attributes().hasAttribute(aStrokewidth);
-    if (hasStrokeColor || hasStrokeWidth)
-    {
-        QPen pen;
-        if (hasStrokeColor)
-            pen.setColor(colorFromString(mReader.attributes().value(aStroke).toString()));
-        if (hasStrokeWidth)
-            pen.setWidth(mReader.attributes().value(aStrokewidth).toString().toInt());
-        
-        painter.setPen(pen);
-        painter.drawRect(5, 5, width, height);
-    }
-
-    painter.end();
-
-    //add resulting svg file to scene
-    UBGraphicsSvgItem *svgItem = mCurrentScene->addSvg(QUrl::fromLocalFile(generator->fileName()));
-    QTransform transform;
-    bool hastransform = getCurElementTransorm(transform);
-    repositionSvgItem(svgItem, width + 10, height + 10, x1 - 5, y1 - 5, hastransform, transform);
-    delete generator;
-
-    return true;
+    return addShape(path);
 }
 
 bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseEllipse()
@@ -436,43 +611,16 @@ bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseEllipse()
     //ellipse horisontal and vertical radius
     qreal rx = mReader.attributes().value(aRx).toString().toDouble();
     qreal ry = mReader.attributes().value(aRy).toString().toDouble();
-    QSvgGenerator *generator = createSvgGenerator(rx * 2 + 10, ry * 2 + 10);
-
-    //fill and stroke color
-    QColor fillColor = colorFromString(mReader.attributes().value(aFill).toString());
-    QColor strokeColor = colorFromString(mReader.attributes().value(aStroke).toString());
-    int strokeWidth = mReader.attributes().value(aStrokewidth).toString().toInt();
 
     //ellipse center coordinates
     qreal cx = mReader.attributes().value(aCx).toString().toDouble();
     qreal cy = mReader.attributes().value(aCy).toString().toDouble();
 
-    //init painter to paint to svg
-    QPainter painter;
-    painter.begin(generator);
-
-    QPen pen(strokeColor);
-    pen.setWidth(strokeWidth);
-    painter.setPen(pen);
-    painter.setBrush(QBrush(fillColor));
-
-    painter.drawEllipse(5, 5, rx * 2, ry * 2);
-
-    painter.end();
-
+    QPainterPath path;
+    path.addEllipse(QPointF(cx, cy), rx, ry);
 
-    //add resulting svg file to scene
-    UBGraphicsSvgItem *svgItem = mCurrentScene->addSvg(QUrl::fromLocalFile(generator->fileName()));
-
-    QTransform transform;
-    bool hasTransform = getCurElementTransorm(transform);
-
-    repositionSvgItem(svgItem, rx * 2 + 10, ry * 2 + 10, cx - rx - 5, cy - ry -5, hasTransform, transform);
-
-    delete generator;
-
-    return true;
-   }
+    return addShape(path);
+}
 
 bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseTextArea()
 {
@@ -486,91 +634,20 @@ bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseTextArea()
     if (currentState == SVG && mCurrentScene == NULL)
         createNewScene();
 
-    //TODO textarea node
     qreal x = mReader.attributes().value(aX).toString().toDouble();
     qreal y = mReader.attributes().value(aY).toString().toDouble();
     qreal width = mReader.attributes().value(aWidth).toString().toDouble();
-    qreal height = mReader.attributes().value(aHeight).toString().toDouble();
-
-    qWarning() << QString().sprintf("Text coordinates : %f,%f. Text size %f,%f", x, y, width, height);
-
-    qreal fontSize = 12.0;
-    QColor fontColor;
-    QString fontFamily = "Arial";
-    QString fontStretch = "normal";
-    bool italic = false;
-    int fontWeight = QFont::Normal;
-    int textAlign = Qt::AlignLeft;
-    QTransform fontTransform;
-    parseTextAttributes(fontSize, fontColor, fontFamily, fontStretch, italic, fontWeight, textAlign, fontTransform);
-
-    QSvgGenerator *generator = createSvgGenerator(width, height);
-    QPainter painter;
-    painter.begin(generator);
-    painter.setFont(QFont(fontFamily, fontSize, fontWeight, italic));
 
-    qreal curY = 0.0;
-    qreal curX = 0.0;
-    qreal linespacing = QFontMetricsF(painter.font()).leading();
+    //transform must be read before moving to the child elements
+    QTransform transform = elementToSceneTransform();
 
-    //remember if text area has transform
-    QString transformString;
-    QTransform transform;
-    bool hasTransform = getCurElementTransorm(transform);
+    qreal contentWidth = 0;
+    UBGraphicsTextItem *textItem = readTextItem(tTextarea, contentWidth);
 
-    QRectF lastDrawnTextBoundingRect;
-    //parse text area tags
-    while(true)
-    {
-        mReader.readNext();
-        QStringRef elementName = mReader.name();
-        if (mReader.isEndDocument())
-            break;
-        if (mReader.isEndElement() && elementName == tBreak)
-        {
-            //when tbreak appers, move down by the drawn rect height
-            //TODO: line spacing is not calculated yet, additional code is required
-            curY += lastDrawnTextBoundingRect.height() + linespacing;
-            curX = 0.0;
-            lastDrawnTextBoundingRect = QRectF(0,0,0,0);
-            continue;
-        }
-        if (mReader.isEndElement() && elementName == tTextarea)
-            break;
-        if (mReader.isStartElement() && elementName == tTspan)
-        {
-            parseTextAttributes(fontSize, fontColor, fontFamily, fontStretch, italic, fontWeight, textAlign, fontTransform);
-            painter.setFont(QFont(fontFamily, fontSize, fontWeight, italic));
-            painter.setPen(fontColor);
-            linespacing = QFontMetricsF(painter.font()).leading();
-            continue;
-        }
-        if (mReader.isCharacters() || mReader.isCDATA())
-        {
-            QString text = mReader.text().toString().trimmed();
+    //text area wraps its content
+    textItem->setTextWidth(width);
 
-            //skip empty text
-            if (text.length() == 0)
-                continue;
-
-            //get bounding rect to obtain desired text height
-            lastDrawnTextBoundingRect = painter.boundingRect(QRectF(curX, curY, width, height - curY), textAlign|Qt::TextWordWrap, text);
-            QString log = QString().sprintf(" at rect  %f, %f, %f, %f. Bounding rect is %f, %f, %f, %f", 0.0, curY, width, height - curY, lastDrawnTextBoundingRect.x(), lastDrawnTextBoundingRect.y(), lastDrawnTextBoundingRect.width(), lastDrawnTextBoundingRect.height());
-            qWarning() << "Text " << text << log;
-            painter.drawText(curX, curY, width, lastDrawnTextBoundingRect.height(), textAlign|Qt::TextWordWrap, text);
-            curX += lastDrawnTextBoundingRect.x() + lastDrawnTextBoundingRect.width();
-            
-            continue;
-        }
-    }
-
-    painter.end();
-
-    //add resulting svg file to scene
-    UBGraphicsSvgItem *svgItem = mCurrentScene->addSvg(QUrl::fromLocalFile(generator->fileName()));
-
-    repositionSvgItem(svgItem, width, height, x, y, hasTransform, transform);
-    delete generator;
+    addTextItem(textItem, QPointF(x, y), transform);
 
     return true;
 }
@@ -590,50 +667,49 @@ bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseText()
     qreal x = mReader.attributes().value(aX).toString().toDouble();
     qreal y = mReader.attributes().value(aY).toString().toDouble();
 
-    qreal width = 0;
-    qreal height = 0;
+    //transform must be read before moving to the child elements
+    QTransform transform = elementToSceneTransform();
+
+    qreal contentWidth = 0;
+    UBGraphicsTextItem *textItem = readTextItem(tText, contentWidth);
 
-    QList<QRectF> textRects;
-    QList<QFont> textFonts;
-    QList<QString> textLines;
-    QList<int> textAligns;
-    QList<QColor> textColors;
+    //text does not wrap, lines are only broken by tbreak
+    textItem->setTextWidth(contentWidth + 2 * textItem->document()->documentMargin());
 
-    qWarning() << QString().sprintf("Text coordinates : %f,%f. Text size %f,%f", x, y, width, height);
+    addTextItem(textItem, QPointF(x, y), transform);
 
+    return true;
+}
+
+UBGraphicsTextItem* UBCFFSubsetAdaptor::UBCFFSubsetReader::readTextItem(const QString& endElement, qreal &contentWidth)
+{
     qreal fontSize = 12.0;
-    QFont textFont;
     QColor fontColor;
     QString fontFamily = "Arial";
     QString fontStretch = "normal";
-
     bool italic = false;
     int fontWeight = QFont::Normal;
     int textAlign = Qt::AlignLeft;
     QTransform fontTransform;
     parseTextAttributes(fontSize, fontColor, fontFamily, fontStretch, italic, fontWeight, textAlign, fontTransform);
-    textFont = QFont(fontFamily, fontSize, fontWeight, italic);
-
-    QFontMetricsF metrics = QFontMetricsF(textFont);
-    qreal curHeight = metrics.height();
 
-    qreal curY = 0.0;
-    qreal curX = 0.0;
+    UBGraphicsTextItem *textItem = new UBGraphicsTextItem();
+    QTextCursor cursor(textItem->document());
 
-    qreal linespacing = QFontMetrics(textFont).leading();
+    QTextCharFormat format = textFormat(fontSize, fontColor, fontFamily, italic, fontWeight);
+    QTextBlockFormat blockFormat;
+    blockFormat.setAlignment((Qt::Alignment)textAlign);
+    cursor.setBlockFormat(blockFormat);
 
-    //remember if text area has transform
-    QTransform transform;
-    bool hasTransform = getCurElementTransorm(transform);
+    QStack<QTextCharFormat> formatStack;
+    QStack<int> alignStack;
 
-    QRectF lastDrawnTextBoundingRect;
+    qreal lineWidth = 0;
+    contentWidth = 0;
 
-    QStack<QFont> fontStack;
-    QStack<QColor> colorStack;
-    QStack<int> alignStack;
+    //text area content is trimmed, text content is kept as is
+    bool trimText = endElement == tTextarea;
 
-    // first extimate desired text area size
-    // to do that, parse text area tags
     while(true)
     {
         mReader.readNext();
@@ -644,35 +720,30 @@ bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseText()
         {
             if (elementName == tBreak)
             {
-                //when tbreak appers, move down by the drawn rect height
-                //TODO: line spacing is not calculated yet, probably additional code is required
-                curY += lastDrawnTextBoundingRect.height() + linespacing;
-                curX = 0.0;
-                height += lastDrawnTextBoundingRect.height();
-                lastDrawnTextBoundingRect = QRectF(0,0,0,0);
+                blockFormat.setAlignment((Qt::Alignment)textAlign);
+                cursor.insertBlock(blockFormat);
+                lineWidth = 0;
                 continue;
             }
-            if (elementName == tTspan)
+            if (elementName == tTspan && !formatStack.isEmpty())
             {
-                textFont = fontStack.pop();
-                fontColor = colorStack.pop();
+                format = formatStack.pop();
                 textAlign = alignStack.pop();
                 continue;
             }
+            if (elementName == endElement)
+                break;
         }
-        if (mReader.isEndElement() && elementName == tText)
-            break;
         if (mReader.isStartElement() && elementName == tTspan)
         {
-            fontStack.push(textFont);
-            colorStack.push(fontColor);
+            formatStack.push(format);
             alignStack.push(textAlign);
 
             parseTextAttributes(fontSize, fontColor, fontFamily, fontStretch, italic, fontWeight, textAlign, fontTransform);
-            textFont = QFont(fontFamily, fontSize, fontWeight, italic);
-            metrics = QFontMetricsF(textFont);
-            curHeight = metrics.height();
-            linespacing = QFontMetricsF(textFont).leading();
+            format = textFormat(fontSize, fontColor, fontFamily, italic, fontWeight);
+
+            blockFormat.setAlignment((Qt::Alignment)textAlign);
+            cursor.mergeBlockFormat(blockFormat);
             continue;
         }
         if (mReader.isCharacters() || mReader.isCDATA())
@@ -682,59 +753,48 @@ bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parseText()
             //skip empty text
             if (text.trimmed().length() == 0)
                 continue;
-            //get bounding rect to obtain desired text height
-            lastDrawnTextBoundingRect = metrics.boundingRect(QRectF(), textAlign, text);
-            QString log = QString().sprintf(" at rect  %f, %f, %f, %f. Bounding rect is %f, %f, %f, %f", 0.0, curY, width, height - curY, lastDrawnTextBoundingRect.x(), lastDrawnTextBoundingRect.y(), lastDrawnTextBoundingRect.width(), lastDrawnTextBoundingRect.height());
-            qWarning() << "Text " << text << log;
-            textFonts.append(textFont);
-            textRects.append(QRectF(curX, curY, lastDrawnTextBoundingRect.width(), lastDrawnTextBoundingRect.height()));
-            textLines.append(text);
-            textAligns.append(textAlign);
-            textColors.append(fontColor);
-            curX += lastDrawnTextBoundingRect.width();
-            if (width < curX)
-                width = curX;
-            if (height == 0)
-                height = curHeight;
-            
-            continue;
-        }
-    }
 
-    QSvgGenerator *generator = createSvgGenerator(width, height);
-    QPainter painter;
-    painter.begin(generator);
+            if (trimText)
+                text = text.trimmed();
 
-    if (textRects.count() != 0)
-    {
-        QListIterator<QRectF> textRectsIter(textRects);
-        QListIterator<QFont> textFontsIter(textFonts);
-        QListIterator<QString> textLinesIter(textLines);
-        QListIterator<int> textAlignsIter(textAligns);
-        QListIterator<QColor> textColorsIter(textColors);
+            cursor.insertText(text, format);
 
-        while (textRectsIter.hasNext())
-        {
-            QRectF rt = textRectsIter.next();
-            QFont font = textFontsIter.next();
-            QString line = textLinesIter.next();
-            int align = textAlignsIter.next();
-            QColor color = textColorsIter.next();
-            painter.setFont(font);
-            painter.setPen(color);
-            painter.drawText(rt.x(), rt.y(), rt.width(), rt.height(), align, line);
+            lineWidth += QFontMetricsF(format.font()).width(text);
+            contentWidth = qMax(contentWidth, lineWidth);
         }
     }
 
-    painter.end();
+    return textItem;
+}
+
+QTextCharFormat UBCFFSubsetAdaptor::UBCFFSubsetReader::textFormat(qreal fontSize, const QColor& fontColor,
+                                                                  const QString& fontFamily, bool italic, int fontWeight)
+{
+    QFont font(fontFamily);
+    font.setPointSizeF(fontSize);
+    font.setWeight(fontWeight);
+    font.setItalic(italic);
 
-    //add resulting svg file to scene
-    UBGraphicsSvgItem *svgItem = mCurrentScene->addSvg(QUrl::fromLocalFile(generator->fileName()));
-    repositionSvgItem(svgItem, width, height, x, y, hasTransform, transform);
+    QTextCharFormat format;
+    format.setFont(font);
 
-    delete generator;
+    if (fontColor.isValid())
+        format.setForeground(QBrush(fontColor));
 
-    return true;
+    return format;
+}
+
+void UBCFFSubsetAdaptor::UBCFFSubsetReader::addTextItem(UBGraphicsTextItem *textItem, const QPointF& position, const QTransform& transform)
+{
+    textItem->setFlag(QGraphicsItem::ItemIsMovable, true);
+    textItem->setFlag(QGraphicsItem::ItemIsSelectable, true);
+    textItem->setZValue(mCurrentScene->getNextObjectZIndex());
+    textItem->setData(UBGraphicsItemData::ItemLayerType, QVariant(UBItemLayerType::Object));
+
+    textItem->setTransform(QTransform(transform.m11(), transform.m12(), transform.m21(), transform.m22(), 0, 0));
+    textItem->setPos(transform.map(position));
+
+    mCurrentScene->addItem(textItem);
 }
 
 bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parsePolygon()
@@ -749,7 +809,22 @@ bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parsePolygon()
     if (currentState == SVG && mCurrentScene == NULL)
         createNewScene();
 
-    return true;
+    //points are given as 'x1,y1 x2,y2 ...', commas and spaces are interchangeable
+    QStringList coordinates = mReader.attributes().value(aPoints).toString()
+            .split(QRegExp("[\\s,]+"), QString::SkipEmptyParts);
+
+    QPolygonF polygon;
+    for (int i = 0; i + 1 < coordinates.size(); i += 2)
+        polygon << QPointF(coordinates.at(i).toDouble(), coordinates.at(i + 1).toDouble());
+
+    if (polygon.size() < 3)
+        return true;
+
+    QPainterPath path;
+    path.addPolygon(polygon);
+    path.closeSubpath();
+
+    return addShape(path);
 }
 
 bool UBCFFSubsetAdaptor::UBCFFSubsetReader::parsePage()
@@ -897,41 +972,6 @@ bool UBCFFSubsetAdaptor::UBCFFSubsetReader::getViewBoxDimenstions(const QString&
     return false;
 }
 
-QSvgGenerator* UBCFFSubsetAdaptor::UBCFFSubsetReader::createSvgGenerator(qreal width, qreal height)
-{
-    QSvgGenerator* generator = new QSvgGenerator();
-    qWarning() << QString("Making generator with file %1, size (%2, %3) and viewbox (%4 %5 %6 %7)").arg(mTempFilePath)
-        .arg(width).arg(height).arg(0.0).arg(0.0).arg(width).arg(width);
-    generator->setResolution(QApplication::desktop()->physicalDpiY());
-    generator->setFileName(mTempFilePath);
-    generator->setSize(QSize(width, height));
-    generator->setViewBox(QRectF(0, 0, width, height));
-
-    return generator;
-}
-
-bool UBCFFSubsetAdaptor::UBCFFSubsetReader::getTempFileName()
-{
-    int tmpNumber = 0;
-    QDir rootDir;
-    while (true)
-    {
-        mTempFilePath = QString("%1/sanksvg%2.%3")
-                .arg(rootDir.tempPath())
-                .arg(QDateTime::currentDateTime().toString("dd_MM_yyyy_HH-mm"))
-                .arg(tmpNumber);
-        if (!QFile::exists(mTempFilePath))
-            return true;
-        tmpNumber++;
-        if (tmpNumber == 100000)
-        {
-            qWarning() << "Import failed. Failed to create temporary file for svg objects";
-            return false;
-        }
-    }
-
-}
-
 void UBCFFSubsetAdaptor::UBCFFSubsetReader::parseTextAttributes(qreal &fontSize, QColor &fontColor,
                                                                 QString &fontFamily, QString &fontStretch, bool &italic,
                                                                 int &fontWeight, int &textAlign, QTransform &fontTransform)
@@ -16,14 +16,15 @@
 #ifndef UBCFFSUBSETADAPTOR_H
 #define UBCFFSUBSETADAPTOR_H
 
+#include <QtGui>
 #include <QtXml>
 #include <QString>
 #include <QStack>
 
 class UBDocumentProxy;
 class UBGraphicsScene;
-class QSvgGenerator;
-class UBGraphicsSvgItem;
+class UBGraphicsStroke;
+class UBGraphicsTextItem;
 class QTransform;
 
 class UBCFFSubsetAdaptor
@@ -57,13 +58,13 @@ private:
         bool parse();
 
     private:
-        QString mTempFilePath;
         UBGraphicsScene *mCurrentScene;
         QRectF mCurrentSceneRect;
         QString mIndent;
         QRectF mViewBox;
         QPointF mViewBoxCenter;
         QSize mSize;
+        QHash<QString, QByteArray> mDefinitions;
 
         //methods to store current xml parse state
         int PopState();
@@ -87,6 +88,7 @@ private:
         bool parsePage();
         bool parsePageSet();
         bool parseIwbElementRef();
+        bool parseDefs();
 
         bool createNewScene();
         bool persistCurrentScene();
@@ -96,12 +98,20 @@ private:
 
         //helper methods
         bool getCurElementTransorm(QTransform &transform);
-        void repositionSvgItem(UBGraphicsSvgItem *item, qreal width, qreal height, qreal x, qreal y, bool useTransform, QTransform &transform);
+        QTransform elementToSceneTransform();
         QColor colorFromString(const QString& clrString);
         QTransform transformFromString(const QString trString);
         bool getViewBoxDimenstions(const QString& viewBox);
-        QSvgGenerator* createSvgGenerator(qreal width, qreal height);
-        bool getTempFileName();
+
+        //scene items creation methods
+        bool isSupportedPaint(const QString& paint);
+        bool addShape(const QPainterPath& path);
+        void addPolygonItem(const QPolygonF& polygon, const QColor& color, UBGraphicsStroke *group);
+        bool addSvgElement(const QRectF& bounds, const QTransform& transform);
+        UBGraphicsTextItem* readTextItem(const QString& endElement, qreal &contentWidth);
+        QTextCharFormat textFormat(qreal fontSize, const QColor& fontColor,
+                                   const QString& fontFamily, bool italic, int fontWeight);
+        void addTextItem(UBGraphicsTextItem *textItem, const QPointF& position, const QTransform& transform);
         void parseTextAttributes(qreal &fontSize, QColor &fontColor,
                                  QString &fontFamily, QString &fontStretch, bool &italic,
                                  int &fontWeight, int &textAlign, QTransform &fontTransform);
@@ -19,6 +19,7 @@
 
 #include "core/UBDocumentManager.h"
 #include "core/UBApplication.h"
+#include "core/UBPersistenceManager.h"
 
 #include "document/UBDocumentProxy.h"
 
@@ -66,6 +67,9 @@ void UBExportDocument::persist(UBDocumentProxy* pDocumentProxy)
 
 void UBExportDocument::persistsDocument(UBDocumentProxy* pDocumentProxy, QString filename)
 {
+    // the pages saved as binary pages are exported as svg
+    UBPersistenceManager::persistenceManager()->persistPendingSvgs(pDocumentProxy);
+
     UniboardSankoreTransition document;
     QString documentPath(pDocumentProxy->persistencePath());
     document.checkDocumentDirectory(documentPath);
@@ -80,8 +84,12 @@ void UBExportDocument::persistsDocument(UBDocumentProxy* pDocumentProxy, QString
 
     QDir documentDir = QDir(pDocumentProxy->persistencePath());
 
+    // the binary pages are working copies, the svg pages were brought up to date above
+    QStringList excluded;
+    excluded << "*.ubpage";
+
     QuaZipFile outFile(&zip);
-    UBFileSystemUtils::compressDirInZip(documentDir, "", &outFile, true, this);
+    UBFileSystemUtils::compressDirInZip(documentDir, "", &outFile, true, this, excluded);
 
     if(zip.getZipError() != 0)
     {
@@ -53,16 +53,11 @@ void UBExportWeb::persist(UBDocumentProxy* pDocumentProxy)
         QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
         UBApplication::showMessage(tr("Exporting document..."));
 
-        if(UBFileSystemUtils::copyDir(pDocumentProxy->persistencePath(), dirName))
+        if(persistsDocument(pDocumentProxy, dirName))
         {
-            QString htmlPath = dirName + "/index.html";
-
-            QFile html(":www/uniboard-web-player.html");
-            html.copy(htmlPath);
-
             UBApplication::showMessage(tr("Export successful."));
 
-            QDesktopServices::openUrl(QUrl::fromLocalFile(htmlPath));
+            QDesktopServices::openUrl(QUrl::fromLocalFile(dirName + "/index.html"));
         }
         else
         {
@@ -75,6 +70,21 @@ void UBExportWeb::persist(UBDocumentProxy* pDocumentProxy)
 }
 
 
+bool UBExportWeb::persistsDocument(UBDocumentProxy* pDocumentProxy, QString dirName)
+{
+    if (!UBFileSystemUtils::copyDir(pDocumentProxy->persistencePath(), dirName))
+        return false;
+
+    QString htmlPath = dirName + "/index.html";
+
+    QFile::remove(htmlPath);
+
+    QFile html(":www/uniboard-web-player.html");
+
+    return html.copy(htmlPath);
+}
+
+
 QString UBExportWeb::exportName()
 {
     return tr("Export to Web Browser");
@@ -34,6 +34,8 @@ class UBExportWeb : public UBExportAdaptor
 
         virtual void persist(UBDocumentProxy* pDocument);
 
+        virtual bool persistsDocument(UBDocumentProxy* pDocument, QString dirName);
+
 };
 
 #endif /* UBEXPORTWEB_H_ */
@@ -104,6 +104,7 @@ bool UBImportCFF::addFileToDocument(UBDocumentProxy* pDocument, const QFile& pFi
         //try to import cff to document
         if (UBCFFSubsetAdaptor::ConvertCFFFileToUbz(contentFile, destDocument))
         {
+            UBPersistenceManager::persistenceManager()->persistPendingSvgs(destDocument);
             UBPersistenceManager::persistenceManager()->addDirectoryContentToDocument(destDocument->persistencePath(), pDocument);
             UBFileSystemUtils::deleteDir(destDocument->persistencePath());
             delete destDocument;
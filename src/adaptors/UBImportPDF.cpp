@@ -21,7 +21,9 @@
 
 #include "core/UBApplication.h"
 #include "core/UBPersistenceManager.h"
+#include "core/UBPdfThumbnailer.h"
 
+#include "domain/UBGraphicsScene.h"
 #include "domain/UBGraphicsPDFItem.h"
 
 #include "pdf/PDFRenderer.h"
@@ -78,6 +80,9 @@ bool UBImportPDF::addFileToDocument(UBDocumentProxy* pDocument, const QFile& pFi
 
     int pdfPageCount = pdfRenderer->pageCount();
 
+    UBPersistenceManager* persistenceManager = UBPersistenceManager::persistenceManager();
+    UBPdfThumbnailer* thumbnailer = UBPdfThumbnailer::pdfThumbnailer();
+
     for(int pdfPageNumber = 1; pdfPageNumber <= pdfPageCount; pdfPageNumber++)
     {
         int pageIndex = documentPageCount + (pdfPageNumber - 1);
@@ -87,28 +92,61 @@ bool UBImportPDF::addFileToDocument(UBDocumentProxy* pDocument, const QFile& pFi
 
         if (pageIndex == 0)
         {
-            scene = UBPersistenceManager::persistenceManager()->loadDocumentScene(pDocument, pageIndex);
+            scene = persistenceManager->loadDocumentScene(pDocument, pageIndex);
         }
         else
         {
-            scene = UBPersistenceManager::persistenceManager()->createDocumentSceneAt(pDocument, pageIndex);
+            scene = persistenceManager->appendDocumentScene(pDocument);
         }
 
-        scene->setBackground(false, false);
-        UBGraphicsPDFItem *pdfItem = new UBGraphicsPDFItem(pdfRenderer, pdfPageNumber); // deleted by the scene
-        scene->addItem(pdfItem);
-
-        pdfItem->setPos(-pdfItem->boundingRect().width() / 2, -pdfItem->boundingRect().height() / 2);
-
-        scene->setAsBackgroundObject(pdfItem, false, false);
+        setupPage(scene, pdfRenderer, pdfPageNumber);
 
-        scene->setNominalSize(pdfItem->boundingRect().width(), pdfItem->boundingRect().height());
+        // the thumbnails are rendered in the background, the pages are announced once all are created
+        bool placeholderWritten = UBPdfThumbnailer::writePlaceholder(pDocument, pageIndex, pdfRenderer->pageSizeF(pdfPageNumber));
 
+        persistenceManager->persistDocumentScene(pDocument, scene, pageIndex, !placeholderWritten);
 
-        UBPersistenceManager::persistenceManager()->persistDocumentScene(pDocument, scene, pageIndex);
+        if (placeholderWritten)
+            thumbnailer->addPage(pDocument, pageIndex, scene->uuid(), pDocument->persistencePath() + "/" + filepath, pdfPageNumber);
     }
 
+    if (pdfPageCount > 0 && documentPageCount + pdfPageCount > 1)
+        persistenceManager->documentScenesAppended(pDocument, qMax(1, documentPageCount));
+
     UBApplication::showMessage(tr("PDF import successful."));
 
     return true;
 }
+
+
+void UBImportPDF::setupPage(UBGraphicsScene* pScene, PDFRenderer* pRenderer, int pPdfPageNumber)
+{
+    pScene->setBackground(false, false);
+    UBGraphicsPDFItem *pdfItem = new UBGraphicsPDFItem(pRenderer, pPdfPageNumber); // deleted by the scene
+    pScene->addItem(pdfItem);
+
+    pdfItem->setPos(-pdfItem->boundingRect().width() / 2, -pdfItem->boundingRect().height() / 2);
+
+    pScene->setAsBackgroundObject(pdfItem, false, false);
+
+    pScene->setNominalSize(pdfItem->boundingRect().width(), pdfItem->boundingRect().height());
+}
+
+
+void UBImportPDF::addPageToDocument(UBDocumentProxy* pDocument, PDFRenderer* pRenderer, int pPdfPageNumber, int pPageIndex)
+{
+    UBGraphicsScene* scene = 0;
+
+    if (pPageIndex == 0)
+    {
+        scene = UBPersistenceManager::persistenceManager()->loadDocumentScene(pDocument, pPageIndex);
+    }
+    else
+    {
+        scene = UBPersistenceManager::persistenceManager()->createDocumentSceneAt(pDocument, pPageIndex);
+    }
+
+    setupPage(scene, pRenderer, pPdfPageNumber);
+
+    UBPersistenceManager::persistenceManager()->persistDocumentScene(pDocument, scene, pPageIndex);
+}
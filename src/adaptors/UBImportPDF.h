@@ -20,6 +20,8 @@
 #include "UBImportAdaptor.h"
 
 class UBDocumentProxy;
+class UBGraphicsScene;
+class PDFRenderer;
 
 class UBImportPDF : public UBImportAdaptor
 {
@@ -33,6 +35,12 @@ class UBImportPDF : public UBImportAdaptor
         virtual QString importFileFilter();
 
         virtual bool addFileToDocument(UBDocumentProxy* pDocument, const QFile& pFile);
+
+        // adds the page pPdfPageNumber (1 based) of pRenderer as page pPageIndex of pDocument, page 0 is reused
+        static void addPageToDocument(UBDocumentProxy* pDocument, PDFRenderer* pRenderer, int pPdfPageNumber, int pPageIndex);
+
+    private:
+        static void setupPage(UBGraphicsScene* pScene, PDFRenderer* pRenderer, int pPdfPageNumber);
 };
 
 #endif /* UBIMPORTPDF_H_ */
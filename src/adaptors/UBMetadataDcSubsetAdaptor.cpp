@@ -24,11 +24,29 @@
 
 #include "document/UBDocumentProxy.h"
 
+#include "frameworks/UBFileSystemUtils.h"
+
 #include "core/memcheck.h"
 
 const QString UBMetadataDcSubsetAdaptor::nsRdf = "http://www.w3.org/1999/02/22-rdf-syntax-ns#";
 const QString UBMetadataDcSubsetAdaptor::nsDc = "http://purl.org/dc/elements/1.1/";
 const QString UBMetadataDcSubsetAdaptor::metadataFilename = "metadata.rdf";
+const QString UBMetadataDcSubsetAdaptor::indexFilename = "metadata.index";
+
+static const quint32 indexMagic = 0x55424d49; // UBMI
+static const qint32 indexVersion = 1;
+
+struct UBMetadataIndexEntry
+{
+    qint64 modified;
+    qint64 size;
+    QMap<QString, QVariant> metadata;
+};
+
+static QHash<QString, UBMetadataIndexEntry> sIndex;
+static bool sIndexLoaded = false;
+static bool sIndexModified = false;
+static QMutex sIndexMutex;
 
 
 UBMetadataDcSubsetAdaptor::UBMetadataDcSubsetAdaptor()
@@ -69,15 +87,11 @@ UBMetadataDcSubsetAdaptor::~UBMetadataDcSubsetAdaptor()
 void UBMetadataDcSubsetAdaptor::persist(UBDocumentProxy* proxy)
 {
     QString fileName = proxy->persistencePath() + "/" + metadataFilename;
-    qWarning() << fileName;
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
-    {
-        qCritical() << "cannot open " << fileName << " for writing ...";
-        return;
-    }
 
-    QXmlStreamWriter xmlWriter(&file);
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    QXmlStreamWriter xmlWriter(&buffer);
     xmlWriter.setAutoFormatting(true);
 
     xmlWriter.writeStartDocument();
@@ -90,8 +104,6 @@ void UBMetadataDcSubsetAdaptor::persist(UBDocumentProxy* proxy)
     xmlWriter.writeStartElement("Description");
     xmlWriter.writeAttribute("about", proxy->metaData(UBSettings::documentIdentifer).toString());
 
-    QDate today = QDate::currentDate();
-
     xmlWriter.writeTextElement(nsDc, "title", proxy->metaData(UBSettings::documentName).toString());
     xmlWriter.writeTextElement(nsDc, "type", proxy->metaData(UBSettings::documentGroupName).toString());
     xmlWriter.writeTextElement(nsDc, "date", QDate::currentDate().toString("yyyy-MM-dd"));
@@ -112,33 +124,99 @@ void UBMetadataDcSubsetAdaptor::persist(UBDocumentProxy* proxy)
 
     xmlWriter.writeEndDocument();
 
-    file.flush();
-    file.close();
+    buffer.close();
+
+    QFile file(fileName);
+
+    // unchanged metadata are not written again
+    if (file.size() == buffer.size() && file.open(QIODevice::ReadOnly))
+    {
+        bool isUnchanged = (file.readAll() == buffer.data());
+        file.close();
+
+        if (isUnchanged)
+            return;
+    }
+
+    // written aside then swapped, a crash never leaves a truncated metadata.rdf
+    QFile tmpFile(fileName + ".tmp");
+
+    if (!tmpFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qCritical() << "cannot open " << tmpFile.fileName() << " for writing ...";
+        return;
+    }
+
+    bool written = tmpFile.write(buffer.data()) == buffer.size();
+    written &= tmpFile.flush();
+    tmpFile.close();
+
+    if (!written || !UBFileSystemUtils::replaceFile(tmpFile.fileName(), fileName))
+    {
+        qCritical() << "cannot write " << fileName;
+        tmpFile.remove();
+        return;
+    }
+
+    buffer.open(QIODevice::ReadOnly);
+
+    bool isComplete = false;
+    QMap<QString, QVariant> metadata = parse(&buffer, isComplete);
+
+    if (isComplete)
+        cacheMetadata(proxy->persistencePath(), QFileInfo(fileName), metadata);
 }
 
 
 QMap<QString, QVariant> UBMetadataDcSubsetAdaptor::load(QString pPath)
 {
-
     QMap<QString, QVariant> metadata;
 
     QString fileName = pPath + "/" + metadataFilename;
 
+    QFileInfo rdfInfo(fileName);
+
+    if (!rdfInfo.exists())
+    {
+        bool isComplete = false;
+        return parse(0, isComplete);
+    }
+
+    if (cachedMetadata(pPath, rdfInfo, metadata))
+        return metadata;
+
     QFile file(fileName);
 
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Cannot open file " << fileName << " for reading ...";
+        return metadata;
+    }
+
+    bool isComplete = false;
+    metadata = parse(&file, isComplete);
+
+    file.close();
+
+    if (isComplete)
+        cacheMetadata(pPath, rdfInfo, metadata);
+
+    return metadata;
+}
+
+
+QMap<QString, QVariant> UBMetadataDcSubsetAdaptor::parse(QIODevice* pDevice, bool& pIsComplete)
+{
+    QMap<QString, QVariant> metadata;
+
     bool sizeFound = false;
     bool updatedAtFound = false;
+    bool hasError = false;
     QString date;
 
-    if (file.exists())
+    if (pDevice)
     {
-        if (!file.open(QIODevice::ReadOnly))
-        {
-            qWarning() << "Cannot open file " << fileName << " for reading ...";
-            return metadata;
-        }
-
-        QXmlStreamReader xml(&file);
+        QXmlStreamReader xml(pDevice);
 
         while (!xml.atEnd())
         {
@@ -213,10 +291,9 @@ QMap<QString, QVariant> UBMetadataDcSubsetAdaptor::load(QString pPath)
             if (xml.hasError())
             {
                 qWarning() << "error parsing sankore metadata.rdf file " << xml.errorString();
+                hasError = true;
             }
         }
-
-        file.close();
     }
 
     if (!sizeFound)
@@ -238,6 +315,130 @@ QMap<QString, QVariant> UBMetadataDcSubsetAdaptor::load(QString pPath)
         metadata.insert(UBSettings::documentUpdatedAt, date + "T00:00:00Z");
     }
 
+    // the default size depends on the screen, such metadata are not cached
+    pIsComplete = sizeFound && !hasError;
+
     return metadata;
 }
 
+
+bool UBMetadataDcSubsetAdaptor::cachedMetadata(const QString& pPath, const QFileInfo& pRdfInfo, QMap<QString, QVariant>& pMetadata)
+{
+    QMutexLocker locker(&sIndexMutex);
+
+    loadIndex();
+
+    QHash<QString, UBMetadataIndexEntry>::const_iterator entry = sIndex.constFind(QDir::cleanPath(pPath));
+
+    if (entry == sIndex.constEnd()
+            || entry.value().size != pRdfInfo.size()
+            || entry.value().modified != pRdfInfo.lastModified().toMSecsSinceEpoch())
+    {
+        return false;
+    }
+
+    pMetadata = entry.value().metadata;
+
+    return true;
+}
+
+
+void UBMetadataDcSubsetAdaptor::cacheMetadata(const QString& pPath, const QFileInfo& pRdfInfo, const QMap<QString, QVariant>& pMetadata)
+{
+    QMutexLocker locker(&sIndexMutex);
+
+    loadIndex();
+
+    UBMetadataIndexEntry entry;
+    entry.modified = pRdfInfo.lastModified().toMSecsSinceEpoch();
+    entry.size = pRdfInfo.size();
+    entry.metadata = pMetadata;
+
+    sIndex.insert(QDir::cleanPath(pPath), entry);
+    sIndexModified = true;
+}
+
+
+void UBMetadataDcSubsetAdaptor::loadIndex()
+{
+    if (sIndexLoaded)
+        return;
+
+    sIndexLoaded = true;
+
+    QFile file(UBSettings::uniboardDataDirectory() + "/" + indexFilename);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_4_6);
+
+    quint32 magic = 0;
+    qint32 version = 0;
+    qint32 count = 0;
+
+    in >> magic >> version >> count;
+
+    if (magic != indexMagic || version != indexVersion)
+        return;
+
+    for (int i = 0; i < count && in.status() == QDataStream::Ok; i++)
+    {
+        QString path;
+        UBMetadataIndexEntry entry;
+
+        in >> path >> entry.modified >> entry.size >> entry.metadata;
+
+        if (in.status() == QDataStream::Ok)
+            sIndex.insert(path, entry);
+    }
+}
+
+
+void UBMetadataDcSubsetAdaptor::saveIndex()
+{
+    QMutexLocker locker(&sIndexMutex);
+
+    if (!sIndexModified)
+        return;
+
+    QString fileName = UBSettings::uniboardDataDirectory() + "/" + indexFilename;
+    QFile file(fileName + ".tmp");
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "cannot open " << file.fileName() << " for writing ...";
+        return;
+    }
+
+    // entries of deleted documents are dropped
+    QStringList removedPaths;
+
+    foreach(QString path, sIndex.keys())
+    {
+        if (!QFileInfo(path).exists())
+            removedPaths << path;
+    }
+
+    foreach(QString path, removedPaths)
+        sIndex.remove(path);
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_4_6);
+
+    out << indexMagic << indexVersion << (qint32)sIndex.size();
+
+    QHash<QString, UBMetadataIndexEntry>::const_iterator entry;
+
+    for (entry = sIndex.constBegin(); entry != sIndex.constEnd(); ++entry)
+        out << entry.key() << entry.value().modified << entry.value().size << entry.value().metadata;
+
+    bool written = out.status() == QDataStream::Ok && file.flush();
+    file.close();
+
+    if (written && UBFileSystemUtils::replaceFile(file.fileName(), fileName))
+        sIndexModified = false;
+    else
+        file.remove();
+}
@@ -29,12 +29,26 @@ class UBMetadataDcSubsetAdaptor
         static void persist(UBDocumentProxy* proxy);
         static QMap<QString, QVariant> load(QString pPath);
 
+        // parsed metadata are cached in a single index file, an entry is used as long as
+        // the rdf file keeps the same size and modification time. The rdf stays the reference.
+        static void saveIndex();
+
         static const QString nsRdf;
         static const QString nsDc;
         static const QString metadataFilename;
+        static const QString indexFilename;
 
         static const QString rdfIdentifierDomain;
 
+    private:
+
+        // pDevice may be 0, only the default values are returned then
+        static QMap<QString, QVariant> parse(QIODevice* pDevice, bool& pIsComplete);
+
+        static bool cachedMetadata(const QString& pPath, const QFileInfo& pRdfInfo, QMap<QString, QVariant>& pMetadata);
+        static void cacheMetadata(const QString& pPath, const QFileInfo& pRdfInfo, const QMap<QString, QVariant>& pMetadata);
+        static void loadIndex();
+
 };
 
 #endif /* UBMETADATADCSUBSETADAPTOR_H_ */
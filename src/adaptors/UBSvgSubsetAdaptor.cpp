@@ -44,6 +44,7 @@
 
 #include "frameworks/UBFileSystemUtils.h"
 #include "frameworks/UBStringUtils.h"
+#include "frameworks/UBTrace.h"
 
 #include "core/UBSettings.h"
 #include "core/UBSetting.h"
@@ -51,6 +52,8 @@
 
 #include "pdf/PDFRenderer.h"
 
+#include "UBBinaryPageAdaptor.h"
+
 #include "core/memcheck.h"
 
 const QString UBSvgSubsetAdaptor::nsSvg = "http://www.w3.org/2000/svg";
@@ -102,13 +105,6 @@ QMatrix UBSvgSubsetAdaptor::fromSvgTransform(const QString& transform)
 }
 
 
-static bool itemZIndexComp(const QGraphicsItem* item1,
-                           const QGraphicsItem* item2)
-{
-    return item1->zValue() < item2->zValue();
-}
-
-
 void UBSvgSubsetAdaptor::upgradeScene(UBDocumentProxy* proxy, const int pageIndex)
 {
     //4.2
@@ -152,6 +148,10 @@ QDomDocument UBSvgSubsetAdaptor::loadSceneDocument(UBDocumentProxy* proxy, const
 
 void UBSvgSubsetAdaptor::setSceneUuid(UBDocumentProxy* proxy, const int pageIndex, QUuid pUuid)
 {
+    // the uuid is replaced in place, the size of the file does not change; the pages given a new
+    // uuid are copies, made once their svg file was brought up to date
+    QFile::remove(UBBinaryPageAdaptor::pagePath(proxy->persistencePath(), pageIndex));
+
     QString fileName = proxy->persistencePath() +
                        UBFileSystemUtils::digitFileFormat("/page%1.svg", pageIndex + 1);
 
@@ -211,6 +211,15 @@ QString UBSvgSubsetAdaptor::uniboardDocumentNamespaceUriFromVersion(int mFileVer
 
 UBGraphicsScene* UBSvgSubsetAdaptor::loadScene(UBDocumentProxy* proxy, const int pageIndex)
 {
+    // a binary page still stamped with the svg file is the newest version of the page,
+    // it is read even when the binary pages are turned off since
+    UBGraphicsScene* binaryScene = UBBinaryPageAdaptor::loadScene(proxy, pageIndex);
+
+    if (binaryScene)
+        return binaryScene;
+
+    UB_TRACE_SCOPE("svg.loadScene", "persistence");
+
     QString fileName = proxy->persistencePath() +
                        UBFileSystemUtils::digitFileFormat("/page%1.svg", pageIndex + 1);
 
@@ -573,10 +582,6 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene()
                     scene->addItem(audioItem);
 
                     audioItem->show();
-
-                    //force start to load the video and display the first frame
-                    audioItem->mediaObject()->play();
-                    audioItem->mediaObject()->pause();
                 }
             }
             else if (mXmlReader.name() == "video")
@@ -593,10 +598,6 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene()
                     scene->addItem(videoItem);
 
                     videoItem->show();
-
-                    //force start to load the video and display the first frame
-                    videoItem->mediaObject()->play();
-                    videoItem->mediaObject()->pause();
                 }
             }
             else if (mXmlReader.name() == "text")//This is for backward compatibility with proto text field prior to version 4.3
@@ -821,8 +822,34 @@ UBGraphicsScene* UBSvgSubsetAdaptor::UBSvgSubsetReader::loadScene()
 
 void UBSvgSubsetAdaptor::persistScene(UBDocumentProxy* proxy, UBGraphicsScene* pScene, const int pageIndex)
 {
+    UB_TRACE_SCOPE("svg.persistScene", "persistence");
+
+    bool isModified = pScene->isModified();
+
+    QString svgFileName = proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", pageIndex + 1);
+
+    // once its svg file is written, a page is saved as a binary page only, the svg file is
+    // brought up to date when the document is exported or copied, and when the application quits
+    if (isModified && UBSettings::settings()->svgBinaryPages->get().toBool() && QFile::exists(svgFileName)
+            && UBBinaryPageAdaptor::persistScene(proxy, pScene, pageIndex))
+    {
+        return;
+    }
+
     UBSvgSubsetWriter writer(proxy, pScene, pageIndex);
-    writer.persistScene();
+
+    // the svg file is the newest version of the page
+    if (writer.persistScene() && isModified)
+        QFile::remove(UBBinaryPageAdaptor::pagePath(proxy->persistencePath(), pageIndex));
+}
+
+
+QByteArray UBSvgSubsetAdaptor::sceneSvg(UBDocumentProxy* proxy, UBGraphicsScene* pScene, const int pageIndex, bool pWithInk)
+{
+    UB_TRACE_SCOPE("svg.sceneSvg", "persistence");
+
+    UBSvgSubsetWriter writer(proxy, pScene, pageIndex);
+    return writer.sceneSvg(false, pWithInk);
 }
 
 
@@ -830,7 +857,8 @@ UBSvgSubsetAdaptor::UBSvgSubsetWriter::UBSvgSubsetWriter(UBDocumentProxy* proxy,
         : mScene(pScene)
         , mDocumentPath(proxy->persistencePath())
         , mPageIndex(pageIndex)
-
+        , mWithSnapshots(true)
+        , mWithInk(true)
 {
     // NOOP
 }
@@ -874,247 +902,273 @@ bool UBSvgSubsetAdaptor::UBSvgSubsetWriter::persistScene()
 {
     if (mScene->isModified())
     {
-        QBuffer buffer;
-        buffer.open(QBuffer::WriteOnly);
-        mXmlWriter.setDevice(&buffer);
+        QByteArray svg = sceneSvg();
 
-        QTime timer = QTime::currentTime();
+        // written aside then swapped in, a crash in the middle leaves the previous page intact
+        QString fileName = mDocumentPath + UBFileSystemUtils::digitFileFormat("/page%1.svg", mPageIndex + 1);
+        QString tmpFileName = fileName + ".tmp";
+        QFile file(tmpFileName);
 
-        mXmlWriter.setAutoFormatting(true);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        {
+            qCritical() << "cannot open " << tmpFileName << " for writing ...";
+            return false;
+        }
 
-        mXmlWriter.writeStartDocument();
-        mXmlWriter.writeDefaultNamespace(nsSvg);
-        mXmlWriter.writeNamespace(nsXLink, "xlink");
-        mXmlWriter.writeNamespace(UBSettings::uniboardDocumentNamespaceUri, "ub");
-        mXmlWriter.writeNamespace(nsXHtml, "xhtml");
+        bool written = file.write(svg) == svg.size() && file.flush();
+        file.close();
 
-        writeSvgElement();
+        if (!written || !UBFileSystemUtils::replaceFile(tmpFileName, fileName))
+        {
+            qCritical() << "cannot write " << fileName;
+            file.remove();
+            return false;
+        }
+    }
+    else
+    {
+        qDebug() << "ignoring unmodified page" << mPageIndex + 1;
+    }
 
-        QList<QGraphicsItem*> items = mScene->items();
+    return true;
+}
 
-        qSort(items.begin(), items.end(), itemZIndexComp);
 
-        UBGraphicsStroke *openStroke = 0;
+QByteArray UBSvgSubsetAdaptor::UBSvgSubsetWriter::sceneSvg(bool pWithSnapshots, bool pWithInk)
+{
+    mWithSnapshots = pWithSnapshots;
+    mWithInk = pWithInk;
 
-        bool groupHoldsInfo = false;
+    QBuffer buffer;
+    buffer.open(QBuffer::WriteOnly);
+    mXmlWriter.setDevice(&buffer);
 
-        while (!items.empty())
-        {
-            QGraphicsItem *item = items.takeFirst();
+    QTime timer = QTime::currentTime();
 
+    mXmlWriter.setAutoFormatting(true);
 
-            UBGraphicsPolygonItem *polygonItem = qgraphicsitem_cast<UBGraphicsPolygonItem*> (item);
+    mXmlWriter.writeStartDocument();
+    mXmlWriter.writeDefaultNamespace(nsSvg);
+    mXmlWriter.writeNamespace(nsXLink, "xlink");
+    mXmlWriter.writeNamespace(UBSettings::uniboardDocumentNamespaceUri, "ub");
+    mXmlWriter.writeNamespace(nsXHtml, "xhtml");
 
-            if (polygonItem && polygonItem->isVisible())
-            {
-                UBGraphicsStroke* currentStroke = polygonItem->stroke();
+    writeSvgElement();
 
-                if (openStroke && (currentStroke != openStroke))
-                {
-                    mXmlWriter.writeEndElement(); //g
-                    openStroke = 0;
-                    groupHoldsInfo = false;
-                }
+    // already ordered by z value
+    QList<QGraphicsItem*> items = mScene->itemsInZOrder();
 
-                bool firstPolygonInStroke = currentStroke  && !openStroke;
+    // polygons written with their stroke as a single polyline
+    QSet<QGraphicsItem*> writtenPolygons;
 
-                if (firstPolygonInStroke)
-                {
-                    mXmlWriter.writeStartElement("g");
-                    openStroke = currentStroke;
+    UBGraphicsStroke *openStroke = 0;
 
-                    QMatrix matrix = item->sceneMatrix();
+    bool groupHoldsInfo = false;
 
-                    if (!matrix.isIdentity())
-                        mXmlWriter.writeAttribute("transform", toSvgTransform(matrix));
+    foreach(QGraphicsItem *item, items)
+    {
+        if (item->scene() != mScene || writtenPolygons.contains(item))
+            continue;
 
-                    UBGraphicsStroke* stroke = dynamic_cast<UBGraphicsStroke* >(currentStroke);
+        UBGraphicsPolygonItem *polygonItem = qgraphicsitem_cast<UBGraphicsPolygonItem*> (item);
 
-                    if (stroke)
-                    {
-                        QColor colorOnDarkBackground = polygonItem->colorOnDarkBackground();
-                        QColor colorOnLightBackground = polygonItem->colorOnLightBackground();
+        if (polygonItem && polygonItem->isVisible())
+        {
+            // the ink of a binary page is stored aside
+            if (!mWithInk)
+                continue;
 
-                        if (colorOnDarkBackground.isValid() && colorOnLightBackground.isValid())
-                        {
-                            mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri, "z-value"
-                                                      , QString("%1").arg(polygonItem->zValue()));
+            UBGraphicsStroke* currentStroke = polygonItem->stroke();
 
-                            mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri
-                                                      , "fill-on-dark-background", colorOnDarkBackground.name());
-                            mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri
-                                                      , "fill-on-light-background", colorOnLightBackground.name());
+            if (openStroke && (currentStroke != openStroke))
+            {
+                mXmlWriter.writeEndElement(); //g
+                openStroke = 0;
+                groupHoldsInfo = false;
+            }
 
-                            groupHoldsInfo = true;
-                        }
-                    }
+            bool firstPolygonInStroke = currentStroke  && !openStroke;
+
+            if (firstPolygonInStroke)
+            {
+                mXmlWriter.writeStartElement("g");
+                openStroke = currentStroke;
+
+                QMatrix matrix = item->sceneMatrix();
+
+                if (!matrix.isIdentity())
+                    mXmlWriter.writeAttribute("transform", toSvgTransform(matrix));
 
-                    if (stroke && !stroke->hasPressure())
+                UBGraphicsStroke* stroke = dynamic_cast<UBGraphicsStroke* >(currentStroke);
+
+                if (stroke)
+                {
+                    QColor colorOnDarkBackground = polygonItem->colorOnDarkBackground();
+                    QColor colorOnLightBackground = polygonItem->colorOnLightBackground();
+
+                    if (colorOnDarkBackground.isValid() && colorOnLightBackground.isValid())
                     {
+                        mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri, "z-value"
+                                                  , QString("%1").arg(polygonItem->zValue()));
 
-                        strokeToSvgPolyline(stroke, groupHoldsInfo);
+                        mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri
+                                                  , "fill-on-dark-background", colorOnDarkBackground.name());
+                        mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri
+                                                  , "fill-on-light-background", colorOnLightBackground.name());
 
-                        //we can dequeue all polygons belonging to that stroke
-                        foreach(UBGraphicsPolygonItem* gi, stroke->polygons())
-                        {
-                            items.removeOne(gi);
-                        }
-                        continue;
+                        groupHoldsInfo = true;
                     }
                 }
 
-                if (polygonItem->isNominalLine())
-                    polygonItemToSvgLine(polygonItem, groupHoldsInfo);
-                else
-                    polygonItemToSvgPolygon(polygonItem, groupHoldsInfo);
+                if (stroke && !stroke->hasPressure())
+                {
 
-                continue;
-            }
+                    strokeToSvgPolyline(stroke, groupHoldsInfo);
 
-            if (openStroke)
-            {
-                mXmlWriter.writeEndElement(); //g
-                groupHoldsInfo = false;
-                openStroke = 0;
+                    //we can skip all polygons belonging to that stroke
+                    foreach(UBGraphicsPolygonItem* gi, stroke->polygons())
+                    {
+                        writtenPolygons << gi;
+                    }
+                    continue;
+                }
             }
 
-            UBGraphicsPixmapItem *pixmapItem = qgraphicsitem_cast<UBGraphicsPixmapItem*> (item);
-
-            if (pixmapItem && pixmapItem->isVisible())
-            {
-                pixmapItemToLinkedImage(pixmapItem);
-                continue;
-            }
+            if (polygonItem->isNominalLine())
+                polygonItemToSvgLine(polygonItem, groupHoldsInfo);
+            else
+                polygonItemToSvgPolygon(polygonItem, groupHoldsInfo);
 
-            UBGraphicsSvgItem *svgItem = qgraphicsitem_cast<UBGraphicsSvgItem*> (item);
+            continue;
+        }
 
-            if (svgItem && svgItem->isVisible())
-            {
-                svgItemToLinkedSvg(svgItem);
-                continue;
-            }
+        if (openStroke)
+        {
+            mXmlWriter.writeEndElement(); //g
+            groupHoldsInfo = false;
+            openStroke = 0;
+        }
 
-            UBGraphicsVideoItem *videoItem = qgraphicsitem_cast<UBGraphicsVideoItem*> (item);
+        UBGraphicsPixmapItem *pixmapItem = qgraphicsitem_cast<UBGraphicsPixmapItem*> (item);
 
-            if (videoItem && videoItem->isVisible())
-            {
-                videoItemToLinkedVideo(videoItem);
-                continue;
-            }
+        if (pixmapItem && pixmapItem->isVisible())
+        {
+            pixmapItemToLinkedImage(pixmapItem);
+            continue;
+        }
 
-            UBGraphicsAudioItem* audioItem = qgraphicsitem_cast<UBGraphicsAudioItem*> (item);
-            if (audioItem && audioItem->isVisible()) {
-                audioItemToLinkedAudio(audioItem);
-                continue;
-            }
+        UBGraphicsSvgItem *svgItem = qgraphicsitem_cast<UBGraphicsSvgItem*> (item);
 
-            UBGraphicsAppleWidgetItem *appleWidgetItem = qgraphicsitem_cast<UBGraphicsAppleWidgetItem*> (item);
+        if (svgItem && svgItem->isVisible())
+        {
+            svgItemToLinkedSvg(svgItem);
+            continue;
+        }
 
-            if (appleWidgetItem && appleWidgetItem->isVisible())
-            {
-                graphicsAppleWidgetToSvg(appleWidgetItem);
-                continue;
-            }
+        UBGraphicsVideoItem *videoItem = qgraphicsitem_cast<UBGraphicsVideoItem*> (item);
 
-            UBGraphicsW3CWidgetItem *w3cWidgetItem = qgraphicsitem_cast<UBGraphicsW3CWidgetItem*> (item);
+        if (videoItem && videoItem->isVisible())
+        {
+            videoItemToLinkedVideo(videoItem);
+            continue;
+        }
 
-            if (w3cWidgetItem && w3cWidgetItem->isVisible())
-            {
-                graphicsW3CWidgetToSvg(w3cWidgetItem);
-                continue;
-            }
+        UBGraphicsAudioItem* audioItem = qgraphicsitem_cast<UBGraphicsAudioItem*> (item);
+        if (audioItem && audioItem->isVisible()) {
+            audioItemToLinkedAudio(audioItem);
+            continue;
+        }
 
-            UBGraphicsPDFItem *pdfItem = qgraphicsitem_cast<UBGraphicsPDFItem*> (item);
+        UBGraphicsAppleWidgetItem *appleWidgetItem = qgraphicsitem_cast<UBGraphicsAppleWidgetItem*> (item);
 
-            if (pdfItem && pdfItem->isVisible())
-            {
-                pdfItemToLinkedPDF(pdfItem);
-                continue;
-            }
+        if (appleWidgetItem && appleWidgetItem->isVisible())
+        {
+            graphicsAppleWidgetToSvg(appleWidgetItem);
+            continue;
+        }
 
-            UBGraphicsTextItem *textItem = qgraphicsitem_cast<UBGraphicsTextItem*> (item);
+        UBGraphicsW3CWidgetItem *w3cWidgetItem = qgraphicsitem_cast<UBGraphicsW3CWidgetItem*> (item);
 
-            if (textItem && textItem->isVisible())
-            {
-                textItemToSvg(textItem);
-                continue;
-            }
+        if (w3cWidgetItem && w3cWidgetItem->isVisible())
+        {
+            graphicsW3CWidgetToSvg(w3cWidgetItem);
+            continue;
+        }
 
-            UBGraphicsCurtainItem *curtainItem = qgraphicsitem_cast<UBGraphicsCurtainItem*> (item);
+        UBGraphicsPDFItem *pdfItem = qgraphicsitem_cast<UBGraphicsPDFItem*> (item);
 
-            if (curtainItem && curtainItem->isVisible())
-            {
-                curtainItemToSvg(curtainItem);
-                continue;
-            }
+        if (pdfItem && pdfItem->isVisible())
+        {
+            pdfItemToLinkedPDF(pdfItem);
+            continue;
+        }
 
-            UBGraphicsRuler *ruler = qgraphicsitem_cast<UBGraphicsRuler*> (item);
+        UBGraphicsTextItem *textItem = qgraphicsitem_cast<UBGraphicsTextItem*> (item);
 
-            if (ruler  && ruler->isVisible())
-            {
-                rulerToSvg(ruler);
-                continue;
-            }
+        if (textItem && textItem->isVisible())
+        {
+            textItemToSvg(textItem);
+            continue;
+        }
 
-            UBGraphicsCache* cache = qgraphicsitem_cast<UBGraphicsCache*>(item);
-            if(cache && cache->isVisible())
-            {
-                cacheToSvg(cache);
-                continue;
-            }
+        UBGraphicsCurtainItem *curtainItem = qgraphicsitem_cast<UBGraphicsCurtainItem*> (item);
 
-            UBGraphicsCompass *compass = qgraphicsitem_cast<UBGraphicsCompass*> (item);
+        if (curtainItem && curtainItem->isVisible())
+        {
+            curtainItemToSvg(curtainItem);
+            continue;
+        }
 
-            if (compass  && compass->isVisible())
-            {
-                compassToSvg(compass);
-                continue;
-            }
+        UBGraphicsRuler *ruler = qgraphicsitem_cast<UBGraphicsRuler*> (item);
 
-            UBGraphicsProtractor *protractor = qgraphicsitem_cast<UBGraphicsProtractor*> (item);
+        if (ruler  && ruler->isVisible())
+        {
+            rulerToSvg(ruler);
+            continue;
+        }
 
-            if (protractor  && protractor->isVisible())
-            {
-                protractorToSvg(protractor);
-                continue;
-            }
+        UBGraphicsCache* cache = qgraphicsitem_cast<UBGraphicsCache*>(item);
+        if(cache && cache->isVisible())
+        {
+            cacheToSvg(cache);
+            continue;
+        }
 
-            UBGraphicsTriangle *triangle = qgraphicsitem_cast<UBGraphicsTriangle*> (item);
+        UBGraphicsCompass *compass = qgraphicsitem_cast<UBGraphicsCompass*> (item);
 
-            if (triangle  && triangle->isVisible())
-            {
-                triangleToSvg(triangle);
-                continue;
-            }
+        if (compass  && compass->isVisible())
+        {
+            compassToSvg(compass);
+            continue;
         }
 
-        if (openStroke)
+        UBGraphicsProtractor *protractor = qgraphicsitem_cast<UBGraphicsProtractor*> (item);
+
+        if (protractor  && protractor->isVisible())
         {
-            mXmlWriter.writeEndElement();
-            groupHoldsInfo = false;
-            openStroke = 0;
+            protractorToSvg(protractor);
+            continue;
         }
 
-        mXmlWriter.writeEndDocument();
-        QString fileName = mDocumentPath + UBFileSystemUtils::digitFileFormat("/page%1.svg", mPageIndex + 1);
-        QFile file(fileName);
+        UBGraphicsTriangle *triangle = qgraphicsitem_cast<UBGraphicsTriangle*> (item);
 
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        if (triangle  && triangle->isVisible())
         {
-            qCritical() << "cannot open " << fileName << " for writing ...";
-            return false;
+            triangleToSvg(triangle);
+            continue;
         }
-        file.write(buffer.data());
-        file.flush();
-        file.close();
-
     }
-    else
+
+    if (openStroke)
     {
-        qDebug() << "ignoring unmodified page" << mPageIndex + 1;
+        mXmlWriter.writeEndElement();
+        groupHoldsInfo = false;
+        openStroke = 0;
     }
 
-    return true;
+    mXmlWriter.writeEndDocument();
+
+    return buffer.data();
 }
 
 
@@ -1778,9 +1832,10 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::audioItemToLinkedAudio(UBGraphicsAud
 
     graphicsItemToSvg(audioItem);
 
-    if (audioItem->mediaObject()->state() == Phonon::PausedState && audioItem->mediaObject()->remainingTime() > 0)
+    qint64 pos = audioItem->resumePosition();
+
+    if (pos > 0)
     {
-        qint64 pos = audioItem->mediaObject()->currentTime();
         mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri, "position", QString("%1").arg(pos));
     }
 
@@ -1803,9 +1858,10 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::videoItemToLinkedVideo(UBGraphicsVid
 
     graphicsItemToSvg(videoItem);
 
-    if (videoItem->mediaObject()->state() == Phonon::PausedState && videoItem->mediaObject()->remainingTime() > 0)
+    qint64 pos = videoItem->resumePosition();
+
+    if (pos > 0)
     {
-        qint64 pos = videoItem->mediaObject()->currentTime();
         mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri, "position", QString("%1").arg(pos));
     }
 
@@ -2069,8 +2125,11 @@ void UBSvgSubsetAdaptor::UBSvgSubsetWriter::graphicsWidgetToSvg(UBGraphicsWidget
         mXmlWriter.writeAttribute(UBSettings::uniboardDocumentNamespaceUri, "frozen", xmlTrue);
     }
 
-    QString snapshotPath = mDocumentPath + "/" + UBPersistenceManager::widgetDirectory + "/" + uuid + ".png";
-    item->widgetWebView()->takeSnapshot().save(snapshotPath, "PNG");
+    if (mWithSnapshots)
+    {
+        QString snapshotPath = mDocumentPath + "/" + UBPersistenceManager::widgetDirectory + "/" + uuid + ".png";
+        item->widgetWebView()->takeSnapshot().save(snapshotPath, "PNG");
+    }
 
     mXmlWriter.writeStartElement(nsXHtml, "iframe");
 
@@ -53,6 +53,8 @@ class UBSvgSubsetAdaptor
 
         static UBGraphicsScene* loadScene(UBDocumentProxy* proxy, const int pageIndex);
         static void persistScene(UBDocumentProxy* proxy, UBGraphicsScene* pScene, const int pageIndex);
+        // the page as it would be persisted, without refreshing the widget snapshots
+        static QByteArray sceneSvg(UBDocumentProxy* proxy, UBGraphicsScene* pScene, const int pageIndex, bool pWithInk = true);
         static void upgradeScene(UBDocumentProxy* proxy, const int pageIndex);
 
         static QUuid sceneUuid(UBDocumentProxy* proxy, const int pageIndex);
@@ -75,6 +77,9 @@ class UBSvgSubsetAdaptor
 
     private:
 
+        // reads the items of its binary pages other than the ink
+        friend class UBBinaryPageAdaptor;
+
         static UBGraphicsScene* loadScene(UBDocumentProxy* proxy, const QByteArray& pArray);
 
         static QDomDocument loadSceneDocument(UBDocumentProxy* proxy, const int pPageIndex);
@@ -154,6 +159,7 @@ class UBSvgSubsetAdaptor
                 UBSvgSubsetWriter(UBDocumentProxy* proxy, UBGraphicsScene* pScene, const int pageIndex);
 
                 bool persistScene();
+                QByteArray sceneSvg(bool pWithSnapshots = true, bool pWithInk = true);
 
                 virtual ~UBSvgSubsetWriter(){};
 
@@ -179,15 +185,53 @@ class UBSvgSubsetAdaptor
                     for(int j = 0; j < pointsCount; j++)
                     {
                             const QPointF & point = crashedPoints.at(j);
-                            int n = sprintf(buffer + length, "%.2f,%.2f ", point.x(), point.y());
-                            length += n;
+                            length += writeFixed2(buffer + length, point.x());
+                            buffer[length++] = ',';
+                            length += writeFixed2(buffer + length, point.y());
+                            buffer[length++] = ' ';
                     }
 
                     svgPoints = QString::fromAscii(buffer, length);
-                    delete buffer;
+                    delete[] buffer;
                     return svgPoints;
                 }
 
+                // same output as sprintf "%.2f" for the coordinates of a page, without the locale and format parsing
+                inline int writeFixed2(char* buffer, qreal value)
+                {
+                    if (qAbs(value) >= 1e15)
+                        return sprintf(buffer, "%.2f", value);
+
+                    qint64 hundredths = qRound64(value * 100);
+                    int length = 0;
+
+                    if (hundredths < 0)
+                    {
+                        buffer[length++] = '-';
+                        hundredths = -hundredths;
+                    }
+
+                    char digits[24];
+                    int digitCount = 0;
+                    qint64 integer = hundredths / 100;
+
+                    do
+                    {
+                        digits[digitCount++] = '0' + (integer % 10);
+                        integer /= 10;
+                    }
+                    while (integer > 0);
+
+                    while (digitCount > 0)
+                        buffer[length++] = digits[--digitCount];
+
+                    buffer[length++] = '.';
+                    buffer[length++] = '0' + (hundredths % 100) / 10;
+                    buffer[length++] = '0' + (hundredths % 10);
+
+                    return length;
+                }
+
                 inline qreal trickAlpha(qreal alpha)
                 {
                         qreal trickAlpha = alpha;
@@ -223,6 +267,8 @@ class UBSvgSubsetAdaptor
                 QXmlStreamWriter mXmlWriter;
                 QString mDocumentPath;
                 int mPageIndex;
+                bool mWithSnapshots;
+                bool mWithInk;
 
         };
 };
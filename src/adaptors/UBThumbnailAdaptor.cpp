@@ -18,6 +18,7 @@
 #include <QtCore>
 
 #include "frameworks/UBFileSystemUtils.h"
+#include "frameworks/UBTrace.h"
 
 #include "core/UBPersistenceManager.h"
 #include "core/UBApplication.h"
@@ -46,47 +47,61 @@ UBThumbnailAdaptor::~UBThumbnailAdaptor()
 
 QList<QPixmap> UBThumbnailAdaptor::load(UBDocumentProxy* proxy)
 {
-
     QList<QPixmap> thumbnails;
 
+    foreach(QString fileName, thumbnailPaths(proxy))
+    {
+        QPixmap pix;
+
+        pix.load(fileName);
+
+        thumbnails.append(pix);
+    }
+
+    return thumbnails;
+}
+
+
+QStringList UBThumbnailAdaptor::thumbnailPaths(UBDocumentProxy* proxy)
+{
+    QStringList thumbnails;
+
     if (!proxy || proxy->persistencePath().size() == 0)
         return thumbnails;
 
     //compatibility with older formats (<= 4.0.b.2.0) : generate missing thumbnails
+    //also the pages recovered from the journal, their thumbnail is removed
 
     int existingPageCount = proxy->pageCount();
 
-    QString thumbFileName = proxy->persistencePath() +
-        UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", existingPageCount);
+    bool displayMessage = (existingPageCount > 5);
 
-    QFile thumbFile(thumbFileName);
+    int thumbCount = 0;
 
-    if (!thumbFile.exists())
+    for(int i = 0 ; i < existingPageCount; i++)
     {
-        bool displayMessage = (existingPageCount > 5);
+        QString thumbFileName = proxy->persistencePath() +
+            UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", i + 1);
 
-        int thumbCount = 0;
+        if (QFile::exists(thumbFileName))
+            continue;
 
-        for(int i = 0 ; i < existingPageCount; i++)
-        {
-            UBGraphicsScene* scene = UBSvgSubsetAdaptor::loadScene(proxy, i);
+        UBGraphicsScene* scene = UBSvgSubsetAdaptor::loadScene(proxy, i);
 
-            if (scene)
-            {
-                thumbCount++;
+        if (scene)
+        {
+            thumbCount++;
 
-                if (displayMessage && thumbCount == 1)
-                    UBApplication::showMessage(tr("Generating preview thumbnails ..."));
+            if (displayMessage && thumbCount == 1)
+                UBApplication::showMessage(tr("Generating preview thumbnails ..."));
 
-                persistScene(proxy->persistencePath(), scene, i);
-            }
+            persistScene(proxy->persistencePath(), scene, i);
         }
-
-        if (displayMessage && thumbCount > 0)
-            UBApplication::showMessage(tr("%1 thumbnails generated ...").arg(thumbCount));
-
     }
 
+    if (displayMessage && thumbCount > 0)
+        UBApplication::showMessage(tr("%1 thumbnails generated ...").arg(thumbCount));
+
     //end compatibility with older format
 
     bool moreToProcess = true;
@@ -104,11 +119,7 @@ QList<QPixmap> UBThumbnailAdaptor::load(UBDocumentProxy* proxy)
 
         if (file.exists())
         {
-            QPixmap pix;
-
-            pix.load(fileName);
-
-            thumbnails.append(pix);
+            thumbnails.append(fileName);
         }
         else
         {
@@ -128,41 +139,49 @@ void UBThumbnailAdaptor::persistScene(const QString& pDocPath, UBGraphicsScene*
 
     if (pScene->isModified() || overrideModified || !thumbFile.exists())
     {
-        qreal nominalWidth = pScene->nominalSize().width();
-        qreal nominalHeight = pScene->nominalSize().height();
-        qreal ratio = nominalWidth / nominalHeight;
-        QRectF sceneRect = pScene->normalizedSceneRect(ratio);
+        render(pScene, UBSettings::maxThumbnailWidth).save(fileName, "JPG");
+    }
+}
 
-        qreal width = UBSettings::maxThumbnailWidth;
-        qreal height = width / ratio;
 
-        QImage thumb(width, height, QImage::Format_ARGB32);
+QImage UBThumbnailAdaptor::render(UBGraphicsScene* pScene, const int pWidth)
+{
+    UB_TRACE_SCOPE("thumbnail.render", "thumbnail");
 
-        QRectF imageRect(0, 0, width, height);
+    qreal nominalWidth = pScene->nominalSize().width();
+    qreal nominalHeight = pScene->nominalSize().height();
+    qreal ratio = nominalWidth / nominalHeight;
+    QRectF sceneRect = pScene->normalizedSceneRect(ratio);
 
-        QPainter painter(&thumb);
-        painter.setRenderHint(QPainter::Antialiasing, true);
-        painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    qreal width = pWidth;
+    qreal height = width / ratio;
 
-        if (pScene->isDarkBackground())
-        {
-            painter.fillRect(imageRect, Qt::black);
-        }
-        else
-        {
-            painter.fillRect(imageRect, Qt::white);
-        }
+    QImage thumb(width, height, QImage::Format_ARGB32);
 
-        pScene->setRenderingContext(UBGraphicsScene::NonScreen);
-        pScene->setRenderingQuality(UBItem::RenderingQualityHigh);
+    QRectF imageRect(0, 0, width, height);
 
-        pScene->render(&painter, imageRect, sceneRect, Qt::KeepAspectRatio);
+    QPainter painter(&thumb);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
 
-        pScene->setRenderingContext(UBGraphicsScene::Screen);
-        pScene->setRenderingQuality(UBItem::RenderingQualityNormal);
-
-        thumb.scaled(width, height, Qt::KeepAspectRatio, Qt::SmoothTransformation).save(fileName, "JPG");
+    if (pScene->isDarkBackground())
+    {
+        painter.fillRect(imageRect, Qt::black);
+    }
+    else
+    {
+        painter.fillRect(imageRect, Qt::white);
     }
+
+    pScene->setRenderingContext(UBGraphicsScene::NonScreen);
+    pScene->setRenderingQuality(UBItem::RenderingQualityHigh);
+
+    pScene->render(&painter, imageRect, sceneRect, Qt::KeepAspectRatio);
+
+    pScene->setRenderingContext(UBGraphicsScene::Screen);
+    pScene->setRenderingQuality(UBItem::RenderingQualityNormal);
+
+    return thumb;
 }
 
 
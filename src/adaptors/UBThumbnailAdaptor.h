@@ -32,8 +32,13 @@ public:
 
     static void persistScene(const QString& pDocPath, UBGraphicsScene* pScene, const int pageIndex,  const bool overrideModified = false);
 
+    static QImage render(UBGraphicsScene* pScene, const int pWidth);
+
     static QList<QPixmap> load(UBDocumentProxy* proxy);
 
+    // the thumbnail files of the pages, the missing ones are generated first
+    static QStringList thumbnailPaths(UBDocumentProxy* proxy);
+
     static QUrl thumbnailUrl(UBDocumentProxy* proxy, const int pageIndex);
 
 };
@@ -4,6 +4,7 @@ HEADERS      += src/adaptors/UBExportAdaptor.h\
                 src/adaptors/UBExportFullPDF.h \
                 src/adaptors/UBExportDocument.h \
                 src/adaptors/UBSvgSubsetAdaptor.h \
+                src/adaptors/UBBinaryPageAdaptor.h \
                 src/adaptors/UBMetadataDcSubsetAdaptor.h \
                 src/adaptors/UBImportAdaptor.h \
                 src/adaptors/UBImportDocument.h \
@@ -18,7 +19,8 @@ HEADERS      += src/adaptors/UBExportAdaptor.h\
 
 HEADERS      += src/adaptors/publishing/UBDocumentPublisher.h \
                 src/adaptors/publishing/UBAbstractPublisher.h \
-                src/adaptors/publishing/UBSvgSubsetRasterizer.h
+                src/adaptors/publishing/UBSvgSubsetRasterizer.h \
+                src/adaptors/publishing/UBPublishingArchiver.h
                
 HEADERS      += src/adaptors/voting/UBAbstractVotingSystem.h
 
@@ -28,6 +30,7 @@ SOURCES      += src/adaptors/UBExportAdaptor.cpp\
                 src/adaptors/UBExportFullPDF.cpp \
                 src/adaptors/UBExportDocument.cpp \
                 src/adaptors/UBSvgSubsetAdaptor.cpp \
+                src/adaptors/UBBinaryPageAdaptor.cpp \
                 src/adaptors/UBMetadataDcSubsetAdaptor.cpp \
                 src/adaptors/UBImportAdaptor.cpp \
                 src/adaptors/UBImportDocument.cpp \
@@ -42,7 +45,8 @@ SOURCES      += src/adaptors/UBExportAdaptor.cpp\
 
 SOURCES      += src/adaptors/publishing/UBDocumentPublisher.cpp \
                 src/adaptors/publishing/UBAbstractPublisher.cpp \
-                src/adaptors/publishing/UBSvgSubsetRasterizer.cpp
+                src/adaptors/publishing/UBSvgSubsetRasterizer.cpp \
+                src/adaptors/publishing/UBPublishingArchiver.cpp
                 
 SOURCES      += src/adaptors/voting/UBAbstractVotingSystem.cpp   
 
@@ -42,11 +42,24 @@
 #include "adaptors/UBSvgSubsetAdaptor.h"
 
 #include "UBSvgSubsetRasterizer.h"
+#include "UBPublishingArchiver.h"
+
+#include "transition/UniboardSankoreTransition.h"
 
 #include "core/memcheck.h"
 #include "../../core/UBApplication.h"
 
 
+// the working files of the document are not published: binary pages, files being written or rewritten
+static QStringList workingFiles()
+{
+    QStringList files;
+    files << "*.ubpage" << "*.tmp" << "*.transition";
+
+    return files;
+}
+
+
 UBDocumentPublisher::UBDocumentPublisher(UBDocumentProxy* pDocument, QObject *parent)
         : UBAbstractPublisher(parent)
         , mSourceDocument(pDocument)
@@ -54,6 +67,13 @@ UBDocumentPublisher::UBDocumentPublisher(UBDocumentProxy* pDocument, QObject *pa
         , mUsername("")
         , mPassword("")
         , bLoginCookieSet(false)
+        , mPageIndex(0)
+        , mPagesPublished(false)
+        , mUbzArchived(false)
+        , mCancelled(false)
+        , mUbzArchiver(0)
+        , mUbwArchiver(0)
+        , mProgressDialog(0)
 {
     init();
 }
@@ -61,10 +81,9 @@ UBDocumentPublisher::UBDocumentPublisher(UBDocumentProxy* pDocument, QObject *pa
 
 UBDocumentPublisher::~UBDocumentPublisher()
 {
-    if(mSourceDocument){
-        delete mSourceDocument;
-        mSourceDocument = NULL;
-    }
+    // the source document belongs to the persistence manager
+
+    removeTemporaryFiles();
 
     if(mPublishingDocument){
         delete mPublishingDocument;
@@ -81,6 +100,7 @@ void UBDocumentPublisher::publish()
     if(settings->communityUsername().isEmpty() || settings->communityPassword().isEmpty()){
         UBApplication::showMessage(tr("Credentials has to not been filled out yet."));
         qDebug() << "trying to connect to community without the required credentials";
+        deleteLater();
         return;
     }
 
@@ -93,108 +113,269 @@ void UBDocumentPublisher::publish()
         mDocInfos.title = dlg.title();
         mDocInfos.description = dlg.description();
 
+        // uploaded once built, in ubwArchived()
         buildUbwFile();
-
-        UBApplication::showMessage(tr("Uploading Sankore File on Web."));
-
-        sendUbw(mUsername, mPassword);
+    }
+    else
+    {
+        deleteLater();
     }
 }
 
 void UBDocumentPublisher::buildUbwFile()
 {
+    // the archives and the page exports read the svg files of the document
+    UBPersistenceManager::persistenceManager()->persistPendingSvgs(mSourceDocument);
+
     QDir d;
     d.mkpath(UBFileSystemUtils::defaultTempDirPath());
 
-    QString tmpDir = UBFileSystemUtils::createTempDir();
+    mStagingDir = UBFileSystemUtils::createTempDir();
+    mPublishingUuid = QUuid::createUuid();
+
+    // only the files changed for publishing are staged, the others are read from the document when archiving
+    QString sourceWidgets = mSourceDocument->persistencePath() + "/" + UBPersistenceManager::widgetDirectory;
 
-    if (UBFileSystemUtils::copyDir(mSourceDocument->persistencePath(), tmpDir))
+    if (QFileInfo(sourceWidgets).exists()
+            && !UBFileSystemUtils::copyDir(sourceWidgets, mStagingDir + "/" + UBPersistenceManager::widgetDirectory))
     {
-        QUuid publishingUuid = QUuid::createUuid();
+        abort(tr("Export canceled ..."));
+        return;
+    }
 
-        mPublishingDocument = new UBDocumentProxy(tmpDir);
-        mPublishingDocument->setPageCount(mSourceDocument->pageCount());
+    mPublishingDocument = new UBDocumentProxy(mStagingDir);
+    mPublishingDocument->setPageCount(mSourceDocument->pageCount());
 
-        rasterizeScenes();
+    mProgressDialog = new QProgressDialog(tr("Publishing document..."), tr("Cancel"), 0, mSourceDocument->pageCount() + 2, UBApplication::mainWindow);
+    mProgressDialog->setWindowModality(Qt::NonModal);
+    mProgressDialog->setMinimumDuration(0);
+    connect(mProgressDialog, SIGNAL(canceled()), this, SLOT(cancel()));
 
-        upgradeDocumentForPublishing();
+    // the ubz holds the whole document, it is archived in parallel with the page rendering
+    mUbzFile = UBFileSystemUtils::defaultTempDirPath() + "/" + UBStringUtils::toCanonicalUuid(mPublishingUuid) + ".ubz";
 
-        UBExportFullPDF pdfExporter;
-        pdfExporter.setVerbode(false);
-        pdfExporter.persistsDocument(mSourceDocument, mPublishingDocument->persistencePath() + "/" + UBStringUtils::toCanonicalUuid(publishingUuid) + ".pdf");
+    // the pages and widgets get the fix-ups of the ubz export (UniboardSankoreTransition::checkDocumentDirectory)
+    // on a copy, the media are read from the document
+    mUbzStagingDir = UBFileSystemUtils::createTempDir();
 
-        UBExportDocument ubzExporter;
-        ubzExporter.setVerbode(false);
-        ubzExporter.persistsDocument(mSourceDocument, mPublishingDocument->persistencePath() + "/" + UBStringUtils::toCanonicalUuid(publishingUuid) + ".ubz");
+    QDir sourceDir(mSourceDocument->persistencePath());
 
-        // remove all useless files
+    foreach(QString page, sourceDir.entryList(QStringList() << "*.svg", QDir::Files))
+    {
+        if (!QFile::copy(sourceDir.filePath(page), mUbzStagingDir + "/" + page))
+        {
+            abort(tr("Export canceled ..."));
+            return;
+        }
+    }
 
-        for (int pageIndex = 0; pageIndex < mPublishingDocument->pageCount(); pageIndex++) {
-            QString filename = mPublishingDocument->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", pageIndex + 1);
+    if (QFileInfo(sourceWidgets).exists()
+            && !UBFileSystemUtils::copyDir(sourceWidgets, mUbzStagingDir + "/" + UBPersistenceManager::widgetDirectory))
+    {
+        abort(tr("Export canceled ..."));
+        return;
+    }
 
-            QFile::remove(filename);
-        }
+    UniboardSankoreTransition transition;
+    transition.checkDocumentDirectory(mUbzStagingDir);
 
-        UBFileSystemUtils::deleteDir(mPublishingDocument->persistencePath() + "/" + UBPersistenceManager::imageDirectory);
-        UBFileSystemUtils::deleteDir(mPublishingDocument->persistencePath() + "/" + UBPersistenceManager::objectDirectory);
-        UBFileSystemUtils::deleteDir(mPublishingDocument->persistencePath() + "/" + UBPersistenceManager::videoDirectory);
-        UBFileSystemUtils::deleteDir(mPublishingDocument->persistencePath() + "/" + UBPersistenceManager::audioDirectory);
+    QStringList ubzExcluded = workingFiles();
+    ubzExcluded << "*.svg" << UBPersistenceManager::widgetDirectory;
 
-        mTmpZipFile = UBFileSystemUtils::defaultTempDirPath() + "/" + UBStringUtils::toCanonicalUuid(QUuid::createUuid()) + ".ubw~";
+    mUbzArchiver = new UBPublishingArchiver(mUbzFile, this);
+    mUbzArchiver->addDirectory(mSourceDocument->persistencePath(), ubzExcluded);
+    mUbzArchiver->addDirectory(mUbzStagingDir);
+    connect(mUbzArchiver, SIGNAL(finished()), this, SLOT(ubzArchived()));
+    mUbzArchiver->start();
 
-        QuaZip zip(mTmpZipFile);
-        zip.setFileNameCodec("UTF-8");
-        if (!zip.open(QuaZip::mdCreate))
-        {
-            qWarning() << "Export failed. Cause: zip.open(): " << zip.getZipError() << "," << mTmpZipFile;
-            QApplication::restoreOverrideCursor();
-            return;
-        }
+    mPageIndex = 0;
 
-        QuaZipFile outFile(&zip);
+    QTimer::singleShot(0, this, SLOT(publishNextPage()));
+}
 
-        if (!UBFileSystemUtils::compressDirInZip(mPublishingDocument->persistencePath(), "", &outFile, true))
-        {
-            qWarning("Export failed. compressDirInZip failed ...");
-            zip.close();
-            UBApplication::showMessage(tr("Export failed."));
-            QApplication::restoreOverrideCursor();
-            return;
-        }
 
-        if (zip.getZipError() != 0)
+void UBDocumentPublisher::publishNextPage()
+{
+    if (mCancelled)
+        return;
+
+    if (mPageIndex < mPublishingDocument->pageCount())
+    {
+        UBApplication::showMessage(tr("Converting page %1/%2 ...").arg(mPageIndex + 1).arg(mPublishingDocument->pageCount()), true);
+
+        UBGraphicsScene *scene = UBSvgSubsetAdaptor::loadScene(mSourceDocument, mPageIndex);
+
+        if (scene)
         {
-            qWarning("Export failed. Cause: zip.close(): %d", zip.getZipError());
-            zip.close();
-            UBApplication::showMessage(tr("Export failed."));
-            QApplication::restoreOverrideCursor();
-            return;
+            QString filename = mPublishingDocument->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.jpg", mPageIndex + 1);
+
+            UBSvgSubsetRasterizer::rasterizeSceneToFile(scene, filename);
+
+            upgradeSceneForPublishing(scene, mPageIndex);
+
+            delete scene;
         }
 
-        zip.close();
+        mPageIndex++;
+        mProgressDialog->setValue(mPageIndex);
 
+        // back to the event loop between pages
+        QTimer::singleShot(0, this, SLOT(publishNextPage()));
+        return;
     }
-    else
+
+    updateGoogleMapApiKey();
+
+    UBExportFullPDF pdfExporter;
+    pdfExporter.setVerbode(false);
+    pdfExporter.persistsDocument(mSourceDocument, mPublishingDocument->persistencePath() + "/" + UBStringUtils::toCanonicalUuid(mPublishingUuid) + ".pdf");
+
+    if (mCancelled)
+        return;
+
+    mProgressDialog->setValue(mPageIndex + 1);
+
+    mPagesPublished = true;
+
+    assembleUbwFile();
+}
+
+
+void UBDocumentPublisher::ubzArchived()
+{
+    mUbzArchiver->wait();
+    mUbzArchived = true;
+
+    if (mCancelled)
+        return;
+
+    if (!mUbzArchiver->succeeded())
     {
-        UBApplication::showMessage(tr("Export canceled ..."));
-        QApplication::restoreOverrideCursor();
+        abort(tr("Export failed."));
+        return;
     }
+
+    assembleUbwFile();
 }
 
-void UBDocumentPublisher::rasterizeScenes()
+
+void UBDocumentPublisher::assembleUbwFile()
 {
+    if (!mPagesPublished || !mUbzArchived || mUbwArchiver)
+        return;
+
+    UBApplication::showMessage(tr("Compressing document ..."), true);
+
+    mTmpZipFile = UBFileSystemUtils::defaultTempDirPath() + "/" + UBStringUtils::toCanonicalUuid(QUuid::createUuid()) + ".ubw~";
+
+    // pages are published as images, the media are in the ubz, widgets come from the staging directory
+    QStringList excluded = workingFiles();
+    excluded << "*.svg"
+             << UBPersistenceManager::imageDirectory
+             << UBPersistenceManager::objectDirectory
+             << UBPersistenceManager::videoDirectory
+             << UBPersistenceManager::audioDirectory
+             << UBPersistenceManager::widgetDirectory;
+
+    mUbwArchiver = new UBPublishingArchiver(mTmpZipFile, this);
+    mUbwArchiver->addDirectory(mSourceDocument->persistencePath(), excluded);
+    mUbwArchiver->addDirectory(mStagingDir);
+    mUbwArchiver->addFile(mUbzFile, UBStringUtils::toCanonicalUuid(mPublishingUuid) + ".ubz");
+    connect(mUbwArchiver, SIGNAL(finished()), this, SLOT(ubwArchived()));
+    mUbwArchiver->start();
+}
+
 
-    for (int pageIndex = 0; pageIndex < mPublishingDocument->pageCount(); pageIndex++)
+void UBDocumentPublisher::ubwArchived()
+{
+    mUbwArchiver->wait();
+
+    if (mCancelled)
+        return;
+
+    if (!mUbwArchiver->succeeded())
     {
-        UBApplication::showMessage(tr("Converting page %1/%2 ...").arg(pageIndex + 1).arg(mPublishingDocument->pageCount()), true);
+        abort(tr("Export failed."));
+        return;
+    }
+
+    mProgressDialog->setValue(mProgressDialog->maximum());
 
-        UBSvgSubsetRasterizer rasterizer(mPublishingDocument, pageIndex);
+    // the .ubw is kept for the upload, onFinished deletes it
+    QString ubwFile = mTmpZipFile;
+    mTmpZipFile = QString();
+    removeTemporaryFiles();
+    mTmpZipFile = ubwFile;
 
-        QString filename = mPublishingDocument->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.jpg", pageIndex + 1);
+    UBApplication::showMessage(tr("Uploading Sankore File on Web."));
+
+    sendUbw(mUsername, mPassword);
+}
 
-        rasterizer.rasterizeToFile(filename);
 
+void UBDocumentPublisher::cancel()
+{
+    if (mCancelled)
+        return;
+
+    mCancelled = true;
+
+    if (mUbzArchiver)
+        mUbzArchiver->cancel();
+
+    if (mUbwArchiver)
+        mUbwArchiver->cancel();
+
+    abort(tr("Export canceled ..."));
+}
+
+
+void UBDocumentPublisher::abort(const QString& message)
+{
+    mCancelled = true;
+
+    UBApplication::showMessage(message);
+
+    removeTemporaryFiles();
+
+    deleteLater();
+}
+
+
+void UBDocumentPublisher::removeTemporaryFiles()
+{
+    if (mUbzArchiver)
+    {
+        mUbzArchiver->wait();
+    }
+
+    if (mUbwArchiver)
+    {
+        mUbwArchiver->wait();
+    }
+
+    if (mProgressDialog)
+    {
+        mProgressDialog->deleteLater();
+        mProgressDialog = 0;
     }
+
+    if (!mStagingDir.isEmpty())
+        UBFileSystemUtils::deleteDir(mStagingDir);
+
+    if (!mUbzStagingDir.isEmpty())
+        UBFileSystemUtils::deleteDir(mUbzStagingDir);
+
+    if (!mUbzFile.isEmpty())
+        QFile::remove(mUbzFile);
+
+    if (!mTmpZipFile.isEmpty())
+        QFile::remove(mTmpZipFile);
+
+    mStagingDir = QString();
+    mUbzStagingDir = QString();
+    mUbzFile = QString();
+    mTmpZipFile = QString();
 }
 
 
@@ -237,125 +418,117 @@ void UBDocumentPublisher::updateGoogleMapApiKey()
 }
 
 
-void UBDocumentPublisher::upgradeDocumentForPublishing()
+void UBDocumentPublisher::upgradeSceneForPublishing(UBGraphicsScene* scene, int pageIndex)
 {
-    for (int pageIndex = 0; pageIndex < mPublishingDocument->pageCount(); pageIndex++)
-    {
-        UBGraphicsScene *scene = UBSvgSubsetAdaptor::loadScene(mPublishingDocument, pageIndex);
-
-        bool sceneHasWidget = false;
+    bool sceneHasWidget = false;
 
-        QList<UBGraphicsW3CWidgetItem*> widgets;
+    QList<UBGraphicsW3CWidgetItem*> widgets;
 
-        foreach(QGraphicsItem* item, scene->items()){
-            UBGraphicsW3CWidgetItem *widgetItem = dynamic_cast<UBGraphicsW3CWidgetItem*>(item);
+    foreach(QGraphicsItem* item, scene->items()){
+        UBGraphicsW3CWidgetItem *widgetItem = dynamic_cast<UBGraphicsW3CWidgetItem*>(item);
 
-            if(widgetItem){
-                generateWidgetPropertyScript(widgetItem, pageIndex + 1);
-                sceneHasWidget = true;
-                widgets << widgetItem;
-            }
+        if(widgetItem){
+            generateWidgetPropertyScript(widgetItem, pageIndex + 1);
+            sceneHasWidget = true;
+            widgets << widgetItem;
         }
+    }
 
-        QString filename = mPublishingDocument->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.json", pageIndex + 1);
-
-        QFile jsonFile(filename);
-        if (jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
-        {
-            jsonFile.write("{\n");
-            jsonFile.write(QString("  \"scene\": {\n").toUtf8());
-            jsonFile.write(QString("    \"x\": %1,\n").arg(scene->normalizedSceneRect().x()).toUtf8());
-            jsonFile.write(QString("    \"y\": %1,\n").arg(scene->normalizedSceneRect().y()).toUtf8());
-            jsonFile.write(QString("    \"width\": %1,\n").arg(scene->normalizedSceneRect().width()).toUtf8());
-            jsonFile.write(QString("    \"height\": %1\n").arg(scene->normalizedSceneRect().height()).toUtf8());
-            jsonFile.write(QString("  },\n").toUtf8());
-
-            jsonFile.write(QString("  \"widgets\": [\n").toUtf8());
+    QString filename = mPublishingDocument->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.json", pageIndex + 1);
 
-            bool first = true;
+    QFile jsonFile(filename);
+    if (jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        jsonFile.write("{\n");
+        jsonFile.write(QString("  \"scene\": {\n").toUtf8());
+        jsonFile.write(QString("    \"x\": %1,\n").arg(scene->normalizedSceneRect().x()).toUtf8());
+        jsonFile.write(QString("    \"y\": %1,\n").arg(scene->normalizedSceneRect().y()).toUtf8());
+        jsonFile.write(QString("    \"width\": %1,\n").arg(scene->normalizedSceneRect().width()).toUtf8());
+        jsonFile.write(QString("    \"height\": %1\n").arg(scene->normalizedSceneRect().height()).toUtf8());
+        jsonFile.write(QString("  },\n").toUtf8());
 
-            foreach(UBGraphicsW3CWidgetItem* widget, widgets)
-            {
-                if (!first)
-                    jsonFile.write(QString("    ,\n").toUtf8());
+        jsonFile.write(QString("  \"widgets\": [\n").toUtf8());
 
-                jsonFile.write(QString("    {\n").toUtf8());
-                jsonFile.write(QString("      \"uuid\": \"%1\",\n").arg(UBStringUtils::toCanonicalUuid(widget->uuid())).toUtf8());
-                jsonFile.write(QString("      \"id\": \"%1\",\n").arg(widget->metadatas().id).toUtf8());
+        bool first = true;
 
-                jsonFile.write(QString("      \"name\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().name).toUtf8());
-                jsonFile.write(QString("      \"description\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().description).toUtf8());
-                jsonFile.write(QString("      \"author\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().author).toUtf8());
-                jsonFile.write(QString("      \"authorEmail\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().authorEmail).toUtf8());
-                jsonFile.write(QString("      \"authorHref\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().authorHref).toUtf8());
-                jsonFile.write(QString("      \"version\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().authorHref).toUtf8());
+        foreach(UBGraphicsW3CWidgetItem* widget, widgets)
+        {
+            if (!first)
+                jsonFile.write(QString("    ,\n").toUtf8());
 
-                jsonFile.write(QString("      \"x\": %1,\n").arg(widget->sceneBoundingRect().x()).toUtf8());
-                jsonFile.write(QString("      \"y\": %1,\n").arg(widget->sceneBoundingRect().y()).toUtf8());
-                jsonFile.write(QString("      \"width\": %1,\n").arg(widget->sceneBoundingRect().width()).toUtf8());
-                jsonFile.write(QString("      \"height\": %1,\n").arg(widget->sceneBoundingRect().height()).toUtf8());
+            jsonFile.write(QString("    {\n").toUtf8());
+            jsonFile.write(QString("      \"uuid\": \"%1\",\n").arg(UBStringUtils::toCanonicalUuid(widget->uuid())).toUtf8());
+            jsonFile.write(QString("      \"id\": \"%1\",\n").arg(widget->metadatas().id).toUtf8());
 
-                jsonFile.write(QString("      \"nominalWidth\": %1,\n").arg(widget->boundingRect().width()).toUtf8());
-                jsonFile.write(QString("      \"nominalHeight\": %1,\n").arg(widget->boundingRect().height()).toUtf8());
+            jsonFile.write(QString("      \"name\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().name).toUtf8());
+            jsonFile.write(QString("      \"description\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().description).toUtf8());
+            jsonFile.write(QString("      \"author\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().author).toUtf8());
+            jsonFile.write(QString("      \"authorEmail\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().authorEmail).toUtf8());
+            jsonFile.write(QString("      \"authorHref\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().authorHref).toUtf8());
+            jsonFile.write(QString("      \"version\": \"%1\",\n").arg(widget->w3cWidget()->metadatas().authorHref).toUtf8());
 
-                QString url = UBPersistenceManager::widgetDirectory + "/" + widget->uuid().toString() + ".wgt";
-                jsonFile.write(QString("      \"src\": \"%1\",\n").arg(url).toUtf8());
-                QString startFile = widget->w3cWidget()->mainHtmlFileName();
-                jsonFile.write(QString("      \"startFile\": \"%1\",\n").arg(startFile).toUtf8());
+            jsonFile.write(QString("      \"x\": %1,\n").arg(widget->sceneBoundingRect().x()).toUtf8());
+            jsonFile.write(QString("      \"y\": %1,\n").arg(widget->sceneBoundingRect().y()).toUtf8());
+            jsonFile.write(QString("      \"width\": %1,\n").arg(widget->sceneBoundingRect().width()).toUtf8());
+            jsonFile.write(QString("      \"height\": %1,\n").arg(widget->sceneBoundingRect().height()).toUtf8());
 
-                QMap<QString, QString> preferences = widget->preferences();
+            jsonFile.write(QString("      \"nominalWidth\": %1,\n").arg(widget->boundingRect().width()).toUtf8());
+            jsonFile.write(QString("      \"nominalHeight\": %1,\n").arg(widget->boundingRect().height()).toUtf8());
 
-                jsonFile.write(QString("      \"preferences\": {\n").toUtf8());
+            QString url = UBPersistenceManager::widgetDirectory + "/" + widget->uuid().toString() + ".wgt";
+            jsonFile.write(QString("      \"src\": \"%1\",\n").arg(url).toUtf8());
+            QString startFile = widget->w3cWidget()->mainHtmlFileName();
+            jsonFile.write(QString("      \"startFile\": \"%1\",\n").arg(startFile).toUtf8());
 
-                foreach(QString key, preferences.keys())
-                {
-                    QString sep = ",";
-                    if (key == preferences.keys().last())
-                        sep = "";
-
-                    jsonFile.write(QString("          \"%1\": \"%2\"%3\n")
-                                   .arg(key)
-                                   .arg(preferences.value(key))
-                                   .arg(sep)
-                                   .toUtf8());
-                }
-                jsonFile.write(QString("      },\n").toUtf8());
+            QMap<QString, QString> preferences = widget->preferences();
 
-                jsonFile.write(QString("      \"datastore\": {\n").toUtf8());
+            jsonFile.write(QString("      \"preferences\": {\n").toUtf8());
 
-                QMap<QString, QString> datastoreEntries = widget->datastoreEntries();
+            foreach(QString key, preferences.keys())
+            {
+                QString sep = ",";
+                if (key == preferences.keys().last())
+                    sep = "";
+
+                jsonFile.write(QString("          \"%1\": \"%2\"%3\n")
+                               .arg(key)
+                               .arg(preferences.value(key))
+                               .arg(sep)
+                               .toUtf8());
+            }
+            jsonFile.write(QString("      },\n").toUtf8());
 
-                foreach(QString entry, datastoreEntries.keys())
-                {
-                    QString sep = ",";
-                    if (entry == datastoreEntries.keys().last())
-                        sep = "";
-
-                    jsonFile.write(QString("          \"%1\": \"%2\"%3\n")
-                                   .arg(entry)
-                                   .arg(datastoreEntries.value(entry))
-                                   .arg(sep)
-                                   .toUtf8());
-                }
-                jsonFile.write(QString("      }\n").toUtf8());
+            jsonFile.write(QString("      \"datastore\": {\n").toUtf8());
 
-                jsonFile.write(QString("    }\n").toUtf8());
+            QMap<QString, QString> datastoreEntries = widget->datastoreEntries();
 
-                first = false;
+            foreach(QString entry, datastoreEntries.keys())
+            {
+                QString sep = ",";
+                if (entry == datastoreEntries.keys().last())
+                    sep = "";
+
+                jsonFile.write(QString("          \"%1\": \"%2\"%3\n")
+                               .arg(entry)
+                               .arg(datastoreEntries.value(entry))
+                               .arg(sep)
+                               .toUtf8());
             }
+            jsonFile.write(QString("      }\n").toUtf8());
 
-            jsonFile.write("  ]\n");
-            jsonFile.write("}\n");
-        }
-        else
-        {
-            qWarning() << "Cannot open file" << filename << "for saving page state";
+            jsonFile.write(QString("    }\n").toUtf8());
+
+            first = false;
         }
 
-        delete scene;
+        jsonFile.write("  ]\n");
+        jsonFile.write("}\n");
+    }
+    else
+    {
+        qWarning() << "Cannot open file" << filename << "for saving page state";
     }
 
-    updateGoogleMapApiKey();
 }
 
 
@@ -574,9 +747,10 @@ void UBDocumentPublisher::onFinished(QNetworkReply *reply)
     // Now we isolate every cookie value
     QStringList qslCookieVals = qsCookieValue.split("; ");
 
+    // also called when the upload fails, the reply then holds the error
     bool bTransferOk = false;
 
-    for(int j = 0; j < qslCookieVals.size(); j++)
+    for(int j = 0; reply->error() == QNetworkReply::NoError && j < qslCookieVals.size(); j++)
     {
         qDebug() << j;
         if(qslCookieVals.at(j).startsWith("assetStatus"))
@@ -600,6 +774,11 @@ void UBDocumentPublisher::onFinished(QNetworkReply *reply)
     }
 
     reply->deleteLater();
+
+    QFile::remove(mTmpZipFile);
+    mTmpZipFile = QString();
+
+    deleteLater();
 }
 
 void UBDocumentPublisher::sendUbw(QString username, QString password)
@@ -629,23 +808,28 @@ void UBDocumentPublisher::sendUbw(QString username, QString password)
             datatoSend += mCrlf;
             datatoSend += QString("--%0--%1").arg(boundary).arg(mCrlf);
 
-            QNetworkRequest request(QUrl(QString(DOCPUBLICATION_URL).toAscii().constData()));
+            QUrl publishingUrl(UBSettings::settings()->communityPublishingUrl->get().toString());
+            QNetworkRequest request(publishingUrl);
 
             request.setHeader(QNetworkRequest::ContentTypeHeader, multipartHeader);
             request.setHeader(QNetworkRequest::ContentLengthHeader,datatoSend.size());
             QString b64Auth = getBase64Of(QString("%0:%1").arg(username).arg(password));
             request.setRawHeader("Authorization", QString("Basic %0").arg(b64Auth).toAscii().constData());
-            request.setRawHeader("Host", "planete.sankore.org");
+            request.setRawHeader("Host", publishingUrl.host().toAscii());
             request.setRawHeader("Accept", "*/*");
             request.setRawHeader("Accept-Language", "en-US,*");
 
-            mpCookieJar->setCookiesFromUrl(mCookies, QUrl(DOCPUBLICATION_URL));
+            mpCookieJar->setCookiesFromUrl(mCookies, publishingUrl);
             mpNetworkMgr->setCookieJar(mpCookieJar);
 
             // Send the file
             mpNetworkMgr->post(request,datatoSend);
+            return;
         }
     }
+
+    // without a request, onFinished never deletes the publisher
+    abort(tr("Export failed."));
 }
 
 QString UBDocumentPublisher::getBase64Of(QString stringToEncode)
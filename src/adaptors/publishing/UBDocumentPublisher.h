@@ -21,8 +21,6 @@
 #include "ui_webPublishing.h"
 #include "UBAbstractPublisher.h"
 
-#define DOCPUBLICATION_URL     "http://planete.sankore.org/xwiki/bin/view/CreateResources/UniboardUpload?xpage=plain&outputSyntax=plain"
-
 typedef struct
 {
     QString title;
@@ -32,6 +30,8 @@ typedef struct
 class UBDocumentProxy;
 class UBServerXMLHttpRequest;
 class UBGraphicsW3CWidgetItem;
+class UBGraphicsScene;
+class UBPublishingArchiver;
 class QWebView;
 
 class UBProxyLoginDlg : public QDialog
@@ -89,6 +89,10 @@ public:
 
     void publish();
 
+public slots:
+
+    void cancel();
+
 signals:
 
     void loginDone();
@@ -96,13 +100,15 @@ signals:
 protected:
 
     virtual void updateGoogleMapApiKey();
-    virtual void rasterizeScenes();
-    virtual void upgradeDocumentForPublishing();
+    virtual void upgradeSceneForPublishing(UBGraphicsScene* scene, int pageIndex);
     virtual void generateWidgetPropertyScript(UBGraphicsW3CWidgetItem *widgetItem, int pageNumber);
 
 private slots:
 
     void onFinished(QNetworkReply* reply);
+    void publishNextPage();
+    void ubzArchived();
+    void ubwArchived();
 
 private:
 
@@ -121,6 +127,23 @@ private:
     bool bLoginCookieSet;
 
     void buildUbwFile();
+    void assembleUbwFile();
+    void abort(const QString& message);
+    void removeTemporaryFiles();
+
+    // pages and pdf are produced on the GUI thread, page by page, while the ubz is archived in the background
+    QString mStagingDir;
+    QString mUbzStagingDir;
+    QString mUbzFile;
+    QUuid mPublishingUuid;
+    int mPageIndex;
+    bool mPagesPublished;
+    bool mUbzArchived;
+    bool mCancelled;
+    UBPublishingArchiver* mUbzArchiver;
+    UBPublishingArchiver* mUbwArchiver;
+    QProgressDialog* mProgressDialog;
+
     QString mTmpZipFile;
     QList<QNetworkCookie> mCookies;
     sDocumentInfos mDocInfos;
@@ -0,0 +1,182 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBPublishingArchiver.h"
+
+#include "quazip.h"
+#include "quazipfile.h"
+
+#include "frameworks/UBTrace.h"
+
+#include "core/memcheck.h"
+
+static const qint64 chunkSize = 64 * 1024;
+
+// deflating these again costs time and gains nothing
+static bool isCompressed(const QString& pFileName)
+{
+    static QStringList compressedSuffixes = QStringList() << "jpg" << "jpeg" << "png" << "gif" << "pdf"
+            << "ubz" << "zip" << "wgt" << "swf" << "flv" << "mp3" << "mp4" << "m4a" << "m4v"
+            << "mov" << "avi" << "wmv" << "wma" << "ogg" << "ogv" << "webm";
+
+    return compressedSuffixes.contains(QFileInfo(pFileName).suffix().toLower());
+}
+
+
+UBPublishingArchiver::UBPublishingArchiver(const QString& pArchivePath, QObject *pParent)
+    : QThread(pParent)
+    , mArchivePath(pArchivePath)
+    , mSucceeded(false)
+    , mCancelRequested(0)
+{
+    // NOOP
+}
+
+
+UBPublishingArchiver::~UBPublishingArchiver()
+{
+    cancel();
+    wait();
+}
+
+
+void UBPublishingArchiver::addDirectory(const QString& pDirectory, const QStringList& pExcludedNames)
+{
+    mDirectories << qMakePair(pDirectory, pExcludedNames);
+}
+
+
+void UBPublishingArchiver::addFile(const QString& pFilePath, const QString& pArchiveName)
+{
+    mFiles << qMakePair(pArchiveName, pFilePath);
+}
+
+
+void UBPublishingArchiver::cancel()
+{
+    mCancelRequested = 1;
+}
+
+
+bool UBPublishingArchiver::isExcluded(const QString& pName, const QStringList& pExcludedNames) const
+{
+    foreach(QString excluded, pExcludedNames)
+    {
+        if (QRegExp(excluded, Qt::CaseInsensitive, QRegExp::Wildcard).exactMatch(pName))
+            return true;
+    }
+
+    return false;
+}
+
+
+void UBPublishingArchiver::run()
+{
+    UB_TRACE_SCOPE("publishing.archive", "publishing");
+
+    mSucceeded = false;
+
+    QList<QPair<QString, QString> > files;
+    qint64 totalSize = 0;
+
+    for (int i = 0; i < mDirectories.size(); i++)
+    {
+        QDir directory(mDirectories.at(i).first);
+        QDirIterator it(directory.absolutePath(), QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+
+        while (it.hasNext())
+        {
+            it.next();
+
+            QString archiveName = directory.relativeFilePath(it.filePath());
+
+            if (!isExcluded(archiveName.section('/', 0, 0), mDirectories.at(i).second))
+            {
+                files << qMakePair(archiveName, it.filePath());
+                totalSize += it.fileInfo().size();
+            }
+        }
+    }
+
+    for (int i = 0; i < mFiles.size(); i++)
+    {
+        files << mFiles.at(i);
+        totalSize += QFileInfo(mFiles.at(i).second).size();
+    }
+
+    QuaZip zip(mArchivePath);
+    zip.setFileNameCodec("UTF-8");
+
+    if (!zip.open(QuaZip::mdCreate))
+    {
+        qWarning() << "Publishing failed. Cause: zip.open(): " << zip.getZipError() << "," << mArchivePath;
+        return;
+    }
+
+    QuaZipFile outFile(&zip);
+
+    qint64 writtenSize = 0;
+    int lastPercent = -1;
+    bool succeeded = true;
+
+    for (int i = 0; i < files.size() && succeeded; i++)
+    {
+        QFile inFile(files.at(i).second);
+
+        if (!inFile.open(QIODevice::ReadOnly))
+        {
+            qWarning() << "Publishing failed. Cause: cannot read" << inFile.fileName() << inFile.errorString();
+            succeeded = false;
+            break;
+        }
+
+        bool stored = isCompressed(inFile.fileName());
+
+        if (!outFile.open(QIODevice::WriteOnly, QuaZipNewInfo(files.at(i).first, inFile.fileName()), 0, 0,
+                stored ? 0 : Z_DEFLATED, stored ? Z_NO_COMPRESSION : Z_DEFAULT_COMPRESSION))
+        {
+            qWarning() << "Publishing failed. Cause: outFile.open(): " << outFile.getZipError();
+            succeeded = false;
+            break;
+        }
+
+        while (!inFile.atEnd() && succeeded)
+        {
+            QByteArray chunk = inFile.read(chunkSize);
+
+            succeeded = mCancelRequested == 0 && outFile.write(chunk) == chunk.size() && outFile.getZipError() == UNZ_OK;
+            writtenSize += chunk.size();
+
+            int percent = totalSize > 0 ? (int)(writtenSize * 100 / totalSize) : 100;
+
+            if (percent != lastPercent)
+            {
+                lastPercent = percent;
+                emit progress(percent);
+            }
+        }
+
+        outFile.close();
+
+        succeeded = succeeded && outFile.getZipError() == UNZ_OK;
+    }
+
+    zip.close();
+
+    mSucceeded = succeeded && zip.getZipError() == 0 && mCancelRequested == 0;
+
+    if (!mSucceeded)
+        QFile::remove(mArchivePath);
+}
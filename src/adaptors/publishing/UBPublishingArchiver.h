@@ -0,0 +1,70 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBPUBLISHINGARCHIVER_H_
+#define UBPUBLISHINGARCHIVER_H_
+
+#include <QtCore>
+
+/**
+ * Writes a zip archive in a background thread, reading each source file once.
+ *
+ * Directories and files are added before start(), already compressed files
+ * (images, pdf, archives, media) are stored as is.
+ */
+class UBPublishingArchiver : public QThread
+{
+    Q_OBJECT;
+
+    public:
+        UBPublishingArchiver(const QString& pArchivePath, QObject *pParent = 0);
+        virtual ~UBPublishingArchiver();
+
+        // pExcludedNames are wildcards matched against the names at the top of pDirectory
+        void addDirectory(const QString& pDirectory, const QStringList& pExcludedNames = QStringList());
+        void addFile(const QString& pFilePath, const QString& pArchiveName);
+
+        void cancel();
+
+        bool succeeded() const
+        {
+            return mSucceeded;
+        }
+
+        QString archivePath() const
+        {
+            return mArchivePath;
+        }
+
+    signals:
+        void progress(int pPercent);
+
+    protected:
+        void run();
+
+    private:
+        bool isExcluded(const QString& pName, const QStringList& pExcludedNames) const;
+
+        QString mArchivePath;
+
+        // archive name -> source file, directories are listed by run()
+        QList<QPair<QString, QString> > mFiles;
+        QList<QPair<QString, QStringList> > mDirectories;
+
+        bool mSucceeded;
+        QAtomicInt mCancelRequested;
+};
+
+#endif /* UBPUBLISHINGARCHIVER_H_ */
@@ -48,6 +48,16 @@ bool UBSvgSubsetRasterizer::rasterizeToFile(const QString& filename)
     if (!scene)
         return false;
 
+    bool success = rasterizeSceneToFile(scene, filename);
+
+    delete scene;
+
+    return success;
+}
+
+
+bool UBSvgSubsetRasterizer::rasterizeSceneToFile(UBGraphicsScene* scene, const QString& filename)
+{
     QRectF sceneRect = scene->normalizedSceneRect();
 
     qreal width = sceneRect.width();
@@ -78,9 +88,5 @@ bool UBSvgSubsetRasterizer::rasterizeToFile(const QString& filename)
     scene->setRenderingQuality(UBItem::RenderingQualityNormal);
     scene->setRenderingContext(UBGraphicsScene::Screen);
 
-    bool success = image.save(filename, "JPG", 100);
-
-    delete scene;
-
-    return success;
+    return image.save(filename, "JPG", 100);
 }
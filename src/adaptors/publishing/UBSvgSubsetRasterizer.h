@@ -19,6 +19,7 @@
 #include <QtGui>
 
 class UBDocumentProxy;
+class UBGraphicsScene;
 
 class UBSvgSubsetRasterizer : QObject
 {
@@ -30,6 +31,9 @@ class UBSvgSubsetRasterizer : QObject
 
         bool rasterizeToFile(const QString& filename);
 
+        // for a scene already loaded by the caller
+        static bool rasterizeSceneToFile(UBGraphicsScene* scene, const QString& filename);
+
     private:
         UBDocumentProxy* mDocument;
         int mPageIndex;
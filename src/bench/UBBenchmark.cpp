@@ -0,0 +1,662 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBBenchmark.h"
+
+#include <QtScript>
+
+#include "frameworks/UBFileSystemUtils.h"
+#include "frameworks/UBPlatformUtils.h"
+
+#include "core/UBApplication.h"
+#include "core/UBSettings.h"
+#include "core/UBPersistenceManager.h"
+#include "core/UBDocumentManager.h"
+
+#include "board/UBBoardController.h"
+#include "board/UBDrawingController.h"
+#include "board/UBInputTrace.h"
+
+#include "domain/UBGraphicsScene.h"
+
+#include "document/UBDocumentProxy.h"
+
+#include "adaptors/UBSvgSubsetAdaptor.h"
+#include "adaptors/UBThumbnailAdaptor.h"
+#include "adaptors/UBExportPDF.h"
+#include "adaptors/UBExportFullPDF.h"
+#include "adaptors/UBExportDocument.h"
+
+#include "pdf/XPDFRenderer.h"
+
+#include "core/memcheck.h"
+
+static const QString sBenchGroupName = "sankore-bench";
+
+UBBenchmark::UBBenchmark(const QStringList& pArguments, QObject *parent)
+    : QObject(parent)
+    , mArguments(pArguments)
+    , mIsValid(true)
+    , mIterations(5)
+    , mOutputPath("sankore-bench.json")
+    , mReplayAtRecordedSpeed(false)
+    , mTolerance(0.10)
+{
+    for (int i = 1; i < mArguments.size(); i++)
+    {
+        QString arg = mArguments.at(i);
+        bool hasValue = i + 1 < mArguments.size();
+
+        if (arg == "-output" && hasValue)
+            mOutputPath = mArguments.at(++i);
+        else if (arg == "-baseline" && hasValue)
+            mBaselinePath = mArguments.at(++i);
+        else if (arg == "-corpus" && hasValue)
+            mCorpusPath = mArguments.at(++i);
+        else if (arg == "-iterations" && hasValue)
+            mIterations = qMax(1, mArguments.at(++i).toInt());
+        else if (arg == "-tolerance" && hasValue)
+            mTolerance = mArguments.at(++i).toDouble();
+        else if (arg == "-replay" && hasValue)
+            mReplayPath = mArguments.at(++i);
+        else if (arg == "-replay-speed" && hasValue)
+            mReplayAtRecordedSpeed = mArguments.at(++i) == "recorded";
+        else
+            mIsValid = false;
+    }
+
+    mWorkPath = UBFileSystemUtils::createTempDir("sankore-bench");
+}
+
+
+UBBenchmark::~UBBenchmark()
+{
+    // NOOP
+}
+
+
+void UBBenchmark::usage(const QString& pProgName)
+{
+    qWarning() << "usage:" << pProgName << "[-output results.json] [-baseline previous.json] [-tolerance 0.10]"
+               << "[-iterations 5] [-corpus directoryOfUbzFiles] [-replay trace.ubtrace [-replay-speed max|recorded]]";
+    qWarning() << "input traces are recorded by running the application with -record-input trace.ubtrace";
+    qWarning() << "exit code is 0 when all measures are within tolerance of the baseline, 2 on regression";
+}
+
+
+void UBBenchmark::run()
+{
+    // stroke replay goes through the undo stack, keep it from growing across cases
+    UBApplication::undoStack->setUndoLimit(1);
+
+    generateCorpus();
+    importRealCorpus();
+
+    for (int i = 0; i < mCorpus.size(); i++)
+    {
+        QString corpusName = mCorpus.at(i).first;
+        UBDocumentProxy* proxy = mCorpus.at(i).second;
+
+        qDebug() << "benchmarking" << corpusName << "(" << proxy->pageCount() << "pages )";
+
+        benchPageSave(proxy, corpusName);
+        benchPageLoad(proxy, corpusName);
+        benchStrokeReplay(proxy, corpusName);
+        benchEraser(proxy, corpusName);
+        benchThumbnail(proxy, corpusName);
+        benchPdfRender(proxy, corpusName);
+        benchExport(proxy, corpusName);
+    }
+
+    if (mReplayPath.length() > 0)
+        benchInputReplay();
+
+    UBDrawingController::drawingController()->setStylusTool((int)UBStylusTool::Pen);
+
+    if (mBaselinePath.length() > 0)
+        compareToBaseline();
+
+    bool hasRegression = false;
+
+    foreach(const Measure& m, mMeasures)
+        hasRegression |= m.isRegression;
+
+    int exitCode = writeResults() ? (hasRegression ? 2 : 0) : 1;
+
+    for (int i = 0; i < mCorpus.size(); i++)
+    {
+        UBPersistenceManager::persistenceManager()->deleteDocument(mCorpus.at(i).second);
+    }
+
+    mCorpus.clear();
+
+    QCoreApplication::exit(exitCode);
+}
+
+
+void UBBenchmark::generateCorpus()
+{
+    mCorpus << qMakePair(QString("synthetic-ink"), createSyntheticDocument("synthetic-ink", 4, 400, false));
+    mCorpus << qMakePair(QString("synthetic-mixed"), createSyntheticDocument("synthetic-mixed", 4, 100, true));
+}
+
+
+void UBBenchmark::importRealCorpus()
+{
+    if (mCorpusPath.length() == 0)
+        return;
+
+    QDir corpusDir(mCorpusPath);
+
+    foreach(QString fileName, corpusDir.entryList(QStringList() << "*.ubz", QDir::Files, QDir::Name))
+    {
+        QFile file(corpusDir.filePath(fileName));
+
+        UBDocumentProxy* proxy = UBDocumentManager::documentManager()->importFile(file, sBenchGroupName);
+
+        if (proxy)
+            mCorpus << qMakePair(QFileInfo(fileName).completeBaseName(), proxy);
+        else
+            qWarning() << "failed to import corpus document" << file.fileName();
+    }
+}
+
+
+UBDocumentProxy* UBBenchmark::createSyntheticDocument(const QString& pName, int pPageCount, int pStrokeCount, bool pMixedContent)
+{
+    UBPersistenceManager* pm = UBPersistenceManager::persistenceManager();
+    UBDocumentProxy* proxy = pm->createDocument(sBenchGroupName, pName);
+
+    UBDrawingController::drawingController()->setStylusTool((int)UBStylusTool::Pen);
+
+    for (int pageIndex = 0; pageIndex < pPageCount; pageIndex++)
+    {
+        UBGraphicsScene* scene = pageIndex == 0 ? pm->loadDocumentScene(proxy, 0)
+                : pm->createDocumentSceneAt(proxy, pageIndex);
+
+        QSize nominal = scene->nominalSize();
+
+        for (int stroke = 0; stroke < pStrokeCount; stroke++)
+        {
+            QPointF origin((stroke * 37) % nominal.width() - nominal.width() / 2,
+                    (stroke * 53) % nominal.height() - nominal.height() / 2);
+
+            replayStroke(scene, origin, 40, pageIndex * pStrokeCount + stroke);
+        }
+
+        if (pMixedContent)
+        {
+            for (int i = 0; i < 20; i++)
+            {
+                scene->addText(QString("Lorem ipsum dolor sit amet, consectetur adipiscing elit %1").arg(i),
+                        QPointF(-nominal.width() / 2 + 20, -nominal.height() / 2 + i * 30));
+            }
+
+            for (int i = 0; i < 4; i++)
+            {
+                QImage image(800, 600, QImage::Format_RGB32);
+                QPainter painter(&image);
+                QLinearGradient gradient(0, 0, 800, 600);
+                gradient.setColorAt(0, QColor::fromHsv((pageIndex * 60 + i * 90) % 360, 200, 220));
+                gradient.setColorAt(1, Qt::white);
+                painter.fillRect(image.rect(), gradient);
+                painter.end();
+
+                scene->addPixmap(QPixmap::fromImage(image), QPointF(i * 100, i * 80));
+            }
+        }
+
+        scene->setModified(true);
+        pm->persistDocumentScene(proxy, scene, pageIndex);
+    }
+
+    UBApplication::undoStack->clear();
+
+    return proxy;
+}
+
+
+void UBBenchmark::replayStroke(UBGraphicsScene* pScene, const QPointF& pOrigin, int pPointCount, int pSeed)
+{
+    // deterministic wavy strokes so runs are comparable
+    qreal amplitude = 10 + (pSeed % 7) * 5;
+    qreal frequency = 0.1 + (pSeed % 5) * 0.05;
+
+    pScene->inputDevicePress(pOrigin, 1.0);
+
+    for (int i = 1; i < pPointCount; i++)
+    {
+        QPointF point(pOrigin.x() + i * 4, pOrigin.y() + amplitude * sin(i * frequency));
+        qreal pressure = 0.5 + 0.5 * qAbs(sin(i * frequency * 0.5));
+
+        pScene->inputDeviceMove(point, pressure);
+    }
+
+    pScene->inputDeviceRelease();
+}
+
+
+void UBBenchmark::benchPageSave(UBDocumentProxy* pProxy, const QString& pCorpus)
+{
+    Measure& m = measure("page.save", pCorpus);
+
+    for (int pageIndex = 0; pageIndex < pProxy->pageCount(); pageIndex++)
+    {
+        UBGraphicsScene* scene = UBPersistenceManager::persistenceManager()->loadDocumentScene(pProxy, pageIndex);
+
+        if (!scene)
+            continue;
+
+        for (int i = 0; i < mIterations; i++)
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            UBSvgSubsetAdaptor::persistScene(pProxy, scene, pageIndex);
+
+            m.samplesMs << timer.nsecsElapsed() / 1000000.0;
+        }
+    }
+}
+
+
+void UBBenchmark::benchPageLoad(UBDocumentProxy* pProxy, const QString& pCorpus)
+{
+    Measure& m = measure("page.load", pCorpus);
+
+    for (int pageIndex = 0; pageIndex < pProxy->pageCount(); pageIndex++)
+    {
+        for (int i = 0; i < mIterations; i++)
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            // bypass the scene cache on purpose, we want the parse cost
+            UBGraphicsScene* scene = UBSvgSubsetAdaptor::loadScene(pProxy, pageIndex);
+
+            m.samplesMs << timer.nsecsElapsed() / 1000000.0;
+
+            delete scene;
+        }
+    }
+}
+
+
+void UBBenchmark::benchStrokeReplay(UBDocumentProxy* pProxy, const QString& pCorpus)
+{
+    Measure& m = measure("stroke.replay", pCorpus);
+
+    UBDrawingController::drawingController()->setStylusTool((int)UBStylusTool::Pen);
+
+    UBGraphicsScene* scene = UBSvgSubsetAdaptor::loadScene(pProxy, 0);
+
+    if (!scene)
+        return;
+
+    for (int i = 0; i < mIterations * 10; i++)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        replayStroke(scene, QPointF(-200, -100 + i * 5), 100, i);
+
+        m.samplesMs << timer.nsecsElapsed() / 1000000.0;
+    }
+
+    UBApplication::undoStack->clear();
+
+    delete scene;
+}
+
+
+void UBBenchmark::benchEraser(UBDocumentProxy* pProxy, const QString& pCorpus)
+{
+    Measure& m = measure("eraser.sweep", pCorpus);
+
+    UBDrawingController::drawingController()->setStylusTool((int)UBStylusTool::Eraser);
+
+    for (int i = 0; i < mIterations; i++)
+    {
+        UBGraphicsScene* scene = UBSvgSubsetAdaptor::loadScene(pProxy, 0);
+
+        if (!scene)
+            break;
+
+        QSize nominal = scene->nominalSize();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        scene->inputDevicePress(QPointF(-nominal.width() / 2, 0), 1.0);
+
+        for (int x = -nominal.width() / 2; x < nominal.width() / 2; x += 8)
+        {
+            scene->inputDeviceMove(QPointF(x, 50 * sin(x / 40.0)), 1.0);
+        }
+
+        scene->inputDeviceRelease();
+
+        m.samplesMs << timer.nsecsElapsed() / 1000000.0;
+
+        UBApplication::undoStack->clear();
+
+        delete scene;
+    }
+
+    UBDrawingController::drawingController()->setStylusTool((int)UBStylusTool::Pen);
+}
+
+
+void UBBenchmark::benchThumbnail(UBDocumentProxy* pProxy, const QString& pCorpus)
+{
+    Measure& m = measure("thumbnail.generate", pCorpus);
+
+    for (int pageIndex = 0; pageIndex < pProxy->pageCount(); pageIndex++)
+    {
+        UBGraphicsScene* scene = UBPersistenceManager::persistenceManager()->loadDocumentScene(pProxy, pageIndex);
+
+        if (!scene)
+            continue;
+
+        for (int i = 0; i < mIterations; i++)
+        {
+            QElapsedTimer timer;
+            timer.start();
+
+            UBThumbnailAdaptor::persistScene(pProxy->persistencePath(), scene, pageIndex, true);
+
+            m.samplesMs << timer.nsecsElapsed() / 1000000.0;
+        }
+    }
+}
+
+
+void UBBenchmark::benchPdfRender(UBDocumentProxy* pProxy, const QString& pCorpus)
+{
+    Measure& m = measure("pdf.render", pCorpus);
+
+    QString pdfPath = mWorkPath + "/" + pCorpus + "-render.pdf";
+
+    UBExportPDF::persistsDocument(pProxy, pdfPath);
+
+    XPDFRenderer renderer(pdfPath);
+
+    if (!renderer.isValid())
+    {
+        qWarning() << "cannot open generated PDF" << pdfPath;
+        return;
+    }
+
+    for (int pageNumber = 1; pageNumber <= renderer.pageCount(); pageNumber++)
+    {
+        QSizeF pageSize = renderer.pageSizeF(pageNumber);
+
+        for (int i = 0; i < mIterations; i++)
+        {
+            QImage image(pageSize.toSize() * 2, QImage::Format_ARGB32);
+            image.fill(Qt::white);
+
+            QElapsedTimer timer;
+            timer.start();
+
+            QPainter painter(&image);
+            painter.scale(2, 2);
+            renderer.render(&painter, pageNumber);
+            painter.end();
+
+            m.samplesMs << timer.nsecsElapsed() / 1000000.0;
+        }
+    }
+}
+
+
+void UBBenchmark::benchExport(UBDocumentProxy* pProxy, const QString& pCorpus)
+{
+    Measure& pdf = measure("export.pdf", pCorpus);
+    Measure& fullPdf = measure("export.fullpdf", pCorpus);
+    Measure& ubz = measure("export.ubz", pCorpus);
+
+    UBExportFullPDF fullPdfExporter;
+    UBExportDocument ubzExporter;
+
+    for (int i = 0; i < mIterations; i++)
+    {
+        QElapsedTimer timer;
+
+        timer.start();
+        UBExportPDF::persistsDocument(pProxy, mWorkPath + "/" + pCorpus + ".pdf");
+        pdf.samplesMs << timer.nsecsElapsed() / 1000000.0;
+
+        timer.restart();
+        fullPdfExporter.persistsDocument(pProxy, mWorkPath + "/" + pCorpus + "-full.pdf");
+        fullPdf.samplesMs << timer.nsecsElapsed() / 1000000.0;
+
+        timer.restart();
+        ubzExporter.persistsDocument(pProxy, mWorkPath + "/" + pCorpus + ".ubz");
+        ubz.samplesMs << timer.nsecsElapsed() / 1000000.0;
+    }
+}
+
+
+void UBBenchmark::benchInputReplay()
+{
+    UBInputTracePlayer player;
+
+    if (!player.load(mReplayPath))
+        return;
+
+    QString corpusName = QFileInfo(mReplayPath).completeBaseName();
+
+    UBDocumentProxy* proxy = UBPersistenceManager::persistenceManager()->createDocument(sBenchGroupName, corpusName);
+    mCorpus << qMakePair(corpusName, proxy);
+
+    UBGraphicsScene* scene = UBPersistenceManager::persistenceManager()->loadDocumentScene(proxy, 0);
+
+    player.replay(scene, mReplayAtRecordedSpeed);
+
+    UBApplication::undoStack->clear();
+
+    Measure& m = measure("input.replay", corpusName);
+    m.samplesMs = player.processingTimesMs();
+
+    QStringList buckets;
+
+    foreach(int count, player.histogram())
+        buckets << QString::number(count);
+
+    m.extraJsonMembers << QString("\"speed\": \"%1\"").arg(mReplayAtRecordedSpeed ? "recorded" : "max");
+    m.extraJsonMembers << QString("\"p50_ms\": %1").arg(player.percentileMs(0.5), 0, 'f', 3);
+    m.extraJsonMembers << QString("\"p99_ms\": %1").arg(player.percentileMs(0.99), 0, 'f', 3);
+    m.extraJsonMembers << QString("\"histogram_log2_us\": [%1]").arg(buckets.join(", "));
+    m.extraJsonMembers << QString("\"items_before\": %1").arg(player.itemCountBefore());
+    m.extraJsonMembers << QString("\"items_after\": %1").arg(player.itemCountAfter());
+    m.extraJsonMembers << QString("\"rss_before_bytes\": %1").arg(player.residentMemoryBefore());
+    m.extraJsonMembers << QString("\"rss_after_bytes\": %1").arg(player.residentMemoryAfter());
+}
+
+
+UBBenchmark::Measure& UBBenchmark::measure(const QString& pName, const QString& pCorpus)
+{
+    for (int i = 0; i < mMeasures.size(); i++)
+    {
+        if (mMeasures.at(i).name == pName && mMeasures.at(i).corpus == pCorpus)
+            return mMeasures[i];
+    }
+
+    Measure m;
+    m.name = pName;
+    m.corpus = pCorpus;
+    mMeasures << m;
+
+    return mMeasures.last();
+}
+
+
+void UBBenchmark::compareToBaseline()
+{
+    QString json = UBFileSystemUtils::readTextFile(mBaselinePath);
+
+    if (json.length() == 0)
+    {
+        qWarning() << "cannot read baseline" << mBaselinePath;
+        return;
+    }
+
+    // Qt 4 has no JSON parser, the script engine evaluates our own output just fine
+    QScriptEngine engine;
+    QScriptValue baseline = engine.evaluate("(" + json + ")");
+
+    if (engine.hasUncaughtException())
+    {
+        qWarning() << "invalid baseline" << mBaselinePath << engine.uncaughtException().toString();
+        return;
+    }
+
+    QScriptValue results = baseline.property("results");
+    int count = results.property("length").toInt32();
+
+    for (int i = 0; i < count; i++)
+    {
+        QScriptValue entry = results.property(i);
+        QString name = entry.property("name").toString();
+        QString corpus = entry.property("corpus").toString();
+        qreal baselineMedian = entry.property("median_ms").toNumber();
+
+        for (int j = 0; j < mMeasures.size(); j++)
+        {
+            Measure& m = mMeasures[j];
+
+            if (m.name == name && m.corpus == corpus && m.samplesMs.size() > 0)
+            {
+                m.baselineMedianMs = baselineMedian;
+                m.isRegression = m.percentileMs(0.5) > baselineMedian * (1.0 + mTolerance);
+
+                if (m.isRegression)
+                {
+                    qWarning() << "regression:" << name << corpus << "median" << m.percentileMs(0.5)
+                               << "ms, baseline" << baselineMedian << "ms";
+                }
+            }
+        }
+    }
+}
+
+
+bool UBBenchmark::writeResults()
+{
+    QFile file(mOutputPath);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        qWarning() << "cannot write results to" << mOutputPath;
+        return false;
+    }
+
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+    out.setRealNumberNotation(QTextStream::FixedNotation);
+    out.setRealNumberPrecision(3);
+
+    out << "{\n";
+    out << "  \"suite\": \"sankore-bench\",\n";
+    out << "  \"version\": \"" << QCoreApplication::applicationVersion() << "\",\n";
+    out << "  \"timestamp\": \"" << QDateTime::currentDateTime().toUTC().toString(Qt::ISODate) << "\",\n";
+    out << "  \"iterations\": " << mIterations << ",\n";
+    out << "  \"tolerance\": " << mTolerance << ",\n";
+    out << "  \"results\": [\n";
+
+    for (int i = 0; i < mMeasures.size(); i++)
+    {
+        const Measure& m = mMeasures.at(i);
+
+        out << "    { \"name\": \"" << m.name << "\", \"corpus\": \"" << m.corpus << "\""
+            << ", \"samples\": " << m.samplesMs.size()
+            << ", \"min_ms\": " << m.minMs()
+            << ", \"median_ms\": " << m.percentileMs(0.5)
+            << ", \"mean_ms\": " << m.meanMs()
+            << ", \"p95_ms\": " << m.percentileMs(0.95)
+            << ", \"max_ms\": " << m.maxMs();
+
+        foreach(QString member, m.extraJsonMembers)
+            out << ", " << member;
+
+        if (m.baselineMedianMs >= 0)
+        {
+            out << ", \"baseline_median_ms\": " << m.baselineMedianMs
+                << ", \"regression\": " << (m.isRegression ? "true" : "false");
+        }
+
+        out << " }" << (i < mMeasures.size() - 1 ? "," : "") << "\n";
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+
+    file.close();
+
+    qDebug() << "benchmark results written to" << QFileInfo(mOutputPath).absoluteFilePath();
+
+    return true;
+}
+
+
+qreal UBBenchmark::Measure::minMs() const
+{
+    qreal result = samplesMs.isEmpty() ? 0 : samplesMs.first();
+
+    foreach(qreal sample, samplesMs)
+        result = qMin(result, sample);
+
+    return result;
+}
+
+
+qreal UBBenchmark::Measure::maxMs() const
+{
+    qreal result = 0;
+
+    foreach(qreal sample, samplesMs)
+        result = qMax(result, sample);
+
+    return result;
+}
+
+
+qreal UBBenchmark::Measure::meanMs() const
+{
+    if (samplesMs.isEmpty())
+        return 0;
+
+    qreal sum = 0;
+
+    foreach(qreal sample, samplesMs)
+        sum += sample;
+
+    return sum / samplesMs.size();
+}
+
+
+qreal UBBenchmark::Measure::percentileMs(qreal pPercentile) const
+{
+    if (samplesMs.isEmpty())
+        return 0;
+
+    QList<qreal> sorted = samplesMs;
+    qSort(sorted);
+
+    int index = qBound(0, (int)(pPercentile * (sorted.size() - 1) + 0.5), sorted.size() - 1);
+
+    return sorted.at(index);
+}
@@ -0,0 +1,118 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBBENCHMARK_H_
+#define UBBENCHMARK_H_
+
+#include <QtGui>
+
+class UBDocumentProxy;
+class UBGraphicsScene;
+
+/**
+ * Headless benchmark suite for the board engine.
+ *
+ * Runs inside a fully initialized UBApplication (the controllers are needed by
+ * UBGraphicsScene) against a corpus of synthetic documents generated on the fly
+ * plus any .ubz lessons found in the corpus directory. Results are written as JSON
+ * and optionally compared against a previous run used as a baseline.
+ */
+class UBBenchmark : public QObject
+{
+    Q_OBJECT;
+
+    public:
+
+        UBBenchmark(const QStringList& pArguments, QObject *parent = 0);
+        virtual ~UBBenchmark();
+
+        static void usage(const QString& pProgName);
+
+        bool isValid() const
+        {
+            return mIsValid;
+        }
+
+    public slots:
+
+        void run();
+
+    private:
+
+        class Measure
+        {
+            public:
+
+                Measure()
+                    : baselineMedianMs(-1)
+                    , isRegression(false)
+                {
+                    // NOOP
+                }
+
+                QString name;
+                QString corpus;
+                QList<qreal> samplesMs;
+
+                qreal baselineMedianMs;
+                bool isRegression;
+
+                // additional JSON members written as is, e.g. "\"histogram\": [...]"
+                QStringList extraJsonMembers;
+
+                qreal minMs() const;
+                qreal maxMs() const;
+                qreal meanMs() const;
+                qreal percentileMs(qreal pPercentile) const;
+        };
+
+        void generateCorpus();
+        void importRealCorpus();
+
+        UBDocumentProxy* createSyntheticDocument(const QString& pName, int pPageCount, int pStrokeCount, bool pMixedContent);
+
+        void replayStroke(UBGraphicsScene* pScene, const QPointF& pOrigin, int pPointCount, int pSeed);
+
+        void benchPageSave(UBDocumentProxy* pProxy, const QString& pCorpus);
+        void benchPageLoad(UBDocumentProxy* pProxy, const QString& pCorpus);
+        void benchStrokeReplay(UBDocumentProxy* pProxy, const QString& pCorpus);
+        void benchEraser(UBDocumentProxy* pProxy, const QString& pCorpus);
+        void benchThumbnail(UBDocumentProxy* pProxy, const QString& pCorpus);
+        void benchPdfRender(UBDocumentProxy* pProxy, const QString& pCorpus);
+        void benchExport(UBDocumentProxy* pProxy, const QString& pCorpus);
+        void benchInputReplay();
+
+        Measure& measure(const QString& pName, const QString& pCorpus);
+
+        void compareToBaseline();
+        bool writeResults();
+
+        QStringList mArguments;
+        bool mIsValid;
+
+        int mIterations;
+        QString mOutputPath;
+        QString mBaselinePath;
+        QString mCorpusPath;
+        QString mWorkPath;
+        QString mReplayPath;
+        bool mReplayAtRecordedSpeed;
+        qreal mTolerance;
+
+        QList<QPair<QString, UBDocumentProxy*> > mCorpus;
+        QList<Measure> mMeasures;
+};
+
+#endif /* UBBENCHMARK_H_ */
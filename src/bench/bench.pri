@@ -0,0 +1,5 @@
+
+HEADERS      += src/bench/UBBenchmark.h
+
+SOURCES      += src/bench/main.cpp \
+                src/bench/UBBenchmark.cpp
@@ -0,0 +1,69 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QtGui>
+#include <QTextCodec>
+
+#include "frameworks/UBFileSystemUtils.h"
+
+#include "core/UBApplication.h"
+
+#include "UBBenchmark.h"
+
+/*
+ * Entry point of the sankore-bench target (qmake "CONFIG+=bench").
+ *
+ * Meant to be run offscreen, e.g. "xvfb-run -a ./sankore-bench -output results.json".
+ * The whole data directory is redirected to a scratch location so the benchmark
+ * never touches the user's document library or settings.
+ */
+int main(int argc, char *argv[])
+{
+    Q_INIT_RESOURCE(sankore);
+
+    QString sandbox = QDir::tempPath() + "/sankore-bench-" + QString::number(QDateTime::currentDateTime().toTime_t());
+    QDir().mkpath(sandbox);
+
+    qputenv("HOME", QFile::encodeName(sandbox));
+    qputenv("XDG_DATA_HOME", QFile::encodeName(sandbox + "/data"));
+    qputenv("XDG_CONFIG_HOME", QFile::encodeName(sandbox + "/config"));
+
+#if defined(Q_WS_X11)
+    QApplication::setGraphicsSystem("raster");
+#endif
+
+    UBApplication app("Sankore 3.1 Benchmark", argc, argv);
+
+    QTextCodec::setCodecForTr(QTextCodec::codecForName("UTF-8"));
+    QTextCodec::setCodecForCStrings(QTextCodec::codecForName("UTF-8"));
+
+    UBBenchmark benchmark(app.arguments());
+
+    if (!benchmark.isValid())
+    {
+        UBBenchmark::usage(app.arguments().at(0));
+        return 1;
+    }
+
+    // the suite needs the board controllers, run it once the application is up
+    QTimer::singleShot(0, &benchmark, SLOT(run()));
+
+    int result = app.exec(QString());
+
+    app.cleanup();
+
+    UBFileSystemUtils::deleteDir(sandbox);
+
+    return result;
+}
@@ -64,6 +64,8 @@
 
 #include "UBBoardPaletteManager.h"
 
+#include "frameworks/UBTrace.h"
+
 #include "core/memcheck.h"
 
 UBBoardController::UBBoardController(UBMainWindow* mainWindow)
@@ -1424,6 +1426,8 @@ void UBBoardController::show()
 
 void UBBoardController::persistCurrentScene()
 {
+    UB_TRACE_SCOPE("board.persistCurrentScene", "autosave");
+
     if(UBPersistenceManager::persistenceManager()
             && mActiveDocument && mActiveScene
             && (mActiveSceneIndex >= 0))
@@ -1705,7 +1709,7 @@ void UBBoardController::cut()
     {
         QClipboard *clipboard = QApplication::clipboard();
 
-        UBMimeDataGraphicsItem*  mimeGi = new UBMimeDataGraphicsItem(selected);
+        UBMimeDataGraphicsItem*  mimeGi = new UBMimeDataGraphicsItem(selected, mActiveDocument->persistencePath());
 
         mimeGi->setData(UBApplication::mimeTypeUniboardPageItem, QByteArray());
         clipboard->setMimeData(mimeGi);
@@ -1731,7 +1735,7 @@ void UBBoardController::copy()
     {
         QClipboard *clipboard = QApplication::clipboard();
 
-        UBMimeDataGraphicsItem*  mimeGi = new UBMimeDataGraphicsItem(selected);
+        UBMimeDataGraphicsItem*  mimeGi = new UBMimeDataGraphicsItem(selected, mActiveDocument->persistencePath());
 
         mimeGi->setData(UBApplication::mimeTypeUniboardPageItem, QByteArray());
         clipboard->setMimeData(mimeGi);
@@ -1785,6 +1789,8 @@ void UBBoardController::processMimeData(const QMimeData* pMimeData, const QPoint
 
                 if (gi)
                 {
+                    importItemFiles(gi, mimeData->sourceDocumentPath());
+
                     gi->setZValue(mActiveScene->getNextObjectZIndex());
                     mActiveScene->addItem(gi);
                     gi->setPos(gi->pos() + QPointF(50, 50));
@@ -1830,6 +1836,36 @@ void UBBoardController::processMimeData(const QMimeData* pMimeData, const QPoint
 }
 
 
+void UBBoardController::importItemFiles(QGraphicsItem* pItem, const QString& pSourceDocumentPath)
+{
+    if (pSourceDocumentPath.isEmpty() || pSourceDocumentPath == mActiveDocument->persistencePath())
+        return;
+
+    QString relativePath;
+
+    UBGraphicsPixmapItem* pixmapItem = qgraphicsitem_cast<UBGraphicsPixmapItem*>(pItem);
+    UBGraphicsMediaItem* mediaItem = dynamic_cast<UBGraphicsMediaItem*>(pItem);
+
+    if (pixmapItem)
+        relativePath = UBPersistenceManager::imageDirectory + "/" + pixmapItem->uuid().toString() + ".png";
+    else if (mediaItem && mediaItem->mediaFileUrl().isRelative())
+        relativePath = mediaItem->mediaFileUrl().toLocalFile();
+
+    if (relativePath.isEmpty())
+        return;
+
+    QString sourceFile = pSourceDocumentPath + "/" + relativePath;
+    QString targetFile = mActiveDocument->persistencePath() + "/" + relativePath;
+
+    // pasted in another document, the encoded file is copied as is rather than encoding the item again on save
+    if (QFile::exists(sourceFile) && !QFile::exists(targetFile))
+    {
+        QDir().mkpath(QFileInfo(targetFile).absolutePath());
+        QFile::copy(sourceFile, targetFile);
+    }
+}
+
+
 void UBBoardController::togglePodcast(bool checked)
 {
     if (UBPodcastController::instance())
@@ -268,6 +268,8 @@ class UBBoardController : public QObject
 
         QString truncate(QString text, int maxWidth);
 
+        void importItemFiles(QGraphicsItem* pItem, const QString& pSourceDocumentPath);
+
     protected slots:
 
         void selectionChanged();
@@ -489,17 +489,11 @@ void UBBoardPaletteManager::addItem(const QUrl& pUrl)
 {
     mItemUrl = pUrl;
     mPixmap = QPixmap();
+    clearBandFiles();
     mPos = QPointF(0, 0);
     mScaleFactor = 1.;
 
-    mAddItemPalette->show();
-    mAddItemPalette->adjustSizeAndPosition();
-
-    QRect controlGeo = UBApplication::applicationController->displayManager()->controlGeometry();
-
-    mAddItemPalette->move(controlGeo.x() + ((controlGeo.width() - mAddItemPalette->geometry().width()) / 2),
-          (controlGeo.y() + (controlGeo.height() - mAddItemPalette->geometry().height()) / 5));
-
+    showAddItemPalette();
 }
 
 
@@ -507,10 +501,30 @@ void UBBoardPaletteManager::addItem(const QPixmap& pPixmap, const QPointF& pos,
 {
     mItemUrl = sourceUrl;
     mPixmap = pPixmap;
+    clearBandFiles();
     mPos = pos;
     mScaleFactor = scaleFactor;
 
-     QRect controlGeo = UBApplication::applicationController->displayManager()->controlGeometry();
+    showAddItemPalette();
+}
+
+
+void UBBoardPaletteManager::addItem(const QStringList& pBandFiles, const QPointF& pTop, qreal scaleFactor, const QUrl& sourceUrl)
+{
+    mItemUrl = sourceUrl;
+    mPixmap = QPixmap();
+    clearBandFiles();
+    mBandFiles = pBandFiles;
+    mPos = pTop;
+    mScaleFactor = scaleFactor;
+
+    showAddItemPalette();
+}
+
+
+void UBBoardPaletteManager::showAddItemPalette()
+{
+    QRect controlGeo = UBApplication::applicationController->displayManager()->controlGeometry();
 
     mAddItemPalette->show();
     mAddItemPalette->adjustSizeAndPosition();
@@ -520,11 +534,62 @@ void UBBoardPaletteManager::addItem(const QPixmap& pPixmap, const QPointF& pos,
 }
 
 
+void UBBoardPaletteManager::clearBandFiles()
+{
+    foreach(QString bandFile, mBandFiles)
+        QFile::remove(bandFile);
+
+    mBandFiles.clear();
+}
+
+
+// read from the header of the file, the band is not loaded
+qreal UBBoardPaletteManager::bandHeight(int pIndex) const
+{
+    return QImageReader(mBandFiles.at(pIndex)).size().height() * mScaleFactor;
+}
+
+
+// the bands are loaded one at a time and left selected, so that the user moves or resizes the capture as a whole
+void UBBoardPaletteManager::addBandsToActiveScene(int pFrom, int pTo, const QPointF& pTop)
+{
+    UBGraphicsScene* scene = UBApplication::boardController->activeScene();
+    qreal top = pTop.y();
+
+    scene->clearSelection();
+
+    for (int i = pFrom; i < pTo; i++)
+    {
+        QPixmap band(mBandFiles.at(i));
+        QFile::remove(mBandFiles.at(i));
+
+        if (band.isNull())
+            continue;
+
+        qreal height = band.height() * mScaleFactor;
+
+        UBGraphicsPixmapItem* item = scene->addPixmap(band, QPointF(pTop.x(), top + height / 2), mScaleFactor);
+
+        item->setSourceUrl(mItemUrl);
+        item->setSelected(true);
+
+        top += height;
+    }
+}
+
+
 void UBBoardPaletteManager::addItemToCurrentPage()
 {
     UBApplication::applicationController->showBoard();
     mAddItemPalette->hide();
-    if(mPixmap.isNull())
+    if(!mBandFiles.isEmpty())
+    {
+        addBandsToActiveScene(0, mBandFiles.size(), mPos);
+        mBandFiles.clear();
+
+        UBDrawingController::drawingController()->setStylusTool(UBStylusTool::Selector);
+    }
+    else if(mPixmap.isNull())
         UBApplication::boardController->downloadURL(mItemUrl);
     else
     {
@@ -540,6 +605,39 @@ void UBBoardPaletteManager::addItemToCurrentPage()
 
 void UBBoardPaletteManager::addItemToNewPage()
 {
+    if(!mBandFiles.isEmpty())
+    {
+        UBApplication::applicationController->showBoard();
+        mAddItemPalette->hide();
+
+        int from = 0;
+
+        // one page per screenful of bands, the first band of a page may be higher than the page
+        while(from < mBandFiles.size())
+        {
+            UBApplication::boardController->addScene();
+
+            qreal pageHeight = UBApplication::boardController->activeScene()->nominalSize().height();
+            qreal height = bandHeight(from);
+            int to = from + 1;
+
+            while(to < mBandFiles.size() && height + bandHeight(to) <= pageHeight)
+            {
+                height += bandHeight(to);
+                to++;
+            }
+
+            addBandsToActiveScene(from, to, QPointF(mPos.x(), pageHeight / -2));
+
+            from = to;
+        }
+
+        mBandFiles.clear();
+
+        UBDrawingController::drawingController()->setStylusTool(UBStylusTool::Selector);
+        return;
+    }
+
     UBApplication::boardController->addScene();
     addItemToCurrentPage();
 }
@@ -547,6 +645,28 @@ void UBBoardPaletteManager::addItemToNewPage()
 
 void UBBoardPaletteManager::addItemToLibrary()
 {
+    if(!mBandFiles.isEmpty())
+    {
+        // one library image per band, a single band is loaded at a time and the page is never assembled
+        foreach(QString bandFile, mBandFiles)
+        {
+            QImage band(bandFile);
+            QFile::remove(bandFile);
+
+            if (band.isNull())
+                continue;
+
+            QImage image = band.scaled(qRound(band.width() * mScaleFactor), qRound(band.height() * mScaleFactor)
+                    , Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+            mRightPalette->libWidget()->libNavigator()->libraryWidget()->libraryController()->importImageOnLibrary(image);
+        }
+
+        mBandFiles.clear();
+        mAddItemPalette->hide();
+        return;
+    }
+
     if(mPixmap.isNull())
     {
        mPixmap = QPixmap(mItemUrl.toLocalFile());
@@ -55,12 +55,18 @@ class UBBoardPaletteManager : public QObject
         void containerResized();
         void addItem(const QUrl& pUrl);
         void addItem(const QPixmap& pPixmap, const QPointF& p = QPointF(0.0, 0.0), qreal scale = 1.0, const QUrl& sourceUrl = QUrl());
+        // the band files of a captured web page, stacked down from pTop, removed once added
+        void addItem(const QStringList& pBandFiles, const QPointF& pTop, qreal scale, const QUrl& sourceUrl = QUrl());
 
     private:
 
         void setupPalettes();
         void connectPalettes();
         void positionFreeDisplayPalette();
+        void showAddItemPalette();
+        void clearBandFiles();
+        qreal bandHeight(int pIndex) const;
+        void addBandsToActiveScene(int pFrom, int pTo, const QPointF& pTop);
 
         QWidget* mContainer;
         UBBoardController *mBoardControler;
@@ -80,6 +86,7 @@ class UBBoardPaletteManager : public QObject
 
         QUrl mItemUrl;
         QPixmap mPixmap;
+        QStringList mBandFiles;
         QPointF mPos;
         qreal mScaleFactor;
 
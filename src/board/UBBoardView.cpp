@@ -21,6 +21,7 @@
 #include "UBDrawingController.h"
 
 #include "frameworks/UBGeometryUtils.h"
+#include "frameworks/UBTrace.h"
 
 #include "core/UBSettings.h"
 #include "core/UBMimeData.h"
@@ -37,6 +38,7 @@
 #include "gui/UBMainWindow.h"
 
 #include "board/UBBoardController.h"
+#include "board/UBInputTrace.h"
 
 #include "domain/UBGraphicsTextItem.h"
 #include "domain/UBGraphicsPixmapItem.h"
@@ -77,6 +79,52 @@ UBBoardView::~UBBoardView () {
   //NOOP
 }
 
+QBrush
+UBBoardView::crossBrush (const QColor& pColor)
+{
+  // smaller tiles cost more fill calls than they save memory
+  static const int minTileSize = 128;
+
+  // zoom levels closer than that share the tile
+  qreal scale = qRound (transform ().m11 () * 1000) / 1000.0;
+
+  int cells = qMax (1, qCeil (minTileSize / (UBSettings::crossSize * scale)));
+  qreal tileSceneSize = cells * UBSettings::crossSize;
+  int tileSize = qMax (cells, qRound (tileSceneSize * scale));
+
+  if (mCrossTile.isNull () || mCrossTileScale != scale || mCrossTileColor != pColor)
+    {
+      UB_TRACE_SCOPE ("board.background.tile", "render");
+
+      mCrossTile = QPixmap (tileSize, tileSize);
+      mCrossTile.fill (Qt::transparent);
+
+      QPainter tilePainter (&mCrossTile);
+      tilePainter.setPen (pColor);
+
+      for (int i = 0; i < cells; i++)
+        {
+          int pos = qRound ((qreal) i * tileSize / cells);
+          tilePainter.drawLine (0, pos, tileSize, pos);
+        }
+
+      for (int i = 0; i < cells; i++)
+        {
+          int pos = qRound ((qreal) i * tileSize / cells);
+          tilePainter.drawLine (pos, 0, pos, tileSize);
+        }
+
+      mCrossTileScale = scale;
+      mCrossTileColor = pColor;
+    }
+
+  // one tile pixel per device pixel once the view transform is applied
+  QBrush brush (mCrossTile);
+  brush.setTransform (QTransform::fromScale (tileSceneSize / tileSize, tileSceneSize / tileSize));
+
+  return brush;
+}
+
 void
 UBBoardView::init ()
 {
@@ -98,6 +146,8 @@ UBBoardView::init ()
 
   setOptimizationFlag (QGraphicsView::IndirectPainting); // enable UBBoardView::drawItems filter
 
+  mCrossTileScale = 0;
+
   mTabletStylusIsPressed = false;
   mMouseButtonIsPressed = false;
   mPendingStylusReleaseEvent = false;
@@ -110,6 +160,14 @@ UBBoardView::init ()
 
   mVirtualKeyboardActive = false;
 
+  mHudVisible = false;
+  mHudTimer = 0;
+  mHudInputEvents = 0;
+  mHudFrames = 0;
+  mFrameTimeUs = 0;
+  mFramesPerSecond = 0;
+  mEventsPerSecond = 0;
+
   settingChanged (QVariant ());
 
   unsetCursor();
@@ -135,6 +193,111 @@ UBBoardView::showEvent (QShowEvent * event)
   emit shown ();
 }
 
+void
+UBBoardView::paintEvent (QPaintEvent * event)
+{
+  UB_TRACE_SCOPE ("view.paint", "paint");
+
+  if (!mHudVisible)
+    {
+      QGraphicsView::paintEvent (event);
+      return;
+    }
+
+  QElapsedTimer frameClock;
+  frameClock.start ();
+
+  QGraphicsView::paintEvent (event);
+
+  // the periodic HUD refreshes are not frames of the board
+  if (event->rect () != hudRect ())
+    {
+      mFrameTimeUs = frameClock.nsecsElapsed () / 1000;
+      mHudFrames++;
+    }
+
+  drawHud ();
+}
+
+void
+UBBoardView::toggleHud ()
+{
+  mHudVisible = !mHudVisible;
+
+  if (!mHudTimer)
+    {
+      mHudTimer = new QTimer (this);
+      mHudTimer->setInterval (500);
+      connect (mHudTimer, SIGNAL (timeout ()), this, SLOT (updateHud ()));
+    }
+
+  // counters are only maintained while tracing is enabled
+  UBTrace::trace ()->setLive (mHudVisible);
+
+  if (mHudVisible)
+    {
+      mHudInputEvents = UBTrace::trace ()->counter ("input.events");
+      mHudFrames = 0;
+      mHudClock.start ();
+      mHudTimer->start ();
+    }
+  else
+    {
+      mHudTimer->stop ();
+    }
+
+  viewport ()->update ();
+}
+
+QRect
+UBBoardView::hudRect () const
+{
+  return QRect (10, 10, 240, 90);
+}
+
+void
+UBBoardView::updateHud ()
+{
+  qreal elapsedS = mHudClock.nsecsElapsed () / 1000000000.0;
+
+  if (elapsedS <= 0)
+    return;
+
+  qint64 inputEvents = UBTrace::trace ()->counter ("input.events");
+
+  mEventsPerSecond = (inputEvents - mHudInputEvents) / elapsedS;
+  mFramesPerSecond = mHudFrames / elapsedS;
+
+  mHudInputEvents = inputEvents;
+  mHudFrames = 0;
+  mHudClock.restart ();
+
+  viewport ()->update (hudRect ());
+}
+
+void
+UBBoardView::drawHud ()
+{
+  QStringList lines;
+
+  lines << tr ("frame: %1 ms (%2 fps)").arg (mFrameTimeUs / 1000.0, 0, 'f', 1).arg (mFramesPerSecond, 0, 'f', 0);
+  lines << tr ("input: %1 events/s").arg (mEventsPerSecond, 0, 'f', 0);
+
+  if (scene ())
+    lines << tr ("items: %1").arg (scene ()->fastAccessItemCount ());
+
+  lines << tr ("scene cache: %1 hits, %2 misses")
+      .arg (UBTrace::trace ()->counter ("sceneCache.hits"))
+      .arg (UBTrace::trace ()->counter ("sceneCache.misses"));
+
+  QPainter painter (viewport ());
+  QRect rect = hudRect ();
+
+  painter.fillRect (rect, QColor (0, 0, 0, 160));
+  painter.setPen (Qt::white);
+  painter.drawText (rect.adjusted (8, 6, -8, -6), Qt::AlignLeft | Qt::AlignTop, lines.join ("\n"));
+}
+
 void
 UBBoardView::keyPressEvent (QKeyEvent *event)
 {
@@ -228,6 +391,12 @@ UBBoardView::keyPressEvent (QKeyEvent *event)
                 event->accept ();
                 break;
               }
+            case Qt::Key_F12:
+              {
+                toggleHud ();
+                event->accept ();
+                break;
+              }
             default:
               {
                 // NOOP
@@ -323,6 +492,8 @@ UBBoardView::tabletEvent (QTabletEvent * event)
 
   bool acceptEvent = true;
 
+  UBInputTraceRecorder::recorder ()->setDevice (UBInputTraceEvent::Tablet);
+
   switch (event->type ())
     {
     case QEvent::TabletPress:
@@ -471,6 +642,7 @@ UBBoardView::mousePressEvent (QMouseEvent *event)
 
                 if (scene () && !mTabletStylusIsPressed)
                 {
+                        UBInputTraceRecorder::recorder ()->setDevice (UBInputTraceEvent::Mouse);
                         scene ()->inputDevicePress (mapToScene (UBGeometryUtils::pointConstrainedInRect (event->pos (), rect ())));
                 }
                 event->accept ();
@@ -760,19 +932,11 @@ UBBoardView::drawBackground (QPainter *painter, const QRectF &rect)
 
       if (scene () && scene ()->isCrossedBackground ())
         {
-          qreal firstY = ((int) (rect.y () / UBSettings::crossSize)) * UBSettings::crossSize;
-
-          for (qreal yPos = firstY; yPos < rect.y () + rect.height (); yPos += UBSettings::crossSize)
-            {
-              painter->drawLine (rect.x (), yPos, rect.x () + rect.width (), yPos);
-            }
-
-          qreal firstX = ((int) (rect.x () / UBSettings::crossSize)) * UBSettings::crossSize;
-
-          for (qreal xPos = firstX; xPos < rect.x () + rect.width (); xPos += UBSettings::crossSize)
-            {
-              painter->drawLine (xPos, rect.y (), xPos, rect.y () + rect.height ());
-            }
+          // the tile is anchored on the scene origin, like the lines it replaces
+          bool smooth = painter->testRenderHint (QPainter::SmoothPixmapTransform);
+          painter->setRenderHint (QPainter::SmoothPixmapTransform, false);
+          painter->fillRect (rect, crossBrush (bgCrossColor));
+          painter->setRenderHint (QPainter::SmoothPixmapTransform, smooth);
         }
     }
 
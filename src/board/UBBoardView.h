@@ -75,10 +75,18 @@ class UBBoardView : public QGraphicsView
         virtual void showEvent(QShowEvent * event);
         virtual void hideEvent(QHideEvent * event);
 
+        virtual void paintEvent(QPaintEvent * event);
+
     private:
 
         void init();
 
+        QBrush crossBrush(const QColor& pColor);
+
+        void toggleHud();
+        QRect hudRect() const;
+        void drawHud();
+
         inline bool shouldDisplayItem(QGraphicsItem *item)
         {
             bool ok;
@@ -111,12 +119,29 @@ class UBBoardView : public QGraphicsView
 
         bool isAbsurdPoint(QPoint point);
 
+        // a few cells of the crossed background, rasterized at the current zoom and tiled by drawBackground
+        QPixmap mCrossTile;
+        qreal mCrossTileScale;
+        QColor mCrossTileColor;
+
 		bool mVirtualKeyboardActive;
 
+        // performance HUD, toggled with Ctrl+F12
+        bool mHudVisible;
+        QTimer* mHudTimer;
+        QElapsedTimer mHudClock;
+        qint64 mHudInputEvents;
+        int mHudFrames;
+        qint64 mFrameTimeUs;
+        qreal mFramesPerSecond;
+        qreal mEventsPerSecond;
+
     private slots:
 
         void settingChanged(QVariant newValue);
 
+        void updateHud();
+
 	public slots:
 
 		void virtualKeyboardActivated(bool b);
@@ -0,0 +1,298 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBInputTrace.h"
+
+#include "UBDrawingController.h"
+
+#include "domain/UBGraphicsScene.h"
+
+#if defined(Q_WS_X11)
+#include <unistd.h>
+#endif
+
+#include "core/memcheck.h"
+
+const quint32 UBInputTraceRecorder::magic = 0x55425452; // 'UBTR'
+const quint16 UBInputTraceRecorder::version = 1;
+
+UBInputTraceRecorder* UBInputTraceRecorder::sRecorder = 0;
+
+UBInputTraceRecorder::UBInputTraceRecorder()
+    : mLastEventUs(0)
+    , mDevice(UBInputTraceEvent::Mouse)
+    , mEventCount(0)
+{
+    // NOOP
+}
+
+
+UBInputTraceRecorder::~UBInputTraceRecorder()
+{
+    stop();
+}
+
+
+UBInputTraceRecorder* UBInputTraceRecorder::recorder()
+{
+    if (!sRecorder)
+        sRecorder = new UBInputTraceRecorder();
+
+    return sRecorder;
+}
+
+
+bool UBInputTraceRecorder::start(const QString& pTraceFile)
+{
+    stop();
+
+    mFile.setFileName(pTraceFile);
+
+    if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "cannot record input trace to" << pTraceFile;
+        return false;
+    }
+
+    mStream.setDevice(&mFile);
+    mStream.setVersion(QDataStream::Qt_4_6);
+    mStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    mStream << magic << version << (qint64)QDateTime::currentDateTime().toMSecsSinceEpoch();
+
+    mClock.start();
+    mLastEventUs = 0;
+    mEventCount = 0;
+
+    qDebug() << "recording input trace to" << pTraceFile;
+
+    return true;
+}
+
+
+void UBInputTraceRecorder::stop()
+{
+    if (!mFile.isOpen())
+        return;
+
+    mStream.setDevice(0);
+    mFile.close();
+
+    qDebug() << "input trace closed," << mEventCount << "events recorded in" << mFile.fileName();
+}
+
+
+void UBInputTraceRecorder::record(UBInputTraceEvent::Kind pKind, const QPointF& pScenePos, qreal pPressure)
+{
+    if (!mFile.isOpen())
+        return;
+
+    qint64 nowUs = mClock.nsecsElapsed() / 1000;
+    quint32 deltaUs = (quint32)qMin(nowUs - mLastEventUs, (qint64)0xFFFFFFFF);
+    mLastEventUs = nowUs;
+
+    quint8 tool = (quint8)UBDrawingController::drawingController()->stylusTool();
+    quint16 pressure = (quint16)qBound(0, qRound(pPressure * 65535), 65535);
+
+    mStream << (quint8)pKind << (quint8)mDevice << tool << deltaUs
+            << (float)pScenePos.x() << (float)pScenePos.y() << pressure;
+
+    mEventCount++;
+}
+
+
+UBInputTracePlayer::UBInputTracePlayer()
+    : mItemCountBefore(0)
+    , mItemCountAfter(0)
+    , mResidentMemoryBefore(-1)
+    , mResidentMemoryAfter(-1)
+{
+    // NOOP
+}
+
+
+UBInputTracePlayer::~UBInputTracePlayer()
+{
+    // NOOP
+}
+
+
+bool UBInputTracePlayer::load(const QString& pTraceFile)
+{
+    mEvents.clear();
+
+    QFile file(pTraceFile);
+
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "cannot open input trace" << pTraceFile;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic;
+    quint16 version;
+    qint64 startTime;
+
+    stream >> magic >> version >> startTime;
+
+    if (magic != UBInputTraceRecorder::magic || version > UBInputTraceRecorder::version)
+    {
+        qWarning() << pTraceFile << "is not a supported input trace";
+        return false;
+    }
+
+    while (!stream.atEnd())
+    {
+        quint8 kind, device, tool;
+        quint32 deltaUs;
+        float x, y;
+        quint16 pressure;
+
+        stream >> kind >> device >> tool >> deltaUs >> x >> y >> pressure;
+
+        if (stream.status() != QDataStream::Ok)
+        {
+            qWarning() << "truncated input trace" << pTraceFile << "after" << mEvents.size() << "events";
+            break;
+        }
+
+        UBInputTraceEvent event;
+        event.kind = (UBInputTraceEvent::Kind)kind;
+        event.device = (UBInputTraceEvent::Device)device;
+        event.tool = tool;
+        event.deltaUs = deltaUs;
+        event.scenePos = QPointF(x, y);
+        event.pressure = pressure / 65535.0;
+
+        mEvents << event;
+    }
+
+    return mEvents.size() > 0;
+}
+
+
+void UBInputTracePlayer::replay(UBGraphicsScene* pScene, bool pAtRecordedSpeed)
+{
+    mProcessingTimesMs.clear();
+
+    if (!pScene)
+        return;
+
+    UBDrawingController* dc = UBDrawingController::drawingController();
+    int previousTool = dc->stylusTool();
+
+    mItemCountBefore = pScene->items().size();
+    mResidentMemoryBefore = residentMemory();
+
+    QElapsedTimer clock;
+    clock.start();
+    qint64 dueUs = 0;
+
+    foreach(const UBInputTraceEvent& event, mEvents)
+    {
+        if (pAtRecordedSpeed)
+        {
+            dueUs += event.deltaUs;
+
+            // let the event loop paint while waiting, as it would between real events
+            while (clock.nsecsElapsed() / 1000 < dueUs)
+                QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+        }
+
+        if (dc->stylusTool() != event.tool)
+            dc->setStylusTool(event.tool);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        switch (event.kind)
+        {
+            case UBInputTraceEvent::Press:
+                pScene->inputDevicePress(event.scenePos, event.pressure);
+                break;
+            case UBInputTraceEvent::Move:
+                pScene->inputDeviceMove(event.scenePos, event.pressure);
+                break;
+            case UBInputTraceEvent::Release:
+                pScene->inputDeviceRelease();
+                break;
+        }
+
+        mProcessingTimesMs << timer.nsecsElapsed() / 1000000.0;
+    }
+
+    mItemCountAfter = pScene->items().size();
+    mResidentMemoryAfter = residentMemory();
+
+    dc->setStylusTool(previousTool);
+}
+
+
+qreal UBInputTracePlayer::percentileMs(qreal pPercentile) const
+{
+    if (mProcessingTimesMs.isEmpty())
+        return 0;
+
+    QList<qreal> sorted = mProcessingTimesMs;
+    qSort(sorted);
+
+    int index = qBound(0, (int)(pPercentile * (sorted.size() - 1) + 0.5), sorted.size() - 1);
+
+    return sorted.at(index);
+}
+
+
+QVector<int> UBInputTracePlayer::histogram() const
+{
+    QVector<int> buckets(24, 0);
+
+    foreach(qreal timeMs, mProcessingTimesMs)
+    {
+        qint64 us = (qint64)(timeMs * 1000);
+        int bucket = 0;
+
+        while (us > 0 && bucket < buckets.size() - 1)
+        {
+            us >>= 1;
+            bucket++;
+        }
+
+        buckets[bucket]++;
+    }
+
+    return buckets;
+}
+
+
+qint64 UBInputTracePlayer::residentMemory()
+{
+#if defined(Q_WS_X11)
+    QFile statm("/proc/self/statm");
+
+    if (statm.open(QIODevice::ReadOnly))
+    {
+        QList<QByteArray> fields = statm.readAll().split(' ');
+
+        if (fields.size() > 1)
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+    }
+#endif
+
+    return -1;
+}
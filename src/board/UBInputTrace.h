@@ -0,0 +1,170 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBINPUTTRACE_H_
+#define UBINPUTTRACE_H_
+
+#include <QtCore>
+
+class UBGraphicsScene;
+
+class UBInputTraceEvent
+{
+    public:
+
+        enum Kind
+        {
+            Press = 0, Move, Release
+        };
+
+        enum Device
+        {
+            Mouse = 0, Tablet
+        };
+
+        UBInputTraceEvent()
+            : kind(Move)
+            , device(Mouse)
+            , tool(0)
+            , deltaUs(0)
+            , pressure(1.0)
+        {
+            // NOOP
+        }
+
+        Kind kind;
+        Device device;
+        int tool;
+        quint32 deltaUs; // time elapsed since the previous event of the trace
+        QPointF scenePos;
+        qreal pressure;
+};
+
+
+/**
+ * Records the input device events received by UBGraphicsScene to a compact binary trace.
+ *
+ * File layout (QDataStream, big endian, single precision floats):
+ *   header : quint32 magic 'UBTR', quint16 version, qint64 start time (ms since epoch)
+ *   events : quint8 kind, quint8 device, quint8 tool, quint32 delta (us), float x, float y, quint16 pressure
+ */
+class UBInputTraceRecorder
+{
+    private:
+
+        UBInputTraceRecorder();
+
+    public:
+
+        virtual ~UBInputTraceRecorder();
+
+        static UBInputTraceRecorder* recorder();
+
+        static const quint32 magic;
+        static const quint16 version;
+
+        bool start(const QString& pTraceFile);
+        void stop();
+
+        bool isRecording() const
+        {
+            return mFile.isOpen();
+        }
+
+        void setDevice(UBInputTraceEvent::Device pDevice)
+        {
+            mDevice = pDevice;
+        }
+
+        void record(UBInputTraceEvent::Kind pKind, const QPointF& pScenePos, qreal pPressure);
+
+    private:
+
+        QFile mFile;
+        QDataStream mStream;
+        QElapsedTimer mClock;
+        qint64 mLastEventUs;
+        UBInputTraceEvent::Device mDevice;
+        int mEventCount;
+
+        static UBInputTraceRecorder* sRecorder;
+};
+
+
+/**
+ * Feeds a recorded trace back into a scene through UBGraphicsScene::inputDevicePress/Move/Release,
+ * at the recorded pace or as fast as possible, and collects per event processing times.
+ */
+class UBInputTracePlayer
+{
+    public:
+
+        UBInputTracePlayer();
+        virtual ~UBInputTracePlayer();
+
+        bool load(const QString& pTraceFile);
+
+        int eventCount() const
+        {
+            return mEvents.size();
+        }
+
+        void replay(UBGraphicsScene* pScene, bool pAtRecordedSpeed);
+
+        // processing time of each replayed event, in the order of the trace
+        const QList<qreal>& processingTimesMs() const
+        {
+            return mProcessingTimesMs;
+        }
+
+        qreal percentileMs(qreal pPercentile) const;
+
+        // buckets are powers of two in microseconds: [0-1[, [1-2[, [2-4[ ... last bucket is open
+        QVector<int> histogram() const;
+
+        int itemCountBefore() const
+        {
+            return mItemCountBefore;
+        }
+
+        int itemCountAfter() const
+        {
+            return mItemCountAfter;
+        }
+
+        qint64 residentMemoryBefore() const
+        {
+            return mResidentMemoryBefore;
+        }
+
+        qint64 residentMemoryAfter() const
+        {
+            return mResidentMemoryAfter;
+        }
+
+        static qint64 residentMemory();
+
+    private:
+
+        QList<UBInputTraceEvent> mEvents;
+        QList<qreal> mProcessingTimesMs;
+
+        int mItemCountBefore;
+        int mItemCountAfter;
+        qint64 mResidentMemoryBefore;
+        qint64 mResidentMemoryAfter;
+};
+
+#endif /* UBINPUTTRACE_H_ */
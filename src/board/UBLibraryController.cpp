@@ -145,7 +145,8 @@ void UBLibraryController::importImageOnLibrary(QImage& pImage)
     if(!pImage.isNull()){
         QDateTime now = QDateTime::currentDateTime();
         QString filePath = mPicturesStandardDirectoryPath.toLocalFile() + "/" + tr("ImportedImage") + "-" + now.toString("dd-MM-yyyy hh-mm-ss") + ".png";
-        filePath = UBFileSystemUtils::normalizeFilePath(filePath);
+        // the bands of a web page capture are imported within the same second
+        filePath = UBFileSystemUtils::nextAvailableFileName(UBFileSystemUtils::normalizeFilePath(filePath), "-");
         pImage.save(filePath);
         UBApplication::showMessage(tr("Added 1 Image to Library"));
     }
@@ -3,13 +3,15 @@ HEADERS      += src/board/UBBoardController.h \
                 src/board/UBBoardPaletteManager.h \
                 src/board/UBBoardView.h \
                 src/board/UBLibraryController.h \
-                src/board/UBDrawingController.h
+                src/board/UBDrawingController.h \
+                src/board/UBInputTrace.h
 
 SOURCES      += src/board/UBBoardController.cpp \
                 src/board/UBBoardPaletteManager.cpp \
                 src/board/UBBoardView.cpp \
                 src/board/UBLibraryController.cpp \
-                src/board/UBDrawingController.cpp
+                src/board/UBDrawingController.cpp \
+                src/board/UBInputTrace.cpp
 
     
     
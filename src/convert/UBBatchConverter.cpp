@@ -0,0 +1,516 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBBatchConverter.h"
+
+#include <QtGui>
+
+#include "core/UBPersistenceManager.h"
+
+#include "frameworks/UBFileSystemUtils.h"
+
+#include "document/UBDocumentProxy.h"
+
+#include "domain/UBGraphicsScene.h"
+
+#include "adaptors/UBImportDocument.h"
+#include "adaptors/UBExportFullPDF.h"
+#include "adaptors/UBExportWeb.h"
+#include "adaptors/UBThumbnailAdaptor.h"
+
+#if defined(Q_WS_X11)
+#include <unistd.h>
+#endif
+
+#include "core/memcheck.h"
+
+static const qint64 minimumJobMemory = 64 * 1024 * 1024;
+static const int documentToMemoryRatio = 6; // decompressed pages, scene items and rendering buffers
+
+UBBatchConverter::UBBatchConverter(const QStringList& pArguments, QObject *parent)
+    : QObject(parent)
+    , mArguments(pArguments)
+    , mIsValid(true)
+    , mMaxJobs(QThread::idealThreadCount())
+    , mMemoryBudget(0)
+    , mForce(false)
+    , mOut(stdout)
+    , mSucceeded(0)
+    , mFailed(0)
+    , mSkipped(0)
+{
+    mFormats << "pdf" << "png" << "web";
+
+    QStringList inputs;
+
+    for (int i = 1; i < mArguments.size(); i++)
+    {
+        QString arg = mArguments.at(i);
+        bool hasValue = i + 1 < mArguments.size();
+
+        if (arg == "-output" && hasValue)
+            mOutputPath = mArguments.at(++i);
+        else if (arg == "-formats" && hasValue)
+            mFormats = mArguments.at(++i).split(",", QString::SkipEmptyParts);
+        else if (arg == "-jobs" && hasValue)
+            mMaxJobs = mArguments.at(++i).toInt();
+        else if (arg == "-memory" && hasValue)
+            mMemoryBudget = mArguments.at(++i).toLongLong() * 1024 * 1024;
+        else if (arg == "-force")
+            mForce = true;
+        else if (!arg.startsWith("-"))
+            inputs << arg;
+        else
+            mIsValid = false;
+    }
+
+    foreach(QString format, mFormats)
+    {
+        if (format != "pdf" && format != "png" && format != "web")
+            mIsValid = false;
+    }
+
+    mIsValid = mIsValid && !mOutputPath.isEmpty() && !inputs.isEmpty() && !mFormats.isEmpty();
+    mMaxJobs = qMax(1, mMaxJobs);
+
+    foreach(QString input, inputs)
+        collectInputs(input);
+
+    mMemoryTimer.setInterval(500);
+    connect(&mMemoryTimer, SIGNAL(timeout()), this, SLOT(sampleMemory()));
+}
+
+
+UBBatchConverter::~UBBatchConverter()
+{
+    foreach(const Job& job, mRunning)
+    {
+        job.process->kill();
+        job.process->waitForFinished();
+        delete job.process;
+    }
+}
+
+
+void UBBatchConverter::usage(const QString& pProgName)
+{
+    qWarning() << "usage:" << pProgName << "-output <dir> [-formats pdf,png,web] [-jobs <n>] [-memory <MB>] [-force] <file.ubz|dir> ...";
+}
+
+
+bool UBBatchConverter::isWorkerInvocation(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (qstrcmp(argv[i], "-worker") == 0)
+            return true;
+    }
+
+    return false;
+}
+
+
+QString UBBatchConverter::jsonString(const QString& pString)
+{
+    QString escaped;
+    escaped.reserve(pString.length() + 2);
+
+    escaped += '"';
+
+    foreach(QChar c, pString)
+    {
+        if (c == '"' || c == '\\')
+            escaped += QString("\\") + c;
+        else if (c == '\n')
+            escaped += "\\n";
+        else if (c == '\t')
+            escaped += "\\t";
+        else if (c.unicode() < 0x20)
+            escaped += QString("\\u%1").arg(c.unicode(), 4, 16, QChar('0'));
+        else
+            escaped += c;
+    }
+
+    escaped += '"';
+
+    return escaped;
+}
+
+
+void UBBatchConverter::collectInputs(const QString& pPath)
+{
+    QFileInfo info(pPath);
+
+    if (info.isDir())
+    {
+        QDir root(info.absoluteFilePath());
+        QDirIterator it(root.absolutePath(), QStringList() << "*.ubz", QDir::Files, QDirIterator::Subdirectories);
+
+        while (it.hasNext())
+        {
+            QString file = it.next();
+            QString relative = root.relativeFilePath(file);
+
+            Job job;
+            job.input = file;
+            job.outputBaseName = relative.left(relative.length() - QFileInfo(file).suffix().length() - 1);
+
+            mPending.enqueue(job);
+        }
+    }
+    else if (info.exists())
+    {
+        Job job;
+        job.input = info.absoluteFilePath();
+        job.outputBaseName = info.completeBaseName();
+
+        mPending.enqueue(job);
+    }
+    else
+    {
+        qWarning() << "no such file or directory" << pPath;
+    }
+}
+
+
+QString UBBatchConverter::outputFile(const QString& pBaseName, const QString& pFormat) const
+{
+    QString base = mOutputPath + "/" + pBaseName;
+
+    if (pFormat == "pdf")
+        return base + ".pdf";
+    else if (pFormat == "png")
+        return base + "-pages/index.txt"; // written last, once every page is rendered
+    else
+        return base + "-web/index.html";
+}
+
+
+QStringList UBBatchConverter::outdatedFormats(const QString& pInput, const QString& pBaseName) const
+{
+    if (mForce)
+        return mFormats;
+
+    QDateTime inputModified = QFileInfo(pInput).lastModified();
+    QStringList outdated;
+
+    foreach(QString format, mFormats)
+    {
+        QFileInfo output(outputFile(pBaseName, format));
+
+        if (!output.exists() || output.lastModified() < inputModified)
+            outdated << format;
+    }
+
+    return outdated;
+}
+
+
+void UBBatchConverter::run()
+{
+    QQueue<Job> toConvert;
+
+    while (!mPending.isEmpty())
+    {
+        Job job = mPending.dequeue();
+        job.formats = outdatedFormats(job.input, job.outputBaseName);
+
+        if (job.formats.isEmpty())
+        {
+            mSkipped++;
+            emitEvent("skipped", job.input, "\"reason\": \"up to date\"");
+            continue;
+        }
+
+        job.estimatedMemory = qMax(minimumJobMemory, QFileInfo(job.input).size() * documentToMemoryRatio);
+        toConvert.enqueue(job);
+    }
+
+    mPending = toConvert;
+
+    if (mPending.isEmpty())
+    {
+        workerFinished(0, QProcess::NormalExit);
+        return;
+    }
+
+    mMemoryTimer.start();
+
+    startJobs();
+}
+
+
+void UBBatchConverter::startJobs()
+{
+    while (!mPending.isEmpty() && mRunning.size() < mMaxJobs)
+    {
+        Job job = mPending.head();
+
+        // always let one job run, even if it alone exceeds the budget
+        if (mMemoryBudget > 0 && !mRunning.isEmpty()
+                && runningMemory() + job.estimatedMemory > mMemoryBudget)
+            break;
+
+        mPending.dequeue();
+
+        QDir().mkpath(QFileInfo(mOutputPath + "/" + job.outputBaseName).absolutePath());
+
+        job.process = new QProcess(this);
+        job.process->setProcessChannelMode(QProcess::SeparateChannels);
+
+        connect(job.process, SIGNAL(readyReadStandardOutput()), this, SLOT(workerOutput()));
+        connect(job.process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(workerFinished(int, QProcess::ExitStatus)));
+
+        QStringList args;
+        args << "-worker" << job.input
+             << "-output" << mOutputPath + "/" + job.outputBaseName
+             << "-formats" << job.formats.join(",");
+
+        job.clock.start();
+        job.process->start(QCoreApplication::applicationFilePath(), args);
+
+        emitEvent("started", job.input, "\"formats\": [\"" + job.formats.join("\", \"") + "\"]");
+
+        mRunning << job;
+    }
+}
+
+
+qint64 UBBatchConverter::runningMemory() const
+{
+    qint64 total = 0;
+
+    foreach(const Job& job, mRunning)
+        total += job.estimatedMemory;
+
+    return total;
+}
+
+
+qint64 UBBatchConverter::processMemory(Q_PID pPid)
+{
+#if defined(Q_WS_X11)
+    QFile statm(QString("/proc/%1/statm").arg(pPid));
+
+    if (statm.open(QIODevice::ReadOnly))
+    {
+        QList<QByteArray> fields = statm.readAll().split(' ');
+
+        if (fields.size() > 1)
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+    }
+#else
+    Q_UNUSED(pPid);
+#endif
+
+    return -1;
+}
+
+
+void UBBatchConverter::sampleMemory()
+{
+    // replace the estimate by the measured resident size once it grows past it
+    for (int i = 0; i < mRunning.size(); i++)
+    {
+        qint64 resident = processMemory(mRunning.at(i).process->pid());
+
+        if (resident > mRunning.at(i).estimatedMemory)
+            mRunning[i].estimatedMemory = resident;
+    }
+
+    startJobs();
+}
+
+
+void UBBatchConverter::workerOutput()
+{
+    QProcess* process = qobject_cast<QProcess*>(sender());
+
+    if (!process)
+        return;
+
+    while (process->canReadLine())
+    {
+        mOut << QString::fromUtf8(process->readLine());
+    }
+
+    mOut.flush();
+}
+
+
+void UBBatchConverter::workerFinished(int pExitCode, QProcess::ExitStatus pExitStatus)
+{
+    QProcess* process = qobject_cast<QProcess*>(sender());
+
+    for (int i = 0; process && i < mRunning.size(); i++)
+    {
+        if (mRunning.at(i).process != process)
+            continue;
+
+        Job job = mRunning.takeAt(i);
+
+        while (process->canReadLine())
+            mOut << QString::fromUtf8(process->readLine());
+
+        QByteArray errors = process->readAllStandardError();
+        if (!errors.isEmpty())
+            fprintf(stderr, "%s", errors.constData());
+
+        bool success = pExitStatus == QProcess::NormalExit && pExitCode == 0;
+
+        if (success)
+            mSucceeded++;
+        else
+            mFailed++;
+
+        emitEvent("finished", job.input, QString("\"status\": %1, \"elapsedMs\": %2")
+                .arg(success ? "\"ok\"" : "\"failed\"")
+                .arg(job.clock.elapsed()));
+
+        process->deleteLater();
+        break;
+    }
+
+    startJobs();
+
+    if (mRunning.isEmpty() && mPending.isEmpty())
+    {
+        mMemoryTimer.stop();
+
+        mOut << QString("{\"event\": \"summary\", \"converted\": %1, \"failed\": %2, \"skipped\": %3}\n")
+                .arg(mSucceeded).arg(mFailed).arg(mSkipped);
+        mOut.flush();
+
+        QCoreApplication::exit(mFailed > 0 ? 1 : 0);
+    }
+}
+
+
+void UBBatchConverter::emitEvent(const QString& pEvent, const QString& pInput, const QString& pExtraMembers)
+{
+    mOut << "{\"event\": " << jsonString(pEvent) << ", \"input\": " << jsonString(pInput);
+
+    if (!pExtraMembers.isEmpty())
+        mOut << ", " << pExtraMembers;
+
+    mOut << "}\n";
+    mOut.flush();
+}
+
+
+int UBBatchConverter::convertDocument(const QStringList& pArguments)
+{
+    QString input;
+    QString outputBase;
+    QStringList formats;
+    int pngWidth = 1024;
+
+    for (int i = 1; i < pArguments.size() - 1; i++)
+    {
+        QString arg = pArguments.at(i);
+
+        if (arg == "-worker")
+            input = pArguments.at(++i);
+        else if (arg == "-output")
+            outputBase = pArguments.at(++i);
+        else if (arg == "-formats")
+            formats = pArguments.at(++i).split(",", QString::SkipEmptyParts);
+        else if (arg == "-png-width")
+            pngWidth = pArguments.at(++i).toInt();
+    }
+
+    QTextStream out(stdout);
+    QString inputMember = "\"input\": " + jsonString(input);
+
+    UBImportDocument importer;
+    UBDocumentProxy* proxy = importer.importFile(QFile(input), "");
+
+    if (!proxy)
+    {
+        out << "{\"event\": \"error\", " << inputMember << ", \"message\": \"cannot import document\"}\n";
+        return 1;
+    }
+
+    bool success = true;
+    int pageCount = UBPersistenceManager::persistenceManager()->sceneCount(proxy);
+
+    foreach(QString format, formats)
+    {
+        QElapsedTimer clock;
+        clock.start();
+
+        QString output;
+
+        if (format == "pdf")
+        {
+            output = outputBase + ".pdf";
+
+            UBExportFullPDF exporter;
+            exporter.persistsDocument(proxy, output);
+
+            success = QFile::exists(output) && success;
+        }
+        else if (format == "png")
+        {
+            output = outputBase + "-pages";
+
+            QDir().mkpath(output);
+            QFile::remove(output + "/index.txt");
+
+            QStringList pages;
+
+            for (int pageIndex = 0; pageIndex < pageCount; pageIndex++)
+            {
+                UBGraphicsScene* scene = UBPersistenceManager::persistenceManager()->loadDocumentScene(proxy, pageIndex);
+
+                if (!scene)
+                    continue;
+
+                QString page = QString("page%1.png").arg(pageIndex + 1, 3, 10, QChar('0'));
+
+                if (UBThumbnailAdaptor::render(scene, pngWidth).save(output + "/" + page, "PNG"))
+                    pages << page;
+
+                out << "{\"event\": \"page\", " << inputMember << ", \"format\": \"png\", \"page\": " << pageIndex + 1
+                    << ", \"pageCount\": " << pageCount << "}\n";
+                out.flush();
+            }
+
+            QFile index(output + "/index.txt");
+
+            if (pages.size() == pageCount && index.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                index.write(pages.join("\n").toUtf8() + "\n");
+            else
+                success = false;
+        }
+        else if (format == "web")
+        {
+            output = outputBase + "-web";
+
+            UBFileSystemUtils::deleteDir(output);
+
+            UBExportWeb exporter;
+            success = exporter.persistsDocument(proxy, output) && success;
+        }
+
+        out << "{\"event\": \"converted\", " << inputMember << ", \"format\": " << jsonString(format)
+            << ", \"output\": " << jsonString(output) << ", \"elapsedMs\": " << clock.elapsed() << "}\n";
+        out.flush();
+    }
+
+    UBPersistenceManager::persistenceManager()->deleteDocument(proxy);
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBBATCHCONVERTER_H_
+#define UBBATCHCONVERTER_H_
+
+#include <QtCore>
+
+/**
+ * Batch conversion of .ubz documents to PDF, PNG pages and web packages.
+ *
+ * QGraphicsScene and QPixmap can only be used from the GUI thread, so documents
+ * are converted in parallel by worker processes (the same executable started
+ * with -worker), each of them converting a single document. The coordinator
+ * keeps at most -jobs workers running and holds back new ones while the
+ * estimated memory use of the running ones exceeds the -memory budget.
+ *
+ * Progress is written to stdout as one JSON object per line.
+ */
+class UBBatchConverter : public QObject
+{
+    Q_OBJECT;
+
+    public:
+
+        UBBatchConverter(const QStringList& pArguments, QObject *parent = 0);
+        virtual ~UBBatchConverter();
+
+        static void usage(const QString& pProgName);
+
+        static bool isWorkerInvocation(int argc, char *argv[]);
+
+        // converts the single document given on the command line, in the current process
+        static int convertDocument(const QStringList& pArguments);
+
+        static QString jsonString(const QString& pString);
+
+        bool isValid() const
+        {
+            return mIsValid;
+        }
+
+    public slots:
+
+        void run();
+
+    private slots:
+
+        void workerOutput();
+        void workerFinished(int pExitCode, QProcess::ExitStatus pExitStatus);
+        void sampleMemory();
+
+    private:
+
+        class Job
+        {
+            public:
+
+                Job()
+                    : estimatedMemory(0)
+                    , process(0)
+                {
+                    // NOOP
+                }
+
+                QString input;
+                QString outputBaseName;
+                QStringList formats;
+                qint64 estimatedMemory;
+                QProcess* process;
+                QElapsedTimer clock;
+        };
+
+        void collectInputs(const QString& pPath);
+        QStringList outdatedFormats(const QString& pInput, const QString& pBaseName) const;
+        QString outputFile(const QString& pBaseName, const QString& pFormat) const;
+
+        void startJobs();
+        qint64 runningMemory() const;
+
+        static qint64 processMemory(Q_PID pPid);
+
+        void emitEvent(const QString& pEvent, const QString& pInput, const QString& pExtraMembers = QString());
+
+        QStringList mArguments;
+        bool mIsValid;
+
+        QString mOutputPath;
+        QStringList mFormats;
+        int mMaxJobs;
+        qint64 mMemoryBudget;
+        bool mForce;
+
+        QQueue<Job> mPending;
+        QList<Job> mRunning;
+
+        QTimer mMemoryTimer;
+        QTextStream mOut;
+
+        int mSucceeded;
+        int mFailed;
+        int mSkipped;
+};
+
+#endif /* UBBATCHCONVERTER_H_ */
@@ -0,0 +1,5 @@
+
+HEADERS      += src/convert/UBBatchConverter.h
+
+SOURCES      += src/convert/main.cpp \
+                src/convert/UBBatchConverter.cpp
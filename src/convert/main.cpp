@@ -0,0 +1,81 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QtGui>
+#include <QTextCodec>
+
+#include "frameworks/UBFileSystemUtils.h"
+
+#include "core/UBApplication.h"
+
+#include "UBBatchConverter.h"
+
+/*
+ * Entry point of the sankore-convert target (qmake "CONFIG+=convert").
+ *
+ * Without -worker the process only schedules the work and needs no display.
+ * Workers render pages and must be able to open one, e.g. under xvfb-run.
+ * Each worker gets its own data directory so that concurrent imports never
+ * share a document library or settings file.
+ */
+int main(int argc, char *argv[])
+{
+    if (!UBBatchConverter::isWorkerInvocation(argc, argv))
+    {
+        QCoreApplication app(argc, argv);
+
+        QTextCodec::setCodecForCStrings(QTextCodec::codecForName("UTF-8"));
+
+        UBBatchConverter converter(app.arguments());
+
+        if (!converter.isValid())
+        {
+            UBBatchConverter::usage(app.arguments().at(0));
+            return 1;
+        }
+
+        QTimer::singleShot(0, &converter, SLOT(run()));
+
+        return app.exec();
+    }
+
+    Q_INIT_RESOURCE(sankore);
+
+    QString sandbox = QDir::tempPath() + "/sankore-convert-" + QString::number(QCoreApplication::applicationPid());
+    QDir().mkpath(sandbox);
+
+    qputenv("HOME", QFile::encodeName(sandbox));
+    qputenv("XDG_DATA_HOME", QFile::encodeName(sandbox + "/data"));
+    qputenv("XDG_CONFIG_HOME", QFile::encodeName(sandbox + "/config"));
+
+#if defined(Q_WS_X11)
+    QApplication::setGraphicsSystem("raster");
+#endif
+
+    int result;
+
+    {
+        // the controllers are only created by UBApplication::exec, which is never called here
+        UBApplication app("Sankore 3.1 Converter " + QString::number(QCoreApplication::applicationPid()), argc, argv);
+
+        QTextCodec::setCodecForTr(QTextCodec::codecForName("UTF-8"));
+        QTextCodec::setCodecForCStrings(QTextCodec::codecForName("UTF-8"));
+
+        result = UBBatchConverter::convertDocument(app.arguments());
+    }
+
+    UBFileSystemUtils::deleteDir(sandbox);
+
+    return result;
+}
@@ -75,7 +75,7 @@ struct UBGraphicsItemData
 {
     enum Enum
     {
-        ItemLayerType, ItemLocked
+        ItemLayerType, ItemLocked, ItemJournalId
     };
 };
 
@@ -25,6 +25,7 @@
 #include "frameworks/UBPlatformUtils.h"
 #include "frameworks/UBFileSystemUtils.h"
 #include "frameworks/UBStringUtils.h"
+#include "frameworks/UBTrace.h"
 
 #include "UBSettings.h"
 #include "UBSetting.h"
@@ -33,12 +34,15 @@
 #include "UBPreferencesController.h"
 #include "UBIdleTimer.h"
 #include "UBApplicationController.h"
+#include "UBSearchIndex.h"
+#include "UBDocumentJournal.h"
 
 //#include "softwareupdate/UBSoftwareUpdateController.h"
 
 #include "board/UBBoardController.h"
 #include "board/UBDrawingController.h"
 #include "board/UBBoardView.h"
+#include "board/UBInputTrace.h"
 
 #include "web/UBWebController.h"
 
@@ -240,6 +244,11 @@ int UBApplication::exec(const QString& pFileToImport)
     webController = new UBWebController(mainWindow);
     documentController = new UBDocumentController(mainWindow);
 
+    // loaded in the background, the pages saved meanwhile are indexed once it is ready
+    UBSearchIndex::searchIndex();
+
+    UBDocumentJournal::documentJournal();
+
     applicationController = new UBApplicationController(boardController->controlView(), boardController->displayView(), mainWindow, staticMemoryCleaner);
 
     connect(mainWindow->actionDesktop, SIGNAL(triggered(bool)), applicationController, SLOT(showDesktop(bool)));
@@ -276,6 +285,20 @@ int UBApplication::exec(const QString& pFileToImport)
         UBApplication::applicationController->importFile(pFileToImport);
     }
 
+    int recordInputIndex = arguments().indexOf("-record-input");
+
+    if (recordInputIndex > 0 && recordInputIndex + 1 < arguments().size())
+    {
+        UBInputTraceRecorder::recorder()->start(arguments().at(recordInputIndex + 1));
+    }
+
+    int traceIndex = arguments().indexOf("-trace");
+
+    if (traceIndex > 0 && traceIndex + 1 < arguments().size())
+    {
+        UBTrace::trace()->startCapture(arguments().at(traceIndex + 1));
+    }
+
 #if defined(Q_WS_MAC)
     static AEEventHandlerUPP ub_proc_ae_handlerUPP = AEEventHandlerUPP(ub_appleEventProcessor);
     AEInstallEventHandler(kCoreEventClass, kAEReopenApplication, ub_proc_ae_handlerUPP, SRefCon(UBApplication::applicationController), true);
@@ -313,7 +336,17 @@ int UBApplication::exec(const QString& pFileToImport)
     if(UBSettings::settings()->appEnableUniboardTransition->get().toBool())
     {
         mUniboardSankoreTransition = new UniboardSankoreTransition();
-        mUniboardSankoreTransition->documentTransition();
+
+        // -transition-dry-run lists what the transition would change instead of proposing it
+        if (arguments().contains("-transition-dry-run"))
+        {
+            foreach(QString line, mUniboardSankoreTransition->dryRun())
+                qDebug() << "transition:" << line;
+        }
+        else
+        {
+            mUniboardSankoreTransition->documentTransition();
+        }
     }
 
     return QApplication::exec();
@@ -392,6 +425,9 @@ void UBApplication::closing()
     if (boardController)
         boardController->closing();
 
+    // the documents are left with their svg files up to date for the older versions and the other applications
+    UBPersistenceManager::persistenceManager()->persistPendingSvgs();
+
     if (applicationController)
         applicationController->closing();
 
@@ -554,6 +590,9 @@ bool UBApplication::handleOpenMessage(const QString& pMessage)
 
 void UBApplication::cleanup()
 {
+	UBInputTraceRecorder::recorder()->stop();
+	UBTrace::trace()->stopCapture();
+
 	if (applicationController) delete applicationController;
 	if (boardController) delete boardController;
 	if (webController) delete webController;
@@ -23,6 +23,7 @@
 #include "core/UBSetting.h"
 #include "core/UBDocumentManager.h"
 #include "core/UBDisplayManager.h"
+#include "core/UBPrintSpoolImporter.h"
 
 #include "softwareupdate/UBSoftwareUpdateController.h"
 #include "softwareupdate/UBSoftwareUpdate.h"
@@ -100,8 +101,17 @@ UBApplicationController::UBApplicationController(UBBoardView *pControlView, UBBo
 
     connect(UBApplication::webController, SIGNAL(imageCaptured(const QPixmap &, bool, const QUrl&))
             , this, SLOT(addCapturedPixmap(const QPixmap &, bool, const QUrl&)));
+    connect(UBApplication::webController, SIGNAL(pageCaptured(const QStringList&, const QUrl&))
+            , this, SLOT(addCapturedPage(const QStringList&, const QUrl&)));
 
     networkAccessManager = new QNetworkAccessManager (this);
+
+#if defined(Q_WS_X11)
+    QString printSpoolDirectory = UBSettings::settings()->printSpoolDirectory->get().toString();
+
+    if (!printSpoolDirectory.isEmpty())
+        new UBPrintSpoolImporter(printSpoolDirectory, this);
+#endif
     QTimer::singleShot (1000, this, SLOT (checkUpdateAtLaunch()));
 
 #ifdef Q_WS_X11
@@ -303,6 +313,28 @@ void UBApplicationController::addCapturedPixmap(const QPixmap &pPixmap, bool pag
 }
 
 
+void UBApplicationController::addCapturedPage(const QStringList& pBandFiles, const QUrl& sourceUrl)
+{
+    // the size is read from the header of the file, the band is not loaded
+    int bandWidth = pBandFiles.isEmpty() ? 0 : QImageReader(pBandFiles.first()).size().width();
+
+    if (bandWidth > 0)
+    {
+        qreal sf = UBApplication::boardController->systemScaleFactor();
+        qreal scaledWidth = ((qreal)bandWidth) / sf;
+
+        QSize pageNominalSize = UBApplication::boardController->activeScene()->nominalSize();
+
+        qreal scaleFactor = qMin(scaledWidth, (qreal)pageNominalSize.width()) / bandWidth;
+
+        // the bands are stacked down from the top of the page
+        QPointF top(0.0, pageNominalSize.height() / -2);
+
+        UBApplication::boardController->paletteManager()->addItem(pBandFiles, top, scaleFactor, sourceUrl);
+    }
+}
+
+
 void UBApplicationController::addCapturedEmbedCode(const QString& embedCode)
 {
     if (!embedCode.isEmpty())
@@ -112,6 +112,11 @@ class UBApplicationController : public QObject
          */
         void addCapturedPixmap(const QPixmap &pPixmap, bool pageMode, const QUrl& sourceUrl = QUrl());
 
+        /**
+         * Same as addCapturedPixmap in page mode, for a web page captured in bands.
+         */
+        void addCapturedPage(const QStringList& pBandFiles, const QUrl& sourceUrl);
+
         void addCapturedEmbedCode(const QString& embedCode);
 
         void screenLayoutChanged();
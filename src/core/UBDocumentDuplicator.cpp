@@ -0,0 +1,157 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBDocumentDuplicator.h"
+
+#include "core/UBPersistenceManager.h"
+
+#include "document/UBDocumentProxy.h"
+
+#include "adaptors/UBSvgSubsetAdaptor.h"
+
+#include "frameworks/UBFileSystemUtils.h"
+#include "frameworks/UBTrace.h"
+
+#include "core/memcheck.h"
+
+UBDocumentDuplicator::UBDocumentDuplicator(const QString& pName, const QString& pSourcePath, const QString& pTargetPath, QObject *pParent)
+    : QThread(pParent)
+    , mName(pName)
+    , mSourcePath(pSourcePath)
+    , mTargetPath(pTargetPath)
+    , mCancelRequested(0)
+{
+    // NOOP
+}
+
+
+UBDocumentDuplicator::~UBDocumentDuplicator()
+{
+    cancel();
+    wait();
+}
+
+
+void UBDocumentDuplicator::cancel()
+{
+    mCancelRequested = 1;
+}
+
+
+void UBDocumentDuplicator::run()
+{
+    bool succeeded = duplicate();
+
+    emit duplicated(mTargetPath, succeeded);
+}
+
+
+bool UBDocumentDuplicator::duplicate()
+{
+    UB_TRACE_SCOPE("document.duplicate", "persistence");
+
+    bool succeeded = copyFiles();
+
+    if (succeeded)
+        regenerateSceneUuids();
+
+    if (!succeeded)
+        UBFileSystemUtils::deleteDir(mTargetPath);
+
+    return succeeded;
+}
+
+
+bool UBDocumentDuplicator::copyFiles()
+{
+    QStringList sharedDirectories;
+    sharedDirectories << UBPersistenceManager::imageDirectory
+                      << UBPersistenceManager::objectDirectory
+                      << UBPersistenceManager::videoDirectory
+                      << UBPersistenceManager::audioDirectory;
+
+    QDir sourceDir(mSourcePath);
+
+    QStringList directories;
+    QStringList files;
+    qint64 totalSize = 0;
+
+    QDirIterator it(mSourcePath, QDir::Files | QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+
+    while (it.hasNext())
+    {
+        it.next();
+
+        if (it.fileInfo().isDir())
+        {
+            directories << sourceDir.relativeFilePath(it.filePath());
+        }
+        else
+        {
+            files << sourceDir.relativeFilePath(it.filePath());
+            totalSize += it.fileInfo().size();
+        }
+    }
+
+    if (!QDir().mkpath(mTargetPath))
+        return false;
+
+    foreach(QString directory, directories)
+    {
+        if (!QDir().mkpath(mTargetPath + "/" + directory))
+            return false;
+    }
+
+    qint64 copiedSize = 0;
+    int lastPercent = -1;
+
+    foreach(QString file, files)
+    {
+        if (mCancelRequested != 0)
+            return false;
+
+        QString source = mSourcePath + "/" + file;
+        bool isAsset = sharedDirectories.contains(file.section('/', 0, 0)) && file.contains('/');
+
+        if (!UBFileSystemUtils::cloneFile(source, mTargetPath + "/" + file, isAsset))
+        {
+            qWarning() << "cannot copy" << source << "to" << mTargetPath;
+            return false;
+        }
+
+        copiedSize += QFileInfo(source).size();
+
+        int percent = totalSize > 0 ? (int)(copiedSize * 100 / totalSize) : 100;
+
+        if (percent != lastPercent)
+        {
+            lastPercent = percent;
+            emit progress(percent);
+        }
+    }
+
+    return mCancelRequested == 0;
+}
+
+
+void UBDocumentDuplicator::regenerateSceneUuids()
+{
+    UBDocumentProxy copy(mTargetPath);
+
+    for (int i = 0; QFile::exists(mTargetPath + UBFileSystemUtils::digitFileFormat("/page%1.svg", i + 1)); i++)
+    {
+        UBSvgSubsetAdaptor::setSceneUuid(&copy, i, QUuid::createUuid());
+    }
+}
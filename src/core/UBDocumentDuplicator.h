@@ -0,0 +1,75 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBDOCUMENTDUPLICATOR_H_
+#define UBDOCUMENTDUPLICATOR_H_
+
+#include <QtGui>
+
+/**
+ * Copies the directory of a document, in a background thread (start()) or in the calling one (duplicate()).
+ *
+ * Assets (images, videos, audios, objects) are never rewritten once added to a document,
+ * they are cloned or hard linked when the file system allows it, so the copy takes no
+ * additional space. Pages, thumbnails and widgets are cloned or copied.
+ */
+class UBDocumentDuplicator : public QThread
+{
+    Q_OBJECT;
+
+    public:
+        UBDocumentDuplicator(const QString& pName, const QString& pSourcePath, const QString& pTargetPath, QObject *pParent = 0);
+        virtual ~UBDocumentDuplicator();
+
+        // false if the duplication failed or was cancelled, the partial copy is removed
+        bool duplicate();
+
+        QString name() const
+        {
+            return mName;
+        }
+
+        QString sourcePath() const
+        {
+            return mSourcePath;
+        }
+
+        QString targetPath() const
+        {
+            return mTargetPath;
+        }
+
+    public slots:
+        void cancel();
+
+    signals:
+        void progress(int pPercent);
+        void duplicated(const QString& pTargetPath, bool pSucceeded);
+
+    protected:
+        void run();
+
+    private:
+        bool copyFiles();
+        void regenerateSceneUuids();
+
+        QString mName;
+        QString mSourcePath;
+        QString mTargetPath;
+
+        QAtomicInt mCancelRequested;
+};
+
+#endif /* UBDOCUMENTDUPLICATOR_H_ */
@@ -0,0 +1,626 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBDocumentJournal.h"
+
+#include "core/UB.h"
+#include "core/UBApplication.h"
+#include "core/UBSettings.h"
+#include "core/UBPersistenceManager.h"
+
+#include "board/UBBoardController.h"
+
+#include "document/UBDocumentProxy.h"
+
+#include "domain/UBGraphicsScene.h"
+#include "domain/UBGraphicsPolygonItem.h"
+
+#include "adaptors/UBSvgSubsetAdaptor.h"
+
+#include "frameworks/UBFileSystemUtils.h"
+#include "frameworks/UBTrace.h"
+
+#include "core/memcheck.h"
+
+static const quint32 recordMagic = 0x55424a52; // "UBJR"
+
+static const int journalInterval = 1000;
+static const int syncInterval = 2000;
+
+// beyond, the journal is rewritten with the last snapshot and ink changes of each page only
+static const qint64 maxJournalSize = 4 * 1024 * 1024;
+
+// beyond, the ink changes of a page are replaced by a new snapshot
+static const int maxPageRecordsSize = 1024 * 1024;
+
+UBDocumentJournal* UBDocumentJournal::sDocumentJournal = 0;
+
+
+class UBDocumentJournalTask : public QRunnable
+{
+    public:
+        enum Operation
+        {
+            Append = 0, AppendAndSync, Sync, Replace, Remove
+        };
+
+        UBDocumentJournalTask(Operation pOperation, const QString& pJournalPath, const QByteArray& pData = QByteArray())
+            : mOperation(pOperation)
+            , mJournalPath(pJournalPath)
+            , mData(pData)
+        {
+            // NOOP
+        }
+
+        virtual void run()
+        {
+            UB_TRACE_SCOPE("journal.write", "autosave");
+
+            if (mOperation == Remove)
+            {
+                QFile::remove(mJournalPath);
+            }
+            else if (mOperation == Replace)
+            {
+                QString tmpJournalPath = mJournalPath + ".tmp";
+                QFile file(tmpJournalPath);
+
+                if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+                        || file.write(mData) != mData.size()
+                        || !UBFileSystemUtils::syncFile(file))
+                {
+                    qWarning() << "cannot write journal" << tmpJournalPath;
+                    return;
+                }
+
+                file.close();
+
+                if (!UBFileSystemUtils::replaceFile(tmpJournalPath, mJournalPath))
+                    qWarning() << "cannot replace journal" << mJournalPath;
+            }
+            else
+            {
+                QFile file(mJournalPath);
+
+                if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+                {
+                    qWarning() << "cannot open journal" << mJournalPath;
+                    return;
+                }
+
+                if (!mData.isEmpty() && file.write(mData) != mData.size())
+                    qWarning() << "cannot write journal" << mJournalPath;
+
+                if (mOperation != Append)
+                    UBFileSystemUtils::syncFile(file);
+            }
+        }
+
+    private:
+        Operation mOperation;
+        QString mJournalPath;
+        QByteArray mData;
+};
+
+
+UBDocumentJournal* UBDocumentJournal::documentJournal()
+{
+    if (!sDocumentJournal)
+    {
+        sDocumentJournal = new UBDocumentJournal(qApp);
+    }
+
+    return sDocumentJournal;
+}
+
+
+UBDocumentJournal::UBDocumentJournal(QObject *pParent)
+    : QObject(pParent)
+    , mJournaledChangeCount(0)
+    , mJournaledOtherChangeCount(0)
+    , mLastInkId(0)
+{
+    mThreadPool.setMaxThreadCount(1);
+
+    QDir().mkpath(journalDirectory());
+
+    connect(&mJournalTimer, SIGNAL(timeout()), this, SLOT(journalActiveScene()));
+    mJournalTimer.start(journalInterval);
+
+    mSyncTimer.setSingleShot(true);
+    mSyncTimer.setInterval(syncInterval);
+    connect(&mSyncTimer, SIGNAL(timeout()), this, SLOT(sync()));
+
+    UBPersistenceManager* persistenceManager = UBPersistenceManager::persistenceManager();
+
+    connect(persistenceManager, SIGNAL(documentScenePersisted(UBDocumentProxy*, int)), this, SLOT(documentScenePersisted(UBDocumentProxy*, int)));
+    connect(persistenceManager, SIGNAL(documentWillBeDeleted(UBDocumentProxy*)), this, SLOT(documentWillBeDeleted(UBDocumentProxy*)));
+}
+
+
+UBDocumentJournal::~UBDocumentJournal()
+{
+    sync();
+
+    mThreadPool.waitForDone();
+
+    sDocumentJournal = 0;
+}
+
+
+QString UBDocumentJournal::journalDirectory()
+{
+    return UBSettings::uniboardDataDirectory() + "/journals";
+}
+
+
+QString UBDocumentJournal::journalFilePath(const QString& pDocumentPath)
+{
+    // the directories of the documents have unique names
+    return journalDirectory() + "/" + QFileInfo(pDocumentPath).fileName() + ".journal";
+}
+
+
+QByteArray UBDocumentJournal::encode(const Record& pRecord)
+{
+    QByteArray payload;
+    QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+    payloadStream.setVersion(QDataStream::Qt_4_6);
+
+    payloadStream << (quint8)pRecord.type << pRecord.documentPath << pRecord.pageIndex << pRecord.sceneUuid << pRecord.svg
+                  << pRecord.inkIds << pRecord.ink.colors << pRecord.ink.polygonCount << pRecord.ink.data << pRecord.removedInkIds;
+
+    QByteArray record;
+    QDataStream recordStream(&record, QIODevice::WriteOnly);
+    recordStream.setVersion(QDataStream::Qt_4_6);
+
+    recordStream << recordMagic << (quint32)payload.size() << qChecksum(payload.constData(), payload.size());
+    recordStream.writeRawData(payload.constData(), payload.size());
+
+    return record;
+}
+
+
+QList<UBDocumentJournal::Record> UBDocumentJournal::readJournal(const QString& pJournalPath)
+{
+    QList<Record> records;
+
+    QFile file(pJournalPath);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return records;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_6);
+
+    while (!stream.atEnd())
+    {
+        quint32 magic = 0;
+        quint32 length = 0;
+        quint16 checksum = 0;
+
+        stream >> magic >> length >> checksum;
+
+        // the record written when the power went off is truncated, the previous ones are consistent
+        if (stream.status() != QDataStream::Ok || magic != recordMagic || length > file.size() - file.pos())
+            break;
+
+        QByteArray payload(length, 0);
+
+        if (stream.readRawData(payload.data(), length) != (int)length || qChecksum(payload.constData(), length) != checksum)
+            break;
+
+        QDataStream payloadStream(payload);
+        payloadStream.setVersion(QDataStream::Qt_4_6);
+
+        Record record;
+        quint8 type = 0;
+
+        payloadStream >> type >> record.documentPath >> record.pageIndex >> record.sceneUuid >> record.svg
+                      >> record.inkIds >> record.ink.colors >> record.ink.polygonCount >> record.ink.data >> record.removedInkIds;
+
+        if (payloadStream.status() != QDataStream::Ok)
+            break;
+
+        record.type = (RecordType)type;
+        records << record;
+    }
+
+    return records;
+}
+
+
+static QUuid sceneUuidInFile(const QString& pSvgPath)
+{
+    QFile file(pSvgPath);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return QUuid();
+
+    QXmlStreamReader reader(&file);
+
+    while (!reader.atEnd())
+    {
+        reader.readNext();
+
+        if (reader.isStartElement())
+        {
+            foreach(QXmlStreamAttribute attribute, reader.attributes())
+            {
+                if (attribute.name() == "uuid")
+                    return QUuid(attribute.value().toString());
+            }
+
+            return QUuid();
+        }
+    }
+
+    return QUuid();
+}
+
+
+bool UBDocumentJournal::recoverPage(const QList<Record>& pRecords)
+{
+    // the records start with the snapshot, the last one knows the current index of the page
+    const Record& lastRecord = pRecords.last();
+    QString pagePath = lastRecord.documentPath + "/page%1.svg";
+
+    int pageCount = 0;
+
+    while (QFile::exists(UBFileSystemUtils::digitFileFormat(pagePath, pageCount + 1)))
+        pageCount++;
+
+    int targetIndex = -1;
+
+    if (lastRecord.pageIndex < pageCount)
+    {
+        QUuid uuid = sceneUuidInFile(UBFileSystemUtils::digitFileFormat(pagePath, lastRecord.pageIndex + 1));
+
+        // a page that cannot be read any more is the one the crash interrupted
+        if (uuid.isNull() || uuid == lastRecord.sceneUuid)
+            targetIndex = lastRecord.pageIndex;
+    }
+
+    // the page moved since it was journaled
+    for (int i = 0; i < pageCount && targetIndex < 0; i++)
+    {
+        if (sceneUuidInFile(UBFileSystemUtils::digitFileFormat(pagePath, i + 1)) == lastRecord.sceneUuid)
+            targetIndex = i;
+    }
+
+    // a page added to the end of the document
+    if (targetIndex < 0 && lastRecord.pageIndex == pageCount)
+        targetIndex = pageCount;
+
+    if (targetIndex < 0)
+        return false;
+
+    UBDocumentProxy proxy(lastRecord.documentPath);
+    UBGraphicsScene* scene = UBSvgSubsetAdaptor::loadScene(&proxy, qUncompress(pRecords.first().svg));
+
+    if (!scene)
+        return false;
+
+    // the polygons by id, added to the scene once all the changes are applied
+    QMap<quint32, QPair<UBGraphicsPolygonItem*, int> > ink;
+    bool inkRead = true;
+
+    foreach(Record record, pRecords)
+    {
+        foreach(quint32 id, record.removedInkIds)
+            delete ink.take(id).first;
+
+        QList<UBGraphicsPolygonItem*> polygonItems;
+        QList<int> strokeIndexes;
+
+        if (!UBBinaryPageAdaptor::readPolygons(record.ink, polygonItems, strokeIndexes) || polygonItems.size() != record.inkIds.size())
+        {
+            qDeleteAll(polygonItems);
+            inkRead = false;
+            break;
+        }
+
+        for (int i = 0; i < polygonItems.size(); i++)
+        {
+            delete ink.value(record.inkIds.at(i)).first;
+            ink.insert(record.inkIds.at(i), qMakePair(polygonItems.at(i), strokeIndexes.at(i)));
+        }
+    }
+
+    QList<UBGraphicsPolygonItem*> polygonItems;
+    QList<int> strokeIndexes;
+
+    foreach(quint32 id, ink.keys())
+    {
+        polygonItems << ink.value(id).first;
+        strokeIndexes << ink.value(id).second;
+    }
+
+    if (!inkRead)
+    {
+        qDeleteAll(polygonItems);
+        delete scene;
+        return false;
+    }
+
+    QHash<int, UBGraphicsStroke*> strokes;
+    UBBinaryPageAdaptor::addPolygons(scene, polygonItems, strokeIndexes, strokes);
+
+    QByteArray svg = UBSvgSubsetAdaptor::sceneSvg(&proxy, scene, targetIndex);
+
+    delete scene;
+
+    QString svgPath = UBFileSystemUtils::digitFileFormat(pagePath, targetIndex + 1);
+    QString tmpSvgPath = svgPath + ".tmp";
+
+    QFile file(tmpSvgPath);
+
+    if (svg.isEmpty() || !file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+            || file.write(svg) != svg.size() || !UBFileSystemUtils::syncFile(file))
+    {
+        return false;
+    }
+
+    file.close();
+
+    if (!UBFileSystemUtils::replaceFile(tmpSvgPath, svgPath))
+        return false;
+
+    // generated again when the document is shown
+    QFile::remove(lastRecord.documentPath + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", targetIndex + 1));
+
+    return true;
+}
+
+
+int UBDocumentJournal::recoverDocuments()
+{
+    UB_TRACE_SCOPE("journal.recover", "autosave");
+
+    int recoveredPageCount = 0;
+
+    QDir dir(journalDirectory());
+
+    foreach(QFileInfo journal, dir.entryInfoList(QStringList() << "*.journal", QDir::Files))
+    {
+        QMap<QString, QList<Record> > pendingRecords;
+
+        foreach(Record record, readJournal(journal.absoluteFilePath()))
+        {
+            QString sceneUuid = record.sceneUuid.toString();
+
+            if (record.type == SceneChanged)
+                pendingRecords.insert(sceneUuid, QList<Record>() << record);
+            else if (record.type == InkChanged && pendingRecords.contains(sceneUuid))
+                pendingRecords[sceneUuid] << record;
+            else
+                pendingRecords.remove(sceneUuid);
+        }
+
+        foreach(QList<Record> records, pendingRecords)
+        {
+            Record record = records.last();
+
+            if (!QFileInfo(record.documentPath).isDir())
+                continue;
+
+            if (recoverPage(records))
+            {
+                qWarning() << "recovered page" << record.pageIndex + 1 << "of" << record.documentPath;
+                recoveredPageCount++;
+            }
+            else
+            {
+                qWarning() << "cannot recover page" << record.pageIndex + 1 << "of" << record.documentPath;
+            }
+        }
+
+        QFile::remove(journal.absoluteFilePath());
+    }
+
+    return recoveredPageCount;
+}
+
+
+void UBDocumentJournal::journalActiveScene()
+{
+    UBBoardController* boardController = UBApplication::boardController;
+
+    if (!boardController)
+        return;
+
+    UBDocumentProxy* document = boardController->activeDocument();
+    UBGraphicsScene* scene = boardController->activeScene();
+    int index = boardController->activeSceneIndex();
+
+    if (!document || !scene || index < 0 || !scene->isModified())
+        return;
+
+    if (scene == mJournaledScene && scene->changeCount() == mJournaledChangeCount)
+        return;
+
+    UB_TRACE_SCOPE("journal.scene", "autosave");
+
+    Record record;
+    record.documentPath = document->persistencePath();
+    record.pageIndex = index;
+    record.sceneUuid = scene->uuid();
+
+    QString sceneUuid = record.sceneUuid.toString();
+    int otherChangeCount = scene->changeCount() - scene->inkChangeCount();
+
+    // the ink changes are journaled against the last snapshot of the page
+    bool snapshot = scene != mJournaledScene
+            || otherChangeCount != mJournaledOtherChangeCount
+            || !mPendingRecords.value(record.documentPath).contains(sceneUuid)
+            || mPendingRecords.value(record.documentPath).value(sceneUuid).size() > maxPageRecordsSize;
+
+    mJournaledScene = scene;
+    mJournaledChangeCount = scene->changeCount();
+    mJournaledOtherChangeCount = otherChangeCount;
+
+    if (snapshot)
+    {
+        record.type = SceneChanged;
+        record.svg = qCompress(UBSvgSubsetAdaptor::sceneSvg(document, scene, index, false));
+
+        mJournaledInkIds.clear();
+        mJournaledStrokes.clear();
+    }
+    else
+    {
+        record.type = InkChanged;
+    }
+
+    QSet<quint32> inkIds;
+
+    foreach(QGraphicsItem* item, scene->itemsInZOrder())
+    {
+        UBGraphicsPolygonItem* polygonItem = qgraphicsitem_cast<UBGraphicsPolygonItem*>(item);
+
+        if (!polygonItem || !polygonItem->isVisible() || item->scene() != scene)
+            continue;
+
+        // the id follows the polygon when it is removed and added again (undo, redo)
+        quint32 id = polygonItem->data(UBGraphicsItemData::ItemJournalId).toUInt();
+
+        if (id == 0)
+        {
+            id = ++mLastInkId;
+            polygonItem->setData(UBGraphicsItemData::ItemJournalId, id);
+        }
+
+        inkIds << id;
+
+        if (mJournaledInkIds.contains(id))
+            continue;
+
+        int strokeIndex = 0;
+
+        if (polygonItem->stroke())
+        {
+            if (!mJournaledStrokes.contains(polygonItem->stroke()))
+                mJournaledStrokes.insert(polygonItem->stroke(), mJournaledStrokes.size() + 1);
+
+            strokeIndex = mJournaledStrokes.value(polygonItem->stroke());
+        }
+
+        record.inkIds << id;
+        UBBinaryPageAdaptor::appendPolygon(record.ink, polygonItem, strokeIndex);
+    }
+
+    foreach(quint32 id, mJournaledInkIds)
+    {
+        if (!inkIds.contains(id))
+            record.removedInkIds << id;
+    }
+
+    mJournaledInkIds = inkIds;
+
+    if (!snapshot && record.inkIds.isEmpty() && record.removedInkIds.isEmpty())
+        return;
+
+    QByteArray data = encode(record);
+
+    if (snapshot)
+        mPendingRecords[record.documentPath].insert(sceneUuid, data);
+    else
+        mPendingRecords[record.documentPath][sceneUuid] += data;
+
+    append(record.documentPath, data);
+}
+
+
+void UBDocumentJournal::append(const QString& pDocumentPath, const QByteArray& pRecord)
+{
+    QString journalPath = journalFilePath(pDocumentPath);
+
+    if (mJournalSizes.value(pDocumentPath) + pRecord.size() > maxJournalSize)
+    {
+        QByteArray data;
+
+        foreach(QByteArray record, mPendingRecords.value(pDocumentPath))
+            data += record;
+
+        mThreadPool.start(new UBDocumentJournalTask(UBDocumentJournalTask::Replace, journalPath, data));
+        mJournalSizes.insert(pDocumentPath, data.size());
+    }
+    else
+    {
+        mThreadPool.start(new UBDocumentJournalTask(UBDocumentJournalTask::Append, journalPath, pRecord));
+        mJournalSizes[pDocumentPath] += pRecord.size();
+
+        mUnsyncedJournals << journalPath;
+
+        if (!mSyncTimer.isActive())
+            mSyncTimer.start();
+    }
+}
+
+
+void UBDocumentJournal::sync()
+{
+    mSyncTimer.stop();
+
+    foreach(QString journalPath, mUnsyncedJournals)
+        mThreadPool.start(new UBDocumentJournalTask(UBDocumentJournalTask::Sync, journalPath));
+
+    mUnsyncedJournals.clear();
+}
+
+
+void UBDocumentJournal::drop(const QString& pDocumentPath)
+{
+    QString journalPath = journalFilePath(pDocumentPath);
+
+    mPendingRecords.remove(pDocumentPath);
+    mJournalSizes.remove(pDocumentPath);
+    mUnsyncedJournals.remove(journalPath);
+
+    mThreadPool.start(new UBDocumentJournalTask(UBDocumentJournalTask::Remove, journalPath));
+}
+
+
+void UBDocumentJournal::documentScenePersisted(UBDocumentProxy* pDocument, int pIndex)
+{
+    QString documentPath = pDocument->persistencePath();
+
+    if (!mPendingRecords.contains(documentPath))
+        return;
+
+    Record record;
+    record.type = ScenePersisted;
+    record.documentPath = documentPath;
+    record.pageIndex = pIndex;
+    record.sceneUuid = UBSvgSubsetAdaptor::sceneUuid(pDocument, pIndex);
+
+    mPendingRecords[documentPath].remove(record.sceneUuid.toString());
+
+    // the next changes of the page start from a new snapshot
+    if (mJournaledScene && mJournaledScene->uuid() == record.sceneUuid)
+        mJournaledScene = 0;
+
+    if (mPendingRecords.value(documentPath).isEmpty())
+        drop(documentPath);
+    else
+        append(documentPath, encode(record));
+}
+
+
+void UBDocumentJournal::documentWillBeDeleted(UBDocumentProxy* pDocument)
+{
+    if (mPendingRecords.contains(pDocument->persistencePath()))
+        drop(pDocument->persistencePath());
+}
@@ -0,0 +1,110 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBDOCUMENTJOURNAL_H_
+#define UBDOCUMENTJOURNAL_H_
+
+#include <QtCore>
+
+#include "adaptors/UBBinaryPageAdaptor.h"
+
+class UBDocumentProxy;
+class UBGraphicsScene;
+class UBGraphicsStroke;
+
+/**
+ * Append only journal of the pages modified on the board and not persisted yet, one file per
+ * document in the data directory.
+ *
+ * The active page is journaled at most once a second while it changes, the journals are synced
+ * to disk at most every two seconds, and dropped once all their pages are persisted. A journal
+ * found at startup is the trace of a crash: its pages are written back into their document
+ * before the documents are loaded.
+ *
+ * A page is journaled as a snapshot, its svg without the ink and its ink in the binary page
+ * encoding; while only ink is drawn or erased, the next records hold the polygons added and the
+ * ones removed since, so that drawing does not serialize the page again each second.
+ */
+class UBDocumentJournal : public QObject
+{
+    Q_OBJECT;
+
+    public:
+        static UBDocumentJournal* documentJournal();
+        virtual ~UBDocumentJournal();
+
+        // returns the number of pages recovered
+        static int recoverDocuments();
+
+    private slots:
+        void journalActiveScene();
+        void sync();
+
+        void documentScenePersisted(UBDocumentProxy* pDocument, int pIndex);
+        void documentWillBeDeleted(UBDocumentProxy* pDocument);
+
+    private:
+        UBDocumentJournal(QObject *pParent = 0);
+
+        enum RecordType
+        {
+            SceneChanged = 1, ScenePersisted, InkChanged
+        };
+
+        struct Record
+        {
+            RecordType type;
+            QString documentPath;
+            qint32 pageIndex;
+            QUuid sceneUuid;
+            QByteArray svg; // compressed, without the ink
+            QList<quint32> inkIds; // of the polygons in ink
+            UBBinaryPageAdaptor::Ink ink; // all the polygons of a snapshot, the added ones otherwise
+            QList<quint32> removedInkIds;
+        };
+
+        static QString journalDirectory();
+        static QString journalFilePath(const QString& pDocumentPath);
+
+        static QByteArray encode(const Record& pRecord);
+        static QList<Record> readJournal(const QString& pJournalPath);
+        // a snapshot and the ink changes which followed it
+        static bool recoverPage(const QList<Record>& pRecords);
+
+        void append(const QString& pDocumentPath, const QByteArray& pRecord);
+        void drop(const QString& pDocumentPath);
+
+        static UBDocumentJournal* sDocumentJournal;
+
+        // one thread, the writes to a journal are kept in order
+        QThreadPool mThreadPool;
+
+        QTimer mJournalTimer;
+        QTimer mSyncTimer;
+
+        QPointer<UBGraphicsScene> mJournaledScene;
+        int mJournaledChangeCount;
+        int mJournaledOtherChangeCount; // the changes which were not only ink
+        QSet<quint32> mJournaledInkIds;
+        QHash<UBGraphicsStroke*, int> mJournaledStrokes;
+        quint32 mLastInkId;
+
+        // last snapshot and ink changes of the pages not persisted yet by document and scene uuid, what a compacted journal holds
+        QHash<QString, QHash<QString, QByteArray> > mPendingRecords;
+        QHash<QString, qint64> mJournalSizes;
+        QSet<QString> mUnsyncedJournals;
+};
+
+#endif /* UBDOCUMENTJOURNAL_H_ */
@@ -36,6 +36,7 @@
 #include "UBApplication.h"
 #include "UBSettings.h"
 #include "UBPersistenceManager.h"
+#include "UBImageImporter.h"
 
 #include "core/memcheck.h"
 #include "../adaptors/UBExportWeb.h"
@@ -157,7 +158,7 @@ bool UBDocumentManager::addFileToDocument(UBDocumentProxy* pDocument, const QFil
 }
 
 
-int UBDocumentManager::addImageDirToDocument(const QDir& pDir, UBDocumentProxy* pDocument)
+QStringList UBDocumentManager::imageDirFiles(const QDir& pDir)
 {
     QStringList filenames = pDir.entryList(QDir::Files | QDir::NoDotAndDotDot);
 
@@ -170,8 +171,30 @@ int UBDocumentManager::addImageDirToDocument(const QDir& pDir, UBDocumentProxy*
         fullPathFilenames << pDir.absolutePath() + "/" + f;
     }
 
-    return addImageAsPageToDocument(fullPathFilenames, pDocument);
+    return fullPathFilenames;
+}
+
+
+int UBDocumentManager::addImageDirToDocument(const QDir& pDir, UBDocumentProxy* pDocument)
+{
+    return addImageAsPageToDocument(imageDirFiles(pDir), pDocument);
+}
+
+
+UBImageImporter* UBDocumentManager::addImageDirToDocumentInBackground(const QDir& pDir, UBDocumentProxy* pDocument)
+{
+    return addImageAsPageToDocumentInBackground(imageDirFiles(pDir), pDocument);
+}
+
+
+UBImageImporter* UBDocumentManager::addImageAsPageToDocumentInBackground(const QStringList& filenames, UBDocumentProxy* pDocument)
+{
+    UBImageImporter* importer = new UBImageImporter(pDocument, filenames, this);
+
+    // started by the caller's event loop, once it is connected to the importer
+    QTimer::singleShot(0, importer, SLOT(start()));
 
+    return importer;
 }
 
 
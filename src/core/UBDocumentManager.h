@@ -21,6 +21,7 @@
 class UBExportAdaptor;
 class UBImportAdaptor;
 class UBDocumentProxy;
+class UBImageImporter;
 
 
 class UBDocumentManager : public QObject
@@ -43,6 +44,10 @@ class UBDocumentManager : public QObject
 
         int addImageAsPageToDocument(const QStringList& images, UBDocumentProxy* document);
 
+        // the pages are added as the images are decoded, the importer emits finished() and deletes itself
+        UBImageImporter* addImageDirToDocumentInBackground(const QDir& pDir, UBDocumentProxy* pDocument);
+        UBImageImporter* addImageAsPageToDocumentInBackground(const QStringList& images, UBDocumentProxy* document);
+
         QList<UBExportAdaptor*> supportedExportAdaptors();
         void emitDocumentUpdated(UBDocumentProxy* pDocument);
 
@@ -51,6 +56,8 @@ class UBDocumentManager : public QObject
 
     private:
         UBDocumentManager(QObject *parent = 0);
+        QStringList imageDirFiles(const QDir& pDir);
+
         QList<UBExportAdaptor*> mExportAdaptors;
         QList<UBImportAdaptor*> mImportAdaptors;
 
@@ -0,0 +1,369 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBImageImporter.h"
+
+#include "core/UBApplication.h"
+#include "core/UBSettings.h"
+#include "core/UBPersistenceManager.h"
+
+#include "document/UBDocumentProxy.h"
+
+#include "domain/UBGraphicsScene.h"
+#include "domain/UBGraphicsPixmapItem.h"
+
+#include "frameworks/UBFileSystemUtils.h"
+#include "frameworks/UBTrace.h"
+
+#include "core/memcheck.h"
+
+// decoded images waiting for their page, per worker thread, bounds the memory used when an image is slow to decode
+static const int decodedImagesPerThread = 2;
+
+class UBImageDecodeTask : public QRunnable
+{
+    public:
+        UBImageDecodeTask(UBImageImporter* pImporter, int pIndex, const QString& pFileName,
+                const QString& pDocumentPath, const QSize& pNominalSize, int pMaxResolution)
+            : mImporter(pImporter)
+            , mIndex(pIndex)
+            , mFileName(pFileName)
+            , mDocumentPath(pDocumentPath)
+            , mNominalSize(pNominalSize)
+            , mMaxResolution(pMaxResolution)
+        {
+            // NOOP
+        }
+
+        virtual void run()
+        {
+            UBImageImporter::Decoded result;
+
+            if (!mImporter->isCancelled())
+                decode(result);
+
+            mImporter->decoded(mIndex, result);
+        }
+
+    private:
+        void decode(UBImageImporter::Decoded& pResult)
+        {
+            UB_TRACE_SCOPE("import.image.decode", "import");
+
+            if (mFileName.endsWith(".svg") || mFileName.endsWith(".svgz"))
+            {
+                // svg pages are built by the scene, on the GUI thread
+                pResult.failed = false;
+                pResult.isSvg = true;
+                return;
+            }
+
+            QImageReader reader(mFileName);
+            QSize size = reader.size();
+
+            // formats supporting it (jpeg) decode directly at the reduced size
+            if (mMaxResolution > 0 && size.isValid() && (size.width() > mMaxResolution || size.height() > mMaxResolution))
+                reader.setScaledSize(size.scaled(mMaxResolution, mMaxResolution, Qt::KeepAspectRatio));
+
+            QImage image = reader.read();
+
+            if (image.isNull())
+                return;
+
+            if (mMaxResolution > 0 && (image.width() > mMaxResolution || image.height() > mMaxResolution))
+                image = image.scaled(mMaxResolution, mMaxResolution, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+            QUuid uuid = QUuid::createUuid();
+
+            // same name as the one written with the page, the svg writer finds the image already there
+            QDir().mkpath(mDocumentPath + "/" + UBPersistenceManager::imageDirectory);
+            QString imagePath = mDocumentPath + "/" + UBPersistenceManager::imageDirectory + "/" + uuid.toString() + ".png";
+
+            if (!image.save(imagePath, "PNG"))
+            {
+                QFile::remove(imagePath);
+                return;
+            }
+
+            pResult.failed = false;
+            pResult.image = image;
+            pResult.uuid = uuid;
+            pResult.thumbnailPath = writeThumbnail(image, uuid);
+        }
+
+        // same rendering as UBThumbnailAdaptor for a page holding only the image as background object
+        QString writeThumbnail(const QImage& pImage, const QUuid& pUuid)
+        {
+            if (!mNominalSize.isValid())
+                return QString();
+
+            qreal ratio = (qreal)mNominalSize.width() / mNominalSize.height();
+            qreal width = UBSettings::maxThumbnailWidth;
+            qreal height = width / ratio;
+
+            QImage thumb(width, height, QImage::Format_ARGB32);
+            thumb.fill(QColor(Qt::white).rgb());
+
+            qreal fitRatio = qMin((qreal)mNominalSize.width() / pImage.width(), (qreal)mNominalSize.height() / pImage.height());
+            qreal imageScale = qMin((qreal)1.0, fitRatio) * width / mNominalSize.width();
+
+            QSizeF imageSize = QSizeF(pImage.size()) * imageScale;
+            QRectF imageRect(QPointF((width - imageSize.width()) / 2, (height - imageSize.height()) / 2), imageSize);
+
+            QPainter painter(&thumb);
+            painter.setRenderHint(QPainter::Antialiasing, true);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+            painter.drawImage(imageRect, pImage);
+            painter.end();
+
+            QString thumbnailPath = mDocumentPath + "/" + pUuid.toString() + ".thumbnail.jpg";
+
+            if (!thumb.save(thumbnailPath, "JPG"))
+            {
+                QFile::remove(thumbnailPath);
+                return QString();
+            }
+
+            return thumbnailPath;
+        }
+
+        UBImageImporter* mImporter;
+        int mIndex;
+        QString mFileName;
+        QString mDocumentPath;
+        QSize mNominalSize;
+        int mMaxResolution;
+};
+
+
+UBImageImporter::UBImageImporter(UBDocumentProxy* pDocument, const QStringList& pFileNames, QObject *pParent)
+    : QObject(pParent)
+    , mDocument(pDocument)
+    , mFileNames(pFileNames)
+    , mSubmittedCount(0)
+    , mNextIndex(0)
+    , mPageIndex(0)
+    , mImportedCount(0)
+    , mFinished(false)
+    , mCancelled(0)
+{
+    connect(UBPersistenceManager::persistenceManager(), SIGNAL(documentWillBeDeleted(UBDocumentProxy*)),
+            this, SLOT(documentWillBeDeleted(UBDocumentProxy*)));
+}
+
+
+UBImageImporter::~UBImageImporter()
+{
+    mCancelled = 1;
+    mThreadPool.waitForDone();
+
+    foreach(Decoded decoded, mDecoded)
+        discard(decoded);
+}
+
+
+void UBImageImporter::start()
+{
+    mPageIndex = mDocument->pageCount();
+
+    if (mPageIndex == 1 && UBPersistenceManager::persistenceManager()->loadDocumentScene(mDocument, 0)->isEmpty())
+    {
+        mPageIndex = 0;
+    }
+
+    submitTasks();
+
+    if (mFileNames.isEmpty())
+        finish();
+}
+
+
+void UBImageImporter::cancel()
+{
+    if (mFinished)
+        return;
+
+    mCancelled = 1;
+
+    // the running tasks only finish their current image
+    mThreadPool.waitForDone();
+
+    QMutexLocker locker(&mMutex);
+
+    foreach(Decoded decoded, mDecoded)
+        discard(decoded);
+
+    mDecoded.clear();
+
+    locker.unlock();
+
+    finish();
+}
+
+
+void UBImageImporter::decoded(int pIndex, const Decoded& pDecoded)
+{
+    QMutexLocker locker(&mMutex);
+
+    if (mCancelled != 0)
+    {
+        discard(pDecoded);
+        return;
+    }
+
+    mDecoded.insert(pIndex, pDecoded);
+
+    locker.unlock();
+
+    QMetaObject::invokeMethod(this, "commitDecoded", Qt::QueuedConnection);
+}
+
+
+void UBImageImporter::submitTasks()
+{
+    int window = qMax(1, mThreadPool.maxThreadCount()) * decodedImagesPerThread;
+    int maxResolution = UBSettings::settings()->importImageMaxResolution->get().toInt();
+
+    while (mSubmittedCount < mFileNames.size() && mSubmittedCount < mNextIndex + window)
+    {
+        mThreadPool.start(new UBImageDecodeTask(this, mSubmittedCount, mFileNames.at(mSubmittedCount),
+                mDocument->persistencePath(), mDocument->defaultDocumentSize(), maxResolution));
+
+        mSubmittedCount++;
+    }
+}
+
+
+void UBImageImporter::commitDecoded()
+{
+    while (mCancelled == 0 && !mFinished)
+    {
+        QMutexLocker locker(&mMutex);
+
+        if (!mDecoded.contains(mNextIndex))
+            break;
+
+        Decoded decoded = mDecoded.take(mNextIndex);
+
+        locker.unlock();
+
+        commit(mNextIndex, decoded);
+
+        mNextIndex++;
+
+        emit progress(mNextIndex, mFileNames.size());
+
+        if (mNextIndex == mFileNames.size())
+            finish();
+        else
+            submitTasks();
+    }
+}
+
+
+void UBImageImporter::commit(int pIndex, const Decoded& pDecoded)
+{
+    UB_TRACE_SCOPE("import.image.commit", "import");
+
+    if (pDecoded.failed)
+    {
+        UBApplication::showMessage(tr("Erronous image data, skipping file %1").arg(mFileNames.at(pIndex)));
+        return;
+    }
+
+    UBPersistenceManager* persistenceManager = UBPersistenceManager::persistenceManager();
+    UBGraphicsScene* scene = 0;
+
+    if (mPageIndex == 0)
+    {
+        scene = persistenceManager->loadDocumentScene(mDocument, mPageIndex);
+    }
+    else
+    {
+        scene = persistenceManager->createDocumentSceneAt(mDocument, mPageIndex);
+    }
+
+    scene->setBackground(false, false);
+
+    QGraphicsItem* gi = 0;
+
+    if (pDecoded.isSvg)
+    {
+        gi = scene->addSvg(QUrl::fromLocalFile(mFileNames.at(pIndex)), QPointF(0, 0));
+    }
+    else
+    {
+        UBGraphicsPixmapItem* pixmapItem = scene->addPixmap(QPixmap::fromImage(pDecoded.image), QPointF(0, 0));
+        pixmapItem->setUuid(pDecoded.uuid);
+        gi = pixmapItem;
+    }
+
+    if (!gi)
+    {
+        discard(pDecoded);
+        return;
+    }
+
+    scene->setAsBackgroundObject(gi, true);
+
+    bool thumbnailWritten = false;
+
+    if (!pDecoded.thumbnailPath.isEmpty())
+    {
+        if (scene->nominalSize() == mDocument->defaultDocumentSize())
+        {
+            thumbnailWritten = UBFileSystemUtils::replaceFile(pDecoded.thumbnailPath, mDocument->persistencePath()
+                    + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", mPageIndex + 1));
+        }
+
+        if (!thumbnailWritten)
+            QFile::remove(pDecoded.thumbnailPath);
+    }
+
+    persistenceManager->persistDocumentScene(mDocument, scene, mPageIndex, !thumbnailWritten);
+
+    mPageIndex++;
+    mImportedCount++;
+}
+
+
+void UBImageImporter::discard(const Decoded& pDecoded)
+{
+    if (!pDecoded.uuid.isNull())
+        QFile::remove(mDocument->persistencePath() + "/" + UBPersistenceManager::imageDirectory + "/" + pDecoded.uuid.toString() + ".png");
+
+    if (!pDecoded.thumbnailPath.isEmpty())
+        QFile::remove(pDecoded.thumbnailPath);
+}
+
+
+void UBImageImporter::finish()
+{
+    if (mFinished)
+        return;
+
+    mFinished = true;
+
+    emit finished(mDocument, mImportedCount, mCancelled != 0);
+
+    deleteLater();
+}
+
+
+void UBImageImporter::documentWillBeDeleted(UBDocumentProxy* pDocument)
+{
+    if (pDocument == mDocument)
+        cancel();
+}
@@ -0,0 +1,114 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBIMAGEIMPORTER_H_
+#define UBIMAGEIMPORTER_H_
+
+#include <QtGui>
+
+class UBDocumentProxy;
+
+/**
+ * Adds a list of images as pages of a document without blocking the user interface.
+ *
+ * Worker threads decode the images, downscale them to the maximum page resolution and
+ * write the image and the page thumbnail. The pages are created on the GUI thread in the
+ * order of the list, as soon as the next image is ready. A cancelled import keeps the pages
+ * already created and removes everything written for the others.
+ */
+class UBImageImporter : public QObject
+{
+    Q_OBJECT;
+
+    public:
+        UBImageImporter(UBDocumentProxy* pDocument, const QStringList& pFileNames, QObject *pParent = 0);
+        virtual ~UBImageImporter();
+
+        UBDocumentProxy* document() const
+        {
+            return mDocument;
+        }
+
+        int imageCount() const
+        {
+            return mFileNames.size();
+        }
+
+        int importedCount() const
+        {
+            return mImportedCount;
+        }
+
+        struct Decoded
+        {
+            Decoded()
+                : failed(true)
+                , isSvg(false)
+            {
+                // NOOP
+            }
+
+            bool failed;
+            bool isSvg;
+            QImage image;
+            QUuid uuid;
+            QString thumbnailPath;
+        };
+
+        // called from the worker threads
+        void decoded(int pIndex, const Decoded& pDecoded);
+
+        bool isCancelled() const
+        {
+            return mCancelled != 0;
+        }
+
+    public slots:
+        void start();
+        void cancel();
+
+    signals:
+        void progress(int pCurrent, int pTotal);
+
+        // emitted once, the importer deletes itself afterwards
+        void finished(UBDocumentProxy* pDocument, int pImportedCount, bool pCancelled);
+
+    private slots:
+        void commitDecoded();
+        void documentWillBeDeleted(UBDocumentProxy* pDocument);
+
+    private:
+        void submitTasks();
+        void commit(int pIndex, const Decoded& pDecoded);
+        void discard(const Decoded& pDecoded);
+        void finish();
+
+        UBDocumentProxy* mDocument;
+        QStringList mFileNames;
+
+        QThreadPool mThreadPool;
+        QMutex mMutex;
+        QMap<int, Decoded> mDecoded;
+
+        int mSubmittedCount;
+        int mNextIndex;
+        int mPageIndex;
+        int mImportedCount;
+        bool mFinished;
+
+        QAtomicInt mCancelled;
+};
+
+#endif /* UBIMAGEIMPORTER_H_ */
@@ -19,6 +19,7 @@
 
 #include "core/UBApplication.h"
 #include "domain/UBItem.h"
+#include "domain/UBGraphicsTextItem.h"
 
 #include "core/memcheck.h"
 
@@ -46,9 +47,11 @@ UBMimeData::~UBMimeData()
     // NOOP
 }
 
-UBMimeDataGraphicsItem::UBMimeDataGraphicsItem(QList<UBItem*> pItems)
+UBMimeDataGraphicsItem::UBMimeDataGraphicsItem(QList<UBItem*> pItems, const QString& pSourceDocumentPath)
+    : mItems(pItems)
+    , mSourceDocumentPath(pSourceDocumentPath)
 {
-        mItems = pItems;
+    // NOOP
 }
 
 UBMimeDataGraphicsItem::~UBMimeDataGraphicsItem()
@@ -56,3 +59,119 @@ UBMimeDataGraphicsItem::~UBMimeDataGraphicsItem()
         foreach(UBItem* item, mItems)
             delete item;
 }
+
+QStringList UBMimeDataGraphicsItem::formats() const
+{
+    QStringList result = QMimeData::formats();
+
+    // the image is only rendered on request, a selection of widgets and media has none to offer
+    QRectF bounds;
+    imageItems(bounds);
+
+    if (!imageSize(bounds).isEmpty())
+        result << "application/x-qt-image";
+
+    if (!itemsText().isEmpty())
+        result << "text/plain";
+
+    return result;
+}
+
+QVariant UBMimeDataGraphicsItem::retrieveData(const QString& mimeType, QVariant::Type preferredType) const
+{
+    if (mimeType == "application/x-qt-image")
+    {
+        if (mRenderedImage.isNull())
+            mRenderedImage = renderImage();
+
+        return mRenderedImage;
+    }
+    else if (mimeType == "text/plain")
+    {
+        return itemsText();
+    }
+
+    return QMimeData::retrieveData(mimeType, preferredType);
+}
+
+static const int maxImageSide = 4096;
+
+QMultiMap<qreal, QGraphicsItem*> UBMimeDataGraphicsItem::imageItems(QRectF& pBounds) const
+{
+    QMultiMap<qreal, QGraphicsItem*> itemsByZ;
+    pBounds = QRectF();
+
+    foreach(UBItem* item, mItems)
+    {
+        QGraphicsItem* gi = dynamic_cast<QGraphicsItem*>(item);
+
+        // proxied widgets (media, widgets) can only be rendered inside a scene
+        if (gi && !gi->isWidget())
+        {
+            itemsByZ.insert(gi->zValue(), gi);
+            pBounds |= gi->sceneBoundingRect();
+        }
+    }
+
+    return itemsByZ;
+}
+
+QSize UBMimeDataGraphicsItem::imageSize(const QRectF& pBounds)
+{
+    if (pBounds.isEmpty())
+        return QSize();
+
+    qreal scale = qMin((qreal)1.0, maxImageSide / qMax(pBounds.width(), pBounds.height()));
+
+    return (pBounds.size() * scale).toSize();
+}
+
+QImage UBMimeDataGraphicsItem::renderImage() const
+{
+    QRectF bounds;
+    QMultiMap<qreal, QGraphicsItem*> itemsByZ = imageItems(bounds);
+    QSize size = imageSize(bounds);
+
+    if (size.isEmpty())
+        return QImage();
+
+    qreal scale = qMin((qreal)1.0, maxImageSide / qMax(bounds.width(), bounds.height()));
+
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    QTransform toImage = QTransform::fromTranslate(-bounds.left(), -bounds.top()) * QTransform::fromScale(scale, scale);
+
+    foreach(QGraphicsItem* gi, itemsByZ)
+    {
+        QStyleOptionGraphicsItem option;
+        option.exposedRect = gi->boundingRect();
+        option.rect = option.exposedRect.toAlignedRect();
+
+        painter.save();
+        painter.setTransform(gi->sceneTransform() * toImage);
+        gi->paint(&painter, &option, 0);
+        painter.restore();
+    }
+
+    return image;
+}
+
+QString UBMimeDataGraphicsItem::itemsText() const
+{
+    QStringList texts;
+
+    foreach(UBItem* item, mItems)
+    {
+        UBGraphicsTextItem* textItem = dynamic_cast<UBGraphicsTextItem*>(item);
+
+        if (textItem && !textItem->toPlainText().isEmpty())
+            texts << textItem->toPlainText();
+    }
+
+    return texts.join("\n");
+}
@@ -36,18 +36,46 @@ struct UBMimeDataItem
 };
 
 
+/**
+ * Items copied on the board.
+ *
+ * The items are snapshots (deep copies that never enter a scene) whose pixmaps, polygons
+ * and SVG renderers are shared with the copied items, pasting them inside the application
+ * costs a deep copy per item. Other applications are offered an image and the text of the
+ * items, which are only rendered when they ask for them.
+ */
 class UBMimeDataGraphicsItem : public QMimeData
 {
     Q_OBJECT;
 
     public:
-            UBMimeDataGraphicsItem(QList<UBItem*> pItems);
+            UBMimeDataGraphicsItem(QList<UBItem*> pItems, const QString& pSourceDocumentPath = QString());
         virtual ~UBMimeDataGraphicsItem();
 
         QList<UBItem*> items() const { return mItems; }
 
+        // the files referenced by the items (images, videos ...) are found in this document
+        QString sourceDocumentPath() const { return mSourceDocumentPath; }
+
+        virtual QStringList formats() const;
+
+    protected:
+
+        virtual QVariant retrieveData(const QString& mimeType, QVariant::Type preferredType) const;
+
     private:
+
+        // the items drawn into the image by z value, pBounds gets their scene bounds
+        QMultiMap<qreal, QGraphicsItem*> imageItems(QRectF& pBounds) const;
+        // empty when there is nothing to draw
+        static QSize imageSize(const QRectF& pBounds);
+        QImage renderImage() const;
+        QString itemsText() const;
+
         QList<UBItem*> mItems;
+        QString mSourceDocumentPath;
+
+        mutable QImage mRenderedImage;
 
 };
 
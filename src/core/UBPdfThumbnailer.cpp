@@ -0,0 +1,386 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBPdfThumbnailer.h"
+
+#include <QtGui>
+
+#include "core/UBApplication.h"
+#include "core/UBSettings.h"
+#include "core/UBPersistenceManager.h"
+
+#include "board/UBBoardController.h"
+
+#include "document/UBDocumentProxy.h"
+
+#include "adaptors/UBSvgSubsetAdaptor.h"
+
+#include "frameworks/UBFileSystemUtils.h"
+#include "frameworks/UBTrace.h"
+
+#include "pdf/XPDFRenderer.h"
+
+#include "core/memcheck.h"
+
+UBPdfThumbnailer* UBPdfThumbnailer::sPdfThumbnailer = 0;
+
+class UBPdfThumbnailTask : public QRunnable
+{
+    public:
+        UBPdfThumbnailTask(UBPdfThumbnailer* pThumbnailer)
+            : mThumbnailer(pThumbnailer)
+            , mRenderer(0)
+        {
+            // NOOP
+        }
+
+        virtual ~UBPdfThumbnailTask()
+        {
+            // deleted by the pool on the worker thread, like the renderer was created
+            delete mRenderer;
+        }
+
+        virtual void run()
+        {
+            UBPdfThumbnailer::Job job;
+
+            while (mThumbnailer->takeJob(job))
+                mThumbnailer->rendered(job, render(job));
+        }
+
+    private:
+        // same rendering as UBThumbnailAdaptor for a page holding only the PDF page as background object
+        QString render(const UBPdfThumbnailer::Job& pJob)
+        {
+            UB_TRACE_SCOPE("import.pdf.thumbnail", "import");
+
+            // the pages of a PDF come one after the other, the renderer is kept for the next ones
+            if (!mRenderer || mRendererPath != pJob.pdfPath)
+            {
+                delete mRenderer;
+                mRenderer = new XPDFRenderer(pJob.pdfPath);
+                mRendererPath = pJob.pdfPath;
+            }
+
+            if (!mRenderer->isValid() || pJob.pdfPageNumber > mRenderer->pageCount())
+                return QString();
+
+            QSizeF pageSize = mRenderer->pageSizeF(pJob.pdfPageNumber);
+
+            if (pageSize.isEmpty())
+                return QString();
+
+            qreal width = UBSettings::maxThumbnailWidth;
+            qreal height = width * pageSize.height() / pageSize.width();
+
+            QImage thumb(width, height, QImage::Format_ARGB32);
+            thumb.fill(QColor(Qt::white).rgb());
+
+            QPainter painter(&thumb);
+            painter.setRenderHint(QPainter::Antialiasing, true);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+            painter.scale(width / pageSize.width(), height / pageSize.height());
+
+            mRenderer->render(&painter, pJob.pdfPageNumber);
+
+            painter.end();
+
+            QString thumbnailPath = pJob.documentPath + "/" + pJob.sceneUuid + ".thumbnail.jpg";
+
+            if (!thumb.save(thumbnailPath, "JPG"))
+            {
+                QFile::remove(thumbnailPath);
+                return QString();
+            }
+
+            return thumbnailPath;
+        }
+
+        UBPdfThumbnailer* mThumbnailer;
+        XPDFRenderer* mRenderer;
+        QString mRendererPath;
+};
+
+
+UBPdfThumbnailer* UBPdfThumbnailer::pdfThumbnailer()
+{
+    if (!sPdfThumbnailer)
+    {
+        sPdfThumbnailer = new UBPdfThumbnailer(qApp);
+    }
+
+    return sPdfThumbnailer;
+}
+
+
+UBPdfThumbnailer::UBPdfThumbnailer(QObject *pParent)
+    : QObject(pParent)
+    , mRunningTasks(0)
+    , mFocusDocument(0)
+    , mFocusIndex(0)
+    , mStopped(0)
+{
+    // the renderer of the worker is its own, the board renders its pages meanwhile; a single
+    // worker keeps the other cores for the import and the board
+    mThreadPool.setMaxThreadCount(1);
+
+    UBPersistenceManager* persistenceManager = UBPersistenceManager::persistenceManager();
+
+    connect(persistenceManager, SIGNAL(documentScenePersisted(UBDocumentProxy*, int)), this, SLOT(documentScenePersisted(UBDocumentProxy*, int)));
+    connect(persistenceManager, SIGNAL(documentWillBeDeleted(UBDocumentProxy*)), this, SLOT(documentWillBeDeleted(UBDocumentProxy*)));
+
+    if (UBApplication::boardController)
+    {
+        connect(UBApplication::boardController, SIGNAL(activeSceneChanged()), this, SLOT(activeSceneChanged()));
+        activeSceneChanged();
+    }
+}
+
+
+UBPdfThumbnailer::~UBPdfThumbnailer()
+{
+    mStopped = 1;
+    mThreadPool.waitForDone();
+
+    QList<Job> unfinished = mJobs;
+
+    for (int i = 0; i < mRendered.size(); i++)
+    {
+        unfinished << mRendered.at(i).first;
+
+        if (!mRendered.at(i).second.isEmpty())
+            QFile::remove(mRendered.at(i).second);
+    }
+
+    // without thumbnail, the pages get theirs from UBThumbnailAdaptor when the document is shown next time
+    foreach(Job job, unfinished)
+    {
+        if (mPendingPages.contains(job.sceneUuid))
+            QFile::remove(job.documentPath + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", job.pageIndex + 1));
+    }
+
+    sPdfThumbnailer = 0;
+}
+
+
+bool UBPdfThumbnailer::writePlaceholder(UBDocumentProxy* pDocument, int pPageIndex, const QSizeF& pPdfPageSize)
+{
+    if (pPdfPageSize.isEmpty())
+        return false;
+
+    qreal width = UBSettings::maxThumbnailWidth;
+    qreal height = width * pPdfPageSize.height() / pPdfPageSize.width();
+
+    // the pages of a PDF mostly share their size, the placeholder is encoded once
+    static QHash<QString, QByteArray> placeholders;
+    QString key = QString("%1x%2").arg((int)width).arg((int)height);
+
+    if (!placeholders.contains(key))
+    {
+        QImage thumb(width, height, QImage::Format_ARGB32);
+        thumb.fill(QColor(Qt::white).rgb());
+
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        thumb.save(&buffer, "JPG");
+
+        placeholders.insert(key, data);
+    }
+
+    QFile file(pDocument->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", pPageIndex + 1));
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QByteArray data = placeholders.value(key);
+    bool written = file.write(data) == data.size();
+    file.close();
+
+    return written;
+}
+
+
+void UBPdfThumbnailer::addPage(UBDocumentProxy* pDocument, int pPageIndex, const QUuid& pSceneUuid, const QString& pPdfPath, int pPdfPageNumber)
+{
+    Job job;
+    job.document = pDocument;
+    job.documentPath = pDocument->persistencePath();
+    job.pageIndex = pPageIndex;
+    job.sceneUuid = pSceneUuid.toString();
+    job.pdfPath = pPdfPath;
+    job.pdfPageNumber = pPdfPageNumber;
+
+    QMutexLocker locker(&mMutex);
+
+    mJobs << job;
+    mPendingPages.insert(job.sceneUuid, pDocument);
+
+    if (mRunningTasks == 0)
+    {
+        mRunningTasks++;
+        mThreadPool.start(new UBPdfThumbnailTask(this));
+    }
+}
+
+
+bool UBPdfThumbnailer::takeJob(Job& pJob)
+{
+    QMutexLocker locker(&mMutex);
+
+    if (mStopped != 0 || mJobs.isEmpty())
+    {
+        mRunningTasks--;
+        return false;
+    }
+
+    // the pages around the one shown on the board first, then in the order of the import
+    int next = 0;
+    int nextDistance = -1;
+
+    for (int i = 0; i < mJobs.size() && mFocusDocument; i++)
+    {
+        if (mJobs.at(i).document != mFocusDocument)
+            continue;
+
+        int distance = qAbs(mJobs.at(i).pageIndex - mFocusIndex);
+
+        if (nextDistance < 0 || distance < nextDistance)
+        {
+            next = i;
+            nextDistance = distance;
+        }
+    }
+
+    pJob = mJobs.takeAt(next);
+
+    return true;
+}
+
+
+void UBPdfThumbnailer::rendered(const Job& pJob, const QString& pThumbnailPath)
+{
+    QMutexLocker locker(&mMutex);
+
+    mRendered << qMakePair(pJob, pThumbnailPath);
+
+    locker.unlock();
+
+    QMetaObject::invokeMethod(this, "commitRendered", Qt::QueuedConnection);
+}
+
+
+void UBPdfThumbnailer::commitRendered()
+{
+    QMutexLocker locker(&mMutex);
+
+    if (mRendered.isEmpty())
+        return;
+
+    QPair<Job, QString> rendered = mRendered.takeFirst();
+    Job job = rendered.first;
+
+    // saved meanwhile with its own thumbnail, or deleted
+    bool pending = mPendingPages.remove(job.sceneUuid) > 0;
+
+    locker.unlock();
+
+    if (rendered.second.isEmpty())
+        return;
+
+    int pageIndex = pending ? currentPageIndex(job) : -1;
+
+    if (pageIndex < 0 || !UBFileSystemUtils::replaceFile(rendered.second, job.documentPath
+            + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", pageIndex + 1)))
+    {
+        QFile::remove(rendered.second);
+        return;
+    }
+
+    emit thumbnailRendered(job.document, pageIndex);
+}
+
+
+int UBPdfThumbnailer::currentPageIndex(const Job& pJob)
+{
+    int pageCount = pJob.document->pageCount();
+
+    if (pJob.pageIndex < pageCount && UBSvgSubsetAdaptor::sceneUuid(pJob.document, pJob.pageIndex).toString() == pJob.sceneUuid)
+        return pJob.pageIndex;
+
+    // moved since the import
+    for (int i = 0; i < pageCount; i++)
+    {
+        if (UBSvgSubsetAdaptor::sceneUuid(pJob.document, i).toString() == pJob.sceneUuid)
+            return i;
+    }
+
+    return -1;
+}
+
+
+void UBPdfThumbnailer::activeSceneChanged()
+{
+    QMutexLocker locker(&mMutex);
+
+    mFocusDocument = UBApplication::boardController->activeDocument();
+    mFocusIndex = UBApplication::boardController->activeSceneIndex();
+}
+
+
+void UBPdfThumbnailer::documentScenePersisted(UBDocumentProxy* pDocument, int pIndex)
+{
+    QMutexLocker locker(&mMutex);
+
+    if (!mPendingPages.values().contains(pDocument))
+        return;
+
+    locker.unlock();
+
+    QString sceneUuid = UBSvgSubsetAdaptor::sceneUuid(pDocument, pIndex).toString();
+
+    locker.relock();
+
+    if (!mPendingPages.remove(sceneUuid))
+        return;
+
+    // the page got its thumbnail with the save
+    for (int i = 0; i < mJobs.size(); i++)
+    {
+        if (mJobs.at(i).sceneUuid == sceneUuid)
+        {
+            mJobs.removeAt(i);
+            break;
+        }
+    }
+}
+
+
+void UBPdfThumbnailer::documentWillBeDeleted(UBDocumentProxy* pDocument)
+{
+    QMutexLocker locker(&mMutex);
+
+    for (int i = mJobs.size() - 1; i >= 0; i--)
+    {
+        if (mJobs.at(i).document == pDocument)
+            mJobs.removeAt(i);
+    }
+
+    foreach(QString sceneUuid, mPendingPages.keys(pDocument))
+        mPendingPages.remove(sceneUuid);
+
+    if (mFocusDocument == pDocument)
+        mFocusDocument = 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBPDFTHUMBNAILER_H_
+#define UBPDFTHUMBNAILER_H_
+
+#include <QtCore>
+
+class UBDocumentProxy;
+
+/**
+ * Renders in the background the thumbnails of the pages imported from a PDF, written with a
+ * placeholder thumbnail so that the import does not wait for xpdf.
+ *
+ * A single worker thread renders the PDF pages with a renderer of its own, which does not wait
+ * for the renderers of the board. The page closest to the one shown
+ * on the board is rendered first, the rendered thumbnail replaces the placeholder on the GUI
+ * thread unless the page was saved with its own thumbnail meanwhile.
+ */
+class UBPdfThumbnailer : public QObject
+{
+    Q_OBJECT;
+
+    public:
+        static UBPdfThumbnailer* pdfThumbnailer();
+        virtual ~UBPdfThumbnailer();
+
+        // writes a blank thumbnail for the page, at the size of the PDF page
+        static bool writePlaceholder(UBDocumentProxy* pDocument, int pPageIndex, const QSizeF& pPdfPageSize);
+
+        // pSceneUuid follows the page if it is moved before its thumbnail is rendered
+        void addPage(UBDocumentProxy* pDocument, int pPageIndex, const QUuid& pSceneUuid, const QString& pPdfPath, int pPdfPageNumber);
+
+        struct Job
+        {
+            UBDocumentProxy* document;
+            QString documentPath;
+            int pageIndex;
+            QString sceneUuid;
+            QString pdfPath;
+            int pdfPageNumber;
+        };
+
+        // called from the worker thread, false once there is nothing left to render
+        bool takeJob(Job& pJob);
+        void rendered(const Job& pJob, const QString& pThumbnailPath);
+
+        bool isStopped() const
+        {
+            return mStopped != 0;
+        }
+
+    signals:
+        void thumbnailRendered(UBDocumentProxy* pDocument, int pPageIndex);
+
+    private slots:
+        void commitRendered();
+        void activeSceneChanged();
+
+        void documentScenePersisted(UBDocumentProxy* pDocument, int pIndex);
+        void documentWillBeDeleted(UBDocumentProxy* pDocument);
+
+    private:
+        UBPdfThumbnailer(QObject *pParent = 0);
+
+        int currentPageIndex(const Job& pJob);
+
+        static UBPdfThumbnailer* sPdfThumbnailer;
+
+        QThreadPool mThreadPool;
+        QMutex mMutex;
+
+        QList<Job> mJobs;
+        QList<QPair<Job, QString> > mRendered;
+        int mRunningTasks;
+
+        // scene uuid of the pages waiting for their thumbnail, queued or being rendered
+        QHash<QString, UBDocumentProxy*> mPendingPages;
+
+        UBDocumentProxy* mFocusDocument;
+        int mFocusIndex;
+
+        QAtomicInt mStopped;
+};
+
+#endif /* UBPDFTHUMBNAILER_H_ */
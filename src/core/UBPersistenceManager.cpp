@@ -24,11 +24,14 @@
 #include "core/UBApplication.h"
 #include "core/UBSettings.h"
 #include "core/UBSetting.h"
+#include "core/UBDocumentDuplicator.h"
+#include "core/UBDocumentJournal.h"
 
 #include "document/UBDocumentProxy.h"
 
 #include "adaptors/UBExportPDF.h"
 #include "adaptors/UBSvgSubsetAdaptor.h"
+#include "adaptors/UBBinaryPageAdaptor.h"
 #include "adaptors/UBThumbnailAdaptor.h"
 #include "adaptors/UBMetadataDcSubsetAdaptor.h"
 
@@ -39,6 +42,7 @@ const QString UBPersistenceManager::objectDirectory = "objects"; // added to UBP
 const QString UBPersistenceManager::widgetDirectory = "widgets"; // added to UBPersistenceManager::mAllDirectories
 const QString UBPersistenceManager::videoDirectory = "videos"; // added to UBPersistenceManager::mAllDirectories
 const QString UBPersistenceManager::audioDirectory = "audios"; // added to
+const QString UBPersistenceManager::videoPosterDirectory = "videoPosters"; // added to UBPersistenceManager::mAllDirectories
 
 UBPersistenceManager * UBPersistenceManager::sSingleton = 0;
 
@@ -52,6 +56,13 @@ UBPersistenceManager::UBPersistenceManager(QObject *pParent)
     mDocumentSubDirectories << widgetDirectory;
     mDocumentSubDirectories << videoDirectory;
     mDocumentSubDirectories << audioDirectory;
+    mDocumentSubDirectories << videoPosterDirectory;
+
+    // the pages modified when the application crashed, before their documents are read
+    int recoveredPageCount = UBDocumentJournal::recoverDocuments();
+
+    if (recoveredPageCount > 0)
+        qWarning() << recoveredPageCount << "pages recovered from the journals";
 
     documentProxies = allDocumentProxies();
     emit proxyListChanged();
@@ -69,6 +80,16 @@ UBPersistenceManager* UBPersistenceManager::persistenceManager()
 
 UBPersistenceManager::~UBPersistenceManager()
 {
+    // a copy finished but not registered yet still carries the uuid of its source
+    foreach(UBDocumentDuplicator* duplicator, mDuplications.keys())
+    {
+        duplicator->cancel();
+        duplicator->wait();
+        UBFileSystemUtils::deleteDir(duplicator->targetPath());
+    }
+
+    UBMetadataDcSubsetAdaptor::saveIndex();
+
     foreach(QPointer<UBDocumentProxy> proxyGuard, documentProxies)
     {
         if (!proxyGuard.isNull())
@@ -117,6 +138,9 @@ QList<QPointer<UBDocumentProxy> > UBPersistenceManager::allDocumentProxies()
         }
     }
 
+    // only the documents whose metadata changed since the last run were parsed
+    UBMetadataDcSubsetAdaptor::saveIndex();
+
     return proxies;
 }
 
@@ -305,6 +329,18 @@ void UBPersistenceManager::deleteDocument(UBDocumentProxy* pDocumentProxy)
 
     emit documentWillBeDeleted(pDocumentProxy);
 
+    foreach(UBDocumentDuplicator* duplicator, mDuplications.keys(pDocumentProxy))
+    {
+        mDuplications.remove(duplicator);
+
+        // the copy may have completed with its duplicated() signal still queued
+        QString targetPath = duplicator->targetPath();
+        delete duplicator; // cancels and waits
+        UBFileSystemUtils::deleteDir(targetPath);
+
+        emit documentDuplicated(pDocumentProxy, 0);
+    }
+
     qDebug() << "Deleting document" << pDocumentProxy->persistencePath();
 
     UBFileSystemUtils::deleteDir(pDocumentProxy->persistencePath());
@@ -325,25 +361,80 @@ UBDocumentProxy* UBPersistenceManager::duplicateDocument(UBDocumentProxy* pDocum
 {
     checkIfDocumentRepositoryExists();
 
-    UBDocumentProxy *copy = new UBDocumentProxy(); // deleted in UBPersistenceManager::destructor
+    persistPendingSvgs(pDocumentProxy);
+
+    QString copyPath = generateUniqueDocumentPath();
+
+    UBDocumentDuplicator duplicator(pDocumentProxy->metaData(UBSettings::documentName).toString(),
+            pDocumentProxy->persistencePath(), copyPath);
+
+    if (!duplicator.duplicate())
+        return 0;
+
+    return createDuplicateProxy(pDocumentProxy, copyPath);
+}
+
+
+UBDocumentDuplicator* UBPersistenceManager::duplicateDocumentInBackground(UBDocumentProxy* pDocumentProxy)
+{
+    checkIfDocumentRepositoryExists();
 
-    generatePathIfNeeded(copy);
+    // the duplicator reads the svg files on its thread
+    persistPendingSvgs(pDocumentProxy);
 
-    UBFileSystemUtils::copyDir(pDocumentProxy->persistencePath(), copy->persistencePath());
+    UBDocumentDuplicator* duplicator = new UBDocumentDuplicator(pDocumentProxy->metaData(UBSettings::documentName).toString(),
+            pDocumentProxy->persistencePath(), generateUniqueDocumentPath(), this);
 
-    // regenerate scenes UUIDs
-    for(int i = 0; i < pDocumentProxy->pageCount(); i++)
+    connect(duplicator, SIGNAL(duplicated(const QString&, bool)), this, SLOT(duplicationFinished(const QString&, bool)));
+
+    mDuplications.insert(duplicator, pDocumentProxy);
+
+    duplicator->start(QThread::LowPriority);
+
+    return duplicator;
+}
+
+
+void UBPersistenceManager::duplicationFinished(const QString& pTargetPath, bool pSucceeded)
+{
+    // the duplicators of deleted documents are already gone
+    UBDocumentDuplicator* duplicator = 0;
+
+    foreach(UBDocumentDuplicator* candidate, mDuplications.keys())
     {
-        UBSvgSubsetAdaptor::setSceneUuid(pDocumentProxy, i, QUuid::createUuid());
+        if (candidate->targetPath() == pTargetPath)
+            duplicator = candidate;
     }
 
-    foreach(QString key, pDocumentProxy->metaDatas().keys())
+    if (!duplicator)
+        return;
+
+    UBDocumentProxy* source = mDuplications.take(duplicator);
+
+    UBDocumentProxy* copy = 0;
+
+    if (pSucceeded)
+        copy = createDuplicateProxy(source, pTargetPath);
+    else
+        UBFileSystemUtils::deleteDir(pTargetPath);
+
+    duplicator->deleteLater();
+
+    emit documentDuplicated(source, copy);
+}
+
+
+UBDocumentProxy* UBPersistenceManager::createDuplicateProxy(UBDocumentProxy* pSourceProxy, const QString& pPath)
+{
+    UBDocumentProxy *copy = new UBDocumentProxy(pPath); // deleted in UBPersistenceManager::destructor
+
+    foreach(QString key, pSourceProxy->metaDatas().keys())
     {
-        copy->setMetaData(key, pDocumentProxy->metaDatas().value(key));
+        copy->setMetaData(key, pSourceProxy->metaDatas().value(key));
     }
 
     copy->setMetaData(UBSettings::documentName,
-            pDocumentProxy->metaData(UBSettings::documentName).toString() + " " + tr("(copy)"));
+            pSourceProxy->metaData(UBSettings::documentName).toString() + " " + tr("(copy)"));
 
     copy->setUuid(QUuid::createUuid());
 
@@ -358,7 +449,6 @@ UBDocumentProxy* UBPersistenceManager::duplicateDocument(UBDocumentProxy* pDocum
     emit documentCreated(copy);
 
     return copy;
-
 }
 
 
@@ -424,6 +514,7 @@ void UBPersistenceManager::deleteDocumentScenes(UBDocumentProxy* proxy, const QL
     QString thumbFileName = trashDocProxy->persistencePath() +
                             UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", 1);
     QFile::remove(thumbFileName);
+    QFile::remove(UBBinaryPageAdaptor::pagePath(trashDocProxy->persistencePath(), 0));
     trashDocProxy->decPageCount();
 
     for (int i = 1; i < pageCount; i++)
@@ -443,6 +534,8 @@ void UBPersistenceManager::deleteDocumentScenes(UBDocumentProxy* proxy, const QL
 
         QFile::remove(thumbFileName);
 
+        QFile::remove(UBBinaryPageAdaptor::pagePath(proxy->persistencePath(), index));
+
         mSceneCache.removeScene(proxy, index);
 
         proxy->decPageCount();
@@ -524,6 +617,25 @@ UBGraphicsScene* UBPersistenceManager::createDocumentSceneAt(UBDocumentProxy* pr
 }
 
 
+UBGraphicsScene* UBPersistenceManager::appendDocumentScene(UBDocumentProxy* proxy)
+{
+    UBGraphicsScene *newScene = mSceneCache.createScene(proxy, proxy->pageCount());
+
+    newScene->setBackground(UBSettings::settings()->isDarkBackground(),
+            UBSettings::settings()->UBSettings::isCrossedBackground());
+
+    proxy->incPageCount();
+
+    return newScene;
+}
+
+
+void UBPersistenceManager::documentScenesAppended(UBDocumentProxy* proxy, int pFirstIndex)
+{
+    emit documentSceneCreated(proxy, pFirstIndex);
+}
+
+
 void UBPersistenceManager::insertDocumentSceneAt(UBDocumentProxy* proxy, UBGraphicsScene* scene, int index)
 {
     scene->setDocument(proxy);
@@ -561,6 +673,10 @@ void UBPersistenceManager::moveSceneToIndex(UBDocumentProxy* proxy, int source,
     QFile thumbTmp(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", source + 1));
     thumbTmp.rename(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.tmp", target + 1));
 
+    // renamed with its svg file, the stamp of the binary page stays valid
+    QFile::rename(UBBinaryPageAdaptor::pagePath(proxy->persistencePath(), source),
+            proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.ubpage.tmp", target + 1));
+
     if (source < target)
     {
         for (int i = source + 1; i <= target; i++)
@@ -582,6 +698,9 @@ void UBPersistenceManager::moveSceneToIndex(UBDocumentProxy* proxy, int source,
     QFile thumb(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.tmp", target + 1));
     thumb.rename(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", target + 1));
 
+    QFile::rename(proxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.ubpage.tmp", target + 1),
+            UBBinaryPageAdaptor::pagePath(proxy->persistencePath(), target));
+
     mSceneCache.moveScene(proxy, source, target);
 
     emit documentSceneMoved(proxy, target);
@@ -607,7 +726,7 @@ UBGraphicsScene* UBPersistenceManager::loadDocumentScene(UBDocumentProxy* proxy,
 }
 
 
-void UBPersistenceManager::persistDocumentScene(UBDocumentProxy* pDocumentProxy, UBGraphicsScene* pScene, const int pSceneIndex)
+void UBPersistenceManager::persistDocumentScene(UBDocumentProxy* pDocumentProxy, UBGraphicsScene* pScene, const int pSceneIndex, const bool pPersistThumbnail)
 {
     checkIfDocumentRepositoryExists();
 
@@ -625,11 +744,20 @@ void UBPersistenceManager::persistDocumentScene(UBDocumentProxy* pDocumentProxy,
 
     if (pScene->isModified())
     {
-        UBThumbnailAdaptor::persistScene(pDocumentProxy->persistencePath(), pScene, pSceneIndex);
+        if (pPersistThumbnail)
+            UBThumbnailAdaptor::persistScene(pDocumentProxy->persistencePath(), pScene, pSceneIndex);
 
         UBSvgSubsetAdaptor::persistScene(pDocumentProxy, pScene, pSceneIndex);
 
         pScene->setModified(false);
+
+        QPointer<UBDocumentProxy> proxyGuard(pDocumentProxy);
+
+        if (!mDocumentsWithPendingSvgs.contains(proxyGuard)
+                && UBBinaryPageAdaptor::hasPendingSvg(pDocumentProxy->persistencePath(), pSceneIndex))
+            mDocumentsWithPendingSvgs << proxyGuard;
+
+        emit documentScenePersisted(pDocumentProxy, pSceneIndex);
     }
 
     mSceneCache.insert(pDocumentProxy, pSceneIndex, pScene);
@@ -639,6 +767,30 @@ void UBPersistenceManager::persistDocumentScene(UBDocumentProxy* pDocumentProxy,
 }
 
 
+void UBPersistenceManager::persistPendingSvgs(UBDocumentProxy* pDocumentProxy)
+{
+    int count = sceneCount(pDocumentProxy);
+
+    for (int i = 0; i < count; i++)
+    {
+        if (!UBBinaryPageAdaptor::persistSvg(pDocumentProxy, i))
+            qWarning() << "cannot write the svg file of page" << i + 1 << pDocumentProxy->persistencePath();
+    }
+}
+
+
+void UBPersistenceManager::persistPendingSvgs()
+{
+    foreach(QPointer<UBDocumentProxy> proxyGuard, mDocumentsWithPendingSvgs)
+    {
+        if (!proxyGuard.isNull())
+            persistPendingSvgs(proxyGuard.data());
+    }
+
+    mDocumentsWithPendingSvgs.clear();
+}
+
+
 UBDocumentProxy* UBPersistenceManager::persistDocumentMetadata(UBDocumentProxy* pDocumentProxy)
 {
     UBMetadataDcSubsetAdaptor::persist(pDocumentProxy);
@@ -656,18 +808,25 @@ void UBPersistenceManager::renamePage(UBDocumentProxy* pDocumentProxy, const int
 
     QFile thumb(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", sourceIndex + 1));
     thumb.rename(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", targetIndex + 1));
+
+    QString binaryTarget = UBBinaryPageAdaptor::pagePath(pDocumentProxy->persistencePath(), targetIndex);
+    QFile::remove(binaryTarget);
+    QFile::rename(UBBinaryPageAdaptor::pagePath(pDocumentProxy->persistencePath(), sourceIndex), binaryTarget);
 }
 
 
 void UBPersistenceManager::copyPage(UBDocumentProxy* pDocumentProxy, const int sourceIndex, const int targetIndex)
 {
-    QFile svg(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", sourceIndex + 1));
-    svg.copy(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", targetIndex + 1));
+    UBBinaryPageAdaptor::persistSvg(pDocumentProxy, sourceIndex);
+
+    // pages are rewritten in place, cloned (copy-on-write) but never hard linked
+    UBFileSystemUtils::cloneFile(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", sourceIndex + 1),
+            pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.svg", targetIndex + 1), false);
 
     UBSvgSubsetAdaptor::setSceneUuid(pDocumentProxy, targetIndex, QUuid::createUuid());
 
-    QFile thumb(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", sourceIndex + 1));
-    thumb.copy(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", targetIndex + 1));
+    UBFileSystemUtils::cloneFile(pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", sourceIndex + 1),
+            pDocumentProxy->persistencePath() + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", targetIndex + 1), false);
 }
 
 
@@ -23,6 +23,7 @@
 class UBDocument;
 class UBDocumentProxy;
 class UBGraphicsScene;
+class UBDocumentDuplicator;
 
 class UBPersistenceManager : public QObject
 {
@@ -40,6 +41,7 @@ class UBPersistenceManager : public QObject
         static const QString objectDirectory;
         static const QString videoDirectory;
         static const QString audioDirectory;
+        static const QString videoPosterDirectory;
         static const QString widgetDirectory;
 
         static UBPersistenceManager* persistenceManager();
@@ -51,6 +53,9 @@ class UBPersistenceManager : public QObject
 
         virtual UBDocumentProxy* duplicateDocument(UBDocumentProxy* pDocumentProxy);
 
+        // documentDuplicated is emitted when done, the returned duplicator reports the progress and can be cancelled
+        virtual UBDocumentDuplicator* duplicateDocumentInBackground(UBDocumentProxy* pDocumentProxy);
+
         virtual void deleteDocument(UBDocumentProxy* pDocumentProxy);
 
         virtual void deleteDocumentScenes(UBDocumentProxy* pDocumentProxy, const QList<int>& indexes);
@@ -58,16 +63,27 @@ class UBPersistenceManager : public QObject
         virtual void duplicateDocumentScene(UBDocumentProxy* pDocumentProxy, int index);
 
         virtual void persistDocumentScene(UBDocumentProxy* pDocumentProxy,
-                UBGraphicsScene* pScene, const int pSceneIndex);
+                UBGraphicsScene* pScene, const int pSceneIndex, const bool pPersistThumbnail = true);
 
         virtual UBGraphicsScene* createDocumentSceneAt(UBDocumentProxy* pDocumentProxy, int index);
 
+        // for the imports creating many pages at once: the blank page appended is persisted by the caller,
+        // and the pages appended are announced once with documentScenesAppended
+        virtual UBGraphicsScene* appendDocumentScene(UBDocumentProxy* pDocumentProxy);
+        virtual void documentScenesAppended(UBDocumentProxy* pDocumentProxy, int pFirstIndex);
+
         virtual void insertDocumentSceneAt(UBDocumentProxy* pDocumentProxy, UBGraphicsScene* scene, int index);
 
         virtual void moveSceneToIndex(UBDocumentProxy* pDocumentProxy, int source, int target);
 
         virtual UBGraphicsScene* loadDocumentScene(UBDocumentProxy* pDocumentProxy, int sceneIndex);
 
+        // writes the svg files of the pages saved as binary pages, before the document files are read as svg
+        virtual void persistPendingSvgs(UBDocumentProxy* pDocumentProxy);
+
+        // for all the documents saved during the session, when the application quits
+        virtual void persistPendingSvgs();
+
         QList<QPointer<UBDocumentProxy> > documentProxies;
 
         virtual QStringList allShapes();
@@ -115,8 +131,10 @@ class UBPersistenceManager : public QObject
         void documentMetadataChanged(UBDocumentProxy* pDocumentProxy);
         void documentCommitted(UBDocumentProxy* pDocumentProxy);
         void documentWillBeDeleted(UBDocumentProxy* pDocumentProxy);
+        void documentDuplicated(UBDocumentProxy* pSourceProxy, UBDocumentProxy* pCopyProxy); // pCopyProxy is 0 if failed or cancelled
 
         void documentSceneCreated(UBDocumentProxy* pDocumentProxy, int pIndex);
+        void documentScenePersisted(UBDocumentProxy* pDocumentProxy, int pIndex);
         void documentSceneMoved(UBDocumentProxy* pDocumentProxy, int pIndex);
         void documentSceneWillBeDeleted(UBDocumentProxy* pDocumentProxy, int pIndex);
         void documentSceneDeleted(UBDocumentProxy* pDocumentProxy, int pDeletedIndex);
@@ -137,6 +155,8 @@ class UBPersistenceManager : public QObject
 
         void generatePathIfNeeded(UBDocumentProxy* pDocumentProxy);
 
+        UBDocumentProxy* createDuplicateProxy(UBDocumentProxy* pSourceProxy, const QString& pPath);
+
         void checkIfDocumentRepositoryExists();
 
         UBSceneCache mSceneCache;
@@ -151,8 +171,13 @@ class UBPersistenceManager : public QObject
 
         QString mDocumentRepositoryPath;
 
+        QMap<UBDocumentDuplicator*, UBDocumentProxy*> mDuplications;
+
+        QList<QPointer<UBDocumentProxy> > mDocumentsWithPendingSvgs;
+
     private slots:
         void documentRepositoryChanged(const QString& path);
+        void duplicationFinished(const QString& pTargetPath, bool pSucceeded);
 
 };
 
@@ -0,0 +1,340 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBPrintSpoolImporter.h"
+
+#include "core/UBApplication.h"
+#include "core/UBApplicationController.h"
+#include "core/UBSettings.h"
+#include "core/UBPersistenceManager.h"
+
+#include "document/UBDocumentProxy.h"
+
+#include "board/UBBoardController.h"
+
+#include "domain/UBGraphicsScene.h"
+
+#include "adaptors/UBImportPDF.h"
+
+#include "pdf/PDFRenderer.h"
+
+#include "frameworks/UBStringUtils.h"
+#include "frameworks/UBTrace.h"
+
+#include "core/memcheck.h"
+
+// time a job file must stay unchanged before it is imported, the printer backend writes it progressively
+static const int settleInterval = 1000;
+
+
+UBPrintSpoolImporter::UBPrintSpoolImporter(const QString& pSpoolDirectory, QObject *pParent)
+    : QObject(pParent)
+    , mSpoolDirectory(pSpoolDirectory)
+    , mConverter(0)
+    , mDocument(0)
+    , mRenderer(0)
+    , mPdfPageNumber(0)
+    , mPageIndex(0)
+{
+    QDir().mkpath(mSpoolDirectory);
+    mWatcher.addPath(mSpoolDirectory);
+
+    connect(&mWatcher, SIGNAL(directoryChanged(const QString&)), this, SLOT(scan()));
+
+    mSettleTimer.setInterval(settleInterval);
+    connect(&mSettleTimer, SIGNAL(timeout()), this, SLOT(scan()));
+
+    connect(UBPersistenceManager::persistenceManager(), SIGNAL(documentWillBeDeleted(UBDocumentProxy*)),
+            this, SLOT(documentWillBeDeleted(UBDocumentProxy*)));
+
+    // jobs printed while the application was not running
+    QTimer::singleShot(0, this, SLOT(scan()));
+}
+
+
+UBPrintSpoolImporter::~UBPrintSpoolImporter()
+{
+    if (mConverter)
+    {
+        mConverter->kill();
+        mConverter->waitForFinished();
+    }
+
+    if (mRenderer)
+        mRenderer->detach();
+
+    if (!mConvertedPath.isEmpty())
+        QFile::remove(mConvertedPath);
+}
+
+
+QStringList UBPrintSpoolImporter::supportedExtensions()
+{
+    return QStringList() << "pdf" << "ps";
+}
+
+
+UBPrintSpoolImporter::FileState UBPrintSpoolImporter::fileState(const QString& pPath)
+{
+    QFileInfo fileInfo(pPath);
+
+    return FileState(fileInfo.size(), fileInfo.lastModified());
+}
+
+
+void UBPrintSpoolImporter::scan()
+{
+    QStringList nameFilters;
+
+    foreach(QString extension, supportedExtensions())
+        nameFilters << "*." + extension;
+
+    // oldest first, the jobs are imported in the order they were printed
+    QFileInfoList files = QDir(mSpoolDirectory).entryInfoList(nameFilters, QDir::Files | QDir::Readable, QDir::Time | QDir::Reversed);
+
+    QHash<QString, FileState> candidates;
+
+    foreach(QFileInfo file, files)
+    {
+        QString path = file.absoluteFilePath();
+
+        if (path == mCurrentJob || mJobs.contains(path))
+            continue;
+
+        FileState state(file.size(), file.lastModified());
+
+        if (mRejected.contains(path) && mRejected.value(path) == state)
+            continue;
+
+        mRejected.remove(path);
+
+        if (state.first > 0 && mCandidates.contains(path) && mCandidates.value(path) == state)
+        {
+            mJobs << path;
+        }
+        else
+        {
+            candidates.insert(path, state);
+        }
+    }
+
+    mCandidates = candidates;
+
+    // the directory is not modified when a file grows, the candidates are polled until they settle
+    if (mCandidates.isEmpty())
+        mSettleTimer.stop();
+    else if (!mSettleTimer.isActive())
+        mSettleTimer.start();
+
+    startNextJob();
+}
+
+
+void UBPrintSpoolImporter::startNextJob()
+{
+    if (!mCurrentJob.isEmpty() || mJobs.isEmpty())
+        return;
+
+    mCurrentJob = mJobs.takeFirst();
+
+    if (!QFile::exists(mCurrentJob))
+    {
+        mCurrentJob.clear();
+        startNextJob();
+        return;
+    }
+
+    UBApplication::showMessage(tr("Importing print job %1").arg(QFileInfo(mCurrentJob).completeBaseName()), true);
+
+    if (QFileInfo(mCurrentJob).suffix().toLower() == "pdf")
+    {
+        importPdf(mCurrentJob);
+    }
+    else
+    {
+        convert(mCurrentJob);
+    }
+}
+
+
+void UBPrintSpoolImporter::convert(const QString& pPostScriptPath)
+{
+    mConvertedPath = QDir::tempPath() + "/" + QUuid::createUuid().toString() + ".pdf";
+
+    mConverter = new QProcess(this);
+
+    connect(mConverter, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(conversionFinished()));
+    connect(mConverter, SIGNAL(error(QProcess::ProcessError)), this, SLOT(conversionFinished()));
+
+    mConverter->start("ps2pdf", QStringList() << pPostScriptPath << mConvertedPath);
+}
+
+
+void UBPrintSpoolImporter::conversionFinished()
+{
+    // both finished() and error() are emitted when ps2pdf crashes
+    if (!mConverter || mConverter->state() != QProcess::NotRunning)
+        return;
+
+    bool converted = mConverter->exitStatus() == QProcess::NormalExit && mConverter->exitCode() == 0
+            && QFileInfo(mConvertedPath).size() > 0;
+
+    if (mConverter->error() == QProcess::FailedToStart)
+        qWarning() << "cannot convert print job, ps2pdf is not available";
+
+    mConverter->deleteLater();
+    mConverter = 0;
+
+    if (converted)
+    {
+        importPdf(mConvertedPath);
+    }
+    else
+    {
+        UBApplication::showMessage(tr("Cannot import print job %1").arg(QFileInfo(mCurrentJob).completeBaseName()));
+        finishJob(false);
+    }
+}
+
+
+void UBPrintSpoolImporter::importPdf(const QString& pPdfPath)
+{
+    UBPersistenceManager* persistenceManager = UBPersistenceManager::persistenceManager();
+
+    bool createdDocument = false;
+
+    if (UBSettings::settings()->printSpoolAddToCurrentDocument->get().toBool() && UBApplication::boardController)
+        mDocument = UBApplication::boardController->activeDocument();
+
+    if (!mDocument)
+    {
+        mDocument = persistenceManager->createDocument(UBSettings::defaultDocumentGroupName, QFileInfo(mCurrentJob).completeBaseName());
+        createdDocument = true;
+    }
+
+    QUuid uuid = QUuid::createUuid();
+    QString filePath = persistenceManager->addPdfFileToDocument(mDocument, pPdfPath, uuid);
+
+    mRenderer = PDFRenderer::rendererForUuid(uuid, mDocument->persistencePath() + "/" + filePath, true);
+
+    // referenced until the last page is added, the pages hold their own reference
+    mRenderer->attach();
+
+    if (!mRenderer->isValid() || mRenderer->pageCount() == 0)
+    {
+        UBApplication::showMessage(tr("Cannot import print job %1").arg(QFileInfo(mCurrentJob).completeBaseName()));
+
+        mRenderer->detach();
+        mRenderer = 0;
+
+        QFile::remove(mDocument->persistencePath() + "/" + filePath);
+
+        UBDocumentProxy* document = mDocument;
+        mDocument = 0;
+
+        if (createdDocument)
+            persistenceManager->deleteDocument(document);
+
+        finishJob(false);
+        return;
+    }
+
+    mPdfPageNumber = 0;
+    mPageIndex = mDocument->pageCount();
+
+    if (mPageIndex == 1 && persistenceManager->loadDocumentScene(mDocument, 0)->isEmpty())
+        mPageIndex = 0;
+
+    QTimer::singleShot(0, this, SLOT(importNextPage()));
+}
+
+
+void UBPrintSpoolImporter::importNextPage()
+{
+    if (!mRenderer || !mDocument)
+        return;
+
+    UB_TRACE_SCOPE("import.print.page", "import");
+
+    mPdfPageNumber++;
+
+    UBApplication::showMessage(tr("Importing page %1 of %2").arg(mPdfPageNumber).arg(mRenderer->pageCount()), true);
+
+    UBImportPDF::addPageToDocument(mDocument, mRenderer, mPdfPageNumber, mPageIndex);
+
+    // the first page printed is shown on the board, the others are added behind it
+    if (mPdfPageNumber == 1 && UBApplication::boardController
+            && UBApplication::applicationController->displayMode() == UBApplicationController::Board)
+    {
+        UBApplication::boardController->setActiveDocumentScene(mDocument, mPageIndex);
+    }
+
+    mPageIndex++;
+
+    if (mPdfPageNumber < mRenderer->pageCount())
+    {
+        QTimer::singleShot(0, this, SLOT(importNextPage()));
+    }
+    else
+    {
+        UBApplication::showMessage(tr("Print job %1 imported").arg(QFileInfo(mCurrentJob).completeBaseName()));
+        finishJob(true);
+    }
+}
+
+
+void UBPrintSpoolImporter::finishJob(bool pSucceeded)
+{
+    if (mRenderer)
+    {
+        mRenderer->detach();
+        mRenderer = 0;
+    }
+
+    if (mDocument && mPdfPageNumber > 0)
+    {
+        mDocument->setMetaData(UBSettings::documentUpdatedAt, UBStringUtils::toUtcIsoDateTime(QDateTime::currentDateTime()));
+        UBPersistenceManager::persistenceManager()->persistDocumentMetadata(mDocument);
+    }
+
+    if (!mConvertedPath.isEmpty())
+        QFile::remove(mConvertedPath);
+
+    if (pSucceeded)
+    {
+        QFile::remove(mCurrentJob);
+    }
+    else
+    {
+        mRejected.insert(mCurrentJob, fileState(mCurrentJob));
+    }
+
+    mCurrentJob.clear();
+    mConvertedPath.clear();
+    mDocument = 0;
+    mPdfPageNumber = 0;
+
+    QTimer::singleShot(0, this, SLOT(startNextJob()));
+}
+
+
+void UBPrintSpoolImporter::documentWillBeDeleted(UBDocumentProxy* pDocument)
+{
+    if (pDocument == mDocument)
+    {
+        mDocument = 0;
+        finishJob(false);
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBPRINTSPOOLIMPORTER_H_
+#define UBPRINTSPOOLIMPORTER_H_
+
+#include <QtGui>
+
+class UBDocumentProxy;
+class PDFRenderer;
+
+/**
+ * Imports the print jobs written in a spool directory, as done by a CUPS-PDF printer.
+ *
+ * A job file is imported once it has not changed between two scans of the directory, the
+ * PostScript jobs are first converted with ps2pdf. Each job goes into a new document, or
+ * into the active one when set in the settings, one page per event loop turn so the pages
+ * show up as they are added. Imported jobs are removed from the spool directory.
+ */
+class UBPrintSpoolImporter : public QObject
+{
+    Q_OBJECT;
+
+    public:
+        UBPrintSpoolImporter(const QString& pSpoolDirectory, QObject *pParent = 0);
+        virtual ~UBPrintSpoolImporter();
+
+        static QStringList supportedExtensions();
+
+    private slots:
+        void scan();
+        void startNextJob();
+        void conversionFinished();
+        void importNextPage();
+        void documentWillBeDeleted(UBDocumentProxy* pDocument);
+
+    private:
+        typedef QPair<qint64, QDateTime> FileState;
+
+        static FileState fileState(const QString& pPath);
+
+        void convert(const QString& pPostScriptPath);
+        void importPdf(const QString& pPdfPath);
+        void finishJob(bool pSucceeded);
+
+        QString mSpoolDirectory;
+        QFileSystemWatcher mWatcher;
+        QTimer mSettleTimer;
+
+        // state at the previous scan of the files not imported yet
+        QHash<QString, FileState> mCandidates;
+        // jobs that failed, retried only once the file changes
+        QHash<QString, FileState> mRejected;
+        QStringList mJobs;
+
+        QString mCurrentJob;
+        QString mConvertedPath;
+        QProcess* mConverter;
+
+        UBDocumentProxy* mDocument;
+        PDFRenderer* mRenderer;
+        int mPdfPageNumber;
+        int mPageIndex;
+};
+
+#endif /* UBPRINTSPOOLIMPORTER_H_ */
@@ -23,6 +23,8 @@
 
 #include "document/UBDocumentProxy.h"
 
+#include "frameworks/UBTrace.h"
+
 #include "core/memcheck.h"
 
 UBSceneCache::UBSceneCache()
@@ -102,10 +104,14 @@ UBGraphicsScene* UBSceneCache::value(UBDocumentProxy* proxy, int pageIndex)
         mCachedKeyFIFO.removeAll(key);
         mCachedKeyFIFO.enqueue(key);
 
+        UB_TRACE_COUNT("sceneCache.hits");
+
         return scene;
     }
     else
     {
+        UB_TRACE_COUNT("sceneCache.misses");
+
         return 0;
     }
 }
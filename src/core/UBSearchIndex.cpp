@@ -0,0 +1,905 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBSearchIndex.h"
+
+#include "core/UBSettings.h"
+#include "core/UBPersistenceManager.h"
+
+#include "document/UBDocumentProxy.h"
+
+#include "adaptors/UBBinaryPageAdaptor.h"
+
+#include "pdf/PDFRenderer.h"
+
+#include "frameworks/UBFileSystemUtils.h"
+#include "frameworks/UBTrace.h"
+
+#include "core/memcheck.h"
+
+static const quint32 indexFileMagic = 0x55425349; // "UBSI"
+static const quint32 indexFileVersion = 1;
+
+// weight of a match in the document name against a match in a page
+static const qreal documentNameBoost = 3.0;
+
+// terms tried for the prefix of the last word of a query
+static const int maxPrefixExpansions = 100;
+
+static const int snippetLength = 120;
+
+UBSearchIndex* UBSearchIndex::sSearchIndex = 0;
+
+
+// lower case, without the accents, one character for one so that the positions are kept
+static QString fold(const QString& pText)
+{
+    QString folded(pText.length(), QChar());
+
+    for (int i = 0; i < pText.length(); i++)
+    {
+        QChar c = pText.at(i);
+
+        if (c.decompositionTag() == QChar::Canonical)
+            c = c.decomposition().at(0);
+
+        folded[i] = c.toLower();
+    }
+
+    return folded;
+}
+
+
+class UBSearchIndexLoadTask : public QRunnable
+{
+    public:
+        UBSearchIndexLoadTask(UBSearchIndex* pIndex, const QString& pFilePath)
+            : mIndex(pIndex)
+            , mFilePath(pFilePath)
+        {
+            // NOOP
+        }
+
+        virtual void run()
+        {
+            UB_TRACE_SCOPE("search.index.load", "search");
+
+            UBSearchIndex::Data data;
+            bool succeeded = false;
+
+            QFile file(mFilePath);
+
+            if (file.open(QIODevice::ReadOnly))
+            {
+                QDataStream stream(&file);
+                stream.setVersion(QDataStream::Qt_4_6);
+
+                quint32 magic = 0;
+                quint32 version = 0;
+
+                stream >> magic >> version;
+
+                if (magic == indexFileMagic && version == indexFileVersion)
+                {
+                    stream >> data.nextEntryId >> data.entries >> data.postings;
+
+                    succeeded = stream.status() == QDataStream::Ok;
+                }
+            }
+
+            if (succeeded)
+            {
+                QHash<quint32, UBSearchIndex::Entry>::const_iterator it = data.entries.constBegin();
+
+                for (; it != data.entries.constEnd(); ++it)
+                    data.entryIds.insert(it.value().documentPath + "#" + QString::number(it.value().pageIndex), it.key());
+            }
+            else
+            {
+                data = UBSearchIndex::Data();
+            }
+
+            mIndex->loaded(data, succeeded);
+        }
+
+    private:
+        UBSearchIndex* mIndex;
+        QString mFilePath;
+};
+
+
+class UBSearchIndexSaveTask : public QRunnable
+{
+    public:
+        // pData is a shallow copy, the index keeps changing its own
+        UBSearchIndexSaveTask(const UBSearchIndex::Data& pData, const QString& pFilePath)
+            : mData(pData)
+            , mFilePath(pFilePath)
+        {
+            // NOOP
+        }
+
+        virtual void run()
+        {
+            UB_TRACE_SCOPE("search.index.save", "search");
+
+            QDir().mkpath(QFileInfo(mFilePath).absolutePath());
+
+            QString tmpFilePath = mFilePath + ".tmp";
+            QFile file(tmpFilePath);
+
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            {
+                qWarning() << "cannot write search index" << tmpFilePath;
+                return;
+            }
+
+            QDataStream stream(&file);
+            stream.setVersion(QDataStream::Qt_4_6);
+
+            stream << indexFileMagic << indexFileVersion;
+            stream << mData.nextEntryId << mData.entries << mData.postings;
+
+            file.close();
+
+            if (stream.status() != QDataStream::Ok || !UBFileSystemUtils::replaceFile(tmpFilePath, mFilePath))
+            {
+                qWarning() << "cannot write search index" << mFilePath;
+                QFile::remove(tmpFilePath);
+            }
+        }
+
+    private:
+        UBSearchIndex::Data mData;
+        QString mFilePath;
+};
+
+
+class UBSearchIndexPageTask : public QRunnable
+{
+    public:
+        UBSearchIndexPageTask(UBSearchIndex* pIndex, const QString& pDocumentPath, int pPageIndex, const QDateTime& pKnownStamp)
+            : mIndex(pIndex)
+            , mDocumentPath(pDocumentPath)
+            , mPageIndex(pPageIndex)
+            , mKnownStamp(pKnownStamp)
+        {
+            // NOOP
+        }
+
+        virtual void run()
+        {
+            UBSearchIndex::PageContent content;
+
+            content.documentPath = mDocumentPath;
+            content.pageIndex = mPageIndex;
+
+            QString svgPath = mDocumentPath + UBFileSystemUtils::digitFileFormat("/page%1.svg", mPageIndex + 1);
+            QFileInfo svgInfo(svgPath);
+
+            content.stamp = svgInfo.lastModified();
+
+            // the saves after the first one only write the binary page
+            QFileInfo binaryInfo(UBBinaryPageAdaptor::pagePath(mDocumentPath, mPageIndex));
+
+            if (binaryInfo.exists() && binaryInfo.lastModified() > content.stamp)
+                content.stamp = binaryInfo.lastModified();
+
+            if (!svgInfo.exists())
+            {
+                content.missing = true;
+            }
+            else if (mKnownStamp.isValid() && content.stamp == mKnownStamp)
+            {
+                content.unchanged = true;
+            }
+            else
+            {
+                QByteArray binarySvg = UBBinaryPageAdaptor::pageSvgWithoutInk(mDocumentPath, mPageIndex);
+
+                if (!binarySvg.isEmpty())
+                {
+                    QBuffer buffer(&binarySvg);
+                    buffer.open(QIODevice::ReadOnly);
+                    read(&buffer, content);
+                }
+                else
+                {
+                    QFile file(svgPath);
+
+                    if (file.open(QIODevice::ReadOnly))
+                        read(&file, content);
+                    else
+                        content.missing = true;
+                }
+            }
+
+            mIndex->extracted(content);
+        }
+
+    private:
+        void read(QIODevice* pSvg, UBSearchIndex::PageContent& pContent)
+        {
+            UB_TRACE_SCOPE("search.index.page", "search");
+
+            QXmlStreamReader reader(pSvg);
+
+            while (!reader.atEnd())
+            {
+                reader.readNext();
+
+                if (!reader.isStartElement() || reader.name() != "foreignObject")
+                    continue;
+
+                QString type;
+                QString src;
+                QString href;
+
+                // the namespace of the attributes changed over the versions of the format
+                foreach(QXmlStreamAttribute attribute, reader.attributes())
+                {
+                    if (attribute.name() == "type")
+                        type = attribute.value().toString();
+                    else if (attribute.name() == "src")
+                        src = attribute.value().toString();
+                    else if (attribute.name() == "href")
+                        href = attribute.value().toString();
+                }
+
+                if (type == "text")
+                {
+                    pContent.texts << foreignObjectText(reader);
+                }
+                else if (href.contains(".pdf"))
+                {
+                    QStringList parts = href.split("#page=");
+
+                    if (parts.size() == 2)
+                        pContent.pdfPages << qMakePair(parts.at(0), parts.at(1).toInt());
+                }
+                else if (src.contains(".wgt"))
+                {
+                    QUrl url(src);
+                    QString widgetPath = url.isRelative() ? mDocumentPath + "/" + src : url.toLocalFile();
+                    QString name = widgetName(widgetPath + "/config.xml");
+
+                    if (!name.isEmpty())
+                        pContent.texts << name;
+                }
+            }
+        }
+
+        QString foreignObjectText(QXmlStreamReader& pReader)
+        {
+            QString text;
+
+            while (!pReader.atEnd() && !(pReader.isEndElement() && pReader.name() == "foreignObject"))
+            {
+                pReader.readNext();
+
+                if (pReader.isCharacters())
+                    text += pReader.text();
+                else if (pReader.isStartElement() && pReader.name() == "br")
+                    text += "\n";
+            }
+
+            return text;
+        }
+
+        QString widgetName(const QString& pConfigPath)
+        {
+            QFile file(pConfigPath);
+
+            if (!file.open(QIODevice::ReadOnly))
+                return QString();
+
+            QXmlStreamReader reader(&file);
+
+            while (!reader.atEnd())
+            {
+                reader.readNext();
+
+                if (reader.isStartElement() && reader.name() == "name")
+                    return reader.readElementText().simplified();
+            }
+
+            return QString();
+        }
+
+        UBSearchIndex* mIndex;
+        QString mDocumentPath;
+        int mPageIndex;
+        QDateTime mKnownStamp;
+};
+
+
+UBSearchIndex* UBSearchIndex::searchIndex()
+{
+    if (!sSearchIndex)
+    {
+        sSearchIndex = new UBSearchIndex(qApp);
+    }
+
+    return sSearchIndex;
+}
+
+
+UBSearchIndex::UBSearchIndex(QObject *pParent)
+    : QObject(pParent)
+    , mLoaded(false)
+    , mLoadSucceeded(false)
+    , mPdfRenderer(0)
+{
+    // reading the pages is not worth more than one core, the user keeps working meanwhile
+    mThreadPool.setMaxThreadCount(1);
+
+    mSaveTimer.setSingleShot(true);
+    mSaveTimer.setInterval(5000);
+    connect(&mSaveTimer, SIGNAL(timeout()), this, SLOT(save()));
+
+    mChangedTimer.setSingleShot(true);
+    mChangedTimer.setInterval(500);
+    connect(&mChangedTimer, SIGNAL(timeout()), this, SIGNAL(indexChanged()));
+    connect(&mChangedTimer, SIGNAL(timeout()), this, SLOT(releasePdfRenderer()));
+
+    UBPersistenceManager* persistenceManager = UBPersistenceManager::persistenceManager();
+
+    connect(persistenceManager, SIGNAL(documentCreated(UBDocumentProxy*)), this, SLOT(documentCreated(UBDocumentProxy*)));
+    connect(persistenceManager, SIGNAL(documentMetadataChanged(UBDocumentProxy*)), this, SLOT(documentMetadataChanged(UBDocumentProxy*)));
+    connect(persistenceManager, SIGNAL(documentScenePersisted(UBDocumentProxy*, int)), this, SLOT(documentScenePersisted(UBDocumentProxy*, int)));
+    connect(persistenceManager, SIGNAL(documentSceneCreated(UBDocumentProxy*, int)), this, SLOT(documentPagesChanged(UBDocumentProxy*, int)));
+    connect(persistenceManager, SIGNAL(documentSceneMoved(UBDocumentProxy*, int)), this, SLOT(documentPagesChanged(UBDocumentProxy*, int)));
+    connect(persistenceManager, SIGNAL(documentSceneDeleted(UBDocumentProxy*, int)), this, SLOT(documentPagesChanged(UBDocumentProxy*, int)));
+    connect(persistenceManager, SIGNAL(documentWillBeDeleted(UBDocumentProxy*)), this, SLOT(documentWillBeDeleted(UBDocumentProxy*)));
+
+    mThreadPool.start(new UBSearchIndexLoadTask(this, indexFilePath()));
+}
+
+
+UBSearchIndex::~UBSearchIndex()
+{
+    if (mLoaded && mSaveTimer.isActive())
+        save();
+
+    mThreadPool.waitForDone();
+
+    releasePdfRenderer();
+
+    sSearchIndex = 0;
+}
+
+
+QString UBSearchIndex::indexFilePath()
+{
+    return UBSettings::uniboardDataDirectory() + "/search.index";
+}
+
+
+QString UBSearchIndex::entryKey(const QString& pDocumentPath, int pPageIndex)
+{
+    return pDocumentPath + "#" + QString::number(pPageIndex);
+}
+
+
+QStringList UBSearchIndex::terms(const QString& pText)
+{
+    QStringList result;
+    QString folded = fold(pText);
+    int start = -1;
+
+    for (int i = 0; i <= folded.length(); i++)
+    {
+        bool isWordCharacter = i < folded.length() && folded.at(i).isLetterOrNumber();
+
+        if (isWordCharacter && start < 0)
+        {
+            start = i;
+        }
+        else if (!isWordCharacter && start >= 0)
+        {
+            if (i - start > 1)
+                result << folded.mid(start, i - start);
+
+            start = -1;
+        }
+    }
+
+    return result;
+}
+
+
+void UBSearchIndex::loaded(const Data& pData, bool pSucceeded)
+{
+    QMutexLocker locker(&mMutex);
+
+    mLoadedData = pData;
+    mLoadSucceeded = pSucceeded;
+
+    locker.unlock();
+
+    QMetaObject::invokeMethod(this, "startIndexing", Qt::QueuedConnection);
+}
+
+
+void UBSearchIndex::startIndexing()
+{
+    QMutexLocker locker(&mMutex);
+
+    mData = mLoadedData;
+    mLoadedData = Data();
+
+    locker.unlock();
+
+    mLoaded = true;
+
+    if (!mLoadSucceeded)
+        qDebug() << "search index missing, indexing all the documents";
+
+    QSet<QString> documentPaths;
+
+    foreach(QPointer<UBDocumentProxy> document, UBPersistenceManager::persistenceManager()->documentProxies)
+    {
+        if (!document)
+            continue;
+
+        documentPaths << document->persistencePath();
+
+        // the pages saved since the index was written have a newer date
+        indexDocument(document, false);
+    }
+
+    QSet<QString> deletedDocumentPaths;
+
+    foreach(Entry entry, mData.entries)
+    {
+        if (!documentPaths.contains(entry.documentPath))
+            deletedDocumentPaths << entry.documentPath;
+    }
+
+    foreach(QString documentPath, deletedDocumentPaths)
+        removeDocument(documentPath);
+
+    changed();
+}
+
+
+void UBSearchIndex::indexDocument(UBDocumentProxy* pDocument, bool pForce)
+{
+    indexMetadata(pDocument);
+
+    int pageCount = pDocument->pageCount();
+
+    for (int i = 0; i < pageCount; i++)
+        indexPage(pDocument->persistencePath(), i, pForce);
+
+    // the pages removed from the end of the document
+    for (int i = pageCount; mData.entryIds.contains(entryKey(pDocument->persistencePath(), i)); i++)
+        removeEntry(entryKey(pDocument->persistencePath(), i));
+}
+
+
+void UBSearchIndex::indexPage(const QString& pDocumentPath, int pPageIndex, bool pForce)
+{
+    QDateTime knownStamp;
+
+    if (!pForce && mData.entryIds.contains(entryKey(pDocumentPath, pPageIndex)))
+        knownStamp = mData.entries.value(mData.entryIds.value(entryKey(pDocumentPath, pPageIndex))).stamp;
+
+    mThreadPool.start(new UBSearchIndexPageTask(this, pDocumentPath, pPageIndex, knownStamp));
+}
+
+
+void UBSearchIndex::indexMetadata(UBDocumentProxy* pDocument)
+{
+    QString name = pDocument->metaData(UBSettings::documentName).toString();
+
+    setEntry(pDocument->persistencePath(), -1, QDateTime(), name);
+}
+
+
+void UBSearchIndex::extracted(const PageContent& pContent)
+{
+    QMutexLocker locker(&mMutex);
+
+    mExtracted << pContent;
+
+    locker.unlock();
+
+    QMetaObject::invokeMethod(this, "commitExtracted", Qt::QueuedConnection);
+}
+
+
+void UBSearchIndex::commitExtracted()
+{
+    QMutexLocker locker(&mMutex);
+
+    if (mExtracted.isEmpty())
+        return;
+
+    PageContent content = mExtracted.takeFirst();
+
+    locker.unlock();
+
+    if (content.unchanged)
+        return;
+
+    if (content.missing)
+    {
+        removeEntry(entryKey(content.documentPath, content.pageIndex));
+        changed();
+        return;
+    }
+
+    QStringList texts = content.texts;
+
+    for (int i = 0; i < content.pdfPages.size(); i++)
+        texts << pdfPageText(content.documentPath, content.pdfPages.at(i).first, content.pdfPages.at(i).second);
+
+    setEntry(content.documentPath, content.pageIndex, content.stamp, texts.join("\n"));
+}
+
+
+QString UBSearchIndex::pdfPageText(const QString& pDocumentPath, const QString& pPdfPath, int pPageNumber)
+{
+    // the pdf file never changes, its uuid is its name
+    QString uuid = QFileInfo(pPdfPath).completeBaseName();
+    QString key = uuid + "#" + QString::number(pPageNumber);
+
+    if (mPdfTexts.contains(key))
+        return mPdfTexts.value(key);
+
+    UB_TRACE_SCOPE("search.index.pdf", "search");
+
+    // the pages of a pdf come one after the other, its renderer is kept until the index is idle
+    if (mPdfRenderer && mPdfRenderer->fileUuid() != QUuid(uuid))
+        releasePdfRenderer();
+
+    if (!mPdfRenderer)
+    {
+        mPdfRenderer = PDFRenderer::rendererForUuid(QUuid(uuid), pDocumentPath + "/" + UBFileSystemUtils::normalizeFilePath(pPdfPath));
+        mPdfRenderer->attach();
+    }
+
+    QString text;
+
+    if (mPdfRenderer->isValid() && pPageNumber >= 1 && pPageNumber <= mPdfRenderer->pageCount())
+        text = mPdfRenderer->pageText(pPageNumber);
+
+    mPdfTexts.insert(key, text);
+
+    return text;
+}
+
+
+void UBSearchIndex::releasePdfRenderer()
+{
+    if (mPdfRenderer)
+    {
+        mPdfRenderer->detach();
+        mPdfRenderer = 0;
+    }
+}
+
+
+void UBSearchIndex::setEntry(const QString& pDocumentPath, int pPageIndex, const QDateTime& pStamp, const QString& pText)
+{
+    QString key = entryKey(pDocumentPath, pPageIndex);
+    QByteArray text = qCompress(pText.toUtf8());
+
+    if (mData.entryIds.contains(key))
+    {
+        Entry& entry = mData.entries[mData.entryIds.value(key)];
+
+        // saved again without a change to its text
+        if (entry.text == text)
+        {
+            if (entry.stamp != pStamp)
+            {
+                entry.stamp = pStamp;
+                mSaveTimer.start();
+            }
+
+            return;
+        }
+    }
+
+    removeEntry(key);
+
+    quint32 id = mData.nextEntryId++;
+
+    Entry entry;
+    entry.documentPath = pDocumentPath;
+    entry.pageIndex = pPageIndex;
+    entry.stamp = pStamp;
+    entry.text = text;
+
+    mData.entries.insert(id, entry);
+    mData.entryIds.insert(key, id);
+
+    QHash<QString, int> occurrences;
+
+    foreach(QString term, terms(pText))
+        occurrences[term]++;
+
+    QHash<QString, int>::const_iterator it = occurrences.constBegin();
+
+    // the ids only grow, the postings stay sorted
+    for (; it != occurrences.constEnd(); ++it)
+    {
+        Posting posting;
+        posting.entry = id;
+        posting.occurrences = qMin(it.value(), 0xffff);
+
+        mData.postings[it.key()].append(posting);
+    }
+
+    changed();
+}
+
+
+static bool postingLessThan(const UBSearchIndex::Posting& pPosting1, const UBSearchIndex::Posting& pPosting2)
+{
+    return pPosting1.entry < pPosting2.entry;
+}
+
+
+void UBSearchIndex::removeEntry(const QString& pKey)
+{
+    if (!mData.entryIds.contains(pKey))
+        return;
+
+    quint32 id = mData.entryIds.take(pKey);
+    Entry entry = mData.entries.take(id);
+
+    Posting key;
+    key.entry = id;
+
+    foreach(QString term, terms(QString::fromUtf8(qUncompress(entry.text))).toSet())
+    {
+        QMap<QString, QVector<Posting> >::iterator postings = mData.postings.find(term);
+
+        if (postings == mData.postings.end())
+            continue;
+
+        QVector<Posting>::iterator posting = qLowerBound(postings.value().begin(), postings.value().end(), key, postingLessThan);
+
+        if (posting != postings.value().end() && posting->entry == id)
+            postings.value().erase(posting);
+
+        if (postings.value().isEmpty())
+            mData.postings.erase(postings);
+    }
+
+    changed();
+}
+
+
+void UBSearchIndex::removeDocument(const QString& pDocumentPath)
+{
+    QStringList keys;
+
+    foreach(Entry entry, mData.entries)
+    {
+        if (entry.documentPath == pDocumentPath)
+            keys << entryKey(entry.documentPath, entry.pageIndex);
+    }
+
+    foreach(QString key, keys)
+        removeEntry(key);
+}
+
+
+void UBSearchIndex::changed()
+{
+    if (!mLoaded)
+        return;
+
+    mSaveTimer.start();
+    mChangedTimer.start();
+}
+
+
+void UBSearchIndex::save()
+{
+    if (!mLoaded)
+        return;
+
+    mSaveTimer.stop();
+
+    mThreadPool.start(new UBSearchIndexSaveTask(mData, indexFilePath()));
+}
+
+
+QList<UBSearchIndex::Hit> UBSearchIndex::search(const QString& pQuery, int pMaxHits) const
+{
+    UB_TRACE_SCOPE("search.query", "search");
+
+    QList<Hit> hits;
+    QStringList queryTerms = terms(pQuery);
+
+    if (queryTerms.isEmpty())
+        return hits;
+
+    qreal entryCount = qMax(1, mData.entries.size());
+    QHash<quint32, qreal> scores;
+
+    for (int i = 0; i < queryTerms.size(); i++)
+    {
+        const QString& term = queryTerms.at(i);
+        bool isPrefix = (i == queryTerms.size() - 1);
+
+        QHash<quint32, qreal> termScores;
+        QMap<QString, QVector<Posting> >::const_iterator postings = isPrefix ? mData.postings.lowerBound(term) : mData.postings.find(term);
+
+        for (int expansions = 0; postings != mData.postings.constEnd() && expansions < maxPrefixExpansions; ++postings, expansions++)
+        {
+            if (isPrefix ? !postings.key().startsWith(term) : postings.key() != term)
+                break;
+
+            qreal idf = qLn(1.0 + entryCount / postings.value().size());
+
+            foreach(Posting posting, postings.value())
+                termScores[posting.entry] += (1.0 + qLn(posting.occurrences)) * idf;
+
+            if (!isPrefix)
+                break;
+        }
+
+        if (i == 0)
+        {
+            scores = termScores;
+        }
+        else
+        {
+            QHash<quint32, qreal>::iterator score = scores.begin();
+
+            while (score != scores.end())
+            {
+                if (termScores.contains(score.key()))
+                {
+                    score.value() += termScores.value(score.key());
+                    ++score;
+                }
+                else
+                {
+                    score = scores.erase(score);
+                }
+            }
+        }
+
+        if (scores.isEmpty())
+            return hits;
+    }
+
+    QMultiMap<qreal, quint32> ranked;
+    QHash<quint32, qreal>::const_iterator score = scores.constBegin();
+
+    for (; score != scores.constEnd(); ++score)
+    {
+        const Entry entry = mData.entries.value(score.key());
+        ranked.insert(entry.pageIndex < 0 ? score.value() * documentNameBoost : score.value(), score.key());
+    }
+
+    QMapIterator<qreal, quint32> it(ranked);
+    it.toBack();
+
+    while (it.hasPrevious() && hits.size() < pMaxHits)
+    {
+        it.previous();
+
+        const Entry entry = mData.entries.value(it.value());
+
+        Hit hit;
+        hit.documentPath = entry.documentPath;
+        hit.pageIndex = entry.pageIndex;
+        hit.score = it.key();
+        hit.snippet = snippet(entry, queryTerms);
+
+        hits << hit;
+    }
+
+    return hits;
+}
+
+
+QString UBSearchIndex::snippet(const Entry& pEntry, const QStringList& pTerms) const
+{
+    QString text = QString::fromUtf8(qUncompress(pEntry.text)).simplified();
+    QString folded = fold(text);
+
+    int position = -1;
+
+    foreach(QString term, pTerms)
+    {
+        int termPosition = folded.indexOf(term);
+
+        if (termPosition >= 0 && (position < 0 || termPosition < position))
+            position = termPosition;
+    }
+
+    int start = qMax(0, position - snippetLength / 3);
+
+    QString result = text.mid(start, snippetLength);
+
+    if (start > 0)
+        result = "..." + result;
+
+    if (start + snippetLength < text.length())
+        result += "...";
+
+    return result;
+}
+
+
+void UBSearchIndex::documentCreated(UBDocumentProxy* pDocument)
+{
+    if (mLoaded)
+        indexDocument(pDocument, true);
+}
+
+
+void UBSearchIndex::documentMetadataChanged(UBDocumentProxy* pDocument)
+{
+    if (mLoaded)
+        indexMetadata(pDocument);
+}
+
+
+void UBSearchIndex::documentScenePersisted(UBDocumentProxy* pDocument, int pIndex)
+{
+    if (mLoaded)
+        indexPage(pDocument->persistencePath(), pIndex, true);
+}
+
+
+void UBSearchIndex::documentPagesChanged(UBDocumentProxy* pDocument, int pIndex)
+{
+    Q_UNUSED(pIndex);
+
+    // the files of the following pages are renamed, their dates do not tell
+    if (mLoaded)
+        indexDocument(pDocument, true);
+}
+
+
+void UBSearchIndex::documentWillBeDeleted(UBDocumentProxy* pDocument)
+{
+    if (mLoaded)
+        removeDocument(pDocument->persistencePath());
+}
+
+
+QDataStream& operator<<(QDataStream& pStream, const UBSearchIndex::Posting& pPosting)
+{
+    return pStream << pPosting.entry << pPosting.occurrences;
+}
+
+
+QDataStream& operator>>(QDataStream& pStream, UBSearchIndex::Posting& pPosting)
+{
+    return pStream >> pPosting.entry >> pPosting.occurrences;
+}
+
+
+QDataStream& operator<<(QDataStream& pStream, const UBSearchIndex::Entry& pEntry)
+{
+    return pStream << pEntry.documentPath << pEntry.pageIndex << pEntry.stamp << pEntry.text;
+}
+
+
+QDataStream& operator>>(QDataStream& pStream, UBSearchIndex::Entry& pEntry)
+{
+    return pStream >> pEntry.documentPath >> pEntry.pageIndex >> pEntry.stamp >> pEntry.text;
+}
@@ -0,0 +1,165 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBSEARCHINDEX_H_
+#define UBSEARCHINDEX_H_
+
+#include <QtCore>
+
+class UBDocumentProxy;
+class PDFRenderer;
+
+/**
+ * Full text index of the documents: text items, widget names and PDF text of the pages,
+ * and the document names.
+ *
+ * The pages are read back from their svg file on a worker thread each time they are saved,
+ * the text of their PDF pages is extracted on the GUI thread as xpdf is not reentrant.
+ * The index is kept in memory and written to the data directory in the background; at
+ * startup the pages saved since it was written, or all of them when it is missing, are indexed again.
+ */
+class UBSearchIndex : public QObject
+{
+    Q_OBJECT;
+
+    public:
+        static UBSearchIndex* searchIndex();
+        virtual ~UBSearchIndex();
+
+        struct Hit
+        {
+            QString documentPath;
+            int pageIndex; // -1 when the document name matched
+            qreal score;
+            QString snippet;
+        };
+
+        // all the words of the query must match, the last one as a prefix, best hits first
+        QList<Hit> search(const QString& pQuery, int pMaxHits = 100) const;
+
+        static QStringList terms(const QString& pText);
+
+        struct Posting
+        {
+            quint32 entry;
+            quint16 occurrences;
+        };
+
+        // a page, or the name of a document for page -1
+        struct Entry
+        {
+            QString documentPath;
+            qint32 pageIndex;
+            QDateTime stamp;
+            QByteArray text; // compressed utf-8, for the snippets
+        };
+
+        struct Data
+        {
+            Data()
+                : nextEntryId(0)
+            {
+                // NOOP
+            }
+
+            QHash<quint32, Entry> entries;
+            QHash<QString, quint32> entryIds;
+            QMap<QString, QVector<Posting> > postings;
+            quint32 nextEntryId;
+        };
+
+        struct PageContent
+        {
+            PageContent()
+                : pageIndex(0)
+                , missing(false)
+                , unchanged(false)
+            {
+                // NOOP
+            }
+
+            QString documentPath;
+            int pageIndex;
+            QDateTime stamp;
+            bool missing;
+            bool unchanged;
+            QStringList texts;
+            QList<QPair<QString, int> > pdfPages; // pdf file relative to the document, page number
+        };
+
+        // called from the worker thread
+        void loaded(const Data& pData, bool pSucceeded);
+        void extracted(const PageContent& pContent);
+
+    signals:
+        void indexChanged();
+
+    public slots:
+        void save();
+
+    private slots:
+        void startIndexing();
+        void commitExtracted();
+        void releasePdfRenderer();
+
+        void documentCreated(UBDocumentProxy* pDocument);
+        void documentMetadataChanged(UBDocumentProxy* pDocument);
+        void documentScenePersisted(UBDocumentProxy* pDocument, int pIndex);
+        void documentPagesChanged(UBDocumentProxy* pDocument, int pIndex);
+        void documentWillBeDeleted(UBDocumentProxy* pDocument);
+
+    private:
+        UBSearchIndex(QObject *pParent = 0);
+
+        static QString indexFilePath();
+        static QString entryKey(const QString& pDocumentPath, int pPageIndex);
+
+        void indexDocument(UBDocumentProxy* pDocument, bool pForce);
+        void indexPage(const QString& pDocumentPath, int pPageIndex, bool pForce);
+        void indexMetadata(UBDocumentProxy* pDocument);
+
+        void setEntry(const QString& pDocumentPath, int pPageIndex, const QDateTime& pStamp, const QString& pText);
+        void removeEntry(const QString& pKey);
+        void removeDocument(const QString& pDocumentPath);
+
+        QString pdfPageText(const QString& pDocumentPath, const QString& pPdfPath, int pPageNumber);
+        QString snippet(const Entry& pEntry, const QStringList& pTerms) const;
+
+        void changed();
+
+        static UBSearchIndex* sSearchIndex;
+
+        Data mData;
+        bool mLoaded;
+
+        QThreadPool mThreadPool;
+        QMutex mMutex;
+        QList<PageContent> mExtracted;
+        Data mLoadedData;
+        bool mLoadSucceeded;
+
+        QHash<QString, QString> mPdfTexts;
+        PDFRenderer* mPdfRenderer;
+
+        QTimer mSaveTimer;
+        QTimer mChangedTimer;
+};
+
+QDataStream& operator<<(QDataStream& pStream, const UBSearchIndex::Posting& pPosting);
+QDataStream& operator>>(QDataStream& pStream, UBSearchIndex::Posting& pPosting);
+QDataStream& operator<<(QDataStream& pStream, const UBSearchIndex::Entry& pEntry);
+QDataStream& operator>>(QDataStream& pStream, UBSearchIndex::Entry& pEntry);
+
+#endif /* UBSEARCHINDEX_H_ */
@@ -22,7 +22,7 @@
 #include "core/memcheck.h"
 
 UBSetting::UBSetting(UBSettings* parent) :
-    QObject(parent)
+    QObject(parent), mGeneration(-1)
 {
     //NOOP
 }
@@ -30,7 +30,7 @@ UBSetting::UBSetting(UBSettings* parent) :
 UBSetting::UBSetting(UBSettings* owner, const QString& pDomain, const QString& pKey,
         const QVariant& pDefaultValue) :
     QObject(owner), mOwner(owner), mDomain(pDomain), mKey(pKey), mPath(
-            pDomain + "/" + pKey), mDefaultValue(pDefaultValue)
+            pDomain + "/" + pKey), mDefaultValue(pDefaultValue), mGeneration(-1)
 {
     //NOOP
 }
@@ -51,7 +51,13 @@ void UBSetting::set(const QVariant& pValue)
 
 QVariant UBSetting::get()
 {
-    return mOwner->value(mPath, mDefaultValue);
+    if (mGeneration != mOwner->generation())
+    {
+        mValue = mOwner->value(mPath, mDefaultValue);
+        mGeneration = mOwner->generation();
+    }
+
+    return mValue;
 }
 
 QVariant UBSetting::reset()
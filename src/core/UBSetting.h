@@ -66,6 +66,10 @@ class UBSetting : public QObject
         QString mKey;
         QString mPath;
         QVariant mDefaultValue;
+
+        // last value read, valid while the settings generation is unchanged
+        QVariant mValue;
+        int mGeneration;
 };
 
 
@@ -25,6 +25,8 @@
 
 QPointer<UBSettings> UBSettings::sSingleton = 0;
 
+static const int saveDelayMs = 2000;
+
 int UBSettings::pointerDiameter = 40;
 int UBSettings::crossSize = 32;
 int UBSettings::colorPaletteSize = 4;
@@ -119,9 +121,15 @@ QSettings* UBSettings::getAppSettings()
 
 UBSettings::UBSettings(QObject *parent)
     : QObject(parent)
+    , mGeneration(0)
 {
     InitKeyboardPaletteKeyBtnSizes();
 
+    mSaveTimer = new QTimer(this);
+    mSaveTimer->setSingleShot(true);
+    mSaveTimer->setInterval(saveDelayMs);
+    connect(mSaveTimer, SIGNAL(timeout()), this, SLOT(save()));
+
     mAppSettings = UBSettings::getAppSettings();
 
     QString userSettingsFile = UBSettings::uniboardDataDirectory() + "/UniboardUser.config";
@@ -134,6 +142,8 @@ UBSettings::UBSettings(QObject *parent)
 
 UBSettings::~UBSettings()
 {
+    save();
+
     delete mAppSettings;
 
     if(supportedKeyboardSizes)
@@ -306,6 +316,9 @@ void UBSettings::init()
 
     lastImportFilePath = new UBSetting(this, "Import", "LastImportFilePath", QVariant(UBDesktopServices::storageLocation(QDesktopServices::DocumentsLocation)));
     lastImportFolderPath = new UBSetting(this, "Import", "LastImportFolderPath", QVariant(UBDesktopServices::storageLocation(QDesktopServices::DocumentsLocation)));
+    importImageMaxResolution = new UBSetting(this, "Import", "ImageMaxResolution", 2048); // largest side of imported images, in pixels, 0 keeps the original size
+    printSpoolDirectory = new UBSetting(this, "Print", "SpoolDirectory", ""); // output directory of a CUPS-PDF printer, empty disables the import of print jobs
+    printSpoolAddToCurrentDocument = new UBSetting(this, "Print", "AddToCurrentDocument", false);
     lastExportFilePath = new UBSetting(this, "Export", "LastExportFilePath", QVariant(UBDesktopServices::storageLocation(QDesktopServices::DocumentsLocation)));
     lastExportDirPath = new UBSetting(this, "Export", "LastExportDirPath", QVariant(UBDesktopServices::storageLocation(QDesktopServices::DocumentsLocation)));
     lastImportToLibraryPath = new UBSetting(this, "Library", "LastImportToLibraryPath", QVariant(UBDesktopServices::storageLocation(QDesktopServices::DocumentsLocation)));
@@ -327,6 +340,7 @@ void UBSettings::init()
     defaultDocumentSize = documentSizes.value(DocumentSizeRatio::Ratio4_3);
 
     svgViewBoxMargin = new UBSetting(this, "SVG", "ViewBoxMargin", "50");
+    svgBinaryPages = new UBSetting(this, "SVG", "BinaryPages", true);
 
     pdfMargin = new UBSetting(this, "PDF", "Margin", "20");
     pdfPageFormat = new UBSetting(this, "PDF", "PageFormat", "A4");
@@ -348,6 +362,7 @@ void UBSettings::init()
 
     communityUser = new UBSetting(this, "Community", "Username", "");
     communityPsw = new UBSetting(this, "Community", "Password", "");
+    communityPublishingUrl = new UBSetting(this, "Community", "PublishingUrl", "http://planete.sankore.org/xwiki/bin/view/CreateResources/UniboardUpload?xpage=plain&outputSyntax=plain");
 
     QStringList uris = UBToolsManager::manager()->allToolIDs();
 
@@ -378,18 +393,77 @@ void UBSettings::init()
 
 QVariant UBSettings::value ( const QString & key, const QVariant & defaultValue) const
 {
+    // background savers and thumbnail workers read settings too
+    {
+        QReadLocker readLocker(&mValuesLock);
+
+        QHash<QString, QVariant>::const_iterator it = mValues.constFind(key);
+
+        // a key first read without default is looked up again when a default is given
+        if (it != mValues.constEnd() && (!it.value().isNull() || defaultValue.isNull()))
+        {
+            return it.value();
+        }
+    }
+
+    // the settings files are only touched while holding the write lock
+    QWriteLocker writeLocker(&mValuesLock);
+
+    QHash<QString, QVariant>::const_iterator it = mValues.constFind(key);
+
+    if (it != mValues.constEnd() && (!it.value().isNull() || defaultValue.isNull()))
+    {
+        return it.value();
+    }
+
     if (!sAppSettings->contains(key) && !(defaultValue == QVariant()))
     {
         sAppSettings->setValue(key, defaultValue);
     }
 
-    return mUserSettings->value(key, sAppSettings->value(key, defaultValue));
+    QVariant result = mUserSettings->value(key, sAppSettings->value(key, defaultValue));
+
+    mValues.insert(key, result);
+
+    return result;
 }
 
 
 void UBSettings::setValue (const QString & key, const QVariant & value)
 {
-    mUserSettings->setValue(key, value);
+    {
+        QWriteLocker writeLocker(&mValuesLock);
+        mValues.insert(key, value);
+    }
+
+    mPendingValues.insert(key, value);
+    mGeneration++;
+
+    // a burst of changes (palette, slider) is written once
+    if (!mSaveTimer->isActive())
+        mSaveTimer->start();
+
+    emit valueChanged(key, value);
+}
+
+
+void UBSettings::save()
+{
+    mSaveTimer->stop();
+
+    if (mPendingValues.isEmpty())
+        return;
+
+    QWriteLocker writeLocker(&mValuesLock);
+
+    for (QHash<QString, QVariant>::const_iterator it = mPendingValues.constBegin(); it != mPendingValues.constEnd(); ++it)
+    {
+        mUserSettings->setValue(it.key(), it.value());
+    }
+
+    mPendingValues.clear();
+
+    mUserSettings->sync();
 }
 
 
@@ -266,6 +266,10 @@ class UBSettings : public QObject
 
         UBSetting* lastImportFilePath;
         UBSetting* lastImportFolderPath;
+        UBSetting* importImageMaxResolution;
+
+        UBSetting* printSpoolDirectory;
+        UBSetting* printSpoolAddToCurrentDocument;
 
         UBSetting* lastExportFilePath;
         UBSetting* lastExportDirPath;
@@ -285,6 +289,7 @@ class UBSettings : public QObject
         QSize defaultDocumentSize;
 
         UBSetting* svgViewBoxMargin;
+        UBSetting* svgBinaryPages;
         UBSetting* pdfMargin;
         UBSetting* pdfPageFormat;
         UBSetting* pdfResolution;
@@ -328,6 +333,7 @@ class UBSettings : public QObject
 
         UBSetting* communityUser;
         UBSetting* communityPsw;
+        UBSetting* communityPublishingUrl;
 
         /*
         static int navigPaletteWidth;
@@ -352,6 +358,9 @@ class UBSettings : public QObject
         void setPenPressureSensitive(bool sensitive);
         void setMarkerPressureSensitive(bool sensitive);
 
+        // writes the pending changes now, they are otherwise written a moment after the last one
+        void save();
+
         QVariant value ( const QString & key, const QVariant & defaultValue = QVariant() ) const;
         void setValue (const QString & key,const QVariant & value);
 
@@ -362,12 +371,28 @@ class UBSettings : public QObject
 
     signals:
         void colorContextChanged();
+        void valueChanged(const QString& key, const QVariant& value);
+
+    public:
+
+        // incremented on every change, lets UBSetting keep its value between changes
+        int generation() const
+        {
+            return mGeneration;
+        }
 
     private:
 
         QSettings* mAppSettings;
         QSettings* mUserSettings;
 
+        // values read once from the settings files, and changes not yet written
+        mutable QHash<QString, QVariant> mValues;
+        mutable QReadWriteLock mValuesLock;
+        QHash<QString, QVariant> mPendingValues;
+        QTimer* mSaveTimer;
+        int mGeneration;
+
         static const int sDefaultFontPixelSize;
         static const char *sDefaultFontFamily;
 
@@ -10,7 +10,13 @@ HEADERS      += src/core/UB.h \
                 src/core/UBIdleTimer.h \
                 src/core/UBDisplayManager.h \
                 src/core/UBDocumentManager.h \
-                src/core/UBApplicationController.h
+                src/core/UBApplicationController.h \
+                src/core/UBDocumentDuplicator.h \
+                src/core/UBImageImporter.h \
+                src/core/UBPdfThumbnailer.h \
+                src/core/UBPrintSpoolImporter.h \
+                src/core/UBSearchIndex.h \
+                src/core/UBDocumentJournal.h
                 
 SOURCES      += src/core/main.cpp \
                 src/core/UBApplication.cpp \
@@ -23,6 +29,12 @@ SOURCES      += src/core/main.cpp \
                 src/core/UBIdleTimer.cpp \
                 src/core/UBDisplayManager.cpp \
                 src/core/UBDocumentManager.cpp \
-                src/core/UBApplicationController.cpp
+                src/core/UBApplicationController.cpp \
+                src/core/UBDocumentDuplicator.cpp \
+                src/core/UBImageImporter.cpp \
+                src/core/UBPdfThumbnailer.cpp \
+                src/core/UBPrintSpoolImporter.cpp \
+                src/core/UBSearchIndex.cpp \
+                src/core/UBDocumentJournal.cpp
     
     
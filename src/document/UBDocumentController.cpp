@@ -25,6 +25,10 @@
 #include "core/UBApplication.h"
 #include "core/UBPersistenceManager.h"
 #include "core/UBDocumentManager.h"
+#include "core/UBDocumentDuplicator.h"
+#include "core/UBImageImporter.h"
+#include "core/UBPdfThumbnailer.h"
+#include "core/UBSearchIndex.h"
 #include "core/UBApplicationController.h"
 #include "core/UBSettings.h"
 #include "core/UBSetting.h"
@@ -112,6 +116,25 @@ UBDocumentProxyTreeItem* UBDocumentController::findDocument(UBDocumentProxy* pro
         ++it;
     }
 
+    // in a group never expanded yet
+    for (int i = 0; i < mDocumentUI->documentTreeWidget->topLevelItemCount(); i++)
+    {
+        UBDocumentGroupTreeItem* groupItem = dynamic_cast<UBDocumentGroupTreeItem*>(mDocumentUI->documentTreeWidget->topLevelItem(i));
+
+        if (!groupItem || !groupItem->hasPendingDocument(proxy))
+            continue;
+
+        groupItem->populate();
+
+        for (int j = 0; j < groupItem->childCount(); j++)
+        {
+            UBDocumentProxyTreeItem *treeItem = dynamic_cast<UBDocumentProxyTreeItem*>(groupItem->child(j));
+
+            if (treeItem && treeItem->proxy() == proxy)
+                return treeItem;
+        }
+    }
+
     return 0;
 }
 
@@ -145,6 +168,9 @@ void UBDocumentController::selectDocument(UBDocumentProxy* proxy, bool setAsCurr
         ++it;
     }
 
+    if (!selected)
+        selected = findDocument(proxy);
+
     if (selected)
     {
         selected->setSelected(true);
@@ -271,12 +297,18 @@ void UBDocumentController::refreshDocumentThumbnailsView()
     if (proxy)
     {
 	mCurrentDocument = proxy;
-        QList<QPixmap> thumbs = UBThumbnailAdaptor::load(proxy);
+        QStringList thumbs = UBThumbnailAdaptor::thumbnailPaths(proxy);
 
         for (int i = 0; i < thumbs.count(); i++)
         {
-            QPixmap pix = thumbs.at(i);
-            QGraphicsPixmapItem *pixmapItem = new UBSceneThumbnailPixmap(pix, proxy, i); // deleted by the tree widget
+            // only the header of the file is read, the thumbnails are decoded as they are scrolled into view
+            QSize thumbSize = QImageReader(thumbs.at(i)).size();
+            QGraphicsPixmapItem *pixmapItem = 0;
+
+            if (thumbSize.isValid())
+                pixmapItem = new UBSceneThumbnailPixmap(thumbs.at(i), thumbSize, proxy, i); // deleted by the tree widget
+            else
+                pixmapItem = new UBSceneThumbnailPixmap(QPixmap(thumbs.at(i)), proxy, i); // deleted by the tree widget
 
             if (proxy == mBoardController->activeDocument() && mBoardController->activeSceneIndex() == i)
             {
@@ -439,6 +471,22 @@ void UBDocumentController::setupViews()
         connect(UBPersistenceManager::persistenceManager(), SIGNAL(documentSceneWillBeDeleted(UBDocumentProxy*, int)),
                 this, SLOT(documentSceneChanged(UBDocumentProxy*, int)));
 
+        connect(UBPersistenceManager::persistenceManager(), SIGNAL(documentDuplicated(UBDocumentProxy*, UBDocumentProxy*)),
+                this, SLOT(documentDuplicated(UBDocumentProxy*, UBDocumentProxy*)));
+
+        connect(UBPdfThumbnailer::pdfThumbnailer(), SIGNAL(thumbnailRendered(UBDocumentProxy*, int)),
+                this, SLOT(documentThumbnailRendered(UBDocumentProxy*, int)));
+
+        mDocumentUI->searchLineEdit->setToolTip(tr("Search the text of the documents"));
+        mDocumentUI->searchResultsList->hide();
+
+        connect(mDocumentUI->searchLineEdit, SIGNAL(textChanged(const QString&)), this, SLOT(search()));
+        connect(mDocumentUI->searchResultsList, SIGNAL(itemClicked(QListWidgetItem*)), this, SLOT(searchResultClicked(QListWidgetItem*)));
+        connect(mDocumentUI->searchResultsList, SIGNAL(itemDoubleClicked(QListWidgetItem*)), this, SLOT(searchResultDoubleClicked(QListWidgetItem*)));
+
+        // the pages are indexed in the background, the results follow
+        connect(UBSearchIndex::searchIndex(), SIGNAL(indexChanged()), this, SLOT(search()));
+
         mDocumentUI->thumbnailWidget->setBackgroundBrush(UBSettings::documentViewLightColor);
 
         mMessageWindow = new UBMessageWindow(mDocumentUI->thumbnailWidget);
@@ -603,18 +651,50 @@ void UBDocumentController::duplicateSelectedItem()
 
                 showMessage(tr("Duplicating Document %1").arg(docName), true);
 
-            UBDocumentProxy* duplicatedDoc = UBPersistenceManager::persistenceManager()->duplicateDocument(source);
-            duplicatedDoc->setMetaData(UBSettings::documentUpdatedAt, UBStringUtils::toUtcIsoDateTime(QDateTime::currentDateTime()));
-            UBMetadataDcSubsetAdaptor::persist(duplicatedDoc);
+            // assets are shared with the source where possible, the copy finishes in documentDuplicated
+            UBDocumentDuplicator* duplicator = UBPersistenceManager::persistenceManager()->duplicateDocumentInBackground(source);
+            connect(duplicator, SIGNAL(progress(int)), this, SLOT(documentDuplicationProgress(int)));
 
-            selectDocument(duplicatedDoc, false);
+            QProgressDialog* progressDialog = new QProgressDialog(tr("Duplicating Document %1").arg(docName), tr("Cancel"), 0, 100, mParentWidget);
+            progressDialog->setWindowModality(Qt::NonModal);
+            progressDialog->setMinimumDuration(1000);
 
-            showMessage(tr("Document %1 copied").arg(docName), false);
+            connect(duplicator, SIGNAL(progress(int)), progressDialog, SLOT(setValue(int)));
+            connect(duplicator, SIGNAL(destroyed()), progressDialog, SLOT(deleteLater()));
+            connect(progressDialog, SIGNAL(canceled()), duplicator, SLOT(cancel()));
         }
     }
 }
 
 
+void UBDocumentController::documentDuplicationProgress(int pPercent)
+{
+    UBDocumentDuplicator* duplicator = qobject_cast<UBDocumentDuplicator*>(sender());
+
+    if (duplicator)
+        showMessage(tr("Duplicating Document %1 (%2%)").arg(duplicator->name()).arg(pPercent), true);
+}
+
+
+void UBDocumentController::documentDuplicated(UBDocumentProxy* pSourceProxy, UBDocumentProxy* pCopyProxy)
+{
+    Q_UNUSED(pSourceProxy);
+
+    if (!pCopyProxy)
+    {
+        showMessage(tr("Document duplication cancelled"), false);
+        return;
+    }
+
+    pCopyProxy->setMetaData(UBSettings::documentUpdatedAt, UBStringUtils::toUtcIsoDateTime(QDateTime::currentDateTime()));
+    UBMetadataDcSubsetAdaptor::persist(pCopyProxy);
+
+    selectDocument(pCopyProxy, false);
+
+    showMessage(tr("Document %1 copied").arg(pCopyProxy->metaData(UBSettings::documentName).toString()), false);
+}
+
+
 void UBDocumentController::deleteSelectedItem()
 {
     if (mSelectionType == Page)
@@ -674,6 +754,8 @@ void UBDocumentController::deleteSelectedItem()
             {
                 if (proxyTi->parent() == mTrashTi)
                 {
+                    mTrashTi->populate();
+
                     int index = proxyTi->parent()->indexOfChild(proxyTi);
                     index --;
 
@@ -703,8 +785,9 @@ void UBDocumentController::deleteSelectedItem()
                             {
                                 QTreeWidgetItem* item = mDocumentUI->documentTreeWidget->topLevelItem(i);
                                 UBDocumentGroupTreeItem* groupItem = dynamic_cast<UBDocumentGroupTreeItem*>(item);
-                                if (groupItem != selectedDocumentGroupTreeItem() && groupItem->childCount() > 0)
+                                if (groupItem != selectedDocumentGroupTreeItem() && groupItem->documentCount() > 0)
                                 {
+                                    groupItem->populate();
                                     selectDocument(((UBDocumentProxyTreeItem*)groupItem->child(0))->proxy());
                                     break;
                                 }
@@ -728,6 +811,7 @@ void UBDocumentController::deleteSelectedItem()
                     UBPersistenceManager::persistenceManager()->persistDocumentMetadata(proxyTi->proxy());
 
                     proxyTi->parent()->removeChild(proxyTi);
+                    mTrashTi->populate();
                     mTrashTi->addChild(proxyTi);
                     proxyTi->setFlags(proxyTi->flags() ^ Qt::ItemIsEditable);
                 }
@@ -742,6 +826,8 @@ void UBDocumentController::deleteSelectedItem()
                         QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes)
                 {
                     QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+                    groupTi->populate();
+
                     QList<UBDocumentProxyTreeItem*> toBeDeleted;
 
                     for (int i = 0; i < groupTi->childCount(); i++)
@@ -774,6 +860,7 @@ void UBDocumentController::deleteSelectedItem()
                         QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes)
                 {
                     QApplication::setOverrideCursor(QCursor(Qt::WaitCursor));
+                    groupTi->populate();
 
                     bool changeCurrentDocument = false;
                     for (int i = 0; i < groupTi->childCount(); i++)
@@ -792,8 +879,9 @@ void UBDocumentController::deleteSelectedItem()
                         {
                             QTreeWidgetItem* item = mDocumentUI->documentTreeWidget->topLevelItem(i);
                             UBDocumentGroupTreeItem* groupItem = dynamic_cast<UBDocumentGroupTreeItem*>(item);
-                            if (groupItem != groupTi && groupItem->childCount() > 0)
+                            if (groupItem != groupTi && groupItem->documentCount() > 0)
                             {
+                                groupItem->populate();
                                 selectDocument(((UBDocumentProxyTreeItem*)groupItem->child(0))->proxy());
                                 break;
                             }
@@ -820,6 +908,7 @@ void UBDocumentController::deleteSelectedItem()
                         UBPersistenceManager::persistenceManager()->persistDocumentMetadata(proxyTi->proxy());
 
                         groupTi->removeChild(proxyTi);
+                        mTrashTi->populate();
                         mTrashTi->addChild(proxyTi);
                         proxyTi->setFlags(proxyTi->flags() ^ Qt::ItemIsEditable);
 
@@ -888,6 +977,12 @@ UBGraphicsScene* UBDocumentController::activeScene()
 }
 
 
+static bool updatedLater(const QPair<QString, UBDocumentProxy*>& pFirst, const QPair<QString, UBDocumentProxy*>& pSecond)
+{
+    return pFirst.first > pSecond.first;
+}
+
+
 void UBDocumentController::loadDocumentProxies()
 {
     QList<QPointer<UBDocumentProxy> > proxies = UBPersistenceManager::persistenceManager()->documentProxies;
@@ -899,6 +994,10 @@ void UBDocumentController::loadDocumentProxies()
     QMap<QString, UBDocumentGroupTreeItem*> groupNamesMap;
 
     UBDocumentGroupTreeItem* emptyGroupNameTi = 0;
+    UBDocumentGroupTreeItem* activeGroupTi = 0;
+
+    // sorted once per group, the items are created when their group is expanded
+    QMap<UBDocumentGroupTreeItem*, QList<QPair<QString, UBDocumentProxy*> > > groupDocuments;
 
     mTrashTi = new UBDocumentGroupTreeItem(0, false); // deleted by the tree widget
     mTrashTi->setGroupName(UBSettings::documentTrashGroupName);
@@ -923,8 +1022,6 @@ void UBDocumentController::loadDocumentProxies()
                 isInTrash = true;
             }
 
-            QString docName = proxy->metaData(UBSettings::documentName).toString();
-
             if (emptyGroupNames.contains(docGroup))
                 emptyGroupNames.removeAll(docGroup);
 
@@ -944,17 +1041,28 @@ void UBDocumentController::loadDocumentProxies()
             else
                 docGroupItem = groupNamesMap.value(docGroup);
 
-            QTreeWidgetItem* docItem = new UBDocumentProxyTreeItem(docGroupItem, proxy, !isInTrash);
-            docItem->setText(0, docName);
+            groupDocuments[docGroupItem] << qMakePair(proxy->metaData(UBSettings::documentUpdatedAt).toString(), (UBDocumentProxy*)proxy);
 
             if (mBoardController->activeDocument() == proxy)
-            {
-                mDocumentUI->documentTreeWidget->expandItem(docGroupItem);
-                mDocumentUI->documentTreeWidget->setCurrentItem(docGroupItem);
-            }
+                activeGroupTi = docGroupItem;
         }
     }
 
+    foreach(UBDocumentGroupTreeItem* docGroupItem, groupDocuments.keys())
+    {
+        QList<QPair<QString, UBDocumentProxy*> > documents = groupDocuments.value(docGroupItem);
+
+        // most recently updated first, the order UBDocumentProxyTreeItem inserts them
+        qStableSort(documents.begin(), documents.end(), updatedLater);
+
+        QList<UBDocumentProxy*> proxies;
+
+        for (int i = 0; i < documents.size(); i++)
+            proxies << documents.at(i).second;
+
+        docGroupItem->setPendingDocuments(proxies);
+    }
+
     foreach (const QString emptyGroupName, emptyGroupNames)
     {
         UBDocumentGroupTreeItem* docGroupItem = new UBDocumentGroupTreeItem(0); // deleted by the tree widget
@@ -977,6 +1085,13 @@ void UBDocumentController::loadDocumentProxies()
         mDocumentUI->documentTreeWidget->addTopLevelItem(emptyGroupNameTi);
 
     mDocumentUI->documentTreeWidget->addTopLevelItem(mTrashTi);
+
+    if (activeGroupTi)
+    {
+        activeGroupTi->populate();
+        mDocumentUI->documentTreeWidget->expandItem(activeGroupTi);
+        mDocumentUI->documentTreeWidget->setCurrentItem(activeGroupTi);
+    }
 }
 
 
@@ -1010,6 +1125,8 @@ void UBDocumentController::itemChanged(QTreeWidgetItem * item, int column)
         UBDocumentGroupTreeItem* editedGroup = dynamic_cast<UBDocumentGroupTreeItem*>(item);
         if (editedGroup)
         {
+            editedGroup->populate();
+
             for (int i = 0; i < item->childCount(); i++)
             {
                 UBDocumentProxyTreeItem* childItem = dynamic_cast<UBDocumentProxyTreeItem*>(item->child(i));
@@ -1095,25 +1212,71 @@ void UBDocumentController::addFolderOfImages()
         {
             QDir dir(imagesDir);
 
-            int importedImageNumber
-                  = UBDocumentManager::documentManager()->addImageDirToDocument(dir, document);
+            UBImageImporter* importer = UBDocumentManager::documentManager()->addImageDirToDocumentInBackground(dir, document);
 
-            if (importedImageNumber == 0)
-            {
-                UBApplication::showMessage(tr("Folder does not contain any image files!"));
-                UBApplication::applicationController->showDocument();
-            }
-            else
-            {
-                document->setMetaData(UBSettings::documentUpdatedAt, UBStringUtils::toUtcIsoDateTime(QDateTime::currentDateTime()));
-                UBMetadataDcSubsetAdaptor::persist(document);
-                refreshDocumentThumbnailsView();
-            }
+            showImageImport(importer, importer->imageCount(), tr("Folder does not contain any image files!"));
         }
     }
 }
 
 
+void UBDocumentController::showImageImport(UBImageImporter* pImporter, int pImageCount, const QString& pNoImageMessage)
+{
+    mNoImageMessages.insert(pImporter, pNoImageMessage);
+
+    QProgressDialog* progressDialog = new QProgressDialog(tr("Importing images..."), tr("Cancel"), 0, pImageCount, mParentWidget);
+    progressDialog->setWindowModality(Qt::NonModal);
+    progressDialog->setMinimumDuration(1000);
+
+    connect(pImporter, SIGNAL(progress(int, int)), progressDialog, SLOT(setValue(int)));
+    connect(pImporter, SIGNAL(destroyed()), progressDialog, SLOT(deleteLater()));
+    connect(progressDialog, SIGNAL(canceled()), pImporter, SLOT(cancel()));
+
+    connect(pImporter, SIGNAL(progress(int, int)), this, SLOT(imageImportProgress(int, int)));
+    connect(pImporter, SIGNAL(finished(UBDocumentProxy*, int, bool)), this, SLOT(imagesImported(UBDocumentProxy*, int, bool)));
+}
+
+
+void UBDocumentController::imageImportProgress(int pCurrent, int pTotal)
+{
+    UBImageImporter* importer = qobject_cast<UBImageImporter*>(sender());
+
+    if (!importer)
+        return;
+
+    UBApplication::showMessage(tr("Importing page %1 of %2").arg(pCurrent).arg(pTotal));
+
+    // the new pages show up while the import goes on, without reloading all the thumbnails for each one
+    if (importer->document() == selectedDocumentProxy() && pCurrent % 10 == 0)
+        refreshDocumentThumbnailsView();
+}
+
+
+void UBDocumentController::imagesImported(UBDocumentProxy* pDocument, int pImportedCount, bool pCancelled)
+{
+    QString noImageMessage = mNoImageMessages.take(qobject_cast<UBImageImporter*>(sender()));
+
+    if (pImportedCount == 0 && !pCancelled)
+    {
+        UBApplication::showMessage(noImageMessage);
+        UBApplication::applicationController->showDocument();
+        return;
+    }
+
+    if (pImportedCount > 0)
+    {
+        pDocument->setMetaData(UBSettings::documentUpdatedAt, UBStringUtils::toUtcIsoDateTime(QDateTime::currentDateTime()));
+        UBMetadataDcSubsetAdaptor::persist(pDocument);
+    }
+
+    if (pCancelled)
+        UBApplication::showMessage(tr("Import cancelled, %1 images imported").arg(pImportedCount));
+
+    if (pDocument == selectedDocumentProxy())
+        refreshDocumentThumbnailsView();
+}
+
+
 void UBDocumentController::addFileToDocument()
 {
     UBDocumentProxy* document = selectedDocumentProxy();
@@ -1245,7 +1408,7 @@ void UBDocumentController::selectionChanged()
             deleteEnabled = true;
         else if (groupSelected && selectedDocumentGroupTreeItem())
         {
-            if (selectedDocumentGroupTreeItem()->childCount() > 0)
+            if (selectedDocumentGroupTreeItem()->documentCount() > 0)
                 deleteEnabled = true;
         }
     }
@@ -1297,6 +1460,26 @@ void UBDocumentController::documentSceneChanged(UBDocumentProxy* proxy, int pSce
 }
 
 
+void UBDocumentController::documentThumbnailRendered(UBDocumentProxy* proxy, int pSceneIndex)
+{
+    if (proxy != selectedDocumentProxy())
+        return;
+
+    // only the placeholder is replaced, the view keeps its selection and scroll position
+    foreach(QGraphicsItem* item, mDocumentUI->thumbnailWidget->scene()->items())
+    {
+        UBSceneThumbnailPixmap* thumbnail = dynamic_cast<UBSceneThumbnailPixmap*>(item);
+
+        if (thumbnail && thumbnail->proxy() == proxy && thumbnail->sceneIndex() == pSceneIndex)
+        {
+            thumbnail->setThumbnail(QPixmap(proxy->persistencePath()
+                    + UBFileSystemUtils::digitFileFormat("/page%1.thumbnail.jpg", pSceneIndex + 1)));
+            break;
+        }
+    }
+}
+
+
 void UBDocumentController::pageDoubleClicked(QGraphicsItem* item, int index)
 {
     Q_UNUSED(item);
@@ -1335,17 +1518,13 @@ void UBDocumentController::closing()
 
     for (int i = 0; i < mDocumentUI->documentTreeWidget->topLevelItemCount(); i++)
     {
-        QTreeWidgetItem* item = mDocumentUI->documentTreeWidget->topLevelItem(i);
+        UBDocumentGroupTreeItem* groupItem = dynamic_cast<UBDocumentGroupTreeItem*>(mDocumentUI->documentTreeWidget->topLevelItem(i));
 
-        if (item->childCount() == 0)
+        if (groupItem && groupItem->documentCount() == 0)
         {
-            UBDocumentGroupTreeItem* groupItem = dynamic_cast<UBDocumentGroupTreeItem*>(item);
-            if (groupItem)
-            {
-                QString groupName = groupItem->groupName();
-                if (!emptyGroups.contains(groupName) && groupName != UBSettings::documentTrashGroupName)
-                    emptyGroups << groupName;
-            }
+            QString groupName = groupItem->groupName();
+            if (!emptyGroups.contains(groupName) && groupName != UBSettings::documentTrashGroupName)
+                emptyGroups << groupName;
         }
     }
 
@@ -1427,6 +1606,8 @@ void UBDocumentController::addDocumentInTree(UBDocumentProxy* pDocument)
         mDocumentUI->documentTreeWidget->addTopLevelItem(group);
     }
 
+    group->populate();
+
     UBDocumentProxyTreeItem *ti = new UBDocumentProxyTreeItem(group, pDocument, !group->isTrashFolder());
     ti->setText(0, documentName);
 }
@@ -1545,20 +1726,9 @@ void UBDocumentController::addImages()
 
             UBSettings::settings()->lastImportFolderPath->set(QVariant(firstImage.absoluteDir().absolutePath()));
 
-            int importedImageNumber
-                  = UBDocumentManager::documentManager()->addImageAsPageToDocument(images, document);
+            UBImageImporter* importer = UBDocumentManager::documentManager()->addImageAsPageToDocumentInBackground(images, document);
 
-            if (importedImageNumber == 0)
-            {
-                UBApplication::showMessage(tr("Selection does not contain any image files!"));
-                UBApplication::applicationController->showDocument();
-            }
-            else
-            {
-                document->setMetaData(UBSettings::documentUpdatedAt, UBStringUtils::toUtcIsoDateTime(QDateTime::currentDateTime()));
-                UBMetadataDcSubsetAdaptor::persist(document);
-                refreshDocumentThumbnailsView();
-            }
+            showImageImport(importer, images.size(), tr("Selection does not contain any image files!"));
         }
     }
 }
@@ -1641,3 +1811,79 @@ void UBDocumentController::focusChanged(QWidget *old, QWidget *current)
     selectionChanged();
 }
 
+
+
+UBDocumentProxy* UBDocumentController::proxyForPath(const QString& pPersistencePath)
+{
+    foreach(QPointer<UBDocumentProxy> proxy, UBPersistenceManager::persistenceManager()->documentProxies)
+    {
+        if (proxy && proxy->persistencePath() == pPersistencePath)
+            return proxy;
+    }
+
+    return 0;
+}
+
+
+void UBDocumentController::search()
+{
+    QString query = mDocumentUI->searchLineEdit->text();
+
+    mDocumentUI->searchResultsList->clear();
+
+    if (query.trimmed().isEmpty())
+    {
+        mDocumentUI->searchResultsList->hide();
+        mDocumentUI->documentTreeWidget->show();
+        return;
+    }
+
+    foreach(UBSearchIndex::Hit hit, UBSearchIndex::searchIndex()->search(query))
+    {
+        UBDocumentProxy* proxy = proxyForPath(hit.documentPath);
+
+        // the documents in the trash are not searched
+        if (!proxy || proxy->metaData(UBSettings::documentGroupName).toString().startsWith(UBSettings::trashedDocumentGroupNamePrefix))
+            continue;
+
+        QString title = proxy->metaData(UBSettings::documentName).toString();
+
+        if (hit.pageIndex >= 0)
+            title = tr("%1 - page %2").arg(title).arg(hit.pageIndex + 1);
+
+        QListWidgetItem* item = new QListWidgetItem(title + "\n" + hit.snippet, mDocumentUI->searchResultsList);
+        item->setData(Qt::UserRole, hit.documentPath);
+        item->setData(Qt::UserRole + 1, hit.pageIndex);
+    }
+
+    mDocumentUI->documentTreeWidget->hide();
+    mDocumentUI->searchResultsList->show();
+}
+
+
+void UBDocumentController::searchResultClicked(QListWidgetItem* pItem)
+{
+    UBDocumentProxy* proxy = proxyForPath(pItem->data(Qt::UserRole).toString());
+
+    if (!proxy)
+        return;
+
+    selectDocument(proxy, false);
+
+    int pageIndex = pItem->data(Qt::UserRole + 1).toInt();
+
+    if (pageIndex >= 0)
+        mDocumentUI->thumbnailWidget->hightlightItem(pageIndex);
+}
+
+
+void UBDocumentController::searchResultDoubleClicked(QListWidgetItem* pItem)
+{
+    UBDocumentProxy* proxy = proxyForPath(pItem->data(Qt::UserRole).toString());
+
+    if (!proxy || !isOKToOpenDocument(proxy))
+        return;
+
+    mBoardController->setActiveDocumentScene(proxy, qMax(0, pItem->data(Qt::UserRole + 1).toInt()));
+    UBApplication::applicationController->showBoard();
+}
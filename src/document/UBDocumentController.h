@@ -35,6 +35,7 @@ class UBDocumentProxyTreeItem;
 class UBMainWindow;
 class UBDocumentToolsPalette;
 class UBKeyboardPalette;
+class UBImageImporter;
 
 class UBDocumentController : public QObject
 {
@@ -50,6 +51,9 @@ class UBDocumentController : public QObject
         bool addFileToDocument(UBDocumentProxy* document);
         UBDocumentProxy* getCurrentDocument();
 
+    private:
+        void showImageImport(UBImageImporter* pImporter, int pImageCount, const QString& pNoImageMessage);
+
     signals:
         void refreshThumbnails();
         void exportDone();
@@ -112,6 +116,11 @@ class UBDocumentController : public QObject
 
         UBKeyboardPalette *mKeyboardPalette;
 
+        // shown when an import ends without any page, the folder and the selection have their own
+        QMap<UBImageImporter*, QString> mNoImageMessages;
+
+        UBDocumentProxy* proxyForPath(const QString& pPersistencePath);
+
 
     private slots:
         void documentZoomSliderValueChanged (int value);
@@ -124,6 +133,7 @@ class UBDocumentController : public QObject
         void pageSelectionChanged();
         void selectionChanged();
         void documentSceneChanged(UBDocumentProxy* proxy, int pSceneIndex);
+        void documentThumbnailRendered(UBDocumentProxy* proxy, int pSceneIndex);
         void pageDoubleClicked(QGraphicsItem* item, int index);
         void pageClicked(QGraphicsItem* item, int index);
         void itemClicked(QTreeWidgetItem * item, int column );
@@ -133,6 +143,13 @@ class UBDocumentController : public QObject
         void addFolderOfImages();
         void addFileToDocument();
         void addImages();
+        void documentDuplicationProgress(int pPercent);
+        void documentDuplicated(UBDocumentProxy* pSourceProxy, UBDocumentProxy* pCopyProxy);
+        void imageImportProgress(int pCurrent, int pTotal);
+        void imagesImported(UBDocumentProxy* pDocument, int pImportedCount, bool pCancelled);
+        void search();
+        void searchResultClicked(QListWidgetItem* pItem);
+        void searchResultDoubleClicked(QListWidgetItem* pItem);
 
 };
 
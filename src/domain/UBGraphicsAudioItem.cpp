@@ -23,22 +23,13 @@ UBGraphicsAudioItem::UBGraphicsAudioItem(const QUrl& pAudioFileUrl, QGraphicsIte
 {
     update();
 
-    mAudioOutput = new Phonon::AudioOutput ( Phonon::MusicCategory, this );
-    mMediaObject = new Phonon::MediaObject ( this );
-    mMediaObject->setTickInterval ( 1000 );
-    Phonon::createPath ( mMediaObject, mAudioOutput );
-
-    mMediaObject->clearQueue();
-    mSource = Phonon::MediaSource(pAudioFileUrl);
-    mMediaObject->setCurrentSource (mSource );
-
-    connect (mMediaObject,SIGNAL ( tick ( qint64 ) ), this, SLOT ( tick ( qint64 ) ) );
-    connect(mMediaObject, SIGNAL(stateChanged(Phonon::State,Phonon::State)), this, SLOT(onStateChanged(Phonon::State,Phonon::State)));
+    // the media object is only taken from the pipeline pool when the item is played
+    connect ( this, SIGNAL ( mediaTick ( qint64 ) ), this, SLOT ( tick ( qint64 ) ) );
+    connect ( this, SIGNAL ( mediaStateChanged ( Phonon::State, Phonon::State ) ), this, SLOT ( onStateChanged ( Phonon::State, Phonon::State ) ) );
 
     mAudioWidget = new QWidget();
 
     mSeekSlider = new Phonon::SeekSlider ( mAudioWidget );
-    mSeekSlider->setMediaObject ( mMediaObject );
 
     QPalette palette;
     palette.setBrush ( QPalette::Light, Qt::darkGray );
@@ -57,7 +48,7 @@ UBGraphicsAudioItem::UBGraphicsAudioItem(const QUrl& pAudioFileUrl, QGraphicsIte
     mAudioWidget->setLayout ( mainLayout );
     setWidget ( mAudioWidget );
 
-    UBGraphicsAudioItemDelegate* delegate = new UBGraphicsAudioItemDelegate ( this, mMediaObject );
+    UBGraphicsAudioItemDelegate* delegate = new UBGraphicsAudioItemDelegate ( this );
     delegate->init();
     setDelegate ( delegate );
 
@@ -71,20 +62,33 @@ void UBGraphicsAudioItem::onStateChanged(Phonon::State newState, Phonon::State o
     qDebug() << "old state:" << oldState;
     qDebug() << "new state:" << newState;
 
-    if(oldState == Phonon::ErrorState)
+    if(oldState == Phonon::ErrorState && mediaObject())
     {
-        qDebug() << "ERROR! : " << mMediaObject->errorString();
+        qDebug() << "ERROR! : " << mediaObject()->errorString();
     }
     else if(newState == Phonon::LoadingState)
     {
-        int itotaltime = mMediaObject->totalTime();
+        int itotaltime = totalTime();
         qDebug() << "[Loading State entered!] Total time : " << itotaltime;
     }
 }
 
 UBGraphicsAudioItem::~UBGraphicsAudioItem()
 {
-    //NOOP
+    releasePipeline();
+}
+
+
+void UBGraphicsAudioItem::pipelineAttached()
+{
+    mediaObject()->setTickInterval ( 1000 );
+    mSeekSlider->setMediaObject ( mediaObject() );
+}
+
+
+void UBGraphicsAudioItem::pipelineDetached()
+{
+    mSeekSlider->setMediaObject ( 0 );
 }
 
 UBItem* UBGraphicsAudioItem::deepCopy() const
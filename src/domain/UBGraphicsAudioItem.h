@@ -38,6 +38,10 @@ public:
 
     virtual UBItem* deepCopy () const;
 
+protected:
+
+    virtual void pipelineAttached();
+    virtual void pipelineDetached();
 
 private slots:
 
@@ -50,8 +54,6 @@ protected:
     QLCDNumber* mTimeLcd;
 
     Phonon::SeekSlider* mSeekSlider;
-private:
-    Phonon::MediaSource mSource;
 
 };
 
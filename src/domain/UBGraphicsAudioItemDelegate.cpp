@@ -48,12 +48,12 @@ void UBGraphicsAudioItemDelegate::buildButtons()
 
 
     connect ( mPlayPauseButton, SIGNAL ( clicked ( bool ) ), this, SLOT ( togglePlayPause() ) );
-    connect ( mStopButton, SIGNAL ( clicked ( bool ) ), mDelegated->mediaObject(), SLOT ( stop() ) );
+    connect ( mStopButton, SIGNAL ( clicked ( bool ) ), mDelegated, SLOT ( stop() ) );
     connect ( mMuteButton, SIGNAL ( clicked ( bool ) ), mDelegated, SLOT ( toggleMute() ) );
     connect ( mMuteButton, SIGNAL ( clicked ( bool ) ), this, SLOT ( toggleMute() ) );
 
-    connect ( mDelegated->mediaObject(), SIGNAL ( stateChanged ( Phonon::State, Phonon::State ) ), this, SLOT ( mediaStateChanged ( Phonon::State, Phonon::State ) ) );
-    connect ( mDelegated->mediaObject(), SIGNAL ( finished() ), this, SLOT ( updatePlayPauseState() ) );
+    connect ( mDelegated, SIGNAL ( mediaStateChanged ( Phonon::State, Phonon::State ) ), this, SLOT ( mediaStateChanged ( Phonon::State, Phonon::State ) ) );
+    connect ( mDelegated, SIGNAL ( mediaFinished() ), this, SLOT ( updatePlayPauseState() ) );
 
     mButtons << mPlayPauseButton << mStopButton << mMuteButton;
 
@@ -61,43 +61,18 @@ void UBGraphicsAudioItemDelegate::buildButtons()
 
 void UBGraphicsAudioItemDelegate::togglePlayPause()
 {
-    if ( mDelegated && mDelegated->mediaObject() )
+    if ( mDelegated )
     {
-        Phonon::MediaObject* media = mDelegated->mediaObject();
-
-        if ( media->state() == Phonon::StoppedState )
-        {
-            media->play();
-        }
-        else if ( media->state() == Phonon::PlayingState )
+        // play() takes a pipeline from the pool and restarts a finished media
+        if ( mDelegated->state() == Phonon::PlayingState && mDelegated->remainingTime() > 0 )
         {
-            if ( media->remainingTime() <= 0 )
-            {
-                media->stop();
-                media->play();
-            }
-            else
-            {
-                media->pause();
-                if ( mDelegated->scene() )
-                    mDelegated->scene()->setModified ( true );
-            }
+            mDelegated->pause();
+            if ( mDelegated->scene() )
+                mDelegated->scene()->setModified ( true );
         }
-        else if ( media->state() == Phonon::PausedState )
+        else
         {
-            if ( media->remainingTime() <= 0 )
-            {
-                media->stop();
-            }
-
-            media->play();
-        }
-        else  if ( media->state() == Phonon::LoadingState ){
-            mDelegated->mediaObject()->setCurrentSource(mDelegated->mediaFileUrl());
-            media->play();
-        }
-        else{
-          qDebug() << "Media state "<< media->state() << " not supported";
+            mDelegated->play();
         }
     }
 }
@@ -112,9 +87,7 @@ void UBGraphicsAudioItemDelegate::toggleMute()
 
 void UBGraphicsAudioItemDelegate::updatePlayPauseState()
 {
-    Phonon::MediaObject* media = mDelegated->mediaObject();
-
-    if ( media->state() == Phonon::PlayingState )
+    if ( mDelegated->state() == Phonon::PlayingState )
         mPlayPauseButton->setFileName ( ":/images/pause.svg" );
     else
         mPlayPauseButton->setFileName ( ":/images/play.svg" );
@@ -129,6 +102,6 @@ void UBGraphicsAudioItemDelegate::mediaStateChanged ( Phonon::State newstate, Ph
 
 void UBGraphicsAudioItemDelegate::remove ( bool canUndo )
 {
-    mDelegated->mediaObject()->stop();
+    mDelegated->stop();
     UBGraphicsItemDelegate::remove ( canUndo );
 }
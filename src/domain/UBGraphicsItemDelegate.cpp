@@ -56,6 +56,7 @@ UBGraphicsItemDelegate::UBGraphicsItemDelegate(QGraphicsItem* pDelegated, QObjec
     , mMenu(0)
     , mLockAction(0)
     , mShowOnDisplayAction(0)
+    , mSendToBackAction(0)
     , mGotoContentSourceAction(0)
     , mFrame(0)
     , mFrameWidth(UBSettings::settings()->objectFrameWidth)
@@ -109,7 +110,8 @@ QVariant UBGraphicsItemDelegate::itemChange(QGraphicsItem::GraphicsItemChange ch
     if ((change == QGraphicsItem::ItemSelectedHasChanged
          || change == QGraphicsItem::ItemPositionHasChanged
          || change == QGraphicsItem::ItemTransformHasChanged)
-        && mDelegated->scene())
+        && mDelegated->scene()
+        && UBApplication::boardController)
         {
         mAntiScaleRatio = 1 / (UBApplication::boardController->systemScaleFactor() * UBApplication::boardController->currentZoom());
 
@@ -135,7 +137,12 @@ QVariant UBGraphicsItemDelegate::itemChange(QGraphicsItem::GraphicsItemChange ch
     {
         UBGraphicsScene* ubScene = qobject_cast<UBGraphicsScene*>(mDelegated->scene());
         if(ubScene)
+        {
             ubScene->setModified(true);
+
+            if (change == QGraphicsItem::ItemZValueHasChanged)
+                ubScene->updateZOrder(mDelegated);
+        }
     }
 
     return value;
@@ -159,11 +166,8 @@ bool UBGraphicsItemDelegate::mousePressEvent(QGraphicsSceneMouseEvent *event)
 
         UBGraphicsScene* scene = static_cast<UBGraphicsScene*>(mDelegated->scene());
 
-        qDebug() << mDelegated->zValue();
-        qDebug() << scene->currentObjectZIndex();
-
-        if (mDelegated->zValue() < scene->currentObjectZIndex() && !isLocked())
-            mDelegated->setZValue(scene->getNextObjectZIndex());
+        if (!isLocked())
+            scene->bringToFront(mDelegated);
 
         positionHandles();
 
@@ -274,12 +278,19 @@ void UBGraphicsItemDelegate::remove(bool canUndo)
             scene->removeItem(button);
 
         scene->removeItem(mFrame);
-        scene->removeItem(mDelegated);
 
-        if (canUndo)
+        // the frame and the buttons are not part of the board, the delegated item leaves the z-order too
+        UBGraphicsScene* ubScene = qobject_cast<UBGraphicsScene*>(scene);
+
+        if (ubScene)
+            ubScene->removeItem(mDelegated);
+        else
+            scene->removeItem(mDelegated);
+
+        if (canUndo && ubScene)
         {
             UBGraphicsItemUndoCommand *uc =
-                    new UBGraphicsItemUndoCommand((UBGraphicsScene*) scene, mDelegated, 0);
+                    new UBGraphicsItemUndoCommand(ubScene, mDelegated, 0);
 
             UBApplication::undoStack->push(uc);
         }
@@ -318,6 +329,19 @@ void UBGraphicsItemDelegate::lock(bool locked)
 }
 
 
+void UBGraphicsItemDelegate::sendToBack()
+{
+    UBGraphicsScene* scene = qobject_cast<UBGraphicsScene*>(mDelegated->scene());
+
+    if (!scene || isLocked())
+        return;
+
+    startUndoStep();
+    scene->sendToBack(mDelegated);
+    commitUndoStep();
+}
+
+
 void UBGraphicsItemDelegate::showHide(bool show)
 {
     if (show)
@@ -400,6 +424,8 @@ void UBGraphicsItemDelegate::decorateMenu(QMenu* menu)
     showIcon.addPixmap(QPixmap(":/images/eyeClosed.svg"), QIcon::Normal, QIcon::Off);
     mShowOnDisplayAction->setIcon(showIcon);
 
+    mSendToBackAction = menu->addAction(tr("Send to Back"), this, SLOT(sendToBack()));
+
     mGotoContentSourceAction = menu->addAction(tr("Go to Content Source"), this, SLOT(gotoContentSource(bool)));
 
     QIcon sourceIcon;
@@ -419,6 +445,9 @@ void UBGraphicsItemDelegate::updateMenuActionState()
         mShowOnDisplayAction->setChecked(!isControl);
     }
 
+    if (mSendToBackAction)
+        mSendToBackAction->setEnabled(!isLocked());
+
     if (mGotoContentSourceAction)
     {
         UBItem* item = dynamic_cast<UBItem*>(mDelegated);
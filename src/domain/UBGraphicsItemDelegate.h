@@ -152,6 +152,7 @@ class UBGraphicsItemDelegate : public QObject
 
         QAction* mLockAction;
         QAction* mShowOnDisplayAction;
+        QAction* mSendToBackAction;
         QAction* mGotoContentSourceAction;
 
         UBGraphicsDelegateFrame* mFrame;
@@ -166,6 +167,7 @@ class UBGraphicsItemDelegate : public QObject
         virtual void showHide(bool show);
         virtual void lock(bool lock);
         virtual void duplicate();
+        virtual void sendToBack();
 
      private:
 
@@ -15,6 +15,7 @@
 #include "UBGraphicsMediaItem.h"
 #include "UBGraphicsScene.h"
 #include "UBGraphicsDelegateFrame.h"
+#include "UBMediaPipelinePool.h"
 
 #include "document/UBDocumentProxy.h"
 
@@ -28,6 +29,8 @@ bool UBGraphicsMediaItem::sIsMutedByDefault = false;
 
 UBGraphicsMediaItem::UBGraphicsMediaItem(const QUrl& pMediaFileUrl, QGraphicsItem *parent)
         : UBGraphicsProxyWidget(parent)
+        , mPipeline(0)
+        , mTotalTime(0)
         , mMuted(sIsMutedByDefault)
         , mMutedByUserAction(sIsMutedByDefault)
         , mMediaFileUrl(pMediaFileUrl)
@@ -39,8 +42,7 @@ UBGraphicsMediaItem::UBGraphicsMediaItem(const QUrl& pMediaFileUrl, QGraphicsIte
 
 UBGraphicsMediaItem::~UBGraphicsMediaItem()
 {
-    if (mMediaObject)
-        mMediaObject->stop();
+    releasePipeline();
 }
 
 
@@ -50,16 +52,17 @@ QVariant UBGraphicsMediaItem::itemChange(GraphicsItemChange change, const QVaria
             || (change == QGraphicsItem::ItemSceneChange)
             || (change == QGraphicsItem::ItemVisibleChange))
     {
-        if (mMediaObject && (!isEnabled() || !isVisible() || !scene()))
+        if (mPipeline && (!isEnabled() || !isVisible() || !scene()))
         {
-            mMediaObject->pause();
+            pause();
         }
     }
     else if (change == QGraphicsItem::ItemSceneHasChanged)
     {
         if (!scene())
         {
-            mMediaObject->stop();
+            releasePipeline();
+            mInitialPos = 0;
         }
         else
         {
@@ -77,19 +80,171 @@ QVariant UBGraphicsMediaItem::itemChange(GraphicsItemChange change, const QVaria
 //            }
 
 
-            if (absoluteMediaFilename.length() > 0)
-                mMediaObject->setCurrentSource(Phonon::MediaSource(absoluteMediaFilename));
+            if (absoluteMediaFilename.length() > 0 && absoluteMediaFilename != mMediaSource)
+            {
+                mMediaSource = absoluteMediaFilename;
 
+                if (mPipeline)
+                    mPipeline->mediaObject->setCurrentSource(Phonon::MediaSource(mMediaSource));
+
+                mediaSourceChanged();
+            }
         }
     }
 
     return UBGraphicsProxyWidget::itemChange(change, value);
 }
 
+
+Phonon::MediaObject* UBGraphicsMediaItem::mediaObject() const
+{
+    return mPipeline ? mPipeline->mediaObject : 0;
+}
+
+
+void UBGraphicsMediaItem::releasePipeline()
+{
+    if (!mPipeline)
+        return;
+
+    Phonon::MediaObject* media = mPipeline->mediaObject;
+    Phonon::State oldState = media->state();
+
+    if (oldState == Phonon::PlayingState || (oldState == Phonon::PausedState && media->remainingTime() > 0))
+        mInitialPos = media->currentTime();
+    else
+        mInitialPos = 0;
+
+    if (media->totalTime() > 0)
+        mTotalTime = media->totalTime();
+
+    media->disconnect(this);
+    pipelineDetached();
+
+    UBMediaPipeline* pipeline = mPipeline;
+    mPipeline = 0;
+
+    UBMediaPipelinePool::pool()->release(pipeline);
+
+    emit mediaStateChanged(state(), oldState);
+}
+
+
+void UBGraphicsMediaItem::play()
+{
+    if (!mPipeline)
+    {
+        mPipeline = UBMediaPipelinePool::pool()->acquire(this, hasVideo());
+
+        Phonon::MediaObject* media = mPipeline->mediaObject;
+
+        connect(media, SIGNAL(stateChanged(Phonon::State, Phonon::State)), this, SIGNAL(mediaStateChanged(Phonon::State, Phonon::State)));
+        connect(media, SIGNAL(tick(qint64)), this, SIGNAL(mediaTick(qint64)));
+        connect(media, SIGNAL(totalTimeChanged(qint64)), this, SIGNAL(mediaTotalTimeChanged(qint64)));
+        connect(media, SIGNAL(finished()), this, SIGNAL(mediaFinished()));
+        connect(media, SIGNAL(seekableChanged(bool)), this, SLOT(hasMediaChanged(bool)));
+
+        mPipeline->audioOutput->setMuted(mMuted);
+
+        pipelineAttached();
+
+        if (mMediaSource.length() > 0)
+            media->setCurrentSource(Phonon::MediaSource(mMediaSource));
+        else
+            media->setCurrentSource(Phonon::MediaSource(mMediaFileUrl));
+    }
+
+    Phonon::MediaObject* media = mPipeline->mediaObject;
+
+    if ((media->state() == Phonon::PlayingState || media->state() == Phonon::PausedState)
+            && media->remainingTime() <= 0)
+    {
+        media->stop();
+    }
+
+    media->play();
+}
+
+
+void UBGraphicsMediaItem::pause()
+{
+    if (mPipeline)
+        mPipeline->mediaObject->pause();
+}
+
+
+void UBGraphicsMediaItem::stop()
+{
+    mInitialPos = 0;
+
+    if (mPipeline)
+        mPipeline->mediaObject->stop();
+}
+
+
+void UBGraphicsMediaItem::seek(qint64 time)
+{
+    if (!mPipeline)
+        mInitialPos = time;
+    else if (mPipeline->mediaObject->isSeekable())
+        mPipeline->mediaObject->seek(time);
+}
+
+
+Phonon::State UBGraphicsMediaItem::state() const
+{
+    if (mPipeline)
+        return mPipeline->mediaObject->state();
+
+    return mInitialPos > 0 ? Phonon::PausedState : Phonon::StoppedState;
+}
+
+
+qint64 UBGraphicsMediaItem::currentTime() const
+{
+    return mPipeline ? mPipeline->mediaObject->currentTime() : mInitialPos;
+}
+
+
+qint64 UBGraphicsMediaItem::totalTime() const
+{
+    if (mPipeline && mPipeline->mediaObject->totalTime() > 0)
+        return mPipeline->mediaObject->totalTime();
+
+    return mTotalTime;
+}
+
+
+qint64 UBGraphicsMediaItem::remainingTime() const
+{
+    if (mPipeline)
+        return mPipeline->mediaObject->remainingTime();
+
+    return qMax(mTotalTime - mInitialPos, (qint64)0);
+}
+
+
+qint64 UBGraphicsMediaItem::resumePosition() const
+{
+    if (!mPipeline)
+        return mInitialPos;
+
+    Phonon::MediaObject* media = mPipeline->mediaObject;
+
+    if (media->state() == Phonon::PausedState && media->remainingTime() > 0)
+        return media->currentTime();
+
+    return 0;
+}
+
+
 void UBGraphicsMediaItem::toggleMute()
 {
     mMuted = !mMuted;
-    mAudioOutput->setMuted(mMuted);
+
+    if (mPipeline)
+        mPipeline->audioOutput->setMuted(mMuted);
+
     mMutedByUserAction = mMuted;
     sIsMutedByDefault = mMuted;
 }
@@ -97,8 +252,8 @@ void UBGraphicsMediaItem::toggleMute()
 
 void UBGraphicsMediaItem::hasMediaChanged(bool hasMedia)
 {
-    Q_UNUSED(hasMedia);
-    mMediaObject->seek(mInitialPos);
+    if (hasMedia && mPipeline && mInitialPos > 0)
+        mPipeline->mediaObject->seek(mInitialPos);
 }
 
 
@@ -110,9 +265,11 @@ UBGraphicsScene* UBGraphicsMediaItem::scene()
 
 void UBGraphicsMediaItem::activeSceneChanged()
 {
-    if (UBApplication::boardController->activeScene() != scene())
+    if (UBApplication::boardController && UBApplication::boardController->activeScene() != scene())
     {
-        mMediaObject->pause();
+        // frees the decoder, the paused position is kept
+        pause();
+        releasePipeline();
     }
 }
 
@@ -122,11 +279,12 @@ void UBGraphicsMediaItem::showOnDisplayChanged(bool shown)
     if (!shown)
     {
         mMuted = true;
-        mAudioOutput->setMuted(mMuted);
     }
     else if (!mMutedByUserAction)
     {
         mMuted = false;
-        mAudioOutput->setMuted(mMuted);
     }
+
+    if (mPipeline)
+        mPipeline->audioOutput->setMuted(mMuted);
 }
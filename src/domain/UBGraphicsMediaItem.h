@@ -19,6 +19,7 @@
 #include <phonon/AudioOutput>
 #include <phonon/MediaObject>
 
+class UBMediaPipeline;
 
 class UBGraphicsMediaItem : public UBGraphicsProxyWidget
 {
@@ -29,7 +30,6 @@ public:
     UBGraphicsMediaItem(const QUrl& pMediaFileUrl, QGraphicsItem *parent = 0);
     ~UBGraphicsMediaItem();
 
-    void hasMediaChanged(bool hasMedia);
     void showOnDisplayChanged(bool shown);
 
     virtual QUrl mediaFileUrl() const
@@ -37,11 +37,25 @@ public:
         return mMediaFileUrl;
     }
 
-    Phonon::MediaObject* mediaObject() const
+    // 0 until the item is played, see UBMediaPipelinePool
+    Phonon::MediaObject* mediaObject() const;
+
+    bool hasPipeline() const
     {
-        return mMediaObject;
+        return mPipeline != 0;
     }
 
+    // gives the pipeline back to the pool, the position is kept for the next play
+    void releasePipeline();
+
+    Phonon::State state() const;
+    qint64 currentTime() const;
+    qint64 totalTime() const;
+    qint64 remainingTime() const;
+
+    // position at which a paused item resumes, 0 if it starts over
+    qint64 resumePosition() const;
+
     void setInitialPos(qint64 p) {
         mInitialPos = p;
     }
@@ -56,8 +70,21 @@ public:
 
     virtual UBGraphicsScene* scene();
 
+signals:
+
+    void mediaStateChanged(Phonon::State newState, Phonon::State oldState);
+    void mediaTick(qint64 time);
+    void mediaTotalTimeChanged(qint64 newTotalTime);
+    void mediaFinished();
+
 public slots:
 
+    void play();
+    void pause();
+    void stop();
+    void seek(qint64 time);
+
+    void hasMediaChanged(bool hasMedia);
     void toggleMute();
     void activeSceneChanged();
 
@@ -65,8 +92,33 @@ protected:
 
     virtual QVariant itemChange(GraphicsItemChange change, const QVariant &value);
 
-    Phonon::MediaObject *mMediaObject;
-    Phonon::AudioOutput *mAudioOutput;
+    virtual bool hasVideo() const
+    {
+        return false;
+    }
+
+    virtual void pipelineAttached()
+    {
+        // NOOP
+    }
+
+    virtual void pipelineDetached()
+    {
+        // NOOP
+    }
+
+    virtual void mediaSourceChanged()
+    {
+        // NOOP
+    }
+
+    QString mediaSource() const
+    {
+        return mMediaSource;
+    }
+
+    UBMediaPipeline* mPipeline;
+    qint64 mTotalTime; // known before playing from the poster frame metadata
 
 private:
 
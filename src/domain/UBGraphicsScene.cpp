@@ -22,6 +22,7 @@
 
 #include "frameworks/UBGeometryUtils.h"
 #include "frameworks/UBPlatformUtils.h"
+#include "frameworks/UBTrace.h"
 
 #include "core/UBApplication.h"
 #include "core/UBSettings.h"
@@ -41,6 +42,7 @@
 
 #include "board/UBBoardController.h"
 #include "board/UBDrawingController.h"
+#include "board/UBInputTrace.h"
 
 #include "UBGraphicsItemUndoCommand.h"
 #include "UBGraphicsTextItemUndoCommand.h"
@@ -82,6 +84,8 @@ UBGraphicsScene::UBGraphicsScene(UBDocumentProxy* parent)
     , mDarkBackground(false)
     , mCrossedBackground(false)
     , mIsModified(true)
+    , mChangeCount(0)
+    , mInkChangeCount(0)
     , mBackgroundObject(0)
     , mPreviousWidth(0)
     , mInputDeviceIsPressed(false)
@@ -145,36 +149,38 @@ UBGraphicsScene::~UBGraphicsScene()
     DisposeMagnifierQWidgets();
 }
 
+
 void UBGraphicsScene::selectionChangedProcessing()
 {
-    QList<QGraphicsItem *> allItemsList = items();
-    for( int i = 0; i < allItemsList.size(); i++ )
-    {
-        QGraphicsItem *nextItem = allItemsList.at(i);
-        qreal zValue = nextItem->zValue();
-        nextItem->setZValue(qreal(1));
-        qDebug() << QString(" %1 ").arg(i) << QString(" %1 ").arg(zValue);
-    }
+    QSet<QGraphicsItem*> selection = selectedItems().toSet();
 
-    QList<QGraphicsItem *> selItemsList = selectedItems();
-    for( int i = 0; i < selItemsList.size(); i++ )
+    // only the newly selected items move, in their current relative order
+    QMap<qreal, QGraphicsItem*> newlySelected;
+
+    foreach(QGraphicsItem* item, selection)
     {
-        QGraphicsItem *nextItem = selItemsList.at(i);
-        qreal zValue = nextItem->zValue();
-        nextItem->setZValue(2);
-        qDebug() << QString(" >>> %1 <<< ").arg(i) << QString(" >>> %1 <<< ").arg(zValue);
+        if (!mPreviousSelection.contains(item)
+                && item->zValue() >= objectLayerStart && item->zValue() < drawingLayerStart
+                && !item->data(UBGraphicsItemData::ItemLocked).toBool())
+        {
+            newlySelected.insertMulti(item->zValue(), item);
+        }
     }
 
+    foreach(QGraphicsItem* item, newlySelected)
+        bringToFront(item);
 
+    mPreviousSelection = selection;
 }
 
+
 // MARK: -
 // MARK: Mouse/Tablet events handling
 
 bool UBGraphicsScene::inputDevicePress(const QPointF& scenePos, const qreal& pressure)
 {
-    //mMesure1Ms = 0;
-    //mMesure2Ms = 0;
+    UB_TRACE_SCOPE("scene.inputDevicePress", "input");
+    UB_TRACE_COUNT("input.events");
 
     bool accepted = false;
 
@@ -185,6 +191,8 @@ bool UBGraphicsScene::inputDevicePress(const QPointF& scenePos, const qreal& pre
     }
     else
     {
+        UBInputTraceRecorder::recorder()->record(UBInputTraceEvent::Press, scenePos, pressure);
+
         mInputDeviceIsPressed = true;
 
         UBStylusTool::Enum currentTool = (UBStylusTool::Enum)UBDrawingController::drawingController()->stylusTool();
@@ -244,8 +252,13 @@ bool UBGraphicsScene::inputDevicePress(const QPointF& scenePos, const qreal& pre
 
 bool UBGraphicsScene::inputDeviceMove(const QPointF& scenePos, const qreal& pressure)
 {
+    UB_TRACE_SCOPE("scene.inputDeviceMove", "input");
+    UB_TRACE_COUNT("input.events");
+
     bool accepted = false;
 
+    UBInputTraceRecorder::recorder()->record(UBInputTraceEvent::Move, scenePos, pressure);
+
     UBDrawingController *dc = UBDrawingController::drawingController();
     UBStylusTool::Enum currentTool = (UBStylusTool::Enum)dc->stylusTool();
 
@@ -319,21 +332,12 @@ bool UBGraphicsScene::inputDeviceMove(const QPointF& scenePos, const qreal& pres
 
 bool UBGraphicsScene::inputDeviceRelease()
 {
-    /*
-    if (mMesure1Ms > 0 ||  mMesure2Ms > 0)
-    {
-        qWarning() << "---------------------------";
-        qWarning() << "mMesure1Ms: " << mMesure1Ms;
-        qWarning() << "mMesure2Ms: " << mMesure2Ms;
-
-        mMesure1Ms = 0;
-        mMesure2Ms = 0;
-    }
-    */
+    UB_TRACE_SCOPE("scene.inputDeviceRelease", "input");
+    UB_TRACE_COUNT("input.events");
 
     bool accepted = false;
 
-
+    UBInputTraceRecorder::recorder()->record(UBInputTraceEvent::Release, mPreviousPoint, 0);
 
     if (mPointer)
     {
@@ -641,6 +645,62 @@ qreal UBGraphicsScene::getNextObjectZIndex()
 }
 
 
+void UBGraphicsScene::bringToFront(QGraphicsItem* pItem)
+{
+    if (!pItem)
+        return;
+
+    qreal zValue = pItem->zValue();
+
+    if (zValue >= objectLayerStart && zValue < drawingLayerStart)
+    {
+        mObjectZIndex = qMax(mObjectZIndex, mZOrder.frontZValue(objectLayerStart, drawingLayerStart) - 1.0);
+
+        if (zValue < mObjectZIndex)
+            pItem->setZValue(getNextObjectZIndex());
+    }
+    else if (zValue >= drawingLayerStart && zValue < toolLayerStart)
+    {
+        mDrawingZIndex = qMax(mDrawingZIndex, mZOrder.frontZValue(drawingLayerStart, toolLayerStart) - 1.0);
+
+        if (zValue < mDrawingZIndex)
+            pItem->setZValue(getNextDrawingZIndex());
+    }
+
+    mZOrder.update(pItem);
+}
+
+
+void UBGraphicsScene::sendToBack(QGraphicsItem* pItem)
+{
+    if (!pItem)
+        return;
+
+    qreal zValue = pItem->zValue();
+
+    // the layer start itself is kept for the background object
+    qreal layerStart = objectLayerStart;
+    qreal layerEnd = drawingLayerStart;
+
+    if (zValue >= drawingLayerStart && zValue < toolLayerStart)
+    {
+        layerStart = drawingLayerStart;
+        layerEnd = toolLayerStart;
+    }
+    else if (zValue < objectLayerStart || zValue >= toolLayerStart)
+    {
+        return;
+    }
+
+    if (mZOrder.backItem(layerStart, layerEnd) == pItem)
+        return;
+
+    pItem->setZValue(mZOrder.backZValue(layerStart, layerEnd));
+
+    mZOrder.update(pItem);
+}
+
+
 void UBGraphicsScene::setBackground(bool pIsDark, bool pIsCrossed)
 {
     bool needRepaint = false;
@@ -1032,13 +1092,9 @@ UBGraphicsVideoItem* UBGraphicsScene::addVideo(const QUrl& pVideoFileUrl, bool s
     UBGraphicsItemUndoCommand* uc = new UBGraphicsItemUndoCommand(this, 0, videoItem);
     UBApplication::undoStack->push(uc);
 
-    videoItem->mediaObject()->play();
-
-    if (!shouldPlayAsap)
-    {
-        videoItem->mediaObject()->pause();
-        videoItem->mediaObject()->seek(0);
-    }
+    // the item shows its poster frame, the media pipeline is only taken when played
+    if (shouldPlayAsap)
+        videoItem->play();
 
     setDocumentUpdated();
 
@@ -1062,13 +1118,9 @@ UBGraphicsAudioItem* UBGraphicsScene::addAudio(const QUrl& pAudioFileUrl, bool s
     UBGraphicsItemUndoCommand* uc = new UBGraphicsItemUndoCommand(this, 0, audioItem);
     UBApplication::undoStack->push(uc);
 
-    audioItem->mediaObject()->play();
-
-    if (!shouldPlayAsap)
-    {
-        audioItem->mediaObject()->pause();
-        audioItem->mediaObject()->seek(0);
-    }
+    // the item shows its poster frame, the media pipeline is only taken when played
+    if (shouldPlayAsap)
+        audioItem->play();
 
     setDocumentUpdated();
 
@@ -1266,12 +1318,30 @@ UBGraphicsTextItem* UBGraphicsScene::addTextWithFont(const QString& pString, con
 void UBGraphicsScene::addItem(QGraphicsItem* item)
 {
     setModified(true);
+
+    if (qgraphicsitem_cast<UBGraphicsPolygonItem*>(item))
+        mInkChangeCount++;
+
     UBCoreGraphicsScene::addItem(item);
 
     if (!mTools.contains(item))
       ++mItemCount;
 
     mFastAccessItems << item;
+    mZOrder.insert(item);
+}
+
+
+// true when all the items are ink polygons
+static bool isInk(const QSet<QGraphicsItem*>& items)
+{
+    foreach(QGraphicsItem* item, items)
+    {
+        if (!qgraphicsitem_cast<UBGraphicsPolygonItem*>(item))
+            return false;
+    }
+
+    return true;
 }
 
 
@@ -1279,24 +1349,36 @@ void UBGraphicsScene::addItems(const QSet<QGraphicsItem*>& items)
 {
     setModified(true);
 
+    if (isInk(items))
+        mInkChangeCount++;
+
     foreach(QGraphicsItem* item, items)
         UBCoreGraphicsScene::addItem(item);
 
     mItemCount += items.size();
 
     mFastAccessItems += items.toList();
+
+    foreach(QGraphicsItem* item, items)
+        mZOrder.insert(item);
 }
 
 
 void UBGraphicsScene::removeItem(QGraphicsItem* item)
 {
     setModified(true);
+
+    if (qgraphicsitem_cast<UBGraphicsPolygonItem*>(item))
+        mInkChangeCount++;
+
     UBCoreGraphicsScene::removeItem(item);
 
     if (!mTools.contains(item))
       --mItemCount;
 
     mFastAccessItems.removeAll(item);
+    mZOrder.remove(item);
+    mPreviousSelection.remove(item);
 }
 
 
@@ -1304,13 +1386,20 @@ void UBGraphicsScene::removeItems(const QSet<QGraphicsItem*>& items)
 {
     setModified(true);
 
+    if (isInk(items))
+        mInkChangeCount++;
+
     foreach(QGraphicsItem* item, items)
         UBCoreGraphicsScene::removeItem(item);
 
     mItemCount -= items.size();
 
     foreach(QGraphicsItem* item, items)
+    {
         mFastAccessItems.removeAll(item);
+        mZOrder.remove(item);
+        mPreviousSelection.remove(item);
+    }
 }
 
 
@@ -1712,6 +1801,11 @@ void UBGraphicsScene::setNominalSize(const QSize& pSize)
         if(mDocument)
             mDocument->setDefaultDocumentSize(pSize);
 
+        // the page frame is part of the cached background
+        foreach(QGraphicsView* view, views())
+        {
+            view->resetCachedContent();
+        }
     }
 }
 
@@ -23,6 +23,7 @@
 #include "core/UB.h"
 
 #include "UBItem.h"
+#include "UBGraphicsZOrder.h"
 #include "tools/UBGraphicsCurtainItem.h"
 
 
@@ -121,9 +122,29 @@ class UBGraphicsScene: public UBCoreGraphicsScene, public UBItem
             return mIsModified;
         }
 
+        int fastAccessItemCount() const
+        {
+            return mFastAccessItems.size();
+        }
+
         void setModified(bool pModified)
         {
             mIsModified = pModified;
+
+            if (pModified)
+                mChangeCount++;
+        }
+
+        // grows with each modification, tells whether the scene changed since a given time
+        int changeCount() const
+        {
+            return mChangeCount;
+        }
+
+        // the modifications which only added or removed ink
+        int inkChangeCount() const
+        {
+            return mInkChangeCount;
         }
 
         void setDocument(UBDocumentProxy* pDocument);
@@ -165,6 +186,22 @@ class UBGraphicsScene: public UBCoreGraphicsScene, public UBItem
 
         qreal getNextObjectZIndex();
 
+        // items of the scene from back to front, without sorting
+        QList<QGraphicsItem*> itemsInZOrder()
+        {
+            return mZOrder.items();
+        }
+
+        // moves the item in front of (or behind) the other items of its layer
+        void bringToFront(QGraphicsItem* pItem);
+        void sendToBack(QGraphicsItem* pItem);
+
+        // to be called when the z value of an item changes
+        void updateZOrder(QGraphicsItem* pItem)
+        {
+            mZOrder.update(pItem);
+        }
+
         void addRuler(QPointF center);
         void addProtractor(QPointF center);
         void addCompass(QPointF center);
@@ -328,6 +365,8 @@ class UBGraphicsScene: public UBCoreGraphicsScene, public UBItem
         bool mCrossedBackground;
 
         bool mIsModified;
+        int mChangeCount;
+        int mInkChangeCount;
 
         QGraphicsItem* mBackgroundObject;
 
@@ -356,7 +395,8 @@ class UBGraphicsScene: public UBCoreGraphicsScene, public UBItem
 
         QList<QGraphicsItem*> mFastAccessItems; // a local copy as QGraphicsScene::items() is very slow in Qt 4.6
 
-        //int mMesure1Ms, mMesure2Ms;
+        UBGraphicsZOrder mZOrder;
+        QSet<QGraphicsItem*> mPreviousSelection;
 
         UBMagnifier *magniferControlViewWidget;
         UBMagnifier *magniferDisplayViewWidget;
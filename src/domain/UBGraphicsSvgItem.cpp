@@ -24,10 +24,8 @@
 #include "core/memcheck.h"
 
 UBGraphicsSvgItem::UBGraphicsSvgItem(const QString& pFilePath, QGraphicsItem* parent)
-    : QGraphicsSvgItem(pFilePath, parent)
+    : QGraphicsSvgItem(parent)
 {
-    init();
-
     QFile f(pFilePath);
 
     if (f.open(QIODevice::ReadOnly))
@@ -35,6 +33,11 @@ UBGraphicsSvgItem::UBGraphicsSvgItem(const QString& pFilePath, QGraphicsItem* pa
         mFileData = f.readAll();
         f.close();
     }
+
+    mRenderer = QSharedPointer<QSvgRenderer>(new QSvgRenderer(mFileData));
+    setSharedRenderer(mRenderer.data());
+
+    init();
 }
 
 
@@ -43,13 +46,24 @@ UBGraphicsSvgItem::UBGraphicsSvgItem(const QByteArray& pFileData, QGraphicsItem*
 {
     init();
 
-    QSvgRenderer* renderer = new QSvgRenderer(pFileData, this);
+    mRenderer = QSharedPointer<QSvgRenderer>(new QSvgRenderer(pFileData));
 
-    setSharedRenderer(renderer);
+    setSharedRenderer(mRenderer.data());
     mFileData = pFileData;
 }
 
 
+UBGraphicsSvgItem::UBGraphicsSvgItem(const QSharedPointer<QSvgRenderer>& pRenderer, const QByteArray& pFileData, QGraphicsItem* parent)
+    : QGraphicsSvgItem(parent)
+    , mFileData(pFileData)
+    , mRenderer(pRenderer)
+{
+    setSharedRenderer(mRenderer.data());
+
+    init();
+}
+
+
 void UBGraphicsSvgItem::init()
 {
     setData(UBGraphicsItemData::ItemLayerType, UBItemLayerType::Object);
@@ -129,7 +143,7 @@ void UBGraphicsSvgItem::paint(QPainter *painter, const QStyleOptionGraphicsItem
 
 UBItem* UBGraphicsSvgItem::deepCopy() const
 {
-    UBGraphicsSvgItem* copy = new UBGraphicsSvgItem(this->fileData());
+    UBGraphicsSvgItem* copy = new UBGraphicsSvgItem(mRenderer, this->fileData());
 
     copy->setPos(this->pos());
     copy->setZValue(this->zValue());
@@ -62,6 +62,9 @@ class UBGraphicsSvgItem: public QGraphicsSvgItem, public UBItem, public UBGraphi
 
     protected:
 
+        // copies share the parsed SVG of the original
+        UBGraphicsSvgItem(const QSharedPointer<QSvgRenderer>& pRenderer, const QByteArray& pFileData, QGraphicsItem* parent = 0);
+
         virtual void mousePressEvent(QGraphicsSceneMouseEvent *event);
         virtual void mouseMoveEvent(QGraphicsSceneMouseEvent *event);
         virtual void mouseReleaseEvent(QGraphicsSceneMouseEvent *event);
@@ -73,6 +76,8 @@ class UBGraphicsSvgItem: public QGraphicsSvgItem, public UBItem, public UBGraphi
         UBGraphicsItemDelegate* mDelegate;
 
         QByteArray mFileData;
+
+        QSharedPointer<QSvgRenderer> mRenderer;
 };
 
 #endif /* UBGRAPHICSSVGITEM_H_ */
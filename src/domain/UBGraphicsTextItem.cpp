@@ -24,10 +24,21 @@
 #include "board/UBBoardView.h"
 #include "core/UBSettings.h"
 
+#include "frameworks/UBTrace.h"
+
 #include "core/memcheck.h"
 
 QColor UBGraphicsTextItem::lastUsedTextColor;
 
+// zoom factors are rounded up to a quarter of an octave, a pan or a small zoom reuses the cache
+static const qreal cacheBucketsPerOctave = 4.0;
+
+// above this size (in pixels) the text is drawn directly, a cache would cost more memory than it saves time
+static const int cacheMaxPixels = 2048 * 2048;
+
+// the control view, the display view and the previous zoom of one of them
+static const int cacheMaxEntries = 3;
+
 UBGraphicsTextItem::UBGraphicsTextItem(QGraphicsItem * parent)
     : QGraphicsTextItem(parent)
     , mDelegate(0)
@@ -47,7 +58,7 @@ UBGraphicsTextItem::UBGraphicsTextItem(QGraphicsItem * parent)
         setColorOnDarkBackground(lastUsedTextColor);
         setColorOnLightBackground(lastUsedTextColor);
     }
-    else
+    else if (UBApplication::boardController)
     {
         QColor colorOnDarkBG = UBApplication::boardController->penColorOnDarkBackground();
         QColor colorOnLightBG = UBApplication::boardController->penColorOnLightBackground();
@@ -101,6 +112,11 @@ QVariant UBGraphicsTextItem::itemChange(GraphicsItemChange change, const QVarian
 
     QVariant newValue = value;
 
+    if (QGraphicsItem::ItemSceneHasChanged == change)
+    {
+        invalidateCache();
+    }
+
     if(mDelegate)
         newValue = mDelegate->itemChange(change, value);
 
@@ -182,16 +198,23 @@ void UBGraphicsTextItem::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 void UBGraphicsTextItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
     QColor color = UBSettings::settings()->isDarkBackground() ? mColorOnDarkBackground : mColorOnLightBackground;
-    setDefaultTextColor(color);
 
-    // Never draw the rubber band, we draw our custom selection with the DelegateFrame
-    QStyleOptionGraphicsItem styleOption = QStyleOptionGraphicsItem(*option);
-    styleOption.state &= ~QStyle::State_Selected;
-    styleOption.state &= ~QStyle::State_HasFocus;
+    // setDefaultTextColor schedules an update, only call it when the color really changes
+    if (defaultTextColor() != color)
+        setDefaultTextColor(color);
+
+    if (!paintCached(painter, option, widget))
+    {
+        // Never draw the rubber band, we draw our custom selection with the DelegateFrame
+        QStyleOptionGraphicsItem styleOption = QStyleOptionGraphicsItem(*option);
+        styleOption.state &= ~QStyle::State_Selected;
+        styleOption.state &= ~QStyle::State_HasFocus;
 
-    QGraphicsTextItem::paint(painter, &styleOption, widget);
+        QGraphicsTextItem::paint(painter, &styleOption, widget);
+    }
 
-    if (widget == UBApplication::boardController->controlView()->viewport() &&
+    if (UBApplication::boardController &&
+            widget == UBApplication::boardController->controlView()->viewport() &&
             !isSelected() && toPlainText().isEmpty())
     {
         painter->setFont(font());
@@ -201,6 +224,91 @@ void UBGraphicsTextItem::paint(QPainter *painter, const QStyleOptionGraphicsItem
 }
 
 
+bool UBGraphicsTextItem::paintCached(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    // the item being edited is drawn live (cursor, selection), renderings without a view
+    // (thumbnails, print, PDF export) stay vector and keep the rasters of the views
+    if (!widget)
+        return false;
+
+    if (hasFocus())
+    {
+        invalidateCache();
+        return false;
+    }
+
+    qreal levelOfDetail = option->levelOfDetailFromTransform(painter->worldTransform());
+
+    if (levelOfDetail <= 0)
+        return false;
+
+    qreal scale = qPow(2.0, qCeil(qLn(levelOfDetail) / qLn(2.0) * cacheBucketsPerOctave) / cacheBucketsPerOctave);
+
+    QRectF bounds = boundingRect();
+    QSize cacheSize = (bounds.size() * scale).toSize().expandedTo(QSize(1, 1));
+
+    if (cacheSize.width() * cacheSize.height() > cacheMaxPixels)
+        return false;
+
+    if (mCacheColor != defaultTextColor())
+        invalidateCache();
+
+    int cacheIndex = 0;
+
+    while (cacheIndex < mCache.size() && mCache.at(cacheIndex).first != scale)
+        cacheIndex++;
+
+    if (cacheIndex < mCache.size())
+    {
+        mCache.move(cacheIndex, 0);
+
+        UB_TRACE_COUNT("text.cache.hit");
+    }
+    else
+    {
+        UB_TRACE_SCOPE("text.cache", "render");
+
+        QPixmap cache(cacheSize);
+        cache.fill(Qt::transparent);
+
+        QStyleOptionGraphicsItem styleOption = QStyleOptionGraphicsItem(*option);
+        styleOption.state &= ~QStyle::State_Selected;
+        styleOption.state &= ~QStyle::State_HasFocus;
+        styleOption.exposedRect = bounds;
+
+        QPainter cachePainter(&cache);
+        cachePainter.setRenderHints(painter->renderHints());
+        cachePainter.scale(scale, scale);
+        cachePainter.translate(-bounds.topLeft());
+
+        QGraphicsTextItem::paint(&cachePainter, &styleOption, widget);
+
+        cachePainter.end();
+
+        mCache.prepend(qMakePair(scale, cache));
+        mCacheColor = defaultTextColor();
+
+        while (mCache.size() > cacheMaxEntries)
+            mCache.removeLast();
+    }
+
+    const QPixmap& cache = mCache.first().second;
+
+    bool smooth = painter->testRenderHint(QPainter::SmoothPixmapTransform);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter->drawPixmap(bounds, cache, QRectF(QPointF(), cache.size()));
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, smooth);
+
+    return true;
+}
+
+
+void UBGraphicsTextItem::invalidateCache()
+{
+    mCache.clear();
+}
+
+
 UBItem* UBGraphicsTextItem::deepCopy() const
 {
     UBGraphicsTextItem* copy = new UBGraphicsTextItem();
@@ -256,6 +364,8 @@ void UBGraphicsTextItem::setTextWidth(qreal width)
     }
 
     QGraphicsTextItem::setTextWidth(newWidth);
+
+    invalidateCache();
 }
 
 
@@ -264,6 +374,7 @@ void UBGraphicsTextItem::setTextHeight(qreal height)
     QFontMetrics fm(font());
     qreal minHeight = fm.height() + document()->documentMargin() * 2;
     mTextHeight = qMax(minHeight, height);
+    invalidateCache();
     update();
     setFocus();
 }
@@ -277,6 +388,8 @@ qreal UBGraphicsTextItem::textHeight() const
 
 void UBGraphicsTextItem::contentsChanged()
 {
+    invalidateCache();
+
     if (scene())
     {
         scene()->setModified(true);
@@ -95,6 +95,9 @@ class UBGraphicsTextItem : public QGraphicsTextItem, public UBItem, public UBRes
 
         virtual QVariant itemChange(GraphicsItemChange change, const QVariant &value);
 
+        bool paintCached(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
+        void invalidateCache();
+
     private:
         UBGraphicsItemDelegate *mDelegate;
         qreal mTextHeight;
@@ -106,6 +109,10 @@ class UBGraphicsTextItem : public QGraphicsTextItem, public UBItem, public UBRes
         QColor mColorOnDarkBackground;
         QColor mColorOnLightBackground;
 
+        // rasters of the document at the last zoom buckets used, most recent first: the control and display
+        // views reuse their own until the content or format changes
+        QList<QPair<qreal, QPixmap> > mCache;
+        QColor mCacheColor;
 
 };
 
@@ -15,6 +15,7 @@
 #include "UBGraphicsVideoItem.h"
 #include "UBGraphicsVideoItemDelegate.h"
 #include "UBGraphicsDelegateFrame.h"
+#include "UBMediaPipelinePool.h"
 
 #include "core/memcheck.h"
 
@@ -24,40 +25,38 @@ UBGraphicsVideoItem::UBGraphicsVideoItem(const QUrl& pVideoFileUrl, QGraphicsIte
 {
     update();
 
-    mMediaObject = new Phonon::MediaObject(this);
-    mVideoWidget = new Phonon::VideoWidget(); // owned and destructed by the scene ...
-
-    Phonon::createPath(mMediaObject, mVideoWidget);
-
-    mAudioOutput = new Phonon::AudioOutput(Phonon::VideoCategory, this);
-    Phonon::createPath(mMediaObject, mAudioOutput);
-
     /*
-     * The VideoVidget should recover the size from the original movie, but this is not always true expecially on
-     * windows and linux os. I don't know why?
-     * In this case the wiget size is equal to QSize(1,1).
+     * The decoder pipeline is only taken from the pool when the video is played,
+     * until then the item shows the poster frame of the video.
      */
 
-    if(mVideoWidget->sizeHint() == QSize(1,1)){
-      mVideoWidget->resize(320,240);
-    }
+    mPosterWidget = new QLabel(); // owned and destructed by the scene while embedded ...
+    mPosterWidget->setScaledContents(true);
+    mPosterWidget->setAutoFillBackground(true);
+
+    QPalette palette = mPosterWidget->palette();
+    palette.setColor(QPalette::Window, Qt::black);
+    mPosterWidget->setPalette(palette);
+
+    mPosterWidget->resize(320,240);
 
-    setWidget(mVideoWidget);
+    setWidget(mPosterWidget);
 
-    UBGraphicsVideoItemDelegate* delegate = new UBGraphicsVideoItemDelegate(this, mMediaObject);
+    UBGraphicsVideoItemDelegate* delegate = new UBGraphicsVideoItemDelegate(this);
     delegate->init();
     setDelegate(delegate);
 
     mDelegate->frame()->setOperationMode(UBGraphicsDelegateFrame::Resizing);
 
     connect(mDelegate, SIGNAL(showOnDisplayChanged(bool)), this, SLOT(showOnDisplayChanged(bool)));
-    connect(mMediaObject, SIGNAL(hasVideoChanged(bool)), this, SLOT(hasVideoChanged(bool)));
+    connect(UBMediaPipelinePool::pool(), SIGNAL(posterReady(const QString&)), this, SLOT(posterReady(const QString&)));
 }
 
 
 UBGraphicsVideoItem::~UBGraphicsVideoItem()
 {
-    //NOOP
+    // puts the poster widget back before the scene destructs the embedded widget
+    releasePipeline();
 }
 
 UBItem* UBGraphicsVideoItem::deepCopy() const
@@ -85,9 +84,83 @@ UBItem* UBGraphicsVideoItem::deepCopy() const
 
 
 
+Phonon::VideoWidget* UBGraphicsVideoItem::videoWidget() const
+{
+    return mPipeline ? mPipeline->videoWidget : 0;
+}
+
+
+void UBGraphicsVideoItem::pipelineAttached()
+{
+    mPipeline->mediaObject->setTickInterval(50);
+
+    connect(mPipeline->mediaObject, SIGNAL(hasVideoChanged(bool)), this, SLOT(hasVideoChanged(bool)));
+
+    setEmbeddedWidget(mPipeline->videoWidget);
+}
+
+
+void UBGraphicsVideoItem::pipelineDetached()
+{
+    // a paused video keeps showing its current frame
+    if (mPipeline->mediaObject->state() == Phonon::PausedState)
+        showPoster(mPipeline->videoWidget->snapshot());
+    else
+        showPoster(UBMediaPipelinePool::pool()->cachedPoster(mediaSource()));
+
+    setEmbeddedWidget(mPosterWidget);
+}
+
+
+void UBGraphicsVideoItem::mediaSourceChanged()
+{
+    showPoster(UBMediaPipelinePool::pool()->cachedPoster(mediaSource()));
+}
+
+
+void UBGraphicsVideoItem::setEmbeddedWidget(QWidget* pWidget)
+{
+    if (widget() == pWidget)
+        return;
+
+    QSizeF currentSize = size();
+
+    setWidget(0); // hands the current widget back without deleting it
+
+    pWidget->resize(currentSize.toSize());
+    setWidget(pWidget);
+
+    resize(currentSize);
+}
+
+
+void UBGraphicsVideoItem::showPoster(const QImage& pPoster)
+{
+    if (pPoster.isNull())
+        return;
+
+    mPosterWidget->setPixmap(QPixmap::fromImage(pPoster));
+
+    qint64 duration = pPoster.text("Duration").toLongLong();
+
+    if (duration > 0 && duration != mTotalTime)
+    {
+        mTotalTime = duration;
+        emit mediaTotalTimeChanged(mTotalTime);
+    }
+}
+
+
+void UBGraphicsVideoItem::posterReady(const QString& pVideoFile)
+{
+    if (pVideoFile == mediaSource())
+        showPoster(UBMediaPipelinePool::pool()->cachedPoster(pVideoFile));
+}
+
+
 void UBGraphicsVideoItem::hasVideoChanged(bool hasVideo)
 {
-    if(hasVideo && mMediaObject->isSeekable())
+    if(hasVideo && mPipeline && mPipeline->mediaObject->isSeekable())
     {
         hasMediaChanged(hasVideo);
         UBGraphicsVideoItemDelegate *vid = dynamic_cast<UBGraphicsVideoItemDelegate *>(mDelegate);
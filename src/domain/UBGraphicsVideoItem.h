@@ -36,10 +36,8 @@ public:
 
     virtual UBItem* deepCopy() const;
 
-    Phonon::VideoWidget* videoWidget() const
-    {
-        return mVideoWidget;
-    }
+    // 0 until the item is played, a poster frame is shown meanwhile
+    Phonon::VideoWidget* videoWidget() const;
 
 
 public slots:
@@ -51,10 +49,23 @@ protected:
     virtual void mousePressEvent(QGraphicsSceneMouseEvent *event);
     virtual void mouseMoveEvent(QGraphicsSceneMouseEvent *event);
 
-    Phonon::VideoWidget *mVideoWidget;
+    virtual bool hasVideo() const
+    {
+        return true;
+    }
+
+    virtual void pipelineAttached();
+    virtual void pipelineDetached();
+    virtual void mediaSourceChanged();
+
+    void setEmbeddedWidget(QWidget* pWidget);
+    void showPoster(const QImage& pPoster);
+
+    QLabel *mPosterWidget;
 
 private slots:
     void showOnDisplayChanged(bool shown);
+    void posterReady(const QString& pVideoFile);
 
 
 private:
@@ -31,9 +31,8 @@
 
 #include "core/memcheck.h"
 
-UBGraphicsVideoItemDelegate::UBGraphicsVideoItemDelegate(UBGraphicsVideoItem* pDelegated, Phonon::MediaObject* pMedia, QObject * parent)
+UBGraphicsVideoItemDelegate::UBGraphicsVideoItemDelegate(UBGraphicsVideoItem* pDelegated, QObject * parent)
     : UBGraphicsItemDelegate(pDelegated, parent, true, false)
-    , mMedia(pMedia)
 {
     // NOOP
 }
@@ -57,18 +56,16 @@ void UBGraphicsVideoItemDelegate::buildButtons()
     mVideoControl->setFlag(QGraphicsItem::ItemIsSelectable, true);
 
     connect(mPlayPauseButton, SIGNAL(clicked(bool)), this, SLOT(togglePlayPause()));
-    connect(mStopButton, SIGNAL(clicked(bool)), mMedia, SLOT(stop()));
+    connect(mStopButton, SIGNAL(clicked(bool)), delegated(), SLOT(stop()));
     connect(mMuteButton, SIGNAL(clicked(bool)), delegated(), SLOT(toggleMute()));
     connect(mMuteButton, SIGNAL(clicked(bool)), this, SLOT(toggleMute()));
 
     mButtons << mPlayPauseButton << mStopButton << mMuteButton;
 
-    mMedia->setTickInterval(50);
-
-    connect(mMedia, SIGNAL(stateChanged (Phonon::State, Phonon::State)), this, SLOT(mediaStateChanged (Phonon::State, Phonon::State)));
-    connect(mMedia, SIGNAL(finished()), this, SLOT(updatePlayPauseState()));
-    connect(mMedia, SIGNAL(tick(qint64)), this, SLOT(updateTicker(qint64)));
-    connect(mMedia, SIGNAL(totalTimeChanged(qint64)), this, SLOT(totalTimeChanged(qint64)));
+    connect(delegated(), SIGNAL(mediaStateChanged (Phonon::State, Phonon::State)), this, SLOT(mediaStateChanged (Phonon::State, Phonon::State)));
+    connect(delegated(), SIGNAL(mediaFinished()), this, SLOT(updatePlayPauseState()));
+    connect(delegated(), SIGNAL(mediaTick(qint64)), this, SLOT(updateTicker(qint64)));
+    connect(delegated(), SIGNAL(mediaTotalTimeChanged(qint64)), this, SLOT(totalTimeChanged(qint64)));
 
 }
 
@@ -117,8 +114,8 @@ void UBGraphicsVideoItemDelegate::positionHandles()
 
 void UBGraphicsVideoItemDelegate::remove(bool canUndo)
 {
-    if (delegated() && delegated()->mediaObject())
-        delegated()->mediaObject()->stop();
+    if (delegated())
+        delegated()->stop();
 
     QGraphicsScene* scene = mDelegated->scene();
 
@@ -146,43 +143,18 @@ UBGraphicsVideoItem* UBGraphicsVideoItemDelegate::delegated()
 
 void UBGraphicsVideoItemDelegate::togglePlayPause()
 {
-    if (delegated() && delegated()->mediaObject())
+    if (delegated())
     {
-        Phonon::MediaObject* media = delegated()->mediaObject();
-
-        if (media->state() == Phonon::StoppedState)
-        {
-            media->play();
-        }
-        else if (media->state() == Phonon::PlayingState)
+        // play() takes a pipeline from the pool and restarts a finished media
+        if (delegated()->state() == Phonon::PlayingState && delegated()->remainingTime() > 0)
         {
-            if (media->remainingTime() <= 0)
-            {
-                media->stop();
-                media->play();
-            }
-            else
-            {
-                media->pause();
-                if(delegated()->scene())
-                        delegated()->scene()->setModified(true);
-            }
+            delegated()->pause();
+            if(delegated()->scene())
+                    delegated()->scene()->setModified(true);
         }
-        else if (media->state() == Phonon::PausedState)
+        else
         {
-            if (media->remainingTime() <= 0)
-            {
-                media->stop();
-            }
-
-            media->play();
-        }
-		else  if ( media->state() == Phonon::LoadingState ){
-            delegated()->mediaObject()->setCurrentSource(delegated()->mediaFileUrl());
-            media->play();
-        }
-        else{
-          qDebug() << "Media state "<< media->state() << " not supported";
+            delegated()->play();
         }
     }
 }
@@ -198,9 +170,7 @@ void UBGraphicsVideoItemDelegate::mediaStateChanged ( Phonon::State newstate, Ph
 
 void UBGraphicsVideoItemDelegate::updatePlayPauseState()
 {
-    Phonon::MediaObject* media = delegated()->mediaObject();
-
-    if (media->state() == Phonon::PlayingState)
+    if (delegated()->state() == Phonon::PlayingState)
         mPlayPauseButton->setFileName(":/images/pause.svg");
     else
         mPlayPauseButton->setFileName(":/images/play.svg");
@@ -209,8 +179,7 @@ void UBGraphicsVideoItemDelegate::updatePlayPauseState()
 
 void UBGraphicsVideoItemDelegate::updateTicker(qint64 time)
 {
-    Phonon::MediaObject* media = delegated()->mediaObject();
-    mVideoControl->totalTimeChanged(media->totalTime());
+    mVideoControl->totalTimeChanged(delegated()->totalTime());
 
     mVideoControl->updateTicker(time);
 }
@@ -328,11 +297,10 @@ void DelegateVideoControl::seekToMousePos(QPointF mousePos)
 
     qreal mouseX = mousePos.x();
 
-    if (mTotalTimeInMs > 0 && length > 0 && mDelegate
-        && mDelegate->mediaObject() && mDelegate->mediaObject()->isSeekable())
+    if (mTotalTimeInMs > 0 && length > 0 && mDelegate)
     {
         qint64 tickPos = mTotalTimeInMs / length * (mouseX - minX);
-        mDelegate->mediaObject()->seek(tickPos);
+        mDelegate->seek(tickPos);
 
         //OSX is a bit lazy
         updateTicker(tickPos);
@@ -71,7 +71,7 @@ class UBGraphicsVideoItemDelegate : public UBGraphicsItemDelegate
     Q_OBJECT;
 
     public:
-        UBGraphicsVideoItemDelegate(UBGraphicsVideoItem* pDelegated, Phonon::MediaObject* pMedia, QObject * parent = 0);
+        UBGraphicsVideoItemDelegate(UBGraphicsVideoItem* pDelegated, QObject * parent = 0);
         virtual ~UBGraphicsVideoItemDelegate();
 
         virtual void positionHandles();
@@ -106,8 +106,6 @@ class UBGraphicsVideoItemDelegate : public UBGraphicsItemDelegate
         DelegateButton* mMuteButton;
         DelegateVideoControl *mVideoControl;
 
-        Phonon::MediaObject* mMedia;
-
 };
 
 
@@ -0,0 +1,134 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBGraphicsZOrder.h"
+
+#include "core/memcheck.h"
+
+UBGraphicsZOrder::UBGraphicsZOrder()
+{
+    // NOOP
+}
+
+
+UBGraphicsZOrder::~UBGraphicsZOrder()
+{
+    // NOOP
+}
+
+
+void UBGraphicsZOrder::insert(QGraphicsItem* pItem)
+{
+    if (mKeys.contains(pItem))
+    {
+        update(pItem);
+        return;
+    }
+
+    mItems.insert(pItem->zValue(), pItem);
+    mKeys.insert(pItem, pItem->zValue());
+}
+
+
+void UBGraphicsZOrder::remove(QGraphicsItem* pItem)
+{
+    if (!mKeys.contains(pItem))
+        return;
+
+    mItems.remove(mKeys.take(pItem), pItem);
+}
+
+
+void UBGraphicsZOrder::clear()
+{
+    mItems.clear();
+    mKeys.clear();
+}
+
+
+void UBGraphicsZOrder::update(QGraphicsItem* pItem)
+{
+    QHash<QGraphicsItem*, qreal>::iterator key = mKeys.find(pItem);
+
+    if (key == mKeys.end() || key.value() == pItem->zValue())
+        return;
+
+    mItems.remove(key.value(), pItem);
+
+    key.value() = pItem->zValue();
+    mItems.insert(key.value(), pItem);
+}
+
+
+qreal UBGraphicsZOrder::frontZValue(qreal pLayerStart, qreal pLayerEnd) const
+{
+    QMultiMap<qreal, QGraphicsItem*>::const_iterator end = mItems.lowerBound(pLayerEnd);
+
+    if (end == mItems.constBegin())
+        return pLayerStart + 1.0;
+
+    qreal frontKey = (end - 1).key();
+
+    if (frontKey < pLayerStart)
+        return pLayerStart + 1.0;
+
+    // past the last integer key of the layer, keeps halving the remaining range
+    if (frontKey + 1.0 < pLayerEnd)
+        return frontKey + 1.0;
+    else
+        return (frontKey + pLayerEnd) / 2;
+}
+
+
+qreal UBGraphicsZOrder::backZValue(qreal pLayerStart, qreal pLayerEnd) const
+{
+    QMultiMap<qreal, QGraphicsItem*>::const_iterator back = mItems.upperBound(pLayerStart);
+
+    if (back == mItems.constEnd() || back.key() >= pLayerEnd)
+        return pLayerStart + 1.0;
+
+    if (back.key() - 1.0 > pLayerStart)
+        return back.key() - 1.0;
+    else
+        return (pLayerStart + back.key()) / 2;
+}
+
+
+QGraphicsItem* UBGraphicsZOrder::backItem(qreal pLayerStart, qreal pLayerEnd) const
+{
+    QMultiMap<qreal, QGraphicsItem*>::const_iterator back = mItems.lowerBound(pLayerStart);
+
+    if (back == mItems.constEnd() || back.key() >= pLayerEnd)
+        return 0;
+
+    return back.value();
+}
+
+
+QList<QGraphicsItem*> UBGraphicsZOrder::items()
+{
+    QList<QGraphicsItem*> staleItems;
+
+    for (QMultiMap<qreal, QGraphicsItem*>::const_iterator it = mItems.constBegin(); it != mItems.constEnd(); ++it)
+    {
+        if (it.key() != it.value()->zValue())
+            staleItems << it.value();
+    }
+
+    foreach(QGraphicsItem* item, staleItems)
+        update(item);
+
+    return mItems.values();
+}
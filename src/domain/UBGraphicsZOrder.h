@@ -0,0 +1,73 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBGRAPHICSZORDER_H_
+#define UBGRAPHICSZORDER_H_
+
+#include <QtGui>
+
+/**
+ * Items of a scene ordered by z value.
+ *
+ * The z value is the key of the item, layers are ranges of keys [layerStart, layerEnd).
+ * Keys are fractional, placing an item in front of or behind the others of its layer
+ * only changes its own key, in O(log n).
+ *
+ * Items with a delegate report their z value changes (see UBGraphicsItemDelegate::itemChange),
+ * the keys of the other items are checked when the ordered list is built.
+ */
+class UBGraphicsZOrder
+{
+    public:
+
+        UBGraphicsZOrder();
+        virtual ~UBGraphicsZOrder();
+
+        void insert(QGraphicsItem* pItem);
+        void remove(QGraphicsItem* pItem);
+        void clear();
+
+        // the z value of the item has changed
+        void update(QGraphicsItem* pItem);
+
+        bool contains(QGraphicsItem* pItem) const
+        {
+            return mKeys.contains(pItem);
+        }
+
+        int size() const
+        {
+            return mKeys.size();
+        }
+
+        // z value placing an item in front of all the items of the layer
+        qreal frontZValue(qreal pLayerStart, qreal pLayerEnd) const;
+
+        // z value placing an item behind all the items of the layer, above pLayerStart
+        qreal backZValue(qreal pLayerStart, qreal pLayerEnd) const;
+
+        // first item of the layer, 0 if the layer is empty
+        QGraphicsItem* backItem(qreal pLayerStart, qreal pLayerEnd) const;
+
+        // from back to front
+        QList<QGraphicsItem*> items();
+
+    private:
+
+        QMultiMap<qreal, QGraphicsItem*> mItems;
+        QHash<QGraphicsItem*, qreal> mKeys;
+};
+
+#endif /* UBGRAPHICSZORDER_H_ */
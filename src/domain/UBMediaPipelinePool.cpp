@@ -0,0 +1,343 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBMediaPipelinePool.h"
+
+#include "core/UBPersistenceManager.h"
+
+#include "domain/UBGraphicsMediaItem.h"
+
+#include "frameworks/UBTrace.h"
+
+#include "core/memcheck.h"
+
+const int UBMediaPipelinePool::maxPipelines = 4;
+
+static const int maxPosterWidth = 640;
+static const int posterTimeoutMs = 10000;
+
+UBMediaPipelinePool* UBMediaPipelinePool::sPool = 0;
+
+UBMediaPipelinePool::UBMediaPipelinePool(QObject *parent)
+    : QObject(parent)
+    , mUseCounter(0)
+    , mPosterPipeline(0)
+{
+    mPosterTimer.setInterval(250);
+    connect(&mPosterTimer, SIGNAL(timeout()), this, SLOT(grabPoster()));
+}
+
+
+UBMediaPipelinePool::~UBMediaPipelinePool()
+{
+    cancelPoster();
+
+    while (!mPipelines.isEmpty())
+    {
+        UBMediaPipeline* pipeline = mPipelines.first();
+
+        if (pipeline->owner)
+            pipeline->owner->releasePipeline();
+
+        destroyPipeline(pipeline);
+    }
+}
+
+
+UBMediaPipelinePool* UBMediaPipelinePool::pool()
+{
+    if (!sPool)
+        sPool = new UBMediaPipelinePool();
+
+    return sPool;
+}
+
+
+UBMediaPipeline* UBMediaPipelinePool::acquire(UBGraphicsMediaItem* pOwner, bool pWithVideo)
+{
+    UBMediaPipeline* pipeline = idlePipeline(pWithVideo);
+
+    if (!pipeline && mPipelines.size() < maxPipelines)
+    {
+        pipeline = createPipeline(pWithVideo);
+    }
+    else if (!pipeline)
+    {
+        UBMediaPipeline* victim = idlePipeline(!pWithVideo);
+
+        if (!victim && mPosterPipeline)
+        {
+            // playing has priority over the poster extraction, it is resumed later
+            victim = mPosterPipeline;
+            cancelPoster();
+        }
+
+        if (!victim)
+        {
+            // least recently acquired, preferring the pipelines not playing
+            foreach(UBMediaPipeline* candidate, mPipelines)
+            {
+                bool candidateIsPlaying = candidate->mediaObject->state() == Phonon::PlayingState;
+                bool victimIsPlaying = victim && victim->mediaObject->state() == Phonon::PlayingState;
+
+                if (!victim
+                        || (victimIsPlaying && !candidateIsPlaying)
+                        || (victimIsPlaying == candidateIsPlaying && candidate->lastUse < victim->lastUse))
+                {
+                    victim = candidate;
+                }
+            }
+
+            UB_TRACE_COUNT("media.pipelines.evicted");
+
+            victim->owner->releasePipeline();
+        }
+
+        if ((victim->videoWidget != 0) == pWithVideo)
+        {
+            pipeline = victim;
+        }
+        else
+        {
+            destroyPipeline(victim);
+            pipeline = createPipeline(pWithVideo);
+        }
+    }
+
+    pipeline->owner = pOwner;
+    pipeline->lastUse = ++mUseCounter;
+
+    return pipeline;
+}
+
+
+void UBMediaPipelinePool::release(UBMediaPipeline* pPipeline)
+{
+    if (!pPipeline)
+        return;
+
+    pPipeline->mediaObject->clear();
+    pPipeline->owner = 0;
+
+    if (!mPendingPosters.isEmpty())
+        QTimer::singleShot(0, this, SLOT(extractNextPoster()));
+}
+
+
+QString UBMediaPipelinePool::posterFile(const QString& pVideoFile)
+{
+    QFileInfo videoInfo(pVideoFile);
+
+    return QDir::cleanPath(videoInfo.absolutePath() + "/../" + UBPersistenceManager::videoPosterDirectory)
+            + "/" + videoInfo.completeBaseName() + ".png";
+}
+
+
+QImage UBMediaPipelinePool::cachedPoster(const QString& pVideoFile)
+{
+    QFileInfo videoInfo(pVideoFile);
+    QFileInfo posterInfo(posterFile(pVideoFile));
+
+    if (posterInfo.exists() && posterInfo.lastModified() >= videoInfo.lastModified())
+    {
+        QImage poster(posterInfo.absoluteFilePath());
+
+        if (!poster.isNull())
+            return poster;
+    }
+
+    if (videoInfo.exists()
+            && mPosterVideoFile != pVideoFile
+            && !mPendingPosters.contains(pVideoFile)
+            && !mFailedPosters.contains(pVideoFile))
+    {
+        mPendingPosters << pVideoFile;
+        QTimer::singleShot(0, this, SLOT(extractNextPoster()));
+    }
+
+    return QImage();
+}
+
+
+UBMediaPipeline* UBMediaPipelinePool::createPipeline(bool pWithVideo)
+{
+    UB_TRACE_COUNT("media.pipelines.created");
+
+    UBMediaPipeline* pipeline = new UBMediaPipeline();
+
+    pipeline->mediaObject = new Phonon::MediaObject(this);
+    pipeline->audioOutput = new Phonon::AudioOutput(pWithVideo ? Phonon::VideoCategory : Phonon::MusicCategory, this);
+    Phonon::createPath(pipeline->mediaObject, pipeline->audioOutput);
+
+    if (pWithVideo)
+    {
+        pipeline->videoWidget = new Phonon::VideoWidget(); // embedded in the media item holding the pipeline
+        Phonon::createPath(pipeline->mediaObject, pipeline->videoWidget);
+    }
+
+    mPipelines << pipeline;
+
+    return pipeline;
+}
+
+
+void UBMediaPipelinePool::destroyPipeline(UBMediaPipeline* pPipeline)
+{
+    mPipelines.removeAll(pPipeline);
+
+    delete pPipeline->videoWidget;
+    delete pPipeline->audioOutput;
+    delete pPipeline->mediaObject;
+    delete pPipeline;
+}
+
+
+UBMediaPipeline* UBMediaPipelinePool::idlePipeline(bool pWithVideo) const
+{
+    foreach(UBMediaPipeline* pipeline, mPipelines)
+    {
+        if (!pipeline->owner && pipeline != mPosterPipeline && (pipeline->videoWidget != 0) == pWithVideo)
+            return pipeline;
+    }
+
+    return 0;
+}
+
+
+void UBMediaPipelinePool::extractNextPoster()
+{
+    if (mPosterPipeline || mPendingPosters.isEmpty())
+        return;
+
+    // posters never take a pipeline from a media item, waits for the next release when the pool is full
+    UBMediaPipeline* pipeline = idlePipeline(true);
+
+    if (!pipeline && mPipelines.size() < maxPipelines)
+        pipeline = createPipeline(true);
+
+    if (!pipeline)
+        return;
+
+    mPosterPipeline = pipeline;
+    mPosterVideoFile = mPendingPosters.takeFirst();
+
+    pipeline->audioOutput->setMuted(true);
+
+    connect(pipeline->mediaObject, SIGNAL(stateChanged(Phonon::State, Phonon::State)),
+            this, SLOT(posterStateChanged(Phonon::State, Phonon::State)));
+
+    pipeline->mediaObject->setCurrentSource(Phonon::MediaSource(mPosterVideoFile));
+    pipeline->mediaObject->pause();
+
+    mPosterClock.start();
+    mPosterTimer.start();
+}
+
+
+void UBMediaPipelinePool::posterStateChanged(Phonon::State pNewState, Phonon::State pOldState)
+{
+    Q_UNUSED(pOldState);
+
+    if (pNewState == Phonon::ErrorState)
+        finishPoster(QImage());
+    else if (pNewState == Phonon::PausedState)
+        grabPoster();
+}
+
+
+void UBMediaPipelinePool::grabPoster()
+{
+    if (!mPosterPipeline)
+    {
+        mPosterTimer.stop();
+        return;
+    }
+
+    if (mPosterPipeline->mediaObject->state() == Phonon::PausedState)
+    {
+        QImage frame = mPosterPipeline->videoWidget->snapshot();
+
+        if (!frame.isNull())
+        {
+            finishPoster(frame);
+            return;
+        }
+    }
+
+    if (mPosterClock.elapsed() > posterTimeoutMs)
+        finishPoster(QImage());
+}
+
+
+void UBMediaPipelinePool::finishPoster(const QImage& pFrame)
+{
+    mPosterTimer.stop();
+
+    Phonon::MediaObject* media = mPosterPipeline->mediaObject;
+    disconnect(media, 0, this, 0);
+
+    qint64 duration = media->totalTime();
+    media->clear();
+
+    QString videoFile = mPosterVideoFile;
+
+    mPosterPipeline = 0;
+    mPosterVideoFile.clear();
+
+    QImage poster = pFrame;
+
+    if (poster.width() > maxPosterWidth)
+        poster = poster.scaledToWidth(maxPosterWidth, Qt::SmoothTransformation);
+
+    if (duration > 0)
+        poster.setText("Duration", QString::number(duration));
+
+    QString posterPath = posterFile(videoFile);
+
+    if (poster.isNull())
+    {
+        qWarning() << "cannot extract poster frame from" << videoFile;
+        mFailedPosters << videoFile;
+    }
+    else if (!QDir().mkpath(QFileInfo(posterPath).absolutePath()) || !poster.save(posterPath, "PNG"))
+    {
+        qWarning() << "cannot write poster frame" << posterPath;
+        mFailedPosters << videoFile;
+    }
+    else
+    {
+        UB_TRACE_COUNT("media.posters.extracted");
+        emit posterReady(videoFile);
+    }
+
+    extractNextPoster();
+}
+
+
+void UBMediaPipelinePool::cancelPoster()
+{
+    if (!mPosterPipeline)
+        return;
+
+    mPosterTimer.stop();
+
+    disconnect(mPosterPipeline->mediaObject, 0, this, 0);
+    mPosterPipeline->mediaObject->clear();
+
+    mPendingPosters.prepend(mPosterVideoFile);
+
+    mPosterPipeline = 0;
+    mPosterVideoFile.clear();
+}
@@ -0,0 +1,116 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBMEDIAPIPELINEPOOL_H_
+#define UBMEDIAPIPELINEPOOL_H_
+
+#include <QtGui>
+#include <phonon/MediaObject>
+#include <phonon/AudioOutput>
+#include <phonon/VideoWidget>
+
+class UBGraphicsMediaItem;
+
+class UBMediaPipeline
+{
+    public:
+
+        UBMediaPipeline()
+            : mediaObject(0)
+            , audioOutput(0)
+            , videoWidget(0)
+            , owner(0)
+            , lastUse(0)
+        {
+            // NOOP
+        }
+
+        Phonon::MediaObject* mediaObject;
+        Phonon::AudioOutput* audioOutput;
+        Phonon::VideoWidget* videoWidget; // 0 for audio pipelines
+
+        UBGraphicsMediaItem* owner;
+        quint64 lastUse;
+};
+
+
+/**
+ * Phonon decoder pipelines shared by the media items of all scenes.
+ *
+ * Media items only hold a pipeline while they are played (or paused after playing).
+ * At most maxPipelines are alive, when the pool is full the least recently acquired
+ * pipeline is taken back from its owner, idle ones first.
+ *
+ * The pool also extracts video poster frames, one video at a time on an idle pipeline,
+ * and caches them as PNG in the videoPosters directory of the document, next to videos.
+ * The duration of the video is kept as the "Duration" text of the PNG.
+ */
+class UBMediaPipelinePool : public QObject
+{
+    Q_OBJECT;
+
+    private:
+
+        UBMediaPipelinePool(QObject *parent = 0);
+
+    public:
+
+        virtual ~UBMediaPipelinePool();
+
+        static UBMediaPipelinePool* pool();
+
+        static const int maxPipelines;
+
+        UBMediaPipeline* acquire(UBGraphicsMediaItem* pOwner, bool pWithVideo);
+        void release(UBMediaPipeline* pPipeline);
+
+        static QString posterFile(const QString& pVideoFile);
+
+        // up to date poster read from the cache, a null image (and a background extraction) otherwise
+        QImage cachedPoster(const QString& pVideoFile);
+
+    signals:
+
+        void posterReady(const QString& pVideoFile);
+
+    private slots:
+
+        void extractNextPoster();
+        void posterStateChanged(Phonon::State pNewState, Phonon::State pOldState);
+        void grabPoster();
+
+    private:
+
+        UBMediaPipeline* createPipeline(bool pWithVideo);
+        void destroyPipeline(UBMediaPipeline* pPipeline);
+        UBMediaPipeline* idlePipeline(bool pWithVideo) const;
+
+        void finishPoster(const QImage& pFrame);
+        void cancelPoster();
+
+        QList<UBMediaPipeline*> mPipelines;
+        quint64 mUseCounter;
+
+        QStringList mPendingPosters;
+        QSet<QString> mFailedPosters;
+        QString mPosterVideoFile;
+        UBMediaPipeline* mPosterPipeline;
+        QTimer mPosterTimer;
+        QElapsedTimer mPosterClock;
+
+        static UBMediaPipelinePool* sPool;
+};
+
+#endif /* UBMEDIAPIPELINEPOOL_H_ */
@@ -199,7 +199,8 @@ UBW3CWidget::UBW3CWidget(const QUrl& pWidgetUrl, QWidget *parent)
         mMainHtmlUrl = QUrl(mMainHtmlFileName);
 
     connect(page()->mainFrame(), SIGNAL(javaScriptWindowObjectCleared()), this, SLOT(javaScriptWindowObjectCleared()));
-    connect(UBApplication::boardController, SIGNAL(activeSceneChanged()), this, SLOT(javaScriptWindowObjectCleared()));
+    if (UBApplication::boardController)
+        connect(UBApplication::boardController, SIGNAL(activeSceneChanged()), this, SLOT(javaScriptWindowObjectCleared()));
 
     QWebView::load(mMainHtmlUrl);
 
@@ -215,6 +216,9 @@ UBW3CWidget::~UBW3CWidget()
 
 void UBW3CWidget::javaScriptWindowObjectCleared()
 {
+    if (!UBApplication::boardController)
+        return;
+
     UBWidgetUniboardAPI *uniboardAPI = new UBWidgetUniboardAPI(UBApplication::boardController->activeScene(), 0);
 
     page()->mainFrame()->addToJavaScriptWindowObject("sankore", uniboardAPI);
@@ -21,7 +21,9 @@ HEADERS      += src/domain/UBGraphicsScene.h \
                 src/domain/UBGraphicsStroke.h \
     src/domain/UBGraphicsMediaItem.h \
     src/domain/UBGraphicsAudioItem.h \
-    src/domain/UBGraphicsAudioItemDelegate.h
+    src/domain/UBGraphicsAudioItemDelegate.h \
+    src/domain/UBMediaPipelinePool.h \
+    src/domain/UBGraphicsZOrder.h
                 
 HEADERS      += src/domain/UBGraphicsItemDelegate.h \
 				src/domain/UBGraphicsVideoItemDelegate.h \
@@ -52,7 +54,9 @@ SOURCES      += src/domain/UBGraphicsScene.cpp \
                 src/domain/UBGraphicsStroke.cpp \
     src/domain/UBGraphicsMediaItem.cpp \
     src/domain/UBGraphicsAudioItem.cpp \
-    src/domain/UBGraphicsAudioItemDelegate.cpp
+    src/domain/UBGraphicsAudioItemDelegate.cpp \
+    src/domain/UBMediaPipelinePool.cpp \
+    src/domain/UBGraphicsZOrder.cpp
                 
 SOURCES      += src/domain/UBGraphicsItemDelegate.cpp \
 				src/domain/UBGraphicsVideoItemDelegate.cpp \
@@ -22,6 +22,22 @@
 
 #include <openssl/md5.h>
 
+#if defined(Q_WS_WIN)
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#endif
+
+#if defined(Q_WS_X11)
+#include <sys/ioctl.h>
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+#endif
+
 #include "core/memcheck.h"
 
 QStringList UBFileSystemUtils::sTempDirToCleanUp;
@@ -253,6 +269,88 @@ bool UBFileSystemUtils::moveDir(const QString& pSourceDirPath, const QString& pT
 }
 
 
+bool UBFileSystemUtils::replaceFile(const QString& pSourceFilePath, const QString& pTargetFilePath)
+{
+#if defined(Q_WS_WIN)
+    return MoveFileExW((LPCWSTR)QDir::toNativeSeparators(pSourceFilePath).utf16(),
+                       (LPCWSTR)QDir::toNativeSeparators(pTargetFilePath).utf16(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    QByteArray source = QFile::encodeName(pSourceFilePath);
+
+    int fd = ::open(source.constData(), O_RDONLY);
+
+    if (fd >= 0)
+    {
+        ::fsync(fd);
+        ::close(fd);
+    }
+
+    return ::rename(source.constData(), QFile::encodeName(pTargetFilePath).constData()) == 0;
+#endif
+}
+
+
+bool UBFileSystemUtils::syncFile(QFile& pFile)
+{
+    if (!pFile.flush())
+        return false;
+
+#if defined(Q_WS_WIN)
+    return FlushFileBuffers((HANDLE)_get_osfhandle(pFile.handle())) != 0;
+#else
+    return ::fsync(pFile.handle()) == 0;
+#endif
+}
+
+
+bool UBFileSystemUtils::cloneFile(const QString& pSourceFilePath, const QString& pTargetFilePath, bool pAllowHardLink)
+{
+#if defined(Q_WS_X11)
+    QByteArray source = QFile::encodeName(pSourceFilePath);
+    QByteArray target = QFile::encodeName(pTargetFilePath);
+
+    int sourceFd = ::open(source.constData(), O_RDONLY);
+
+    if (sourceFd >= 0)
+    {
+        int targetFd = ::open(target.constData(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+
+        if (targetFd >= 0)
+        {
+            bool cloned = ::ioctl(targetFd, FICLONE, sourceFd) == 0;
+
+            ::close(targetFd);
+            ::close(sourceFd);
+
+            if (cloned)
+                return true;
+
+            ::unlink(target.constData());
+        }
+        else
+        {
+            ::close(sourceFd);
+        }
+    }
+#endif
+
+    if (pAllowHardLink)
+    {
+#if defined(Q_WS_WIN)
+        if (CreateHardLinkW((LPCWSTR)QDir::toNativeSeparators(pTargetFilePath).utf16(),
+                            (LPCWSTR)QDir::toNativeSeparators(pSourceFilePath).utf16(), 0))
+            return true;
+#else
+        if (::link(QFile::encodeName(pSourceFilePath).constData(), QFile::encodeName(pTargetFilePath).constData()) == 0)
+            return true;
+#endif
+    }
+
+    return QFile::copy(pSourceFilePath, pTargetFilePath);
+}
+
+
 
 QString UBFileSystemUtils::cleanName(const QString& name)
 {
@@ -506,7 +604,8 @@ QString UBFileSystemUtils::getFirstExistingFileFromList(const QString& path, con
 
 
 bool UBFileSystemUtils::compressDirInZip(const QDir& pDir, const QString& pDestPath,
-                QuaZipFile *pOutZipFile, bool pRootDocumentFolder, UBProcessingProgressListener* progressListener)
+                QuaZipFile *pOutZipFile, bool pRootDocumentFolder, UBProcessingProgressListener* progressListener,
+                const QStringList& pExcludedNames)
 {
     QFileInfoList files = pDir.entryInfoList(QDir::AllDirs | QDir::Files | QDir::NoDotAndDotDot);
 
@@ -525,7 +624,7 @@ bool UBFileSystemUtils::compressDirInZip(const QDir& pDir, const QString& pDestP
             }
         }
 
-        if (file.isFile())
+        if (file.isFile() && !QDir::match(pExcludedNames, file.fileName()))
         {
             QString objectType;
             if (pRootDocumentFolder)
@@ -564,7 +663,12 @@ bool UBFileSystemUtils::compressDirInZip(const QDir& pDir, const QString& pDestP
                 return false;
             }
 
-            pOutZipFile->write(inFile.readAll());
+            // media files are streamed, not loaded at once
+            while (!inFile.atEnd() && pOutZipFile->getZipError() == UNZ_OK)
+            {
+                pOutZipFile->write(inFile.read(64 * 1024));
+            }
+
             if(pOutZipFile->getZipError() != UNZ_OK)
             {
                 qWarning() << "Compression of file" << inFile.fileName() << " failed. Cause: outFile.write(): " << pOutZipFile->getZipError();
@@ -45,6 +45,24 @@ class UBFileSystemUtils
 
         static bool moveDir(const QString& pSourceDirPath, const QString& pTargetDirPath);
 
+        /**
+         * Atomically replace pTargetFilePath with pSourceFilePath (typically a temp file written next to the target).
+         * The source is synced to disk first, readers see either the old or the new content, never a partial file.
+         */
+        static bool replaceFile(const QString& pSourceFilePath, const QString& pTargetFilePath);
+
+        /**
+         * Flush pFile and wait until its content is on disk.
+         */
+        static bool syncFile(QFile& pFile);
+
+        /**
+         * Copy a file, sharing its data with the source when the file system allows it: a copy-on-write
+         * clone first (reflink), then a hard link if pAllowHardLink, a plain copy otherwise.
+         * Hard links are only safe for files never rewritten in place, such as the assets of a document.
+         */
+        static bool cloneFile(const QString& pSourceFilePath, const QString& pTargetFilePath, bool pAllowHardLink);
+
         static QString cleanName(const QString& name);
 
         static QString digitFileFormat(const QString& s, int digit);
@@ -71,10 +89,12 @@ class UBFileSystemUtils
          * @arg pDestPath the path inside the zip. Attention, if path is not empty it must end by a /.
          * @arg pOutZipFile the zip file we want to populate with the directory
          * @arg UBProcessingProgressListener an object listening to the compression progress
+         * @arg pExcludedNames wildcards of the files of pDir left out of the zip, the sub directories are added whole
          * @return bool. true if compression is successful.
          */
         static bool compressDirInZip(const QDir& pDir, const QString& pDestDir, QuaZipFile *pOutZipFile
-                        , bool pRootDocumentFolder, UBProcessingProgressListener* progressListener = 0);
+                        , bool pRootDocumentFolder, UBProcessingProgressListener* progressListener = 0
+                        , const QStringList& pExcludedNames = QStringList());
 
         static bool expandZipToDir(const QFile& pZipFile, const QDir& pTargetDir);
 
@@ -0,0 +1,219 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBTrace.h"
+
+#include "core/memcheck.h"
+
+// about 40 bytes per event, bounds a forgotten capture to ~80MB
+static const int maxCapturedEvents = 2 * 1024 * 1024;
+
+bool UBTrace::sEnabled = false;
+UBTrace* UBTrace::sTrace = 0;
+
+UBTrace::UBTrace()
+    : mLive(false)
+    , mCapturing(false)
+    , mDroppedEvents(0)
+{
+    mClock.start();
+}
+
+
+UBTrace::~UBTrace()
+{
+    stopCapture();
+}
+
+
+UBTrace* UBTrace::trace()
+{
+    if (!sTrace)
+        sTrace = new UBTrace();
+
+    return sTrace;
+}
+
+
+void UBTrace::updateEnabled()
+{
+    sEnabled = mLive || mCapturing;
+}
+
+
+void UBTrace::setLive(bool pLive)
+{
+    QMutexLocker locker(&mMutex);
+
+    mLive = pLive;
+    updateEnabled();
+}
+
+
+bool UBTrace::startCapture(const QString& pTraceFile)
+{
+    stopCapture();
+
+    QMutexLocker locker(&mMutex);
+
+    QFile file(pTraceFile);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "cannot write trace to" << pTraceFile;
+        return false;
+    }
+
+    mCaptureFile = pTraceFile;
+    mEvents.clear();
+    mEvents.reserve(64 * 1024);
+    mDroppedEvents = 0;
+
+    mCapturing = true;
+    updateEnabled();
+
+    qDebug() << "capturing trace to" << pTraceFile;
+
+    return true;
+}
+
+
+void UBTrace::stopCapture()
+{
+    QMutexLocker locker(&mMutex);
+
+    if (!mCapturing)
+        return;
+
+    mCapturing = false;
+    updateEnabled();
+
+    writeCapture();
+
+    mEvents.clear();
+    mEvents.squeeze();
+}
+
+
+bool UBTrace::writeCapture()
+{
+    QFile file(mCaptureFile);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        qWarning() << "cannot write trace to" << mCaptureFile;
+        return false;
+    }
+
+    QHash<Qt::HANDLE, int> threadIds;
+
+    QTextStream out(&file);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+    for (int i = 0; i < mEvents.size(); i++)
+    {
+        const Event& event = mEvents.at(i);
+
+        if (!threadIds.contains(event.threadId))
+            threadIds.insert(event.threadId, threadIds.size() + 1);
+
+        out << (i > 0 ? ",\n" : "")
+            << "{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+            << "\", \"ph\": \"" << event.phase << "\", \"ts\": " << event.timestampUs
+            << ", \"pid\": 1, \"tid\": " << threadIds.value(event.threadId);
+
+        if (event.phase == 'X')
+            out << ", \"dur\": " << event.value << "}";
+        else
+            out << ", \"args\": {\"value\": " << event.value << "}}";
+    }
+
+    out << "\n], \"otherData\": {\"droppedEvents\": " << mDroppedEvents << "}}\n";
+
+    qDebug() << "trace written to" << mCaptureFile << ":" << mEvents.size() << "events," << mDroppedEvents << "dropped";
+
+    return out.status() == QTextStream::Ok;
+}
+
+
+void UBTrace::addDuration(const char* pName, const char* pCategory, qint64 pStartUs, qint64 pDurationUs)
+{
+    QMutexLocker locker(&mMutex);
+
+    mLastDurations.insert(QByteArray::fromRawData(pName, qstrlen(pName)), pDurationUs);
+
+    if (!mCapturing)
+        return;
+
+    if (mEvents.size() >= maxCapturedEvents)
+    {
+        mDroppedEvents++;
+        return;
+    }
+
+    Event event;
+    event.name = pName;
+    event.category = pCategory;
+    event.phase = 'X';
+    event.timestampUs = pStartUs;
+    event.value = pDurationUs;
+    event.threadId = QThread::currentThreadId();
+
+    mEvents << event;
+}
+
+
+void UBTrace::addCount(const char* pName, qint64 pDelta)
+{
+    QMutexLocker locker(&mMutex);
+
+    qint64& value = mCounters[QByteArray::fromRawData(pName, qstrlen(pName))];
+    value += pDelta;
+
+    if (!mCapturing)
+        return;
+
+    if (mEvents.size() >= maxCapturedEvents)
+    {
+        mDroppedEvents++;
+        return;
+    }
+
+    Event event;
+    event.name = pName;
+    event.category = "counter";
+    event.phase = 'C';
+    event.timestampUs = nowUs();
+    event.value = value;
+    event.threadId = QThread::currentThreadId();
+
+    mEvents << event;
+}
+
+
+qint64 UBTrace::counter(const char* pName) const
+{
+    QMutexLocker locker(&mMutex);
+
+    return mCounters.value(QByteArray::fromRawData(pName, qstrlen(pName)), 0);
+}
+
+
+qint64 UBTrace::lastDurationUs(const char* pName) const
+{
+    QMutexLocker locker(&mMutex);
+
+    return mLastDurations.value(QByteArray::fromRawData(pName, qstrlen(pName)), -1);
+}
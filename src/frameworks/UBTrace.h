@@ -0,0 +1,140 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBTRACE_H_
+#define UBTRACE_H_
+
+#include <QtCore>
+
+/**
+ * Always compiled tracing of scoped timings and counters.
+ *
+ * When tracing is disabled, a UB_TRACE_SCOPE or UB_TRACE_COUNT costs a single
+ * test of a static flag. Tracing is live while the board HUD is shown (counters only)
+ * and during a capture (-trace <file> on the command line), whose events are written
+ * in the Chrome trace event format when the capture stops (load in chrome://tracing).
+ *
+ * Names and categories must be string literals, they are kept as pointers.
+ */
+class UBTrace
+{
+    private:
+
+        UBTrace();
+
+    public:
+
+        virtual ~UBTrace();
+
+        static UBTrace* trace();
+
+        static bool isEnabled()
+        {
+            return sEnabled;
+        }
+
+        void setLive(bool pLive);
+
+        bool startCapture(const QString& pTraceFile);
+        void stopCapture();
+
+        bool isCapturing() const
+        {
+            return mCapturing;
+        }
+
+        qint64 nowUs() const
+        {
+            return mClock.nsecsElapsed() / 1000;
+        }
+
+        void addDuration(const char* pName, const char* pCategory, qint64 pStartUs, qint64 pDurationUs);
+        void addCount(const char* pName, qint64 pDelta);
+
+        qint64 counter(const char* pName) const;
+
+        // last duration recorded under the name, -1 if none
+        qint64 lastDurationUs(const char* pName) const;
+
+    private:
+
+        class Event
+        {
+            public:
+
+                const char* name;
+                const char* category;
+                char phase;
+                qint64 timestampUs;
+                qint64 value; // duration for complete events, counter value for counter events
+                Qt::HANDLE threadId;
+        };
+
+        void updateEnabled();
+        bool writeCapture();
+
+        mutable QMutex mMutex;
+        QElapsedTimer mClock;
+
+        bool mLive;
+        bool mCapturing;
+        QString mCaptureFile;
+
+        QVector<Event> mEvents;
+        int mDroppedEvents;
+
+        QHash<QByteArray, qint64> mCounters;
+        QHash<QByteArray, qint64> mLastDurations;
+
+        static bool sEnabled;
+        static UBTrace* sTrace;
+};
+
+
+class UBTraceScope
+{
+    public:
+
+        UBTraceScope(const char* pName, const char* pCategory)
+            : mName(pName)
+            , mCategory(pCategory)
+            , mStartUs(-1)
+        {
+            if (UBTrace::isEnabled())
+                mStartUs = UBTrace::trace()->nowUs();
+        }
+
+        ~UBTraceScope()
+        {
+            if (mStartUs >= 0)
+                UBTrace::trace()->addDuration(mName, mCategory, mStartUs, UBTrace::trace()->nowUs() - mStartUs);
+        }
+
+    private:
+
+        const char* mName;
+        const char* mCategory;
+        qint64 mStartUs;
+};
+
+#define UB_TRACE_JOIN_(a, b) a##b
+#define UB_TRACE_JOIN(a, b) UB_TRACE_JOIN_(a, b)
+
+#define UB_TRACE_SCOPE(name, category) UBTraceScope UB_TRACE_JOIN(ubTraceScope, __LINE__)(name, category)
+
+#define UB_TRACE_COUNT(name) \
+    do { if (UBTrace::isEnabled()) UBTrace::trace()->addCount(name, 1); } while (0)
+
+#endif /* UBTRACE_H_ */
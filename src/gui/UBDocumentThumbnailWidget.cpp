@@ -71,7 +71,7 @@ void UBDocumentThumbnailWidget::mouseMoveEvent(QMouseEvent *event)
         UBMimeData *mime = new UBMimeData(mimeDataItems);
         drag->setMimeData(mime);
 
-        drag->setPixmap(sceneItem->pixmap().scaledToWidth(100));
+        drag->setPixmap(sceneItem->thumbnail().scaledToWidth(100));
         drag->setHotSpot(QPoint(drag->pixmap().width()/2,
                                      drag->pixmap().height() / 2));
 
@@ -40,6 +40,9 @@ UBDocumentTreeWidget::UBDocumentTreeWidget(QWidget * parent)
 
     connect(this, SIGNAL(itemChanged(QTreeWidgetItem *, int))
             , this,  SLOT(itemChangedValidation(QTreeWidgetItem *, int)));
+
+    connect(this, SIGNAL(itemExpanded(QTreeWidgetItem *))
+            , this, SLOT(populateGroup(QTreeWidgetItem *)));
 }
 
 
@@ -162,6 +165,15 @@ void UBDocumentTreeWidget::dragMoveEvent(QDragMoveEvent *event)
 }
 
 
+void UBDocumentTreeWidget::populateGroup(QTreeWidgetItem *item)
+{
+    UBDocumentGroupTreeItem *group = dynamic_cast<UBDocumentGroupTreeItem*>(item);
+
+    if (group)
+        group->populate();
+}
+
+
 void UBDocumentTreeWidget::focusInEvent(QFocusEvent *event)
 {
     Q_UNUSED(event);
@@ -185,6 +197,8 @@ void UBDocumentTreeWidget::dropEvent(QDropEvent *event)
 
     if (groupItem && mSelectedProxyTi && mSelectedProxyTi->proxy())
     {
+        groupItem->populate();
+
         UBDocumentGroupTreeItem *sourceGroupItem = dynamic_cast<UBDocumentGroupTreeItem*>(mSelectedProxyTi->parent());
         bool isTrashItem = sourceGroupItem && sourceGroupItem->isTrashFolder();
         if ((isTrashItem && !groupItem->isTrashFolder()) ||
@@ -369,6 +383,19 @@ UBDocumentProxyTreeItem::UBDocumentProxyTreeItem(QTreeWidgetItem * parent, UBDoc
 }
 
 
+UBDocumentProxyTreeItem::UBDocumentProxyTreeItem(UBDocumentProxy* proxy, bool isEditable)
+    : QTreeWidgetItem()
+    , mProxy(proxy)
+{
+    Qt::ItemFlags flags = Qt::ItemIsSelectable | Qt::ItemIsEnabled | Qt::ItemIsDragEnabled;
+
+    if (isEditable)
+        flags |= Qt::ItemIsEditable;
+
+    setFlags(flags);
+}
+
+
 UBDocumentGroupTreeItem::UBDocumentGroupTreeItem(QTreeWidgetItem *parent, bool isEditable)
     : QTreeWidgetItem(parent)
 {
@@ -406,3 +433,63 @@ bool UBDocumentGroupTreeItem::isDefaultFolder() const
 {
     return (0 == (flags() & Qt::ItemIsEditable)) && (groupName() == UBSettings::defaultDocumentGroupName);
 }
+
+
+void UBDocumentGroupTreeItem::setPendingDocuments(const QList<UBDocumentProxy*>& pDocuments)
+{
+    mPendingDocuments.clear();
+
+    foreach(UBDocumentProxy* proxy, pDocuments)
+        mPendingDocuments << proxy;
+
+    setChildIndicatorPolicy(mPendingDocuments.isEmpty() ? QTreeWidgetItem::DontShowIndicatorWhenChildless : QTreeWidgetItem::ShowIndicator);
+}
+
+
+void UBDocumentGroupTreeItem::populate()
+{
+    if (mPendingDocuments.isEmpty())
+        return;
+
+    QList<QPointer<UBDocumentProxy> > pending = mPendingDocuments;
+    mPendingDocuments.clear();
+
+    setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicatorWhenChildless);
+
+    bool isEditable = !isTrashFolder();
+
+    if (childCount() == 0)
+    {
+        // already in their order, added in one go
+        QList<QTreeWidgetItem*> items;
+
+        foreach(QPointer<UBDocumentProxy> proxy, pending)
+        {
+            if (!proxy)
+                continue;
+
+            QTreeWidgetItem* item = new UBDocumentProxyTreeItem(proxy, isEditable); // deleted by the tree widget
+            item->setText(0, proxy->name());
+            items << item;
+        }
+
+        addChildren(items);
+    }
+    else
+    {
+        foreach(QPointer<UBDocumentProxy> proxy, pending)
+        {
+            if (!proxy)
+                continue;
+
+            QTreeWidgetItem* item = new UBDocumentProxyTreeItem(this, proxy, isEditable); // deleted by the tree widget
+            item->setText(0, proxy->name());
+        }
+    }
+}
+
+
+int UBDocumentGroupTreeItem::documentCount() const
+{
+    return childCount() + mPendingDocuments.size();
+}
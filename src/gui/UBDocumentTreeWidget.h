@@ -41,6 +41,8 @@ class UBDocumentTreeWidget : public QTreeWidget
     private slots:
         void documentUpdated(UBDocumentProxy *pDocument);
 
+        void populateGroup(QTreeWidgetItem *item);
+
         void itemChangedValidation(QTreeWidgetItem * item, int column);
 
     private:
@@ -56,6 +58,9 @@ class UBDocumentProxyTreeItem : public QTreeWidgetItem
 
         UBDocumentProxyTreeItem(QTreeWidgetItem * parent, UBDocumentProxy* proxy, bool isEditable = true);
 
+        // not inserted, for the documents added at once in their order
+        UBDocumentProxyTreeItem(UBDocumentProxy* proxy, bool isEditable);
+
         QPointer<UBDocumentProxy> proxy() const
         {
             return mProxy;
@@ -77,6 +82,22 @@ class UBDocumentGroupTreeItem : public QTreeWidgetItem
 
         bool isTrashFolder() const;
         bool isDefaultFolder() const;
+
+        // the documents of the group, most recently updated first, get their item when the group
+        // is first expanded or walked through
+        void setPendingDocuments(const QList<UBDocumentProxy*>& pDocuments);
+        void populate();
+
+        // including the documents not populated yet
+        int documentCount() const;
+
+        bool hasPendingDocument(UBDocumentProxy* pDocument) const
+        {
+            return mPendingDocuments.contains(pDocument);
+        }
+
+    private:
+        QList<QPointer<UBDocumentProxy> > mPendingDocuments;
 };
 
 #endif /* UBDOCUMENTTREEWIDGET_H_ */
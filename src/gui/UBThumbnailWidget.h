@@ -257,6 +257,79 @@ class UBSceneThumbnailPixmap : public UBThumbnailPixmap
             // NOOP
         }
 
+        // the thumbnail file is read the first time the item is painted, the item keeps pThumbnailSize
+        UBSceneThumbnailPixmap(const QString& pThumbnailPath, const QSize& pThumbnailSize, UBDocumentProxy* proxy, int pSceneIndex)
+            : UBThumbnailPixmap(QPixmap())
+            , mProxy(proxy)
+            , mSceneIndex(pSceneIndex)
+            , mThumbnailPath(pThumbnailPath)
+            , mThumbnailSize(pThumbnailSize)
+        {
+            // NOOP
+        }
+
+        virtual QRectF boundingRect() const
+        {
+            if (!mThumbnailPath.isEmpty())
+                return QRectF(QPointF(0, 0), mThumbnailSize);
+
+            return UBThumbnailPixmap::boundingRect();
+        }
+
+        // the decoded thumbnail is drawn directly, the geometry of the item never changes in paint
+        virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+        {
+            if (mThumbnailPath.isEmpty())
+            {
+                UBThumbnailPixmap::paint(painter, option, widget);
+                return;
+            }
+
+            painter->setRenderHint(QPainter::SmoothPixmapTransform, transformationMode() == Qt::SmoothTransformation);
+            painter->drawPixmap(QPointF(0, 0), thumbnail());
+        }
+
+        // the pixmap shown, read from the thumbnail file when needed
+        QPixmap thumbnail()
+        {
+            if (mThumbnailPath.isEmpty())
+                return pixmap();
+
+            if (mThumbnail.isNull())
+            {
+                QPixmap pix(mThumbnailPath);
+
+                // a file which cannot be read keeps a blank cell
+                if (pix.isNull())
+                {
+                    pix = QPixmap(mThumbnailSize);
+                    pix.fill(Qt::white);
+                }
+
+                mThumbnail = pix.size() == mThumbnailSize ? pix : pix.scaled(mThumbnailSize);
+            }
+
+            return mThumbnail;
+        }
+
+        // replaces the pixmap shown, a placeholder already painted is redrawn
+        void setThumbnail(const QPixmap& pThumbnail)
+        {
+            if (mThumbnailPath.isEmpty())
+            {
+                setPixmap(pThumbnail);
+                return;
+            }
+
+            // an unreadable pixmap is read again from the thumbnail file on the next paint
+            if (pThumbnail.isNull())
+                mThumbnail = QPixmap();
+            else
+                mThumbnail = pThumbnail.size() == mThumbnailSize ? pThumbnail : pThumbnail.scaled(mThumbnailSize);
+
+            update();
+        }
+
         virtual ~UBSceneThumbnailPixmap()
         {
             // NOOP
@@ -280,6 +353,10 @@ class UBSceneThumbnailPixmap : public UBThumbnailPixmap
     private:
         UBDocumentProxy* mProxy;
         int mSceneIndex;
+
+        QString mThumbnailPath;
+        QSize mThumbnailSize;
+        QPixmap mThumbnail;
 };
 
 
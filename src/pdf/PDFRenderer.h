@@ -44,6 +44,8 @@ class PDFRenderer : public QObject
 
         virtual QString title() const = 0;
 
+        virtual QString pageText(int pageNumber) = 0;
+
         void attach();
         void detach();
 
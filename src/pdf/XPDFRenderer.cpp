@@ -18,23 +18,37 @@
 #include <QtGui>
 
 #include <frameworks/UBPlatformUtils.h>
+#include <frameworks/UBTrace.h>
+
+#include <xpdf/TextOutputDev.h>
 
 #include "core/memcheck.h"
 
 QAtomicInt XPDFRenderer::sInstancesCount = 0;
 
+// globalParams is shared by all the documents, its creation and deletion are serialized; its
+// font, CMap and unicode map caches lock themselves (xpdf built MULTITHREADED). A document is
+// used by one thread at a time through mDocumentMutex, the documents render independently.
+static QMutex sGlobalParamsMutex;
+
 XPDFRenderer::XPDFRenderer(const QString &filename, bool importingFile)
     : mDocument(0)
     , mpSplashBitmap(0)
     , mSplash(0)
 {
     Q_UNUSED(importingFile);
+
+    QMutexLocker locker(&sGlobalParamsMutex);
+
     if (!globalParams)
     {
         // globalParams must be allocated once and never be deleted
         // note that this is *not* an instance variable of this XPDFRenderer class
         globalParams = new GlobalParams(0);
         globalParams->setupBaseFonts(QFile::encodeName(UBPlatformUtils::applicationResourcesDirectory() + "/" + "fonts").data());
+
+        // set once, the text extraction does not change the shared settings
+        globalParams->setTextEncoding((char*)"UTF-8");
     }
 
     mDocument = new PDFDoc(new GString(filename.toUtf8().data()), 0, 0, 0); // the filename GString is deleted on PDFDoc desctruction
@@ -45,6 +59,8 @@ XPDFRenderer::XPDFRenderer(const QString &filename, bool importingFile)
 
 XPDFRenderer::~XPDFRenderer()
 {
+    QMutexLocker locker(&sGlobalParamsMutex);
+
     if(mSplash){
         delete mSplash;
         mSplash = NULL;
@@ -77,6 +93,8 @@ bool XPDFRenderer::isValid() const
 
 int XPDFRenderer::pageCount() const
 {
+    QMutexLocker locker(&mDocumentMutex);
+
     if (isValid())
         return mDocument->getNumPages();
     else
@@ -85,6 +103,8 @@ int XPDFRenderer::pageCount() const
 
 QString XPDFRenderer::title() const
 {
+    QMutexLocker locker(&mDocumentMutex);
+
     if (isValid())
     {
         Object pdfInfo;
@@ -105,11 +125,39 @@ QString XPDFRenderer::title() const
 }
 
 
+static void appendText(void *stream, char *text, int length)
+{
+    static_cast<QByteArray*>(stream)->append(text, length);
+}
+
+
+QString XPDFRenderer::pageText(int pageNumber)
+{
+    QByteArray text;
+
+    QMutexLocker locker(&mDocumentMutex);
+
+    if (isValid())
+    {
+        UB_TRACE_SCOPE("pdf.text", "pdf");
+
+        TextOutputDev textOutput(appendText, &text, gFalse, gFalse);
+
+        if (textOutput.isOk())
+            mDocument->displayPage(&textOutput, pageNumber, 72, 72, 0, gFalse, gTrue, gFalse);
+    }
+
+    return QString::fromUtf8(text);
+}
+
+
 QSizeF XPDFRenderer::pageSizeF(int pageNumber) const
 {
     qreal cropWidth = 0;
     qreal cropHeight = 0;
 
+    QMutexLocker locker(&mDocumentMutex);
+
     if (isValid())
     {
         int rotate = mDocument->getPageRotate(pageNumber);
@@ -130,6 +178,8 @@ QSizeF XPDFRenderer::pageSizeF(int pageNumber) const
 
 int XPDFRenderer::pageRotation(int pageNumber) const
 {
+    QMutexLocker locker(&mDocumentMutex);
+
     if (mDocument)
         return  mDocument->getPageRotate(pageNumber);
     else
@@ -138,6 +188,11 @@ int XPDFRenderer::pageRotation(int pageNumber) const
 
 void XPDFRenderer::render(QPainter *p, int pageNumber, const QRectF &bounds)
 {
+    UB_TRACE_SCOPE("pdf.render", "pdf");
+
+    // the image drawn is the bitmap of mSplash, it is kept locked until drawn
+    QMutexLocker locker(&mDocumentMutex);
+
     if (isValid())
     {
         qreal xscale = p->worldTransform().m11();
@@ -160,6 +215,7 @@ void XPDFRenderer::render(QPainter *p, int pageNumber, const QRectF &bounds)
     }
 }
 
+// called by render() with mDocumentMutex locked
 QImage* XPDFRenderer::createPDFImage(int pageNumber, const qreal xscale, const qreal yscale, const QRectF &bounds)
 {
     QImage* img = new QImage();
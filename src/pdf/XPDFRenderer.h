@@ -16,6 +16,7 @@
 #ifndef XPDFRENDERER_H
 #define XPDFRENDERER_H
 #include <QImage>
+#include <QMutex>
 #include "PDFRenderer.h"
 #include <splash/SplashBitmap.h>
 #include <xpdf/Object.h>
@@ -43,6 +44,8 @@ class XPDFRenderer : public PDFRenderer
 
         virtual QString title() const;
 
+        virtual QString pageText(int pageNumber);
+
     public slots:
         void render(QPainter *p, int pageNumber, const QRectF &bounds = QRectF());
 
@@ -51,6 +54,7 @@ class XPDFRenderer : public PDFRenderer
         QImage* createPDFImage(int pageNumber, const qreal xscale = 0.5, const qreal yscale = 0.5, const QRectF &bounds = QRectF());
 
         PDFDoc *mDocument;
+        mutable QMutex mDocumentMutex; // the board and the search index share the renderers
         static QAtomicInt sInstancesCount;
         qreal mSliceX;
         qreal mSliceY;
@@ -19,6 +19,7 @@
 #include "frameworks/UBFileSystemUtils.h"
 #include "frameworks/UBStringUtils.h"
 #include "frameworks/UBPlatformUtils.h"
+#include "frameworks/UBTrace.h"
 
 #include "core/UBApplication.h"
 #include "core/UBSettings.h"
@@ -37,6 +38,7 @@
 #include "domain/UBGraphicsScene.h"
 
 #include "UBAbstractVideoEncoder.h"
+#include "UBPodcastFrameWorker.h"
 
 #include "podcast/youtube/UBYouTubePublisher.h"
 #include "podcast/intranet/UBIntranetPodcastPublisher.h"
@@ -69,6 +71,7 @@ UBPodcastController::UBPodcastController(QObject* pParent)
     , mVideoBitsPerSecondAtStart(1700000)
     , mSourceWidget(0)
     , mSourceScene(0)
+    , mFrameWorker(0)
     , mScreenGrabingTimerEventID(0)
     , mRecordingProgressTimerEventID(0)
     , mRecordingPalette(0)
@@ -95,6 +98,10 @@ UBPodcastController::UBPodcastController(QObject* pParent)
     connect(UBApplication::app(), SIGNAL(lastWindowClosed()),
             this, SLOT(applicationAboutToQuit()));
 
+    mFrameWorker = new UBPodcastFrameWorker(this);
+
+    connect(mFrameWorker, SIGNAL(frameReady(const QImage&, long)),
+            this, SLOT(processGrabbedFrame(const QImage&, long)), Qt::QueuedConnection);
 }
 
 
@@ -430,6 +437,8 @@ void UBPodcastController::stop()
         if (mRecordingProgressTimerEventID != 0)
             killTimer(mRecordingProgressTimerEventID);
 
+        mFrameWorker->stop();
+
         sendLatestPixmapToEncoder();
 
         setRecordingState(Stopping);
@@ -445,9 +454,11 @@ bool UBPodcastController::eventFilter(QObject *obj, QEvent *event)
     {
         QPaintEvent *paintEvent = static_cast<QPaintEvent*>(event);
 
-        mWidgetRepaintRectQueue.enqueue(paintEvent->rect());
+        bool shouldRepaint = mWidgetDirtyRegion.isEmpty();
 
-        if (mWidgetRepaintRectQueue.length() == 1)
+        mWidgetDirtyRegion += paintEvent->region();
+
+        if (shouldRepaint)
             QTimer::singleShot(1000.0 / mVideoFramesPerSecondAtStart, this, SLOT(processWidgetPaintEvent()));
      }
 
@@ -460,12 +471,11 @@ void UBPodcastController::processWidgetPaintEvent()
     if(mRecordingState != Recording)
         return;
 
-    QRect repaintRect;
+    QRegion repaintRegion;
 
     if (!mInitialized)
     {
-        mWidgetRepaintRectQueue.clear();
-        repaintRect = mSourceWidget->geometry();
+        repaintRegion = QRegion(mSourceWidget->geometry());
 
         mLatestCapture.fill(sBackgroundColor);
 
@@ -473,14 +483,15 @@ void UBPodcastController::processWidgetPaintEvent()
     }
     else
     {
-        while(mWidgetRepaintRectQueue.size() > 0)
-        {
-            repaintRect = repaintRect.unite(mWidgetRepaintRectQueue.dequeue());
-        }
+        repaintRegion = mWidgetDirtyRegion;
     }
 
-    if (!repaintRect.isNull())
+    mWidgetDirtyRegion = QRegion();
+
+    if (!repaintRegion.isEmpty())
     {
+        UB_TRACE_SCOPE("podcast.captureWidget", "podcast");
+
         mIsGrabbing = true;
 
         QPainter p(&mLatestCapture);
@@ -488,7 +499,8 @@ void UBPodcastController::processWidgetPaintEvent()
         p.setRenderHints(QPainter::Antialiasing);
         p.setRenderHints(QPainter::SmoothPixmapTransform);
 
-        mSourceWidget->render(&p, repaintRect.topLeft(), QRegion(repaintRect), QWidget::DrawChildren);
+        // only the dirty rectangles are rendered, not their bounding rectangle
+        mSourceWidget->render(&p, repaintRegion.boundingRect().topLeft(), repaintRegion, QWidget::DrawChildren);
 
         mIsGrabbing = false;
 
@@ -514,13 +526,6 @@ void UBPodcastController::activeSceneChanged()
 
     startNextChapter();
 
-    UBBoardView *bv = qobject_cast<UBBoardView*>(mSourceWidget);
-    if (bv)
-    {
-        QRectF viewportRect = bv->mapToScene(bv->geometry()).boundingRect();
-        mSceneRepaintRectQueue.enqueue(viewportRect);
-    }
-
     processScenePaintEvent();
 }
 
@@ -562,16 +567,19 @@ void UBPodcastController::sceneChanged(const QList<QRectF> & region)
     if(mRecordingState != Recording)
         return;
 
-    bool shouldRepaint = (mSceneRepaintRectQueue.length() == 0);
+    bool shouldRepaint = mSceneDirtyRegion.isEmpty();
 
     UBBoardView *bv = qobject_cast<UBBoardView *>(mSourceWidget);
     if (bv)
     {
-        QRectF viewportRect = bv->mapToScene(QRect(0, 0, bv->width(), bv->height())).boundingRect();
+        QTransform sceneToVideo = bv->viewportTransform() * mViewToVideoTransform;
+        QRect frameRect = mLatestCapture.rect();
+
         foreach(const QRectF rect, region)
         {
-            QRectF maxRect = rect.intersect(viewportRect);
-            mSceneRepaintRectQueue.enqueue(maxRect);
+            // 1 pixel margin for antialiasing bleeding over the item bounds
+            QRect videoRect = sceneToVideo.mapRect(rect).toAlignedRect().adjusted(-1, -1, 1, 1);
+            mSceneDirtyRegion += videoRect.intersected(frameRect);
         }
 
         if (shouldRepaint)
@@ -591,54 +599,64 @@ void UBPodcastController::processScenePaintEvent()
     if(!bv)
         return;
 
-    QRectF repaintRect;
+    QRegion repaintRegion;
 
     if (!mInitialized)
     {
-        mSceneRepaintRectQueue.clear();
-        repaintRect = bv->mapToScene(QRect(0, 0, bv->width(), bv->height())).boundingRect();
-
         if (bv->scene()->isDarkBackground())
                 mLatestCapture.fill(Qt::black);
         else
                 mLatestCapture.fill(Qt::white);
 
-        mLatestCapture.fill(Qt::white);
+        QTransform sceneToVideo = bv->viewportTransform() * mViewToVideoTransform;
+        QRectF viewportRect = bv->mapToScene(QRect(0, 0, bv->width(), bv->height())).boundingRect();
+
+        repaintRegion = QRegion(sceneToVideo.mapRect(viewportRect).toAlignedRect().intersected(mLatestCapture.rect()));
 
         mInitialized = true;
     }
     else
     {
-        while(mSceneRepaintRectQueue.size() > 0)
-        {
-            repaintRect = repaintRect.unite(mSceneRepaintRectQueue.dequeue());
-        }
+        repaintRegion = mSceneDirtyRegion;
     }
 
-    if (!repaintRect.isNull())
+    mSceneDirtyRegion = QRegion();
+
+    if (!repaintRegion.isEmpty())
     {
+        UB_TRACE_SCOPE("podcast.captureScene", "podcast");
+
         UBGraphicsScene *scene = bv->scene();
 
-        QPainter p(&mLatestCapture);
+        QVector<QRect> tiles = repaintRegion.rects();
 
-        p.setTransform(mViewToVideoTransform);
-        p.setTransform(bv->viewportTransform(), true);
+        // past a few dozen tiles the per render overhead outweighs the saved pixels
+        if (tiles.size() > 32)
+        {
+            tiles.clear();
+            tiles << repaintRegion.boundingRect();
+        }
+
+        QTransform videoToScene = (bv->viewportTransform() * mViewToVideoTransform).inverted();
+
+        QPainter p(&mLatestCapture);
 
         p.setRenderHints(QPainter::Antialiasing);
         p.setRenderHints(QPainter::SmoothPixmapTransform);
 
-        repaintRect.adjust(-1, -1, 1, 1);
-
-        p.setClipRect(repaintRect);
+        scene->setRenderingContext(UBGraphicsScene::Podcast);
 
-        if (scene->isDarkBackground())
-            p.fillRect(repaintRect, Qt::black);
-        else
-            p.fillRect(repaintRect, Qt::white);
+        foreach(const QRect& tile, tiles)
+        {
+            p.setClipRect(tile);
 
-        scene->setRenderingContext(UBGraphicsScene::Podcast);
+            if (scene->isDarkBackground())
+                p.fillRect(tile, Qt::black);
+            else
+                p.fillRect(tile, Qt::white);
 
-        scene->render(&p, repaintRect, repaintRect);
+            scene->render(&p, tile, videoToScene.mapRect(QRectF(tile)), Qt::IgnoreAspectRatio);
+        }
 
         scene->setRenderingContext(UBGraphicsScene::Screen);
 
@@ -743,6 +761,19 @@ void UBPodcastController::sendLatestPixmapToEncoder()
         mVideoEncoder->newPixmap(mLatestCapture, elapsedRecordingMs());
 }
 
+
+void UBPodcastController::processGrabbedFrame(const QImage& pFrame, long pTimestamp)
+{
+    // frames scaled after stop or pause are stale
+    if (mRecordingState != Recording || mSourceWidget != qApp->desktop())
+        return;
+
+    mLatestCapture = pFrame;
+
+    if (mVideoEncoder)
+        mVideoEncoder->newPixmap(mLatestCapture, pTimestamp);
+}
+
 void UBPodcastController::timerEvent(QTimerEvent *event)
 {
     if (mRecordingState == Recording
@@ -751,23 +782,13 @@ void UBPodcastController::timerEvent(QTimerEvent *event)
     {
         QPixmap desktop = QPixmap::grabWindow(qApp->desktop()->screen(UBApplication::applicationController->displayManager()->controleScreenIndex())->winId());
 
-        {
-            QPainter p(&mLatestCapture);
+        QRectF targetRect = mViewToVideoTransform.mapRect(QRectF(0, 0, desktop.width(), desktop.height()));
 
-            if (!mInitialized)
-            {
-                mLatestCapture.fill(sBackgroundColor);
-                mInitialized = true;
-            }
-
-            QRectF targetRect = mViewToVideoTransform.mapRect(QRectF(0, 0, desktop.width(), desktop.height()));
-
-            p.setRenderHints(QPainter::Antialiasing);
-            p.setRenderHints(QPainter::SmoothPixmapTransform);
-            p.drawPixmap(targetRect.left(), targetRect.top(), desktop.scaled(targetRect.width(), targetRect.height(),  Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        }
+        // QPixmap is GUI thread only, the worker gets an image and does the scaling
+        mFrameWorker->submit(desktop.toImage(), mLatestCapture.size(), targetRect,
+                elapsedRecordingMs(), !mInitialized, sBackgroundColor);
 
-        sendLatestPixmapToEncoder();
+        mInitialized = true;
     }
 
     if (mRecordingProgressTimerEventID == event->timerId() && mRecordingState == Recording)
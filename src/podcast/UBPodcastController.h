@@ -25,6 +25,7 @@
 class UBGraphicsScene;
 class WBWebView;
 class UBPodcastRecordingPalette;
+class UBPodcastFrameWorker;
 
 
 class UBPodcastController : public QObject
@@ -83,6 +84,8 @@ class UBPodcastController : public QObject
 
         void processScenePaintEvent();
 
+        void processGrabbedFrame(const QImage& pFrame, long pTimestamp);
+
         void sceneChanged(const QList<QRectF> & region);
         void sceneBackgroundChanged();
 
@@ -121,8 +124,9 @@ class UBPodcastController : public QObject
 
         bool mIsGrabbing;
 
-        QQueue<QRect> mWidgetRepaintRectQueue;
-        QQueue<QRectF> mSceneRepaintRectQueue;
+        // dirty areas since the last capture, in video frame coordinates for the scene
+        QRegion mWidgetDirtyRegion;
+        QRegion mSceneDirtyRegion;
 
         bool mInitialized;
 
@@ -140,6 +144,8 @@ class UBPodcastController : public QObject
 
         QTransform mViewToVideoTransform;
 
+        UBPodcastFrameWorker* mFrameWorker;
+
         int mScreenGrabingTimerEventID;
         int mRecordingProgressTimerEventID;
 
@@ -0,0 +1,138 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBPodcastFrameWorker.h"
+
+#include "frameworks/UBTrace.h"
+
+#include "core/memcheck.h"
+
+UBPodcastFrameWorker::UBPodcastFrameWorker(QObject * pParent)
+    : QThread(pParent)
+    , mHasPendingGrab(false)
+    , mStopRequested(false)
+    , mPendingTimestamp(0)
+    , mPendingClearFrame(false)
+    , mPendingBackgroundColor(0)
+{
+    // NOOP
+}
+
+
+UBPodcastFrameWorker::~UBPodcastFrameWorker()
+{
+    stop();
+}
+
+
+void UBPodcastFrameWorker::submit(const QImage& pGrab, const QSize& pFrameSize, const QRectF& pTargetRect,
+        long pTimestamp, bool pClearFrame, unsigned int pBackgroundColor)
+{
+    QMutexLocker locker(&mMutex);
+
+    if (mHasPendingGrab)
+    {
+        UB_TRACE_COUNT("podcast.droppedGrabs");
+
+        // keep the clear request of the dropped grab
+        pClearFrame = pClearFrame || mPendingClearFrame;
+    }
+
+    mPendingGrab = pGrab;
+    mPendingFrameSize = pFrameSize;
+    mPendingTargetRect = pTargetRect;
+    mPendingTimestamp = pTimestamp;
+    mPendingClearFrame = pClearFrame;
+    mPendingBackgroundColor = pBackgroundColor;
+    mHasPendingGrab = true;
+
+    if (!isRunning())
+    {
+        mStopRequested = false;
+        start(QThread::LowPriority);
+    }
+
+    mGrabAvailable.wakeOne();
+}
+
+
+void UBPodcastFrameWorker::stop()
+{
+    {
+        QMutexLocker locker(&mMutex);
+
+        mStopRequested = true;
+        mHasPendingGrab = false;
+        mPendingGrab = QImage();
+
+        mGrabAvailable.wakeOne();
+    }
+
+    wait();
+}
+
+
+void UBPodcastFrameWorker::run()
+{
+    forever
+    {
+        QImage grab;
+        QSize frameSize;
+        QRectF targetRect;
+        long timestamp;
+        bool clearFrame;
+        unsigned int backgroundColor;
+
+        {
+            QMutexLocker locker(&mMutex);
+
+            while (!mHasPendingGrab && !mStopRequested)
+                mGrabAvailable.wait(&mMutex);
+
+            if (mStopRequested)
+                break;
+
+            grab = mPendingGrab;
+            frameSize = mPendingFrameSize;
+            targetRect = mPendingTargetRect;
+            timestamp = mPendingTimestamp;
+            clearFrame = mPendingClearFrame;
+            backgroundColor = mPendingBackgroundColor;
+
+            mPendingGrab = QImage();
+            mHasPendingGrab = false;
+        }
+
+        UB_TRACE_SCOPE("podcast.scaleGrab", "podcast");
+
+        if (clearFrame || mFrame.size() != frameSize)
+        {
+            mFrame = QImage(frameSize, QImage::Format_RGB32); //0xffRRGGBB
+            mFrame.fill(backgroundColor);
+        }
+
+        // scaled and converted straight to the encoder format, drawImage then is a plain copy
+        QImage scaled = grab.scaled(targetRect.size().toSize(), Qt::KeepAspectRatio, Qt::SmoothTransformation)
+                .convertToFormat(QImage::Format_RGB32);
+
+        {
+            QPainter p(&mFrame);
+            p.drawImage(targetRect.topLeft(), scaled);
+        }
+
+        // the GUI thread gets a shared copy, painting the next grab detaches it here
+        emit frameReady(mFrame, timestamp);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBPODCASTFRAMEWORKER_H_
+#define UBPODCASTFRAMEWORKER_H_
+
+#include <QtGui>
+
+/**
+ * Scales and converts screen grabs to video frames off the GUI thread.
+ *
+ * Only the latest submitted grab is kept: if the worker is still busy when a new
+ * grab arrives, the previous one is dropped rather than queued, so a slow machine
+ * records at a lower frame rate instead of lagging behind.
+ */
+class UBPodcastFrameWorker : public QThread
+{
+    Q_OBJECT;
+
+    public:
+        UBPodcastFrameWorker(QObject * pParent = 0);
+        virtual ~UBPodcastFrameWorker();
+
+        // pTargetRect is the area of the video frame the grab is scaled into
+        void submit(const QImage& pGrab, const QSize& pFrameSize, const QRectF& pTargetRect,
+                long pTimestamp, bool pClearFrame, unsigned int pBackgroundColor);
+
+        void stop();
+
+    signals:
+        void frameReady(const QImage& pFrame, long pTimestamp);
+
+    protected:
+        void run();
+
+    private:
+        QMutex mMutex;
+        QWaitCondition mGrabAvailable;
+
+        bool mHasPendingGrab;
+        bool mStopRequested;
+
+        QImage mPendingGrab;
+        QSize mPendingFrameSize;
+        QRectF mPendingTargetRect;
+        long mPendingTimestamp;
+        bool mPendingClearFrame;
+        unsigned int mPendingBackgroundColor;
+
+        QImage mFrame; // only touched by the worker thread
+};
+
+#endif /* UBPODCASTFRAMEWORKER_H_ */
@@ -13,6 +13,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <QDebug>
+#include <qmath.h>
 
 #include "UBGraphicsCache.h"
 
@@ -115,20 +116,48 @@ void UBGraphicsCache::mousePressEvent(QGraphicsSceneMouseEvent *event)
     Q_UNUSED(event);
     mShapePos = event->pos();
     mDrawMask = true;
-    update();
+    update(maskRect());
 }
 
 void UBGraphicsCache::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
 {
+    // the cache covers the whole board, only the hole moves
+    update(maskRect());
     mShapePos = event->pos();
-    update();
+    update(maskRect());
 }
 
 void UBGraphicsCache::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
 {
     Q_UNUSED(event);
     mDrawMask = false;
-    update();
+    update(maskRect());
+}
+
+QRectF UBGraphicsCache::maskRect() const
+{
+    QRectF shapeRect(mShapePos.x(), mShapePos.y(), mShapeWidth, mShapeWidth);
+
+    if(eMaskShape_Circle == mMaskShape)
+    {
+        shapeRect = QRectF(mShapePos.x() - mShapeWidth, mShapePos.y() - mShapeWidth, 2 * mShapeWidth, 2 * mShapeWidth);
+    }
+
+    // the antialiased edge of the cosmetic outline spills over the shape, a couple of device pixels in the most zoomed out view
+    qreal margin = 0;
+
+    if (scene())
+    {
+        foreach(QGraphicsView* view, scene()->views())
+        {
+            qreal viewScale = qSqrt(qAbs(deviceTransform(view->viewportTransform()).determinant()));
+
+            if (viewScale > 0)
+                margin = qMax(margin, 2 / viewScale);
+        }
+    }
+
+    return shapeRect.adjusted(-margin, -margin, margin, margin);
 }
 
 int UBGraphicsCache::shapeWidth()
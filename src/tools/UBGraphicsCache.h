@@ -50,6 +50,7 @@ protected:
 
 private:
     void init();
+    QRectF maskRect() const;
 
     QColor mMaskColor;
     eMaskShape mMaskShape;
@@ -49,6 +49,7 @@ UBGraphicsCompass::UBGraphicsCompass()
     , mResizeSvgItem(0)
     , mAntiScaleRatio(1.0)
     , mDrewCenterCross(false)
+    , mShapePenWidthIndex(-1)
 {
     setRect(sDefaultRect);
     setFlag(QGraphicsItem::ItemIsMovable, true);
@@ -95,9 +96,6 @@ UBItem* UBGraphicsCompass::deepCopy() const
 
 void UBGraphicsCompass::paint(QPainter *painter, const QStyleOptionGraphicsItem *styleOption, QWidget *widget)
 {
-    Q_UNUSED(styleOption);
-    Q_UNUSED(widget);
-
     mAntiScaleRatio = 1 / (UBApplication::boardController->systemScaleFactor() * UBApplication::boardController->currentZoom());
     QTransform antiScaleTransform;
     antiScaleTransform.scale(mAntiScaleRatio, mAntiScaleRatio);
@@ -112,6 +110,25 @@ void UBGraphicsCompass::paint(QPainter *painter, const QStyleOptionGraphicsItem
         resizeButtonRect().center().x() - mResizeSvgItem->boundingRect().width() * mAntiScaleRatio / 2,
         resizeButtonRect().center().y() - mResizeSvgItem->boundingRect().height() * mAntiScaleRatio / 2);
 
+    // the compass turns with its item transform while drawing, the raster follows it
+    if (!mBodyCache.paint(painter, styleOption, widget, boundingRect(),
+            QVariantList() << rect() << scene()->isDarkBackground() << pencilColor() << UBSettings::settings()->penWidthIndex(), this, &UBGraphicsCompass::paintBody))
+    {
+        paintBody(painter);
+    }
+
+    painter->setPen(drawColor());
+
+    if (mShowButtons)
+        paintAngleDisplay(painter);
+
+    if (mResizing || mRotating || mDrawing || (mShowButtons && rect().width() > sDisplayRadiusOnPencilArmMinLength))
+        paintRadiusDisplay(painter);
+}
+
+
+void UBGraphicsCompass::paintBody(QPainter *painter)
+{
     painter->setPen(drawColor());
     painter->drawRoundedRect(hingeRect(), 4, 4);
     painter->fillPath(hingeShape(), middleFillColor());
@@ -131,8 +148,6 @@ void UBGraphicsCompass::paint(QPainter *painter, const QStyleOptionGraphicsItem
 
     QRectF hingeGripRect(rect().center().x() - 16, rect().center().y() - 16, 32, 32);
     painter->drawEllipse(hingeGripRect);
-    if (mShowButtons)
-        paintAngleDisplay(painter);
 
     QLinearGradient pencilArmLinearGradient(
         QPointF(hingeRect().right(), rect().center().y()),
@@ -142,16 +157,10 @@ void UBGraphicsCompass::paint(QPainter *painter, const QStyleOptionGraphicsItem
     painter->fillPath(pencilArmShape(), pencilArmLinearGradient);
     painter->drawPath(pencilArmShape());
 
-    if (scene()->isDarkBackground())
-        painter->fillPath(pencilShape(), UBApplication::boardController->penColorOnDarkBackground());
-    else
-        painter->fillPath(pencilShape(), UBApplication::boardController->penColorOnLightBackground());
+    painter->fillPath(pencilShape(), pencilColor());
 
     painter->fillPath(pencilBaseShape(), middleFillColor());
     painter->drawPath(pencilBaseShape());
-
-    if (mResizing || mRotating || mDrawing || (mShowButtons && rect().width() > sDisplayRadiusOnPencilArmMinLength))
-        paintRadiusDisplay(painter);
 }
 
 
@@ -557,14 +566,25 @@ QPointF UBGraphicsCompass::pencilPosition() const
 
 QPainterPath UBGraphicsCompass::shape() const
 {
-    QPainterPath path = needleShape();
-    path = path.united(needleBaseShape());
-    path = path.united(needleArmShape());
-    path.addRect(hingeRect());
-    path = path.united(pencilArmShape());
-    path = path.united(pencilBaseShape());
-    path = path.united(pencilShape());
-    return path;
+    // every hover and click hit-tests the shape, the united paths only change with the rect and the pencil width
+    int penWidthIndex = UBSettings::settings()->penWidthIndex();
+
+    if (mShape.isEmpty() || mShapeRect != rect() || mShapePenWidthIndex != penWidthIndex)
+    {
+        QPainterPath path = needleShape();
+        path = path.united(needleBaseShape());
+        path = path.united(needleArmShape());
+        path.addRect(hingeRect());
+        path = path.united(pencilArmShape());
+        path = path.united(pencilBaseShape());
+        path = path.united(pencilShape());
+
+        mShape = path;
+        mShapeRect = rect();
+        mShapePenWidthIndex = penWidthIndex;
+    }
+
+    return mShape;
 }
 
 QPainterPath UBGraphicsCompass::needleShape() const
@@ -715,6 +735,14 @@ QColor UBGraphicsCompass::drawColor() const
     return scene()->isDarkBackground() ? sDarkBackgroundDrawColor : sLightBackgroundDrawColor;
 }
 
+QColor UBGraphicsCompass::pencilColor() const
+{
+    if (scene()->isDarkBackground())
+        return UBApplication::boardController->penColorOnDarkBackground();
+    else
+        return UBApplication::boardController->penColorOnLightBackground();
+}
+
 QColor UBGraphicsCompass::middleFillColor() const
 {
     return scene()->isDarkBackground() ? sDarkBackgroundMiddleFillColor : sLightBackgroundMiddleFillColor;
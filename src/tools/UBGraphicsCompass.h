@@ -21,6 +21,7 @@
 
 #include "core/UB.h"
 #include "domain/UBItem.h"
+#include "tools/UBToolBodyCache.h"
 
 class UBGraphicsScene;
 
@@ -63,6 +64,7 @@ class UBGraphicsCompass: public QObject, public QGraphicsRectItem, public UBItem
 
     private:
         // Helpers
+        void                    paintBody(QPainter *painter);
         void            paintAngleDisplay(QPainter *painter);
         void           paintRadiusDisplay(QPainter *painter);
         void           rotateAroundNeedle(qreal angle);
@@ -93,6 +95,7 @@ class UBGraphicsCompass: public QObject, public QGraphicsRectItem, public UBItem
         QColor                  drawColor() const;
         QColor            middleFillColor() const;
         QColor              edgeFillColor() const;
+        QColor                pencilColor() const;
         QFont                        font() const;
         qreal              angleInDegrees() const;
 
@@ -111,6 +114,10 @@ class UBGraphicsCompass: public QObject, public QGraphicsRectItem, public UBItem
         QGraphicsSvgItem* mResizeSvgItem;
         qreal mAntiScaleRatio;
         bool mDrewCenterCross;
+        UBToolBodyCache mBodyCache;
+        mutable QPainterPath mShape;
+        mutable QRectF mShapeRect;
+        mutable int mShapePenWidthIndex;
 
         // Constants
         static const QRect                     sDefaultRect;
@@ -37,13 +37,13 @@ UBGraphicsProtractor::UBGraphicsProtractor()
         , mResetSvgItem(0)
         , mResizeSvgItem(0)
         , mMarkerSvgItem(0)
+        , mShapeStartAngle(0)
+        , mShapeAntiScale(0)
 {
     sFillTransparency = 127;
     sDrawTransparency = 192;
     create(*this);
 
-    setCacheMode(QGraphicsItem::DeviceCoordinateCache);
-
     setStartAngle(0);
     setSpanAngle(180 * 16);
 
@@ -72,15 +72,26 @@ void UBGraphicsProtractor::paint(QPainter *painter, const QStyleOptionGraphicsIt
 {
     painter->save();
 
-    Q_UNUSED(styleOption);
-    Q_UNUSED(widget);
+    // the body is drawn from a start angle of 0 and turned around the center, a rotation reuses
+    // its raster; the graduation labels stay upright and are drawn over it
+    QPointF center = rect().center();
+
+    painter->save();
+    painter->translate(center);
+    painter->rotate(-mStartAngle);
+    painter->translate(-center);
+
+    if (!mBodyCache.paint(painter, styleOption, widget, QGraphicsEllipseItem::boundingRect(),
+            QVariantList() << rect() << mSpan << scene()->isDarkBackground(), this, &UBGraphicsProtractor::paintBody))
+    {
+        paintBody(painter);
+    }
+
+    painter->restore();
 
     painter->setFont(QFont("Arial"));
     painter->setPen(drawColor());
-    painter->setBrush(fillBrush());
-    painter->drawPie(QRectF(rect().center().x() - radius(), rect().center().y() - radius(),
-                            2 * radius(), 2 * radius()), mStartAngle * 16, mSpan * 16);
-    paintGraduations(painter);
+    paintGraduationLabels(painter);
     paintButtons(painter);
     paintAngleMarker(painter);
 
@@ -88,6 +99,17 @@ void UBGraphicsProtractor::paint(QPainter *painter, const QStyleOptionGraphicsIt
 }
 
 
+void UBGraphicsProtractor::paintBody(QPainter *painter)
+{
+    painter->setFont(QFont("Arial"));
+    painter->setPen(drawColor());
+    painter->setBrush(fillBrush());
+    painter->drawPie(QRectF(rect().center().x() - radius(), rect().center().y() - radius(),
+                            2 * radius(), 2 * radius()), 0, mSpan * 16);
+    paintGraduations(painter);
+}
+
+
 QVariant UBGraphicsProtractor::itemChange(GraphicsItemChange change, const QVariant &value)
 {
     if (change == QGraphicsItem::ItemSceneChange)
@@ -127,6 +149,12 @@ QRectF UBGraphicsProtractor::boundingRect() const
 
 QPainterPath UBGraphicsProtractor::shape() const
 {
+    // hit-tested on every hover, the subtraction only changes with the geometry and the zoom
+    qreal antiSc = antiScale();
+
+    if (!mShape.isEmpty() && mShapeRect == rect() && mShapeStartAngle == mStartAngle && mShapeAntiScale == antiSc)
+        return mShape;
+
     QPainterPath path = QGraphicsEllipseItem::shape();
     QPainterPath buttonPath;
     QRectF markerRect = markerButtonRect();
@@ -152,6 +180,11 @@ QPainterPath UBGraphicsProtractor::shape() const
     buttonPath = buttonPath.subtracted(path);
     path.addPath(buttonPath);
 
+    mShape = path;
+    mShapeRect = rect();
+    mShapeStartAngle = mStartAngle;
+    mShapeAntiScale = antiSc;
+
     return path;
 }
 
@@ -357,13 +390,46 @@ QRectF UBGraphicsProtractor::resizeButtonRect () const
 }
 
 
+static const int  tenDegreeGraduationLength = 15;
+static const int fiveDegreeGraduationLength = 10;
+static const int  oneDegreeGraduationLength = 5;
+
+
+// drawn from a start angle of 0, the body is turned by the caller
 void UBGraphicsProtractor::paintGraduations(QPainter *painter)
 {
     painter->save();
 
-    const int  tenDegreeGraduationLength = 15;
-    const int fiveDegreeGraduationLength = 10;
-    const int  oneDegreeGraduationLength = 5;
+    qreal rad = radius();
+
+    QPointF center = rect().center();
+    painter->drawArc(QRectF(center.x() - rad/2, center.y() - rad/2, rad, rad), 0, mSpan*16);
+
+    for (int angle = 1; angle < mSpan; angle++)
+    {
+        int graduationLength = (0 == angle % 10) ? tenDegreeGraduationLength : ((0 == angle % 5) ? fiveDegreeGraduationLength : oneDegreeGraduationLength);
+        qreal co = cos((qreal)angle * PI/180);
+        qreal si = sin((qreal)angle * PI/180);
+        if (0 == angle % 90)
+            painter->drawLine(QLineF(QPointF(center.x(), center.y()), QPointF(center.x() + co*tenDegreeGraduationLength, center.y() - si*tenDegreeGraduationLength)));
+
+        //external arc
+        painter->drawLine(QLineF(QPointF(center.x()+ rad*co, center.y() - rad*si),
+                                 QPointF(center.x()+ (rad - graduationLength)*co, center.y() - (rad - graduationLength)*si)));
+        //internal arc
+        painter->drawLine(QLineF(QPointF(center.x()+ rad/2*co, center.y() - rad/2*si),
+                                 QPointF(center.x()+ (rad/2 + graduationLength)*co,
+                                         center.y() - (rad/2 + graduationLength)*si)));
+    }
+
+    painter->restore();
+}
+
+
+// the labels stay upright, they are placed along the turned graduations
+void UBGraphicsProtractor::paintGraduationLabels(QPainter *painter)
+{
+    painter->save();
 
     QFont font1 = painter->font();
 #ifdef Q_WS_MAC
@@ -379,43 +445,27 @@ void UBGraphicsProtractor::paintGraduations(QPainter *painter)
     qreal rad = radius();
 
     QPointF center = rect().center();
-    painter->drawArc(QRectF(center.x() - rad/2, center.y() - rad/2, rad, rad), mStartAngle*16, mSpan*16);
 
-    for (int angle = 1; angle < mSpan; angle++)
+    for (int angle = 10; angle < mSpan; angle += 10)
     {
-        int graduationLength = (0 == angle % 10) ? tenDegreeGraduationLength : ((0 == angle % 5) ? fiveDegreeGraduationLength : oneDegreeGraduationLength);
+        int graduationLength = tenDegreeGraduationLength;
         qreal co = cos(((qreal)angle + mStartAngle) * PI/180);
         qreal si = sin(((qreal)angle + mStartAngle) * PI/180);
-        if (0 == angle % 90)
-            painter->drawLine(QLineF(QPointF(center.x(), center.y()), QPointF(center.x() + co*tenDegreeGraduationLength, center.y() - si*tenDegreeGraduationLength)));
 
         //external arc
-        painter->drawLine(QLineF(QPointF(center.x()+ rad*co, center.y() - rad*si),
-                                 QPointF(center.x()+ (rad - graduationLength)*co, center.y() - (rad - graduationLength)*si)));
-        //internal arc
-        painter->drawLine(QLineF(QPointF(center.x()+ rad/2*co, center.y() - rad/2*si),
-                                 QPointF(center.x()+ (rad/2 + graduationLength)*co,
-                                         center.y() - (rad/2 + graduationLength)*si)));
+        painter->setFont(font1);
+        QString grad = QString("%1").arg((int)(angle));
+        QString grad2 = QString("%1").arg((int)(mSpan - angle));
+
+        painter->drawText(QRectF(center.x() + (rad - graduationLength*1.5)*co  - fm1.width(grad)/2,
+                                 center.y() - (rad - graduationLength*1.5)*si - fm1.height()/2,
+                                 fm1.width(grad), fm1.height()), Qt::AlignTop, grad);
 
-        if (0 == angle % 10)
-        {
-            //external arc
-            painter->setFont(font1);
-            QString grad = QString("%1").arg((int)(angle));
-            QString grad2 = QString("%1").arg((int)(mSpan - angle));
-
-            painter->drawText(QRectF(center.x() + (rad - graduationLength*1.5)*co  - fm1.width(grad)/2,
-                                     center.y() - (rad - graduationLength*1.5)*si - fm1.height()/2,
-                                     fm1.width(grad), fm1.height()), Qt::AlignTop, grad);
-
-            //internal arc
-            painter->setFont(font2);
-            painter->drawText(QRectF(center.x() + (rad/2 + graduationLength*1.5)*co  - fm2.width(grad2)/2,
-                                     center.y() - (rad/2 + graduationLength*1.5)*si - fm2.height()/2,
-                                     fm2.width(grad2), fm2.height()), Qt::AlignTop, grad2);
-            painter->setFont(font1);
-
-        }
+        //internal arc
+        painter->setFont(font2);
+        painter->drawText(QRectF(center.x() + (rad/2 + graduationLength*1.5)*co  - fm2.width(grad2)/2,
+                                 center.y() - (rad/2 + graduationLength*1.5)*si - fm2.height()/2,
+                                 fm2.width(grad2), fm2.height()), Qt::AlignTop, grad2);
     }
 
     painter->restore();
@@ -21,6 +21,7 @@
 
 #include "core/UB.h"
 #include "tools/UBAbstractDrawRuler.h"
+#include "tools/UBToolBodyCache.h"
 #include "domain/UBItem.h"
 
 class UBGraphicsScene;
@@ -64,7 +65,9 @@ class UBGraphicsProtractor : public UBAbstractDrawRuler, public QGraphicsEllipse
 
     private:
         // Helpers
+        void paintBody (QPainter *painter);
         void paintGraduations (QPainter *painter);
+        void paintGraduationLabels (QPainter *painter);
         void paintButtons (QPainter *painter);
         void paintAngleMarker (QPainter *painter);
         Tool toolFromPos (QPointF pos);
@@ -95,6 +98,12 @@ class UBGraphicsProtractor : public UBAbstractDrawRuler, public QGraphicsEllipse
         QGraphicsSvgItem* mMarkerSvgItem;
 		QGraphicsSvgItem* mRotateSvgItem;
 
+        UBToolBodyCache mBodyCache;
+        mutable QPainterPath mShape;
+        mutable QRectF mShapeRect;
+        mutable qreal mShapeStartAngle;
+        mutable qreal mShapeAntiScale;
+
         static const QRectF sDefaultRect;
 
         virtual void rotateAroundCenter(qreal angle);
@@ -84,9 +84,6 @@ UBItem* UBGraphicsRuler::deepCopy() const
 
 void UBGraphicsRuler::paint(QPainter *painter, const QStyleOptionGraphicsItem *styleOption, QWidget *widget)
 {
-    Q_UNUSED(styleOption);
-    Q_UNUSED(widget);
-
 	UBAbstractDrawRuler::paint();
 
 	QTransform antiScaleTransform2;
@@ -101,12 +98,26 @@ void UBGraphicsRuler::paint(QPainter *painter, const QStyleOptionGraphicsItem *s
 
 
 
+    if (!mBodyCache.paint(painter, styleOption, widget, boundingRect(),
+            QVariantList() << rect() << scene()->isDarkBackground(), this, &UBGraphicsRuler::paintBody))
+    {
+        paintBody(painter);
+    }
+
+    if (mRotating)
+    {
+        painter->setPen(drawColor());
+        paintRotationCenter(painter);
+    }
+}
+
+
+void UBGraphicsRuler::paintBody(QPainter *painter)
+{
     painter->setPen(drawColor());
     painter->drawRoundedRect(rect(), sRoundingRadius, sRoundingRadius);
     fillBackground(painter);
     paintGraduations(painter);
-    if (mRotating)
-        paintRotationCenter(painter);
 }
 
 
@@ -22,6 +22,7 @@
 #include "core/UB.h"
 #include "domain/UBItem.h"
 #include "tools/UBAbstractDrawRuler.h"
+#include "tools/UBToolBodyCache.h"
 
 class UBGraphicsScene;
 
@@ -66,6 +67,7 @@ class UBGraphicsRuler : public UBAbstractDrawRuler, public QGraphicsRectItem, pu
 
 
         // Helpers
+        void    paintBody(QPainter *painter);
         void    fillBackground(QPainter *painter);
         void    paintGraduations(QPainter *painter);
         void    paintRotationCenter(QPainter *painter);
@@ -85,6 +87,8 @@ class UBGraphicsRuler : public UBAbstractDrawRuler, public QGraphicsRectItem, pu
 
 		QCursor mResizeCursor;
 
+        UBToolBodyCache mBodyCache;
+
 		int drawLineDirection;
 
         // Constants
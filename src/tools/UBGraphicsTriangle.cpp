@@ -200,9 +200,42 @@ void UBGraphicsTriangle::calculatePoints(const QRectF& r)
     }
 }
 
-void UBGraphicsTriangle::paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *)
+void UBGraphicsTriangle::paint(QPainter *painter, const QStyleOptionGraphicsItem *styleOption, QWidget *widget)
 {
+    if (!mBodyCache.paint(painter, styleOption, widget, boundingRect(),
+            QVariantList() << rect() << (int)mOrientation << scene()->isDarkBackground(), this, &UBGraphicsTriangle::paintBody))
+    {
+        paintBody(painter);
+    }
+
+    mAntiScaleRatio = 1 / (UBApplication::boardController->systemScaleFactor() * UBApplication::boardController->currentZoom());
+    QTransform antiScaleTransform;
+    antiScaleTransform.scale(mAntiScaleRatio, mAntiScaleRatio);
+
+    mCloseSvgItem->setTransform(antiScaleTransform);
+    mHFlipSvgItem->setTransform(antiScaleTransform);
+    mVFlipSvgItem->setTransform(antiScaleTransform);
+    mRotateSvgItem->setTransform(antiScaleTransform);
+
+    mCloseSvgItem->setPos(closeButtonRect().topLeft());
+    mHFlipSvgItem->setPos(hFlipRect().topLeft());
+    mVFlipSvgItem->setPos(vFlipRect().topLeft());
+    mRotateSvgItem->setPos(rotateRect().topLeft());
+
+    if (mShowButtons || mResizing1 || mResizing2)
+    {
+        painter->setPen(drawColor());
+        painter->setBrush(QColor(0, 0, 0));
+        if (mShowButtons || mResizing1)
+            painter->drawPolygon(resize1Polygon());
+        if (mShowButtons || mResizing2)
+            painter->drawPolygon(resize2Polygon());
+    }
+}
 
+
+void UBGraphicsTriangle::paintBody(QPainter *painter)
+{
     painter->setPen(Qt::NoPen);
 
     QPolygonF polygon;
@@ -243,29 +276,6 @@ void UBGraphicsTriangle::paint(QPainter *painter, const QStyleOptionGraphicsItem
     painter->drawPolygon(polygon);
 
     paintGraduations(painter);
-
-    mAntiScaleRatio = 1 / (UBApplication::boardController->systemScaleFactor() * UBApplication::boardController->currentZoom());
-    QTransform antiScaleTransform;
-    antiScaleTransform.scale(mAntiScaleRatio, mAntiScaleRatio);
-
-    mCloseSvgItem->setTransform(antiScaleTransform);
-    mHFlipSvgItem->setTransform(antiScaleTransform);
-    mVFlipSvgItem->setTransform(antiScaleTransform);
-    mRotateSvgItem->setTransform(antiScaleTransform);
-
-    mCloseSvgItem->setPos(closeButtonRect().topLeft());
-    mHFlipSvgItem->setPos(hFlipRect().topLeft());
-    mVFlipSvgItem->setPos(vFlipRect().topLeft());
-    mRotateSvgItem->setPos(rotateRect().topLeft());
-
-    if (mShowButtons || mResizing1 || mResizing2)
-    {
-        painter->setBrush(QColor(0, 0, 0));
-        if (mShowButtons || mResizing1)
-            painter->drawPolygon(resize1Polygon());
-        if (mShowButtons || mResizing2)
-            painter->drawPolygon(resize2Polygon());
-    }
 }
 
 QPainterPath UBGraphicsTriangle::shape() const
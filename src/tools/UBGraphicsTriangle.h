@@ -23,6 +23,7 @@
 #include "core/UB.h"
 #include "domain/UBItem.h"
 #include "tools/UBAbstractDrawRuler.h"
+#include "tools/UBToolBodyCache.h"
 
 
 class UBGraphicsScene;
@@ -140,8 +141,10 @@ class UBGraphicsTriangle : public UBAbstractDrawRuler, public QGraphicsPolygonIt
         static const QRect sDefaultRect;
         static const UBGraphicsTriangleOrientation sDefaultOrientation;
 
+        void paintBody(QPainter *painter);
         void paintGraduations(QPainter *painter);
 
+        UBToolBodyCache mBodyCache;
 
         UBGraphicsTriangleOrientation mOrientation;
 
@@ -0,0 +1,109 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBToolBodyCache.h"
+
+#include "core/memcheck.h"
+
+// same buckets as the text items, a pan or a small zoom reuses the raster
+static const qreal cacheBucketsPerOctave = 4.0;
+
+// a tool enlarged on a strong zoom is drawn directly rather than kept as a huge pixmap
+static const int cacheMaxPixels = 2048 * 2048;
+
+// the control view, the display view and the previous zoom of one of them
+static const int cacheMaxEntries = 3;
+
+
+UBToolBodyCache::UBToolBodyCache()
+{
+    // NOOP
+}
+
+
+void UBToolBodyCache::invalidate()
+{
+    mEntries.clear();
+}
+
+
+bool UBToolBodyCache::takeEntry(qreal pScale, const QRectF& pBounds, const QVariantList& pKey)
+{
+    for (int i = 0; i < mEntries.size(); i++)
+    {
+        const Entry& entry = mEntries.at(i);
+
+        if (entry.scale == pScale && entry.bounds == pBounds && entry.key == pKey)
+        {
+            mEntries.move(i, 0);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void UBToolBodyCache::addEntry(const Entry& pEntry)
+{
+    // the rasters of a former geometry or background are not drawn again
+    for (int i = mEntries.size() - 1; i >= 0; i--)
+    {
+        if (mEntries.at(i).key != pEntry.key)
+            mEntries.removeAt(i);
+    }
+
+    mEntries.prepend(pEntry);
+
+    while (mEntries.size() > cacheMaxEntries)
+        mEntries.removeLast();
+}
+
+
+qreal UBToolBodyCache::cacheScale(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget,
+                                  const QRectF& pBounds, QRectF& pCacheBounds) const
+{
+    // renderings without a view (thumbnails, print, PDF export) stay vector
+    if (!widget || !option || pBounds.isEmpty())
+        return 0;
+
+    qreal levelOfDetail = option->levelOfDetailFromTransform(painter->worldTransform());
+
+    if (levelOfDetail <= 0)
+        return 0;
+
+    qreal scale = qPow(2.0, qCeil(qLn(levelOfDetail) / qLn(2.0) * cacheBucketsPerOctave) / cacheBucketsPerOctave);
+
+    // the cosmetic outline is one device pixel wide, half of it falls outside the shape
+    qreal margin = 1 / scale;
+    pCacheBounds = pBounds.adjusted(-margin, -margin, margin, margin);
+
+    QSize cacheSize = (pCacheBounds.size() * scale).toSize();
+
+    if (cacheSize.isEmpty() || cacheSize.width() * cacheSize.height() > cacheMaxPixels)
+        return 0;
+
+    return scale;
+}
+
+
+void UBToolBodyCache::drawCache(QPainter *painter) const
+{
+    bool smooth = painter->testRenderHint(QPainter::SmoothPixmapTransform);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, true);
+    const Entry& entry = mEntries.first();
+    painter->drawPixmap(entry.bounds, entry.pixmap, QRectF(QPointF(), entry.pixmap.size()));
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, smooth);
+}
@@ -0,0 +1,109 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBTOOLBODYCACHE_H_
+#define UBTOOLBODYCACHE_H_
+
+#include <QtGui>
+
+#include "frameworks/UBTrace.h"
+
+/**
+ * Raster of the static body of a drawing tool (outline, fill, graduations), rendered once per
+ * zoom bucket and key and drawn as a pixmap while the tool is moved, rotated or used.
+ *
+ * The raster is kept in item coordinates: the item transform (move, rotation) reuses it, the
+ * key holds what the body is drawn from (geometry, background). The dynamic parts (handles,
+ * angle and radius displays) are drawn over it by the tool.
+ *
+ * The last rasters used are kept, so that the control view and the display view, drawn at
+ * different zooms, do not render the body again in turn.
+ */
+class UBToolBodyCache
+{
+    public:
+        UBToolBodyCache();
+
+        // false when the body must be drawn directly, pPaintBody is only called to refresh the raster
+        template <class T>
+        bool paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget,
+                   const QRectF& pBounds, const QVariantList& pKey, T* pTool, void (T::*pPaintBody)(QPainter*))
+        {
+            QRectF bounds;
+            qreal scale = cacheScale(painter, option, widget, pBounds, bounds);
+
+            if (scale <= 0)
+                return false;
+
+            if (!takeEntry(scale, bounds, pKey))
+            {
+                UB_TRACE_SCOPE("tool.cache", "render");
+
+                Entry entry;
+                entry.pixmap = QPixmap((bounds.size() * scale).toSize());
+                entry.pixmap.fill(Qt::transparent);
+
+                QPainter cachePainter(&entry.pixmap);
+                cachePainter.setRenderHints(painter->renderHints());
+                cachePainter.scale(scale, scale);
+                cachePainter.translate(-bounds.topLeft());
+
+                (pTool->*pPaintBody)(&cachePainter);
+
+                cachePainter.end();
+
+                entry.scale = scale;
+                entry.bounds = bounds;
+                entry.key = pKey;
+
+                addEntry(entry);
+            }
+            else
+            {
+                UB_TRACE_COUNT("tool.cache.hit");
+            }
+
+            drawCache(painter);
+
+            return true;
+        }
+
+        void invalidate();
+
+    private:
+        struct Entry
+        {
+            QPixmap pixmap;
+            qreal scale;
+            QRectF bounds;
+            QVariantList key;
+        };
+
+        // 0 when not cacheable, pCacheBounds gets the bounds with a margin for the antialiased outline
+        qreal cacheScale(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget,
+                         const QRectF& pBounds, QRectF& pCacheBounds) const;
+
+        // moves the matching entry first, false when there is none
+        bool takeEntry(qreal pScale, const QRectF& pBounds, const QVariantList& pKey);
+
+        void addEntry(const Entry& pEntry);
+
+        // draws the first entry
+        void drawCache(QPainter *painter) const;
+
+        QList<Entry> mEntries; // most recently used first
+};
+
+#endif /* UBTOOLBODYCACHE_H_ */
@@ -7,7 +7,8 @@ HEADERS      += src/tools/UBGraphicsRuler.h \
                 src/tools/UBGraphicsCurtainItem.h \
                 src/tools/UBGraphicsCurtainItemDelegate.h \
                 src/tools/UBAbstractDrawRuler.h \
-    src/tools/UBGraphicsCache.h
+    src/tools/UBGraphicsCache.h \
+    src/tools/UBToolBodyCache.h
                 
 SOURCES      += src/tools/UBGraphicsRuler.cpp \
 		src/tools/UBGraphicsTriangle.cpp \
@@ -17,4 +18,5 @@ SOURCES      += src/tools/UBGraphicsRuler.cpp \
                 src/tools/UBGraphicsCurtainItem.cpp \
                 src/tools/UBGraphicsCurtainItemDelegate.cpp \
                 src/tools/UBAbstractDrawRuler.cpp \
-    src/tools/UBGraphicsCache.cpp
+    src/tools/UBGraphicsCache.cpp \
+    src/tools/UBToolBodyCache.cpp
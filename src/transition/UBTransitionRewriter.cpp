@@ -0,0 +1,282 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBTransitionRewriter.h"
+
+static const qint64 chunkSize = 64 * 1024;
+
+static bool isTagStart(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '/' || c == '!' || c == '?';
+}
+
+static bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+UBTransitionRewriter::UBTransitionRewriter()
+    : mKeepSource(false)
+    , mChanges(0)
+{
+    // NOOP
+}
+
+UBTransitionRewriter::~UBTransitionRewriter()
+{
+    // NOOP
+}
+
+bool UBTransitionRewriter::rewrite(QIODevice* pInput, QIODevice* pOutput)
+{
+    mChanges = 0;
+    mKeepSource = false;
+
+    QByteArray tag;
+    bool inTag = false;
+    char quote = 0;
+
+    while (!pInput->atEnd() && !mKeepSource)
+    {
+        QByteArray chunk = pInput->read(chunkSize);
+
+        if (chunk.isEmpty())
+            return false;
+
+        int i = 0;
+
+        while (i < chunk.size() && !mKeepSource)
+        {
+            if (!inTag)
+            {
+                int tagStart = chunk.indexOf('<', i);
+                int textEnd = tagStart < 0 ? chunk.size() : tagStart;
+
+                if (pOutput && textEnd > i && pOutput->write(chunk.constData() + i, textEnd - i) < 0)
+                    return false;
+
+                if (tagStart < 0)
+                {
+                    i = chunk.size();
+                }
+                else
+                {
+                    tag = "<";
+                    inTag = true;
+                    quote = 0;
+                    i = tagStart + 1;
+                }
+                continue;
+            }
+
+            char c = chunk.at(i++);
+
+            if (tag.size() == 1 && !isTagStart(c))
+            {
+                // a lone '<' in text, e.g. in a script
+                if (pOutput && pOutput->write(tag) < 0)
+                    return false;
+
+                if (c == '<')
+                    continue;
+
+                // c is text again
+                inTag = false;
+                i--;
+                continue;
+            }
+
+            tag += c;
+
+            bool tagEnd = false;
+
+            if (tag.startsWith("<!--"))
+                tagEnd = tag.size() >= 7 && tag.endsWith("-->");
+            else if (tag.startsWith("<![CDATA["))
+                tagEnd = tag.endsWith("]]>");
+            else if (quote)
+                quote = (c == quote) ? 0 : quote;
+            else if ((c == '"' || c == '\'') && tag.at(tag.size() - 2) == '=')
+                quote = c;
+            else
+                tagEnd = (c == '>');
+
+            if (tagEnd)
+            {
+                if (!flushTag(tag, pOutput))
+                    return false;
+
+                inTag = false;
+            }
+        }
+    }
+
+    // unterminated tag, copied as is
+    if (inTag && !mKeepSource && pOutput && pOutput->write(tag) < 0)
+        return false;
+
+    return true;
+}
+
+bool UBTransitionRewriter::flushTag(QByteArray& pTag, QIODevice* pOutput)
+{
+    char first = pTag.size() > 1 ? pTag.at(1) : 0;
+    bool isElement = (first >= 'a' && first <= 'z') || (first >= 'A' && first <= 'Z');
+
+    if (isElement && rewriteTag(pTag))
+        mChanges++;
+
+    return !pOutput || pOutput->write(pTag) >= 0;
+}
+
+QByteArray UBTransitionRewriter::tagName(const QByteArray& pTag)
+{
+    int end = 1;
+
+    while (end < pTag.size() && !isSpace(pTag.at(end)) && pTag.at(end) != '/' && pTag.at(end) != '>')
+        end++;
+
+    return pTag.mid(1, end - 1).toLower();
+}
+
+bool UBTransitionRewriter::attributeValue(const QByteArray& pTag, const QByteArray& pName, int& pValueStart, int& pValueLength)
+{
+    int from = 0;
+
+    while ((from = pTag.indexOf(pName, from)) > 0)
+    {
+        int i = from + pName.size();
+        bool isAttribute = isSpace(pTag.at(from - 1));
+
+        from = i;
+
+        if (!isAttribute)
+            continue;
+
+        while (i < pTag.size() && isSpace(pTag.at(i)))
+            i++;
+
+        if (i >= pTag.size() || pTag.at(i) != '=')
+            continue;
+
+        i++;
+
+        while (i < pTag.size() && isSpace(pTag.at(i)))
+            i++;
+
+        if (i >= pTag.size() || (pTag.at(i) != '"' && pTag.at(i) != '\''))
+            continue;
+
+        int valueEnd = pTag.indexOf(pTag.at(i), i + 1);
+
+        if (valueEnd < 0)
+            return false;
+
+        pValueStart = i + 1;
+        pValueLength = valueEnd - pValueStart;
+
+        return true;
+    }
+
+    return false;
+}
+
+bool UBTransitionRewriter::stripPrefix(QByteArray& pTag, const QByteArray& pAttributeName, const QByteArray& pMarker, bool pKeepMarker)
+{
+    int valueStart = 0;
+    int valueLength = 0;
+
+    if (!attributeValue(pTag, pAttributeName, valueStart, valueLength))
+        return false;
+
+    int marker = pTag.mid(valueStart, valueLength).indexOf(pMarker);
+
+    if (marker < 0)
+        return false;
+
+    int prefixLength = pKeepMarker ? marker : marker + pMarker.size();
+
+    if (prefixLength == 0)
+        return false;
+
+    pTag.remove(valueStart, prefixLength);
+
+    return true;
+}
+
+
+UBPageTransitionRewriter::UBPageTransitionRewriter()
+    : UBTransitionRewriter()
+{
+    // NOOP
+}
+
+bool UBPageTransitionRewriter::rewriteTag(QByteArray& pTag)
+{
+    QByteArray name = tagName(pTag);
+
+    if (name == "video")
+        return stripPrefix(pTag, "xlink:href", "videos/", true);
+    else if (name == "audio")
+        return stripPrefix(pTag, "xlink:href", "audios/", true);
+
+    return false;
+}
+
+
+UBWidgetTransitionRewriter::UBWidgetTransitionRewriter()
+    : UBTransitionRewriter()
+{
+    // NOOP
+}
+
+bool UBWidgetTransitionRewriter::rewriteTag(QByteArray& pTag)
+{
+    static const QByteArray webDirectory("interactive content/Web/");
+
+    QByteArray name = tagName(pTag);
+
+    if (name == "object")
+        return stripPrefix(pTag, "data", webDirectory, false);
+
+    if (name != "param")
+        return false;
+
+    int valueStart = 0;
+    int valueLength = 0;
+
+    if (!attributeValue(pTag, "name", valueStart, valueLength) || pTag.mid(valueStart, valueLength) != "movie"
+            || !attributeValue(pTag, "value", valueStart, valueLength))
+        return false;
+
+    if (mSwfOrigin.isEmpty())
+    {
+        mSwfOrigin = QString::fromUtf8(pTag.mid(valueStart, valueLength));
+
+        if (mSwfOrigin.contains("http://"))
+        {
+            // an url is the source of the swf. The source is kept as is.
+            mKeepSource = true;
+            return false;
+        }
+    }
+
+    bool changed = stripPrefix(pTag, "value", webDirectory, false);
+
+    if (mSwfFileName.isEmpty() && attributeValue(pTag, "value", valueStart, valueLength))
+        mSwfFileName = QString::fromUtf8(pTag.mid(valueStart, valueLength));
+
+    return changed;
+}
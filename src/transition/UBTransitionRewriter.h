@@ -0,0 +1,83 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef UBTRANSITIONREWRITER_H
+#define UBTRANSITIONREWRITER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+
+// Streams a page or a widget index tag by tag, only the rewritten tags are changed,
+// everything else (text, comments, encoding) is copied byte for byte.
+class UBTransitionRewriter
+{
+public:
+    UBTransitionRewriter();
+    virtual ~UBTransitionRewriter();
+
+    // pOutput may be 0 to only count the changes (dry run)
+    bool rewrite(QIODevice* pInput, QIODevice* pOutput);
+
+    int changes() const { return mChanges; }
+
+    // the output must be discarded, the source is kept as is
+    bool keepSource() const { return mKeepSource; }
+
+protected:
+    // returns true if pTag was changed
+    virtual bool rewriteTag(QByteArray& pTag) = 0;
+
+    static QByteArray tagName(const QByteArray& pTag);
+    static bool attributeValue(const QByteArray& pTag, const QByteArray& pName, int& pValueStart, int& pValueLength);
+    static bool stripPrefix(QByteArray& pTag, const QByteArray& pAttributeName, const QByteArray& pMarker, bool pKeepMarker);
+
+    bool mKeepSource;
+
+private:
+    bool flushTag(QByteArray& pTag, QIODevice* pOutput);
+
+    int mChanges;
+};
+
+
+// media hrefs of the pages become relative to the document
+class UBPageTransitionRewriter : public UBTransitionRewriter
+{
+public:
+    UBPageTransitionRewriter();
+
+protected:
+    virtual bool rewriteTag(QByteArray& pTag);
+};
+
+
+// flash paths of the widgets become relative to the widget
+class UBWidgetTransitionRewriter : public UBTransitionRewriter
+{
+public:
+    UBWidgetTransitionRewriter();
+
+    QString swfOrigin() const { return mSwfOrigin; }
+    QString swfFileName() const { return mSwfFileName; }
+
+protected:
+    virtual bool rewriteTag(QByteArray& pTag);
+
+private:
+    QString mSwfOrigin;
+    QString mSwfFileName;
+};
+
+#endif // UBTRANSITIONREWRITER_H
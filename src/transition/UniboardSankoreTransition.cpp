@@ -19,6 +19,16 @@
 #include "frameworks/UBFileSystemUtils.h"
 #include "core/UBApplication.h"
 #include "core/UBPersistenceManager.h"
+#include "transition/UBTransitionRewriter.h"
+
+static const QString backupJournalEntry("backup ");
+static const QString documentJournalEntry("document ");
+static const QString targetJournalEntry("target ");
+
+static bool isTransitionDocument(const QFileInfo& fileInfo)
+{
+    return fileInfo.isDir() && (fileInfo.fileName().startsWith("Uniboard Document ") || fileInfo.fileName().startsWith("Sankore Document "));
+}
 
 UniboardSankoreTransition::UniboardSankoreTransition(QObject *parent) :
     QObject(parent)
@@ -52,25 +62,35 @@ UniboardSankoreTransition::~UniboardSankoreTransition()
 
 void UniboardSankoreTransition::rollbackDocumentsTransition(QFileInfoList& fileInfoList)
 {
+    // only the copies written by this transition are removed, the Sankore documents already there are kept
+    QSet<QString> journal = readJournal();
+
     QFileInfoList::iterator fileInfo;
     for (fileInfo = fileInfoList.begin(); fileInfo != fileInfoList.end(); fileInfo += 1) {
         if (fileInfo->isDir() && fileInfo->fileName().startsWith("Uniboard Document ")){
             QString sankoreDocumentName = fileInfo->fileName();
             sankoreDocumentName.replace("Uniboard","Sankore");
             QString sankoreDocumentDirectoryPath = UBSettings::uniboardDocumentDirectory() + "/" + sankoreDocumentName;
-            if (QFileInfo(sankoreDocumentDirectoryPath).exists()){
+            if (journal.contains(targetJournalEntry + sankoreDocumentDirectoryPath) && QFileInfo(sankoreDocumentDirectoryPath).exists()){
                 UBFileSystemUtils::deleteDir(sankoreDocumentDirectoryPath);
             }
         }
     }
 }
 
-bool UniboardSankoreTransition::checkDocumentDirectory(QString& documentDirectoryPath)
+QFileInfoList UniboardSankoreTransition::sourceDocuments()
+{
+    QFileInfoList fileInfoList = UBFileSystemUtils::allElementsInDirectory(mUniboardSourceDirectory + "/document");
+    fileInfoList << UBFileSystemUtils::allElementsInDirectory(mOldSankoreDirectory + "/document");
+    return fileInfoList;
+}
+
+bool UniboardSankoreTransition::checkDocumentDirectory(QString& documentDirectoryPath, QStringList* pDryRunReport)
 {
     bool result = true;
-    result = updateSankoreHRef(documentDirectoryPath);
+    result = updateSankoreHRef(documentDirectoryPath, pDryRunReport);
     QString sankoreWidgetPath = documentDirectoryPath + "/widgets";
-    result &= updateIndexWidget(sankoreWidgetPath);
+    result &= updateIndexWidget(sankoreWidgetPath, pDryRunReport);
     return result;
 }
 
@@ -101,94 +121,70 @@ void UniboardSankoreTransition::startDocumentTransition()
 }
 
 
-bool UniboardSankoreTransition::checkPage(QString& sankorePagePath)
+bool UniboardSankoreTransition::rewriteFile(const QString& pPath, UBTransitionRewriter& pRewriter, QStringList* pDryRunReport)
 {
-    QFile file(sankorePagePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    QFile file(pPath);
+    if (!file.open(QIODevice::ReadOnly))
         return false;
 
-    QByteArray documentByteArray = file.readAll();
-    file.close();
-
-    QString sankoreDirectory = sankorePagePath.left(sankorePagePath.indexOf("/page"));
-
-    sankoreDirectory = QUrl::fromLocalFile(sankoreDirectory).toString();
-    QString documentString(documentByteArray);
-
-    QRegExp videoRegExp("<video(.*)xlink:href=\"(.*)videos/(.*)/>");
-    videoRegExp.setMinimal(true);
-
-    documentString.replace(videoRegExp,"<video\\1xlink:href=\"videos/\\3/>");
-
-
-    QRegExp audioRegExp("<audio(.*)xlink:href=\"(.*)audios/(.*)/>");
-    audioRegExp.setMinimal(true);
-
-    documentString.replace(audioRegExp,"<audio\\1xlink:href=\"audios/\\3/>");
+    if (pDryRunReport){
+        bool result = pRewriter.rewrite(&file, 0);
+        if (result && !pRewriter.keepSource() && pRewriter.changes() > 0)
+            *pDryRunReport << QString("%1: %2 change(s)").arg(pPath).arg(pRewriter.changes());
+        return result;
+    }
 
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    // streamed to a sibling file, the page is only replaced once completely rewritten
+    QFile rewrittenFile(pPath + ".transition");
+    if (!rewrittenFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
         return false;
 
-    file.write(documentString.toAscii());
+    bool result = pRewriter.rewrite(&file, &rewrittenFile);
     file.close();
+    rewrittenFile.close();
 
-    return true;
+    if (!result || pRewriter.keepSource() || pRewriter.changes() == 0){
+        rewrittenFile.remove();
+        return result;
+    }
+
+    return file.remove() && rewrittenFile.rename(pPath);
 }
 
 
-bool UniboardSankoreTransition::checkWidget(QString& sankoreWidgetIndexPath)
+bool UniboardSankoreTransition::checkPage(QString& sankorePagePath, QStringList* pDryRunReport)
 {
-    QFile file(sankoreWidgetIndexPath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
-        return false;
+    UBPageTransitionRewriter rewriter;
+    return rewriteFile(sankorePagePath, rewriter, pDryRunReport);
+}
 
-    QByteArray documentByteArray = file.readAll();
-    file.close();
 
-    QString documentString(documentByteArray);
+bool UniboardSankoreTransition::checkWidget(QString& sankoreWidgetIndexPath, QStringList* pDryRunReport)
+{
+    UBWidgetTransitionRewriter rewriter;
+    if (!rewriteFile(sankoreWidgetIndexPath, rewriter, pDryRunReport))
+        return false;
 
-    QRegExp swfOriginFilePathRegExp("<param name=\"movie\" value=\"(.*)\">");
-    swfOriginFilePathRegExp.setMinimal(true);
-    swfOriginFilePathRegExp.indexIn(documentString);
-    QString origin = swfOriginFilePathRegExp.cap(1);
-    if(origin.contains("http://")){
-        // an url is the source of the swf. The source is kept as is.
+    if (rewriter.keepSource() || rewriter.swfOrigin().isEmpty())
         return true;
-    }
-
-    //changing the path
-    QRegExp swfDataPathRegExp("<object(.*)data=\"(.*)interactive content/Web/(.*)\"(.*)>");
-    swfDataPathRegExp.setMinimal(true);
-    documentString.replace(swfDataPathRegExp,"<object\\1data=\"\\3\">");
-
-    QRegExp swfMoviePathRegExp("<param name=\"movie\" value=\"(.*)interactive content/Web/(.*)\">");
-    swfMoviePathRegExp.setMinimal(true);
-    documentString.replace(swfMoviePathRegExp,"<param name=\"movie\" value=\"\\2\">");
 
     //copy the swf on the right place
-    QRegExp swfFileNameRegExp("<param name=\"movie\" value=\"(.*)\">");
-    swfFileNameRegExp.setMinimal(true);
-    swfFileNameRegExp.indexIn(documentString);
-    QString swfFileName = swfFileNameRegExp.cap(1);
     int lastDirectoryLevel = sankoreWidgetIndexPath.lastIndexOf("/");
     if (lastDirectoryLevel == -1)
         lastDirectoryLevel = sankoreWidgetIndexPath.lastIndexOf("\\");
 
+    QString destination(sankoreWidgetIndexPath.left(lastDirectoryLevel) + "/" + rewriter.swfFileName());
 
-    QString destination(sankoreWidgetIndexPath.left(lastDirectoryLevel) + "/" + swfFileName);
-    QFile(origin).copy(destination);
-
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
-        return false;
-
-    file.write(documentString.toAscii());
-    file.close();
+    if (pDryRunReport)
+        *pDryRunReport << QString("%1: copy %2 to %3").arg(sankoreWidgetIndexPath).arg(rewriter.swfOrigin()).arg(destination);
+    else
+        QFile(rewriter.swfOrigin()).copy(destination);
 
     return true;
 }
 
 
-bool UniboardSankoreTransition::updateIndexWidget(QString& sankoreWidgetPath)
+bool UniboardSankoreTransition::updateIndexWidget(QString& sankoreWidgetPath, QStringList* pDryRunReport)
 {
     bool result = true;
     QFileInfoList fileInfoList = UBFileSystemUtils::allElementsInDirectory(sankoreWidgetPath);
@@ -198,18 +194,18 @@ bool UniboardSankoreTransition::updateIndexWidget(QString& sankoreWidgetPath)
         if (fileInfo->fileName().endsWith("wgt")){
             QString path = fileInfo->absolutePath() + "/" + fileInfo->fileName() + "/index.html";
             if (QFile(path).exists())
-                result = checkWidget(path);
+                result = checkWidget(path, pDryRunReport);
 
             path = fileInfo->absolutePath() + "/" + fileInfo->fileName() + "/index.htm";
             if (QFile(path).exists())
-                result &= checkWidget(path);
+                result &= checkWidget(path, pDryRunReport);
         }
     }
 
     return result;
 }
 
-bool UniboardSankoreTransition::updateSankoreHRef(QString& sankoreDocumentPath)
+bool UniboardSankoreTransition::updateSankoreHRef(QString& sankoreDocumentPath, QStringList* pDryRunReport)
 {
     bool result = true;
     QFileInfoList fileInfoList = UBFileSystemUtils::allElementsInDirectory(sankoreDocumentPath);
@@ -219,7 +215,7 @@ bool UniboardSankoreTransition::updateSankoreHRef(QString& sankoreDocumentPath)
     for (fileInfo = fileInfoList.begin(); fileInfo != fileInfoList.end() && result; fileInfo += 1) {
         if (fileInfo->fileName().endsWith("svg")){
             QString path = fileInfo->absolutePath() + "/" + fileInfo->fileName();
-            result = checkPage(path);
+            result = checkPage(path, pDryRunReport);
         }
     }
 
@@ -228,29 +224,37 @@ bool UniboardSankoreTransition::updateSankoreHRef(QString& sankoreDocumentPath)
 
 void UniboardSankoreTransition::executeTransition()
 {
-    bool result = false;
+    bool result = true;
     QString backupDestinationPath = mTransitionDlg->backupPath() + "/OldSankoreAndUniboardVersionsBackup";
-    result = UBFileSystemUtils::copyDir(mUniboardSourceDirectory + "/document", backupDestinationPath);
-    result &= UBFileSystemUtils::copyDir(mOldSankoreDirectory + "/document", backupDestinationPath);
 
-    QString uniboardDocumentDirectory = mUniboardSourceDirectory + "/document";
-    QFileInfoList fileInfoList = UBFileSystemUtils::allElementsInDirectory(uniboardDocumentDirectory);
-    fileInfoList.append(UBFileSystemUtils::allElementsInDirectory(mOldSankoreDirectory + "/document"));
+    mJournal = readJournal();
 
-    QFileInfoList::iterator fileInfo;
-    QString sankoreDocumentDirectory = UBSettings::uniboardDocumentDirectory();
+    if (!mJournal.contains(backupJournalEntry + backupDestinationPath)){
+        // the backup of an interrupted transition is incomplete
+        if (!mJournal.isEmpty())
+            UBFileSystemUtils::deleteDir(backupDestinationPath);
 
-    for (fileInfo = fileInfoList.begin(); fileInfo != fileInfoList.end() && result; fileInfo += 1) {
-        if (fileInfo->isDir() && (fileInfo->fileName().startsWith("Uniboard Document ") || fileInfo->fileName().startsWith("Sankore Document "))){
-            QString sankoreDocumentName = fileInfo->fileName();
-            emit transitioningFile(sankoreDocumentName);
-            sankoreDocumentName.replace("Uniboard","Sankore");
-            QString sankoreDocumentPath = sankoreDocumentDirectory + "/" + sankoreDocumentName;
-            result = UBFileSystemUtils::copyDir(fileInfo->filePath(),sankoreDocumentPath);
-            result &= updateSankoreHRef(sankoreDocumentPath);
-            QString sankoreWidgetPath = sankoreDocumentDirectory +  "/" + sankoreDocumentName + "/widgets";
-            result &= updateIndexWidget(sankoreWidgetPath);
+        result = UBFileSystemUtils::copyDir(mUniboardSourceDirectory + "/document", backupDestinationPath);
+        result &= UBFileSystemUtils::copyDir(mOldSankoreDirectory + "/document", backupDestinationPath);
+        if (result)
+            appendJournal(backupJournalEntry + backupDestinationPath);
+    }
+
+    QFileInfoList fileInfoList = sourceDocuments();
+
+    if (result){
+        mFailed = 0;
+
+        // documents are independent, the ones done by an interrupted transition are skipped
+        QThreadPool documentPool;
+        QFileInfoList::iterator fileInfo;
+        for (fileInfo = fileInfoList.begin(); fileInfo != fileInfoList.end(); fileInfo += 1) {
+            if (isTransitionDocument(*fileInfo) && !mJournal.contains(documentJournalEntry + fileInfo->filePath()))
+                documentPool.start(new UniboardSankoreDocumentTask(this, *fileInfo));
         }
+        documentPool.waitForDone();
+
+        result = (mFailed == 0);
     }
 
     if (!result){
@@ -263,9 +267,99 @@ void UniboardSankoreTransition::executeTransition()
         UBFileSystemUtils::deleteDir(mUniboardSourceDirectory);
     }
 
+    QFile::remove(journalPath());
+
     emit transitionFinished(result);
 }
 
+void UniboardSankoreTransition::transitionDocument(const QFileInfo& pSourceDocument)
+{
+    if (mFailed != 0)
+        return;
+
+    QString sankoreDocumentName = pSourceDocument.fileName();
+    emit transitioningFile(sankoreDocumentName);
+    sankoreDocumentName.replace("Uniboard","Sankore");
+    QString sankoreDocumentPath = UBSettings::uniboardDocumentDirectory() + "/" + sankoreDocumentName;
+
+    QFileInfo sankoreDocumentInfo(sankoreDocumentPath);
+    if (sankoreDocumentInfo.exists() && sankoreDocumentInfo.canonicalFilePath() != pSourceDocument.canonicalFilePath()){
+        // a copy started by an interrupted transition is partial and done again, any other document is never replaced
+        if (!mJournal.contains(targetJournalEntry + sankoreDocumentPath)){
+            qWarning() << "transition skips" << pSourceDocument.filePath() << "as" << sankoreDocumentPath << "already exists";
+            appendJournal(documentJournalEntry + pSourceDocument.filePath());
+            return;
+        }
+
+        UBFileSystemUtils::deleteDir(sankoreDocumentPath);
+    }
+
+    appendJournal(targetJournalEntry + sankoreDocumentPath);
+
+    bool result = UBFileSystemUtils::copyDir(pSourceDocument.filePath(), sankoreDocumentPath);
+    result = result && checkDocumentDirectory(sankoreDocumentPath);
+
+    if (result)
+        appendJournal(documentJournalEntry + pSourceDocument.filePath());
+    else
+        mFailed = 1;
+}
+
+QStringList UniboardSankoreTransition::dryRun()
+{
+    QStringList report;
+    QSet<QString> journal = readJournal();
+
+    foreach(QFileInfo fileInfo, sourceDocuments()){
+        if (!isTransitionDocument(fileInfo))
+            continue;
+
+        QString documentPath = fileInfo.filePath();
+
+        if (journal.contains(documentJournalEntry + documentPath))
+            report << QString("%1: already transitioned").arg(documentPath);
+        else if (!checkDocumentDirectory(documentPath, &report))
+            report << QString("%1: cannot be read").arg(documentPath);
+    }
+
+    return report;
+}
+
+QString UniboardSankoreTransition::journalPath() const
+{
+    return UBSettings::uniboardDataDirectory() + "/transition.journal";
+}
+
+QSet<QString> UniboardSankoreTransition::readJournal() const
+{
+    QSet<QString> entries;
+
+    QFile journal(journalPath());
+    if (!journal.open(QIODevice::ReadOnly | QIODevice::Text))
+        return entries;
+
+    // a line cut by an interruption matches nothing, that step is done again
+    while (!journal.atEnd())
+        entries << QString::fromUtf8(journal.readLine()).trimmed();
+
+    return entries;
+}
+
+void UniboardSankoreTransition::appendJournal(const QString& pEntry)
+{
+    QMutexLocker locker(&mJournalMutex);
+
+    QFile journal(journalPath());
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)){
+        qWarning() << "cannot write transition journal" << journalPath();
+        return;
+    }
+
+    journal.write(pEntry.toUtf8() + "\n");
+    journal.flush();
+    journal.close();
+}
+
 
 UniboardSankoreThread::UniboardSankoreThread(QObject* parent):QThread(parent)
 {
@@ -284,3 +378,14 @@ void UniboardSankoreThread::run()
     pTransition->executeTransition();
 }
 
+UniboardSankoreDocumentTask::UniboardSankoreDocumentTask(UniboardSankoreTransition* pTransition, const QFileInfo& pSourceDocument)
+    : mTransition(pTransition)
+    , mSourceDocument(pSourceDocument)
+{
+
+}
+
+void UniboardSankoreDocumentTask::run()
+{
+    mTransition->transitionDocument(mSourceDocument);
+}
@@ -18,9 +18,16 @@
 #include <QObject>
 #include <QFileInfo>
 #include <QThread>
+#include <QRunnable>
+#include <QMutex>
+#include <QSet>
+#include <QStringList>
 #include "gui/UBUpdateDlg.h"
 #include "document/UBDocumentProxy.h"
 
+class UBTransitionRewriter;
+class UniboardSankoreTransition;
+
 class UniboardSankoreThread : public QThread
 {
     Q_OBJECT
@@ -32,6 +39,18 @@ public:
 
 };
 
+class UniboardSankoreDocumentTask : public QRunnable
+{
+public:
+    UniboardSankoreDocumentTask(UniboardSankoreTransition* pTransition, const QFileInfo& pSourceDocument);
+
+    void run();
+
+private:
+    UniboardSankoreTransition* mTransition;
+    QFileInfo mSourceDocument;
+};
+
 class UniboardSankoreTransition : public QObject
 {
     Q_OBJECT
@@ -39,19 +58,35 @@ public:
     explicit UniboardSankoreTransition(QObject *parent = 0);
     ~UniboardSankoreTransition();
 
-    bool checkDocumentDirectory(QString& documentDirectoryPath);
+    // with a dry run report, the files are only read and the changes they need are reported
+    bool checkDocumentDirectory(QString& documentDirectoryPath, QStringList* pDryRunReport = 0);
 
     void documentTransition();
-    bool checkPage(QString& sankorePagePath);
-    bool updateSankoreHRef(QString &sankoreDocumentPath);
-    bool checkWidget(QString& sankoreWidgetPath);
-    bool updateIndexWidget(QString& sankoreWidgetPath);
+    bool checkPage(QString& sankorePagePath, QStringList* pDryRunReport = 0);
+    bool updateSankoreHRef(QString &sankoreDocumentPath, QStringList* pDryRunReport = 0);
+    bool checkWidget(QString& sankoreWidgetPath, QStringList* pDryRunReport = 0);
+    bool updateIndexWidget(QString& sankoreWidgetPath, QStringList* pDryRunReport = 0);
     void executeTransition();
+    void transitionDocument(const QFileInfo& pSourceDocument);
 
+    // what the transition would change, nothing is written
+    QStringList dryRun();
 
 private:
     void rollbackDocumentsTransition(QFileInfoList& fileInfoList);
+    QFileInfoList sourceDocuments();
+    bool rewriteFile(const QString& pPath, UBTransitionRewriter& pRewriter, QStringList* pDryRunReport);
+
+    // the journal lists what is started and done, an interrupted transition resumes from it
+    QString journalPath() const;
+    QSet<QString> readJournal() const;
+    void appendJournal(const QString& pEntry);
+
     UBUpdateDlg* mTransitionDlg;
+    QSet<QString> mJournal; // as read when the transition starts
+
+    QMutex mJournalMutex;
+    QAtomicInt mFailed;
 
 protected:
     QString mUniboardSourceDirectory;
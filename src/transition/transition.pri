@@ -1,5 +1,7 @@
 
-HEADERS      += src/transition/UniboardSankoreTransition.h
+HEADERS      += src/transition/UniboardSankoreTransition.h \
+                src/transition/UBTransitionRewriter.h
 
                 
-SOURCES      += src/transition/UniboardSankoreTransition.cpp
+SOURCES      += src/transition/UniboardSankoreTransition.cpp \
+                src/transition/UBTransitionRewriter.cpp
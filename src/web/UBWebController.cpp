@@ -19,6 +19,7 @@
 
 #include "UBWebController.h"
 #include "UBTrapFlashController.h"
+#include "UBWebPageCapture.h"
 
 #include "web/browser/WBBrowserWindow.h"
 #include "web/browser/WBWebView.h"
@@ -311,58 +312,6 @@ void UBWebController::activePageChanged()
 }
 
 
-QPixmap UBWebController::captureCurrentPage()
-{
-    QPixmap pix;
-
-    if (mCurrentWebBrowser
-        && (*mCurrentWebBrowser)
-        && (*mCurrentWebBrowser)->currentTabWebView()
-        && (*mCurrentWebBrowser)->currentTabWebView()->page()
-        && (*mCurrentWebBrowser)->currentTabWebView()->page()->mainFrame())
-    {
-        QWebFrame* frame = (*mCurrentWebBrowser)->currentTabWebView()->page()->mainFrame();
-        QSize size = frame->contentsSize();
-
-        qDebug() << size;
-
-        QVariant top = frame->evaluateJavaScript("document.getElementsByTagName('body')[0].clientTop");
-        QVariant left = frame->evaluateJavaScript("document.getElementsByTagName('body')[0].clientLeft");
-        QVariant width = frame->evaluateJavaScript("document.getElementsByTagName('body')[0].clientWidth");
-        QVariant height = frame->evaluateJavaScript("document.getElementsByTagName('body')[0].clientHeight");
-
-        QSize vieportSize = (*mCurrentWebBrowser)->currentTabWebView()->page()->viewportSize();
-        (*mCurrentWebBrowser)->currentTabWebView()->page()->setViewportSize(frame->contentsSize());
-        pix = QPixmap(frame->geometry().width(), frame->geometry().height());
-
-        {
-            QPainter p(&pix);
-            frame->render(&p);
-        }
-
-        if (left.isValid() && top.isValid() && width.isValid() && height.isValid())
-        {
-            bool okLeft, okTop, okWidth, okHeight;
-
-            int iLeft = left.toInt(&okLeft) * frame->zoomFactor();
-            int iTop = top.toInt(&okTop) * frame->zoomFactor();
-            int iWidth = width.toInt(&okWidth) * frame->zoomFactor();
-            int iHeight = height.toInt(&okHeight) * frame->zoomFactor();
-
-            if(okLeft && okTop && okWidth && okHeight)
-            {
-                pix = pix.copy(iLeft, iTop, iWidth, iHeight);
-            }
-        }
-
-
-        (*mCurrentWebBrowser)->currentTabWebView()->page()->setViewportSize(vieportSize);
-    }
-
-    return pix;
-}
-
-
 void UBWebController::setupPalettes()
 {
 	if(!(*mToolsCurrentPalette))
@@ -427,11 +376,50 @@ void UBWebController::toggleWebToolsPalette(bool checked)
 
 void UBWebController::captureWindow()
 {
-    QPixmap webPagePixmap = captureCurrentPage();
+    if (mPageCapture)
+        return;
+
+    if (mCurrentWebBrowser
+        && (*mCurrentWebBrowser)
+        && (*mCurrentWebBrowser)->currentTabWebView()
+        && (*mCurrentWebBrowser)->currentTabWebView()->page())
+    {
+        mPageCaptureUrl = (*mCurrentWebBrowser)->currentTabWebView()->url();
+        mPageCapture = new UBWebPageCapture((*mCurrentWebBrowser)->currentTabWebView()->page(), this);
+
+        connect(mPageCapture, SIGNAL(progress(int, int)), this, SLOT(pageCaptureProgress(int, int)));
+        connect(mPageCapture, SIGNAL(finished(UBWebPageCapture*, bool)), this, SLOT(pageCaptureFinished(UBWebPageCapture*, bool)));
+
+        mPageCapture->start();
+    }
+}
+
+
+void UBWebController::pageCaptureProgress(int pCurrent, int pTotal)
+{
+    UBApplication::showMessage(tr("Capturing web page (%1%)").arg(pTotal > 0 ? pCurrent * 100 / pTotal : 100), true);
+}
+
+
+void UBWebController::pageCaptureFinished(UBWebPageCapture* pCapture, bool pCancelled)
+{
+    QStringList bandFiles = pCapture->bandFiles();
 
-    if (!webPagePixmap.isNull())
+    UBApplication::showMessage(pCancelled ? tr("Web page capture cancelled") : "");
+
+    if (pCancelled || bandFiles.isEmpty())
+        return;
+
+    if (bandFiles.size() == 1)
+    {
+        QPixmap pixmap(bandFiles.first());
+        QFile::remove(bandFiles.first());
+
+        emit imageCaptured(pixmap, true, mPageCaptureUrl);
+    }
+    else
     {
-        emit imageCaptured(webPagePixmap, true, (*mCurrentWebBrowser)->currentTabWebView()->url());
+        emit pageCaptured(bandFiles, mPageCaptureUrl);
     }
 }
 
@@ -29,6 +29,7 @@ class UBWebToolsPalette;
 class WBWebView;
 class UBServerXMLHttpRequest;
 class UBKeyboardPalette;
+class UBWebPageCapture;
 
 
 class UBWebController : public QObject
@@ -41,8 +42,6 @@ class UBWebController : public QObject
         void closing();
         void adaptToolBar();
 
-        QPixmap captureCurrentPage();
-
         void showTabAtTop(bool attop);
 
         void loadUrl(const QUrl& url);
@@ -113,6 +112,9 @@ class UBWebController : public QObject
 
         UBServerXMLHttpRequest* mGetOEmbedProviderListRequest;
 
+        QPointer<UBWebPageCapture> mPageCapture;
+        QUrl mPageCaptureUrl;
+
         void tutorialWebInstance();
         void webBrowserInstance();
         void paraschoolWebInstance();
@@ -131,6 +133,9 @@ class UBWebController : public QObject
 
         void getOEmbedProviderListResponse(bool success, const QByteArray& payload);
 
+        void pageCaptureProgress(int pCurrent, int pTotal);
+        void pageCaptureFinished(UBWebPageCapture* pCapture, bool pCancelled);
+
     signals:
         /**
          * This signal is emitted once the screenshot has been performed. This signal is also emitted when user
@@ -139,6 +144,13 @@ class UBWebController : public QObject
          */
         void imageCaptured(const QPixmap& pCapturedPixmap, bool pageMode, const QUrl& source);
 
+        /**
+         * Emitted instead of imageCaptured when a whole page higher than UBWebPageCapture::bandHeight is captured.
+         * @param pBandFiles the image files of the page from top to bottom, in bands of UBWebPageCapture::bandHeight,
+         * removed by the receiver once read
+         */
+        void pageCaptured(const QStringList& pBandFiles, const QUrl& source);
+
         void activeWebPageChanged(WBWebView* pWebView);
 
 };
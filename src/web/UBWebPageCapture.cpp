@@ -0,0 +1,146 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UBWebPageCapture.h"
+
+#include "frameworks/UBFileSystemUtils.h"
+#include "frameworks/UBTrace.h"
+
+#include "core/memcheck.h"
+
+const int UBWebPageCapture::bandHeight = 1024;
+
+
+UBWebPageCapture::UBWebPageCapture(QWebPage* pPage, QObject *pParent)
+    : QObject(pParent)
+    , mPage(pPage)
+    , mNextBandTop(0)
+    , mFinished(false)
+{
+    connect(pPage, SIGNAL(loadStarted()), this, SLOT(cancel()));
+    connect(pPage, SIGNAL(destroyed()), this, SLOT(cancel()));
+}
+
+
+UBWebPageCapture::~UBWebPageCapture()
+{
+    if (mPage && !mViewportSize.isEmpty())
+        mPage->setViewportSize(mViewportSize);
+}
+
+
+void UBWebPageCapture::start()
+{
+    if (!mPage || !mPage->mainFrame())
+    {
+        finish(true);
+        return;
+    }
+
+    QWebFrame* frame = mPage->mainFrame();
+
+    // the whole content is laid out at once, the bands are clipped out of it
+    mViewportSize = mPage->viewportSize();
+    mPage->setViewportSize(frame->contentsSize());
+    mPageSize = frame->geometry().size();
+
+    if (mPageSize.isEmpty())
+    {
+        finish(true);
+        return;
+    }
+
+    QTimer::singleShot(0, this, SLOT(captureNextBand()));
+}
+
+
+void UBWebPageCapture::cancel()
+{
+    finish(true);
+}
+
+
+void UBWebPageCapture::captureNextBand()
+{
+    if (mFinished)
+        return;
+
+    if (!mPage || !mPage->mainFrame())
+    {
+        finish(true);
+        return;
+    }
+
+    UB_TRACE_SCOPE("web.capture.band", "web");
+
+    QRect bandRect(0, mNextBandTop, mPageSize.width(), qMin(bandHeight, mPageSize.height() - mNextBandTop));
+
+    QImage band(bandRect.size(), QImage::Format_RGB32);
+    band.fill(QColor(Qt::white).rgb());
+
+    QPainter painter(&band);
+    painter.translate(0, -bandRect.top());
+    mPage->mainFrame()->render(&painter, QRegion(bandRect));
+    painter.end();
+
+    if (mBandDirectory.isEmpty())
+        mBandDirectory = UBFileSystemUtils::createTempDir("WebCapture");
+
+    // uncompressed, the band is written and read back quickly
+    QString bandFile = mBandDirectory + UBFileSystemUtils::digitFileFormat("/band%1.bmp", mBandFiles.size() + 1);
+
+    if (!band.save(bandFile, "BMP"))
+    {
+        qWarning() << "cannot write the web page capture band" << bandFile;
+        finish(true);
+        return;
+    }
+
+    mBandFiles << bandFile;
+    mNextBandTop = bandRect.bottom() + 1;
+
+    emit progress(mNextBandTop, mPageSize.height());
+
+    if (mNextBandTop >= mPageSize.height())
+        finish(false);
+    else
+        QTimer::singleShot(0, this, SLOT(captureNextBand()));
+}
+
+
+void UBWebPageCapture::finish(bool pCancelled)
+{
+    if (mFinished)
+        return;
+
+    mFinished = true;
+
+    if (mPage && !mViewportSize.isEmpty())
+        mPage->setViewportSize(mViewportSize);
+
+    mViewportSize = QSize();
+
+    if (pCancelled)
+    {
+        if (!mBandDirectory.isEmpty())
+            UBFileSystemUtils::deleteDir(mBandDirectory);
+
+        mBandFiles.clear();
+    }
+
+    emit finished(this, pCancelled);
+
+    deleteLater();
+}
@@ -0,0 +1,79 @@
+/*
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UBWEBPAGECAPTURE_H_
+#define UBWEBPAGECAPTURE_H_
+
+#include <QtGui>
+#include <QtWebKit>
+
+/**
+ * Captures the whole content of a web page as horizontal bands of a fixed height.
+ *
+ * WebKit only renders on the GUI thread, one band is rendered per event loop turn so the
+ * application stays responsive. Each band is written to a temporary file and released once
+ * rendered, no image larger than a band is ever allocated and a single band is held at a time.
+ * The capture is cancelled when the page starts loading another url or is destroyed.
+ */
+class UBWebPageCapture : public QObject
+{
+    Q_OBJECT;
+
+    public:
+        UBWebPageCapture(QWebPage* pPage, QObject *pParent = 0);
+        virtual ~UBWebPageCapture();
+
+        static const int bandHeight;
+
+        QSize pageSize() const
+        {
+            return mPageSize;
+        }
+
+        // top to bottom, all bands have the page width and bandHeight except the last one;
+        // the files belong to the receiver of finished, they are removed when the application quits
+        QStringList bandFiles() const
+        {
+            return mBandFiles;
+        }
+
+    public slots:
+        void start();
+        void cancel();
+
+    signals:
+        void progress(int pCurrent, int pTotal);
+
+        // emitted once, the capture deletes itself afterwards
+        void finished(UBWebPageCapture* pCapture, bool pCancelled);
+
+    private slots:
+        void captureNextBand();
+
+    private:
+        void finish(bool pCancelled);
+
+        QPointer<QWebPage> mPage;
+        QSize mViewportSize;
+        QSize mPageSize;
+
+        QString mBandDirectory;
+        QStringList mBandFiles;
+        int mNextBandTop;
+
+        bool mFinished;
+};
+
+#endif /* UBWEBPAGECAPTURE_H_ */
@@ -14,6 +14,7 @@ HEADERS      += src/web/UBWebController.h \
                 src/web/UBWebPage.h \
                 src/web/UBWebPluginWidget.h \
                 src/web/UBRoutedMouseEventWebView.h \
+                src/web/UBWebPageCapture.h \
 			    src/web/browser/WBBrowserWindow.h \
 			    src/web/browser/WBChaseWidget.h \
 			    src/web/browser/WBDownloadManager.h \
@@ -34,6 +35,7 @@ SOURCES      += src/web/UBWebController.cpp \
                 src/web/UBWebPage.cpp \
                 src/web/UBWebPluginWidget.cpp \
                 src/web/UBRoutedMouseEventWebView.cpp \
+                src/web/UBWebPageCapture.cpp \
 			    src/web/browser/WBBrowserWindow.cpp \
 			    src/web/browser/WBChaseWidget.cpp \
 			    src/web/browser/WBDownloadManager.cpp \